@@ -591,6 +591,7 @@ namespace Microsoft.Build.Utilities
         InputNewerThanOutput = 0,
         InputOrOutputNewerThanTracking = 1,
         InputNewerThanTracking = 2,
+        InputNewerThanOutputAndContentsChanged = 3,
     }
     public enum VisualStudioVersion
     {
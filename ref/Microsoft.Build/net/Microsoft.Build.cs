@@ -1444,6 +1444,14 @@ namespace Microsoft.Build.Experimental.ProjectCache
         CacheMiss = 2,
         CacheNotApplicable = 3,
     }
+    public sealed partial class ContentAddressedProjectCache : Microsoft.Build.Experimental.ProjectCache.ProjectCachePluginBase
+    {
+        public ContentAddressedProjectCache() { }
+        public override System.Threading.Tasks.Task BeginBuildAsync(Microsoft.Build.Experimental.ProjectCache.CacheContext context, Microsoft.Build.Experimental.ProjectCache.PluginLoggerBase logger, System.Threading.CancellationToken cancellationToken) { throw null; }
+        public override System.Threading.Tasks.Task EndBuildAsync(Microsoft.Build.Experimental.ProjectCache.PluginLoggerBase logger, System.Threading.CancellationToken cancellationToken) { throw null; }
+        public override System.Threading.Tasks.Task<Microsoft.Build.Experimental.ProjectCache.CacheResult> GetCacheResultAsync(Microsoft.Build.Execution.BuildRequestData buildRequest, Microsoft.Build.Experimental.ProjectCache.PluginLoggerBase logger, System.Threading.CancellationToken cancellationToken) { throw null; }
+        public override System.Threading.Tasks.Task HandleProjectFinishedAsync(Microsoft.Build.Execution.BuildRequestData buildRequest, Microsoft.Build.Execution.BuildResult buildResult, Microsoft.Build.Experimental.ProjectCache.PluginLoggerBase logger, System.Threading.CancellationToken cancellationToken) { throw null; }
+    }
     public abstract partial class PluginLoggerBase
     {
         protected PluginLoggerBase(Microsoft.Build.Framework.LoggerVerbosity verbosity) { }
@@ -1486,6 +1494,7 @@ namespace Microsoft.Build.Experimental.ProjectCache
         public abstract System.Threading.Tasks.Task BeginBuildAsync(Microsoft.Build.Experimental.ProjectCache.CacheContext context, Microsoft.Build.Experimental.ProjectCache.PluginLoggerBase logger, System.Threading.CancellationToken cancellationToken);
         public abstract System.Threading.Tasks.Task EndBuildAsync(Microsoft.Build.Experimental.ProjectCache.PluginLoggerBase logger, System.Threading.CancellationToken cancellationToken);
         public abstract System.Threading.Tasks.Task<Microsoft.Build.Experimental.ProjectCache.CacheResult> GetCacheResultAsync(Microsoft.Build.Execution.BuildRequestData buildRequest, Microsoft.Build.Experimental.ProjectCache.PluginLoggerBase logger, System.Threading.CancellationToken cancellationToken);
+        public virtual System.Threading.Tasks.Task HandleProjectFinishedAsync(Microsoft.Build.Execution.BuildRequestData buildRequest, Microsoft.Build.Execution.BuildResult buildResult, Microsoft.Build.Experimental.ProjectCache.PluginLoggerBase logger, System.Threading.CancellationToken cancellationToken) { throw null; }
     }
     public partial class ProxyTargets
     {
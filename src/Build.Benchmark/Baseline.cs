@@ -0,0 +1,69 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+using System.Linq;
+
+namespace Microsoft.Build.Benchmark
+{
+    /// <summary>
+    /// The times of a previous run, stored as one tab separated metric name and time in milliseconds per line, so that
+    /// baselines can be checked in and diffed.
+    /// </summary>
+    internal static class Baseline
+    {
+        internal static void Save(string path, IReadOnlyDictionary<string, double> metrics)
+        {
+            File.WriteAllLines(
+                path,
+                metrics.OrderBy(metric => metric.Key, StringComparer.Ordinal)
+                    .Select(metric => metric.Key + "\t" + metric.Value.ToString("F1", CultureInfo.InvariantCulture)));
+        }
+
+        internal static Dictionary<string, double> Load(string path)
+        {
+            var metrics = new Dictionary<string, double>(StringComparer.Ordinal);
+
+            foreach (string line in File.ReadLines(path))
+            {
+                string[] fields = line.Split('\t');
+                if (fields.Length == 2 && double.TryParse(fields[1], NumberStyles.Float, CultureInfo.InvariantCulture, out double milliseconds))
+                {
+                    metrics[fields[0]] = milliseconds;
+                }
+            }
+
+            return metrics;
+        }
+
+        /// <summary>
+        /// Finds the metrics that got slower than the baseline by more than the threshold. Differences of less than the
+        /// noise floor are ignored, as the times of small metrics vary by more than any threshold from run to run.
+        /// </summary>
+        /// <returns>A description of each regression</returns>
+        internal static List<string> FindRegressions(IReadOnlyDictionary<string, double> baseline, IReadOnlyDictionary<string, double> metrics, double thresholdPercent, double noiseFloorMilliseconds)
+        {
+            var regressions = new List<string>();
+
+            foreach (KeyValuePair<string, double> metric in metrics.OrderBy(metric => metric.Key, StringComparer.Ordinal))
+            {
+                if (baseline.TryGetValue(metric.Key, out double baselineMilliseconds) &&
+                    metric.Value - baselineMilliseconds > noiseFloorMilliseconds &&
+                    metric.Value > baselineMilliseconds * (1 + (thresholdPercent / 100)))
+                {
+                    regressions.Add(string.Format(
+                        CultureInfo.InvariantCulture,
+                        "{0}: {1:F1} ms, {2:F1} ms in the baseline",
+                        metric.Key,
+                        metric.Value,
+                        baselineMilliseconds));
+                }
+            }
+
+            return regressions;
+        }
+    }
+}
@@ -0,0 +1,105 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections.Generic;
+using Microsoft.Build.Framework;
+using Microsoft.Build.Framework.Profiler;
+using Microsoft.Build.Logging;
+
+namespace Microsoft.Build.Benchmark
+{
+    /// <summary>
+    /// Where a build spent its time, read from its binary log: the time evaluating projects, by evaluation pass when the
+    /// build was profiled, and the time running tasks, by task.
+    /// </summary>
+    /// <remarks>
+    /// Times are summed over every project and task, so they only add up to the time of the build when it runs on one node.
+    /// The MSBuild and CallTarget tasks are left out of the task times, as they wait for the projects and targets they build.
+    /// </remarks>
+    internal sealed class BuildBreakdown
+    {
+        private readonly Dictionary<int, DateTime> _evaluationStarts = new Dictionary<int, DateTime>();
+        private readonly Dictionary<BuildEventContext, DateTime> _taskStarts = new Dictionary<BuildEventContext, DateTime>();
+
+        private BuildBreakdown()
+        {
+        }
+
+        internal int Evaluations { get; private set; }
+
+        internal TimeSpan EvaluationTime { get; private set; }
+
+        internal Dictionary<EvaluationPass, TimeSpan> EvaluationPassTimes { get; } = new Dictionary<EvaluationPass, TimeSpan>();
+
+        internal TimeSpan TaskTime { get; private set; }
+
+        internal Dictionary<string, TimeSpan> TaskTimes { get; } = new Dictionary<string, TimeSpan>(StringComparer.OrdinalIgnoreCase);
+
+        internal Dictionary<string, int> TaskCounts { get; } = new Dictionary<string, int>(StringComparer.OrdinalIgnoreCase);
+
+        internal static BuildBreakdown Read(string binaryLogPath)
+        {
+            var breakdown = new BuildBreakdown();
+
+            var replay = new BinaryLogReplayEventSource();
+            replay.AnyEventRaised += (sender, e) => breakdown.Add(e);
+            replay.Replay(binaryLogPath);
+
+            return breakdown;
+        }
+
+        internal TimeSpan GetTaskTime(string taskName) => TaskTimes.TryGetValue(taskName, out TimeSpan time) ? time : TimeSpan.Zero;
+
+        internal int GetTaskCount(string taskName) => TaskCounts.TryGetValue(taskName, out int count) ? count : 0;
+
+        private void Add(BuildEventArgs e)
+        {
+            switch (e)
+            {
+                case ProjectEvaluationStartedEventArgs _:
+                    _evaluationStarts[e.BuildEventContext.EvaluationId] = e.Timestamp;
+                    break;
+
+                case ProjectEvaluationFinishedEventArgs evaluationFinished:
+                    if (_evaluationStarts.TryGetValue(e.BuildEventContext.EvaluationId, out DateTime evaluationStart))
+                    {
+                        Evaluations++;
+                        EvaluationTime += e.Timestamp - evaluationStart;
+                    }
+
+                    if (evaluationFinished.ProfilerResult is ProfilerResult profilerResult)
+                    {
+                        foreach (KeyValuePair<EvaluationLocation, ProfiledLocation> location in profilerResult.ProfiledLocations)
+                        {
+                            if (location.Key.IsEvaluationPass && location.Key.EvaluationPass != EvaluationPass.TotalEvaluation)
+                            {
+                                EvaluationPassTimes.TryGetValue(location.Key.EvaluationPass, out TimeSpan passTime);
+                                EvaluationPassTimes[location.Key.EvaluationPass] = passTime + location.Value.InclusiveTime;
+                            }
+                        }
+                    }
+
+                    break;
+
+                case TaskStartedEventArgs _:
+                    _taskStarts[e.BuildEventContext] = e.Timestamp;
+                    break;
+
+                case TaskFinishedEventArgs taskFinished:
+                    if (_taskStarts.TryGetValue(e.BuildEventContext, out DateTime taskStart) &&
+                        !string.Equals(taskFinished.TaskName, "MSBuild", StringComparison.OrdinalIgnoreCase) &&
+                        !string.Equals(taskFinished.TaskName, "CallTarget", StringComparison.OrdinalIgnoreCase))
+                    {
+                        TimeSpan duration = e.Timestamp - taskStart;
+                        TaskTime += duration;
+
+                        TaskTimes[taskFinished.TaskName] = GetTaskTime(taskFinished.TaskName) + duration;
+                        TaskCounts[taskFinished.TaskName] = GetTaskCount(taskFinished.TaskName) + 1;
+                    }
+
+                    break;
+            }
+        }
+    }
+}
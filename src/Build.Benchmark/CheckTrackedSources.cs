@@ -0,0 +1,45 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using Microsoft.Build.Framework;
+using Microsoft.Build.Utilities;
+
+namespace Microsoft.Build.Benchmark
+{
+    /// <summary>
+    /// The up to date check of CL: reads the tlogs of the project and finds the sources that are newer than their
+    /// objects, or that include a header that is.
+    /// </summary>
+    public sealed class CheckTrackedSources : Task
+    {
+        [Required]
+        public ITaskItem[] Sources { get; set; }
+
+        [Required]
+        public string TrackerLogDirectory { get; set; }
+
+        [Required]
+        public string ObjectDirectory { get; set; }
+
+        [Output]
+        public ITaskItem[] SourcesToCompile { get; set; }
+
+        public override bool Execute()
+        {
+            CanonicalTrackedOutputFiles outputs = TrackedSources.ReadOutputs(this, TrackerLogDirectory);
+            CanonicalTrackedInputFiles inputs = TrackedSources.ReadInputs(this, TrackerLogDirectory, Sources, outputs);
+
+            // The tracking classes return new items for the sources, without the metadata the compile needs
+            var sourcesToCompile = new HashSet<string>(
+                inputs.ComputeSourcesNeedingCompilation().Select(source => Path.GetFullPath(source.ItemSpec)),
+                StringComparer.OrdinalIgnoreCase);
+            SourcesToCompile = Sources.Where(source => sourcesToCompile.Contains(source.GetMetadata("FullPath"))).ToArray();
+
+            return !Log.HasLoggedErrors;
+        }
+    }
+}
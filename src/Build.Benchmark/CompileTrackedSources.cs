@@ -0,0 +1,106 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Text;
+using Microsoft.Build.Framework;
+using Microsoft.Build.Utilities;
+
+namespace Microsoft.Build.Benchmark
+{
+    /// <summary>
+    /// Stands in for a tracked compile by CL: writes an object for each source, records what the compile read and wrote
+    /// in the tlogs FileTracker would have written, and compacts those into the tlogs of the project.
+    /// </summary>
+    public sealed class CompileTrackedSources : Task
+    {
+        private const string IncludeDirective = "#include \"";
+
+        [Required]
+        public ITaskItem[] Sources { get; set; }
+
+        [Required]
+        public string TrackerLogDirectory { get; set; }
+
+        [Required]
+        public string ObjectDirectory { get; set; }
+
+        public override bool Execute()
+        {
+            Directory.CreateDirectory(ObjectDirectory);
+            Directory.CreateDirectory(TrackerLogDirectory);
+
+            // Like CL, forget what the sources depended on before compiling them, so that a failed compile leaves them out of date
+            CanonicalTrackedOutputFiles outputs = TrackedSources.ReadOutputs(this, TrackerLogDirectory);
+            outputs.RemoveEntriesForSource(Sources);
+            outputs.SaveTlog();
+
+            CanonicalTrackedInputFiles inputs = TrackedSources.ReadInputs(this, TrackerLogDirectory, Sources, outputs);
+            inputs.RemoveEntriesForSource(Sources);
+            inputs.SaveTlog();
+
+            var reads = new List<string>();
+            var writes = new List<string>();
+
+            foreach (ITaskItem source in Sources)
+            {
+                string sourcePath = source.GetMetadata("FullPath");
+                string objectPath = Path.GetFullPath(Path.Combine(ObjectDirectory, source.GetMetadata("Filename") + ".obj"));
+
+                reads.Add("^" + sourcePath.ToUpperInvariant());
+                foreach (string include in GetIncludes(source, sourcePath))
+                {
+                    reads.Add(include.ToUpperInvariant());
+                }
+
+                File.WriteAllText(objectPath, sourcePath);
+
+                writes.Add("^" + sourcePath.ToUpperInvariant());
+                writes.Add(objectPath.ToUpperInvariant());
+            }
+
+            File.WriteAllLines(Path.Combine(TrackerLogDirectory, TrackedSources.ToolReadTlog), reads, Encoding.Unicode);
+            File.WriteAllLines(Path.Combine(TrackerLogDirectory, TrackedSources.ToolWriteTlog), writes, Encoding.Unicode);
+
+            // Compact the tlogs of the tool into those of the project, as CL does once the tool exits
+            outputs = TrackedSources.ReadOutputs(this, TrackerLogDirectory);
+            outputs.SaveTlog();
+            TrackedSources.ReadInputs(this, TrackerLogDirectory, Sources, outputs).SaveTlog();
+
+            Log.LogMessage(MessageImportance.Normal, "Compiled {0} sources.", Sources.Length);
+
+            return !Log.HasLoggedErrors;
+        }
+
+        /// <returns>The full paths of the headers the source includes, found next to it or in its include directories</returns>
+        private static IEnumerable<string> GetIncludes(ITaskItem source, string sourcePath)
+        {
+            var searchDirectories = new List<string> { Path.GetDirectoryName(sourcePath) };
+            foreach (string directory in source.GetMetadata("AdditionalIncludeDirectories").Split(new[] { ';' }, StringSplitOptions.RemoveEmptyEntries))
+            {
+                searchDirectories.Add(directory);
+            }
+
+            foreach (string line in File.ReadLines(sourcePath))
+            {
+                if (!line.StartsWith(IncludeDirective, StringComparison.Ordinal))
+                {
+                    continue;
+                }
+
+                string header = line.Substring(IncludeDirective.Length).TrimEnd('"');
+                foreach (string directory in searchDirectories)
+                {
+                    string headerPath = Path.GetFullPath(Path.Combine(directory, header));
+                    if (File.Exists(headerPath))
+                    {
+                        yield return headerPath;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
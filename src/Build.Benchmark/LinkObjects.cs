@@ -0,0 +1,31 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.IO;
+using System.Linq;
+using Microsoft.Build.Framework;
+using Microsoft.Build.Utilities;
+
+namespace Microsoft.Build.Benchmark
+{
+    /// <summary>
+    /// Stands in for Lib: writes a library listing the objects. Its target is skipped by the engine once the library is
+    /// newer than every object, as the targets of the link tools are.
+    /// </summary>
+    public sealed class LinkObjects : Task
+    {
+        [Required]
+        public ITaskItem[] Objects { get; set; }
+
+        [Required]
+        public string OutputFile { get; set; }
+
+        public override bool Execute()
+        {
+            Directory.CreateDirectory(Path.GetDirectoryName(Path.GetFullPath(OutputFile)));
+            File.WriteAllLines(OutputFile, Objects.Select(o => o.ItemSpec));
+
+            return true;
+        }
+    }
+}
@@ -0,0 +1,429 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.IO;
+using System.Linq;
+using System.Reflection;
+using Microsoft.Build.Execution;
+using Microsoft.Build.Framework;
+using Microsoft.Build.Framework.Profiler;
+using Microsoft.Build.Logging;
+
+namespace Microsoft.Build.Benchmark
+{
+    /// <summary>
+    /// Measures incremental builds of a synthetic native solution end to end through BuildManager: a build where nothing
+    /// changed, and one where a header included by a tenth of the sources of every project changed.
+    /// </summary>
+    /// <remarks>
+    /// Each build runs in a process of its own, like a command line build, so that nothing cached in memory carries over
+    /// from one build to the next, and so that builds pick up the MSBUILD* environment variables the benchmark runs with.
+    /// Each scenario is built twice per iteration: without loggers, for the time of the build, and with a binary logger
+    /// and the evaluation profiler, for where that time went. Their difference is the cost of the loggers. The time that
+    /// is neither evaluation nor tasks is reported as scheduling: the scheduler, the results cache, target up to date
+    /// checks and the hand off of project references. That breakdown assumes the build runs on one node.
+    /// </remarks>
+    public class Program
+    {
+        private const string BuildSwitch = "--build";
+
+        public static int Main(string[] args)
+        {
+            if (args.Length > 0 && args[0] == BuildSwitch)
+            {
+                return RunBuild(args);
+            }
+
+            Options options = Options.Parse(args);
+            if (options == null)
+            {
+                Console.WriteLine(Options.Usage);
+                return 1;
+            }
+
+            var solution = new SyntheticSolution(Path.Combine(options.Directory, "Solution"), options.Projects, options.SourcesPerProject, options.CommonHeaders);
+            Console.WriteLine($"Writing {options.Projects} projects of {options.SourcesPerProject} sources to {solution.Directory}");
+            solution.Generate();
+
+            string logDirectory = Path.Combine(options.Directory, "Logs");
+            Directory.CreateDirectory(logDirectory);
+
+            var runner = new BuildRunner(options, solution, logDirectory);
+
+            // The first build compiles everything, and writes the tlogs that the incremental builds check
+            if (runner.Build("Initial", instrumented: true) == null)
+            {
+                return 1;
+            }
+
+            var scenarios = new[]
+            {
+                new Scenario("NoOp", () => { }, compiles: false),
+                new Scenario("HeaderChanged", solution.TouchChangedHeader, compiles: true),
+            };
+
+            var samples = new Dictionary<string, List<double>>(StringComparer.Ordinal);
+            var counts = new Dictionary<string, string>(StringComparer.Ordinal);
+
+            for (int iteration = 1; iteration <= options.Iterations; iteration++)
+            {
+                Console.WriteLine($"Iteration {iteration} of {options.Iterations}");
+
+                foreach (Scenario scenario in scenarios)
+                {
+                    scenario.Prepare();
+                    double? instrumentedTime = runner.Build(scenario.Name, instrumented: true);
+                    if (instrumentedTime == null)
+                    {
+                        return 1;
+                    }
+
+                    BuildBreakdown breakdown = BuildBreakdown.Read(runner.GetBinaryLogPath(scenario.Name));
+                    int projectsCompiled = breakdown.GetTaskCount(nameof(CompileTrackedSources));
+                    if ((projectsCompiled > 0) != scenario.Compiles)
+                    {
+                        Console.WriteLine($"The {scenario.Name} build compiled {projectsCompiled} projects, which means the up to date check is broken. Its log is {runner.GetBinaryLogPath(scenario.Name)}.");
+                        return 1;
+                    }
+
+                    counts[scenario.Name] = $"{breakdown.Evaluations} evaluations, {projectsCompiled} projects compiled";
+
+                    scenario.Prepare();
+                    double? buildTime = runner.Build(scenario.Name, instrumented: false);
+                    if (buildTime == null)
+                    {
+                        return 1;
+                    }
+
+                    double evaluationTime = breakdown.EvaluationTime.TotalMilliseconds;
+                    double taskTime = breakdown.TaskTime.TotalMilliseconds;
+
+                    AddSample(samples, scenario, "Build", buildTime.Value);
+                    AddSample(samples, scenario, "Evaluation", evaluationTime);
+                    foreach (KeyValuePair<EvaluationPass, TimeSpan> pass in breakdown.EvaluationPassTimes)
+                    {
+                        AddSample(samples, scenario, "Evaluation." + pass.Key, pass.Value.TotalMilliseconds);
+                    }
+
+                    AddSample(samples, scenario, "Scheduling", buildTime.Value - evaluationTime - taskTime);
+                    AddSample(samples, scenario, "Tasks", taskTime);
+                    AddSample(samples, scenario, "Tasks.TrackedDependencies", breakdown.GetTaskTime(nameof(CheckTrackedSources)).TotalMilliseconds);
+                    AddSample(samples, scenario, "Tasks.Compile", breakdown.GetTaskTime(nameof(CompileTrackedSources)).TotalMilliseconds);
+                    AddSample(samples, scenario, "Loggers", instrumentedTime.Value - buildTime.Value);
+                }
+            }
+
+            Dictionary<string, double> medians = samples.ToDictionary(sample => sample.Key, sample => Median(sample.Value), StringComparer.Ordinal);
+            Dictionary<string, double> baseline = options.BaselinePath != null ? Baseline.Load(options.BaselinePath) : null;
+
+            Console.WriteLine();
+            foreach (Scenario scenario in scenarios)
+            {
+                Console.WriteLine($"{scenario.Name}: {counts[scenario.Name]}");
+            }
+
+            Console.WriteLine();
+            Console.WriteLine($"{"Metric (ms)",-48}{"Median",10}{"Min",10}{"Max",10}{"Baseline",10}");
+            foreach (KeyValuePair<string, List<double>> sample in samples.OrderBy(sample => sample.Key, StringComparer.Ordinal))
+            {
+                string baselineTime = baseline != null && baseline.TryGetValue(sample.Key, out double time) ? time.ToString("F1", CultureInfo.InvariantCulture) : "-";
+                Console.WriteLine(string.Format(CultureInfo.InvariantCulture, "{0,-48}{1,10:F1}{2,10:F1}{3,10:F1}{4,10}", sample.Key, medians[sample.Key], sample.Value.Min(), sample.Value.Max(), baselineTime));
+            }
+
+            Console.WriteLine();
+            Console.WriteLine($"The binary logs and evaluation profiles of the last iteration are in {logDirectory}");
+
+            if (options.SaveBaselinePath != null)
+            {
+                Baseline.Save(options.SaveBaselinePath, medians);
+                Console.WriteLine($"Saved the medians as a baseline to {options.SaveBaselinePath}");
+            }
+
+            if (baseline != null)
+            {
+                List<string> regressions = Baseline.FindRegressions(baseline, medians, options.ThresholdPercent, options.NoiseFloorMilliseconds);
+                if (regressions.Count > 0)
+                {
+                    Console.WriteLine($"Slower than the baseline by more than {options.ThresholdPercent}%:");
+                    foreach (string regression in regressions)
+                    {
+                        Console.WriteLine("  " + regression);
+                    }
+
+                    return 1;
+                }
+
+                Console.WriteLine($"Within {options.ThresholdPercent}% of the baseline");
+            }
+
+            return 0;
+        }
+
+        /// <summary>
+        /// Builds the solution in this process, and writes the time the build took to the result file.
+        /// </summary>
+        /// <remarks>
+        /// Arguments: --build project nodes resultFile [binaryLog evaluationProfile]
+        /// </remarks>
+        private static int RunBuild(string[] args)
+        {
+            string projectPath = args[1];
+            int nodes = int.Parse(args[2], CultureInfo.InvariantCulture);
+            string resultPath = args[3];
+
+            var loggers = new List<ILogger>();
+            if (args.Length > 5)
+            {
+                loggers.Add(new BinaryLogger { Parameters = args[4] });
+                loggers.Add(new ProfilerLogger(args[5]));
+            }
+
+            var parameters = new BuildParameters
+            {
+                Loggers = loggers,
+                MaxNodeCount = nodes,
+                EnableNodeReuse = false
+            };
+
+            var request = new BuildRequestData(projectPath, new Dictionary<string, string>(), null, new[] { "Build" }, null);
+
+            Stopwatch stopwatch = Stopwatch.StartNew();
+            BuildResult result = BuildManager.DefaultBuildManager.Build(parameters, request);
+            stopwatch.Stop();
+
+            if (result.OverallResult != BuildResultCode.Success)
+            {
+                Console.WriteLine($"The build failed. {result.Exception}");
+                return 1;
+            }
+
+            File.WriteAllText(resultPath, stopwatch.Elapsed.TotalMilliseconds.ToString("R", CultureInfo.InvariantCulture));
+            return 0;
+        }
+
+        private static void AddSample(Dictionary<string, List<double>> samples, Scenario scenario, string metric, double milliseconds)
+        {
+            string name = scenario.Name + "." + metric;
+            if (!samples.TryGetValue(name, out List<double> values))
+            {
+                values = new List<double>();
+                samples.Add(name, values);
+            }
+
+            values.Add(milliseconds);
+        }
+
+        private static double Median(List<double> values)
+        {
+            var sorted = values.OrderBy(value => value).ToArray();
+            int middle = sorted.Length / 2;
+            return sorted.Length % 2 == 1 ? sorted[middle] : (sorted[middle - 1] + sorted[middle]) / 2;
+        }
+
+        private sealed class Scenario
+        {
+            internal Scenario(string name, Action prepare, bool compiles)
+            {
+                Name = name;
+                Prepare = prepare;
+                Compiles = compiles;
+            }
+
+            internal string Name { get; }
+
+            /// <summary>
+            /// Changes the solution before each build of the scenario.
+            /// </summary>
+            internal Action Prepare { get; }
+
+            /// <summary>
+            /// Whether the build compiles anything, to check that the up to date check still works.
+            /// </summary>
+            internal bool Compiles { get; }
+        }
+
+        /// <summary>
+        /// Starts this executable to build the solution in a process of its own.
+        /// </summary>
+        private sealed class BuildRunner
+        {
+            private readonly Options _options;
+            private readonly SyntheticSolution _solution;
+            private readonly string _logDirectory;
+            private readonly string _resultPath;
+
+            internal BuildRunner(Options options, SyntheticSolution solution, string logDirectory)
+            {
+                _options = options;
+                _solution = solution;
+                _logDirectory = logDirectory;
+                _resultPath = Path.Combine(options.Directory, "BuildTime.txt");
+            }
+
+            internal string GetBinaryLogPath(string name) => Path.Combine(_logDirectory, name + ".binlog");
+
+            /// <returns>The time the build took in milliseconds, or null if it failed</returns>
+            internal double? Build(string name, bool instrumented)
+            {
+                File.Delete(_resultPath);
+
+                string arguments = $"{BuildSwitch} {Quote(_solution.TraversalProject)} {_options.Nodes.ToString(CultureInfo.InvariantCulture)} {Quote(_resultPath)}";
+                if (instrumented)
+                {
+                    arguments += $" {Quote(GetBinaryLogPath(name))} {Quote(Path.Combine(_logDirectory, name + ".evaluation.md"))}";
+                }
+
+                // Run the same way this process was, through the host when this is a framework dependent assembly
+                string host = Process.GetCurrentProcess().MainModule.FileName;
+                string entryAssembly = Assembly.GetEntryAssembly().Location;
+                if (!string.Equals(host, entryAssembly, StringComparison.OrdinalIgnoreCase))
+                {
+                    arguments = Quote(entryAssembly) + " " + arguments;
+                }
+
+                var startInfo = new ProcessStartInfo(host, arguments)
+                {
+                    UseShellExecute = false,
+                    RedirectStandardOutput = true
+                };
+
+                string output;
+                int exitCode;
+                using (Process process = Process.Start(startInfo))
+                {
+                    output = process.StandardOutput.ReadToEnd();
+                    process.WaitForExit();
+                    exitCode = process.ExitCode;
+                }
+
+                if (exitCode != 0 || !File.Exists(_resultPath))
+                {
+                    Console.WriteLine($"The {name} build failed{(instrumented ? $", its log is {GetBinaryLogPath(name)}" : string.Empty)}:");
+                    Console.WriteLine(output);
+                    return null;
+                }
+
+                return double.Parse(File.ReadAllText(_resultPath), CultureInfo.InvariantCulture);
+            }
+
+            private static string Quote(string argument) => "\"" + argument + "\"";
+        }
+
+        private sealed class Options
+        {
+            internal const string Usage =
+@"Measures incremental builds of a synthetic native solution, and compares them with a baseline.
+
+Build.Benchmark [options]
+  --projects <n>          Projects in the solution (50)
+  --sources <n>           Sources in each project (40)
+  --common-headers <n>    Headers every source includes (40)
+  --iterations <n>        Builds of each scenario to take the median of (5)
+  --nodes <n>             Nodes to build with (1). Only one node gives a breakdown that adds up,
+                          and more need MSBUILD_EXE_PATH to point to the MSBuild.exe the nodes run.
+  --directory <path>      Where to write the solution and logs (Build.Benchmark under the current directory,
+                          as files in the temp directory are excluded from tracking)
+  --save-baseline <path>  Saves the medians as a baseline
+  --baseline <path>       Compares the medians with a baseline saved on the same machine, and fails
+                          if any is slower by more than the threshold
+  --threshold <percent>   The slowdown allowed from the baseline (10)
+  --noise-floor <ms>      Slowdowns of fewer milliseconds than this are allowed (20)";
+
+            internal int Projects { get; private set; } = 50;
+
+            internal int SourcesPerProject { get; private set; } = 40;
+
+            internal int CommonHeaders { get; private set; } = 40;
+
+            internal int Iterations { get; private set; } = 5;
+
+            internal int Nodes { get; private set; } = 1;
+
+            internal string Directory { get; private set; } = Path.Combine(Environment.CurrentDirectory, "Build.Benchmark");
+
+            internal string SaveBaselinePath { get; private set; }
+
+            internal string BaselinePath { get; private set; }
+
+            internal double ThresholdPercent { get; private set; } = 10;
+
+            internal double NoiseFloorMilliseconds { get; private set; } = 20;
+
+            /// <returns>The options, or null if the arguments aren't valid</returns>
+            internal static Options Parse(string[] args)
+            {
+                var options = new Options();
+
+                for (int i = 0; i < args.Length; i += 2)
+                {
+                    if (i + 1 == args.Length)
+                    {
+                        return null;
+                    }
+
+                    string value = args[i + 1];
+                    bool isValid = true;
+
+                    switch (args[i])
+                    {
+                        case "--projects":
+                            isValid = TryParseCount(value, out int projects);
+                            options.Projects = projects;
+                            break;
+                        case "--sources":
+                            isValid = TryParseCount(value, out int sources);
+                            options.SourcesPerProject = sources;
+                            break;
+                        case "--common-headers":
+                            isValid = TryParseCount(value, out int commonHeaders);
+                            options.CommonHeaders = commonHeaders;
+                            break;
+                        case "--iterations":
+                            isValid = TryParseCount(value, out int iterations);
+                            options.Iterations = iterations;
+                            break;
+                        case "--nodes":
+                            isValid = TryParseCount(value, out int nodes);
+                            options.Nodes = nodes;
+                            break;
+                        case "--directory":
+                            options.Directory = Path.GetFullPath(value);
+                            break;
+                        case "--save-baseline":
+                            options.SaveBaselinePath = Path.GetFullPath(value);
+                            break;
+                        case "--baseline":
+                            options.BaselinePath = Path.GetFullPath(value);
+                            isValid = File.Exists(options.BaselinePath);
+                            break;
+                        case "--threshold":
+                            isValid = double.TryParse(value, NumberStyles.Float, CultureInfo.InvariantCulture, out double threshold) && threshold >= 0;
+                            options.ThresholdPercent = threshold;
+                            break;
+                        case "--noise-floor":
+                            isValid = double.TryParse(value, NumberStyles.Float, CultureInfo.InvariantCulture, out double noiseFloor) && noiseFloor >= 0;
+                            options.NoiseFloorMilliseconds = noiseFloor;
+                            break;
+                        default:
+                            isValid = false;
+                            break;
+                    }
+
+                    if (!isValid)
+                    {
+                        return null;
+                    }
+                }
+
+                return options;
+            }
+
+            private static bool TryParseCount(string value, out int count)
+                => int.TryParse(value, NumberStyles.None, CultureInfo.InvariantCulture, out count) && count > 0;
+        }
+    }
+}
@@ -0,0 +1,216 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Security;
+using System.Text;
+
+namespace Microsoft.Build.Benchmark
+{
+    /// <summary>
+    /// Writes a solution shaped like a large native one: vcxproj-style projects that reference the projects before them,
+    /// each with sources that include a common set of headers, a header of their project, and one of a few group headers
+    /// shared by sources across all projects. The projects compile and link through the tracked tasks of this assembly,
+    /// which keep tlogs like CL and Link do.
+    /// </summary>
+    internal sealed class SyntheticSolution
+    {
+        /// <summary>
+        /// The number of group headers, each of which is included by that share of the sources of every project.
+        /// </summary>
+        private const int HeaderGroups = 10;
+
+        // The projects load the tracked tasks from this assembly, and the MSBuild task from the one this build of MSBuild ships
+        private static readonly string s_tasksAssembly = SecurityElement.Escape(typeof(SyntheticSolution).Assembly.Location);
+        private static readonly string s_tasksCoreAssembly = SecurityElement.Escape(typeof(Tasks.MSBuild).Assembly.Location);
+
+        private readonly int _projects;
+        private readonly int _sourcesPerProject;
+        private readonly int _commonHeaders;
+
+        internal SyntheticSolution(string directory, int projects, int sourcesPerProject, int commonHeaders)
+        {
+            Directory = Path.GetFullPath(directory);
+            _projects = projects;
+            _sourcesPerProject = sourcesPerProject;
+            _commonHeaders = commonHeaders;
+        }
+
+        internal string Directory { get; }
+
+        /// <summary>
+        /// The project that builds every project of the solution, like a solution file does.
+        /// </summary>
+        internal string TraversalProject => Path.Combine(Directory, "Solution.proj");
+
+        /// <summary>
+        /// The header that the scenario where one header changes touches.
+        /// </summary>
+        internal string ChangedHeader => Path.Combine(Directory, "common", "group0.h");
+
+        /// <summary>
+        /// Writes the solution, replacing whatever the directory held.
+        /// </summary>
+        internal void Generate()
+        {
+            if (System.IO.Directory.Exists(Directory))
+            {
+                System.IO.Directory.Delete(Directory, true);
+            }
+
+            string commonDirectory = Path.Combine(Directory, "common");
+            System.IO.Directory.CreateDirectory(commonDirectory);
+
+            var commonIncludes = new StringBuilder();
+            for (int i = 0; i < _commonHeaders; i++)
+            {
+                WriteFile(Path.Combine(commonDirectory, $"common{i}.h"), "#pragma once\n");
+                commonIncludes.Append($"#include \"common{i}.h\"\n");
+            }
+
+            for (int i = 0; i < HeaderGroups; i++)
+            {
+                WriteFile(Path.Combine(commonDirectory, $"group{i}.h"), "#pragma once\n");
+            }
+
+            WriteFile(Path.Combine(Directory, "Native.targets"), GetNativeTargets());
+
+            var projectFiles = new List<string>(_projects);
+            for (int project = 0; project < _projects; project++)
+            {
+                string projectName = $"project{project}";
+                string projectDirectory = Path.Combine(Directory, projectName);
+                System.IO.Directory.CreateDirectory(projectDirectory);
+
+                WriteFile(Path.Combine(projectDirectory, projectName + ".h"), "#pragma once\n");
+
+                var sources = new List<string>(_sourcesPerProject);
+                for (int source = 0; source < _sourcesPerProject; source++)
+                {
+                    string sourceName = $"source{source}.cpp";
+                    WriteFile(
+                        Path.Combine(projectDirectory, sourceName),
+                        $"{commonIncludes}#include \"{projectName}.h\"\n#include \"group{(project + source) % HeaderGroups}.h\"\n");
+                    sources.Add(sourceName);
+                }
+
+                // Each project depends on the one before it and on one about half way back, for a graph with some depth and fan-in
+                var references = new SortedSet<int>();
+                if (project > 0)
+                {
+                    references.Add(project - 1);
+                    references.Add(project / 2);
+                }
+
+                string projectFile = Path.Combine(projectDirectory, projectName + ".vcxproj");
+                WriteFile(projectFile, GetProject(projectName, sources, references));
+                projectFiles.Add(projectFile);
+            }
+
+            WriteFile(TraversalProject, GetTraversalProject(projectFiles));
+        }
+
+        /// <summary>
+        /// Makes the changed header newer than every output, as an edit would.
+        /// </summary>
+        internal void TouchChangedHeader()
+        {
+            File.SetLastWriteTimeUtc(ChangedHeader, DateTime.UtcNow);
+        }
+
+        private static string GetProject(string projectName, List<string> sources, IEnumerable<int> references)
+        {
+            var project = new StringBuilder();
+            project.Append(
+$@"<Project DefaultTargets=""Build"">
+  <PropertyGroup>
+    <ProjectName>{projectName}</ProjectName>
+    <ConfigurationType>StaticLibrary</ConfigurationType>
+    <IntDir>$(MSBuildProjectDirectory)\obj\</IntDir>
+    <OutDir>$(MSBuildProjectDirectory)\bin\</OutDir>
+    <TLogLocation>$(IntDir){projectName}.tlog\</TLogLocation>
+  </PropertyGroup>
+  <ItemDefinitionGroup>
+    <ClCompile>
+      <AdditionalIncludeDirectories>$(MSBuildThisFileDirectory)..\common;%(AdditionalIncludeDirectories)</AdditionalIncludeDirectories>
+      <PreprocessorDefinitions>WIN32;_LIB;%(PreprocessorDefinitions)</PreprocessorDefinitions>
+    </ClCompile>
+  </ItemDefinitionGroup>
+  <ItemGroup>
+    <ClInclude Include=""{projectName}.h"" />
+");
+            foreach (string source in sources)
+            {
+                project.Append($"    <ClCompile Include=\"{source}\" />\n");
+            }
+
+            project.Append("  </ItemGroup>\n  <ItemGroup>\n");
+            foreach (int reference in references)
+            {
+                project.Append($"    <ProjectReference Include=\"..\\project{reference}\\project{reference}.vcxproj\" />\n");
+            }
+
+            project.Append("  </ItemGroup>\n  <Import Project=\"..\\Native.targets\" />\n</Project>\n");
+            return project.ToString();
+        }
+
+        private static string GetTraversalProject(List<string> projectFiles)
+        {
+            var project = new StringBuilder();
+            project.Append(
+$@"<Project DefaultTargets=""Build"">
+  <UsingTask TaskName=""Microsoft.Build.Tasks.MSBuild"" AssemblyFile=""{s_tasksCoreAssembly}"" />
+  <ItemGroup>
+");
+            foreach (string projectFile in projectFiles)
+            {
+                project.Append($"    <ProjectReference Include=\"{SecurityElement.Escape(projectFile)}\" />\n");
+            }
+
+            project.Append(
+@"  </ItemGroup>
+  <Target Name=""Build"">
+    <MSBuild Projects=""@(ProjectReference)"" Targets=""Build"" BuildInParallel=""true"" />
+  </Target>
+</Project>
+");
+            return project.ToString();
+        }
+
+        private static string GetNativeTargets()
+        {
+            return
+$@"<Project>
+  <UsingTask TaskName=""Microsoft.Build.Tasks.MSBuild"" AssemblyFile=""{s_tasksCoreAssembly}"" />
+  <UsingTask TaskName=""CheckTrackedSources"" AssemblyFile=""{s_tasksAssembly}"" />
+  <UsingTask TaskName=""CompileTrackedSources"" AssemblyFile=""{s_tasksAssembly}"" />
+  <UsingTask TaskName=""LinkObjects"" AssemblyFile=""{s_tasksAssembly}"" />
+
+  <Target Name=""Build"" DependsOnTargets=""ResolveProjectReferences;ClCompile;Lib"" />
+
+  <Target Name=""ResolveProjectReferences"">
+    <MSBuild Projects=""@(ProjectReference)"" Targets=""Build"" BuildInParallel=""true"" />
+  </Target>
+
+  <Target Name=""ClCompile"" Condition=""'@(ClCompile)' != ''"">
+    <CheckTrackedSources Sources=""@(ClCompile)"" ObjectDirectory=""$(IntDir)"" TrackerLogDirectory=""$(TLogLocation)"">
+      <Output TaskParameter=""SourcesToCompile"" ItemName=""_SourcesToCompile"" />
+    </CheckTrackedSources>
+    <CompileTrackedSources Condition=""'@(_SourcesToCompile)' != ''"" Sources=""@(_SourcesToCompile)"" ObjectDirectory=""$(IntDir)"" TrackerLogDirectory=""$(TLogLocation)"" />
+  </Target>
+
+  <Target Name=""Lib"" Inputs=""@(ClCompile->'$(IntDir)%(Filename).obj')"" Outputs=""$(OutDir)$(ProjectName).lib"">
+    <LinkObjects Objects=""@(ClCompile->'$(IntDir)%(Filename).obj')"" OutputFile=""$(OutDir)$(ProjectName).lib"" />
+  </Target>
+</Project>
+";
+        }
+
+        private static void WriteFile(string path, string contents)
+        {
+            File.WriteAllText(path, contents);
+        }
+    }
+}
@@ -0,0 +1,46 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.IO;
+using Microsoft.Build.Framework;
+using Microsoft.Build.Utilities;
+
+namespace Microsoft.Build.Benchmark
+{
+    /// <summary>
+    /// The tlogs of the synthetic compiler, named like those of CL: the compacted tlogs the task keeps, and the tlogs
+    /// of the tracked tool, which the task compacts into its own after each compile.
+    /// </summary>
+    internal static class TrackedSources
+    {
+        internal const string ToolReadTlog = "CL.1.read.1.tlog";
+
+        internal const string ToolWriteTlog = "CL.1.write.1.tlog";
+
+        internal static CanonicalTrackedOutputFiles ReadOutputs(ITask task, string trackerLogDirectory)
+        {
+            return new CanonicalTrackedOutputFiles(task, GetTlogs(trackerLogDirectory, "write"));
+        }
+
+        internal static CanonicalTrackedInputFiles ReadInputs(ITask task, string trackerLogDirectory, ITaskItem[] sources, CanonicalTrackedOutputFiles outputs)
+        {
+            return new CanonicalTrackedInputFiles(
+                task,
+                GetTlogs(trackerLogDirectory, "read"),
+                sources,
+                null,
+                outputs,
+                true, /* minimal rebuild optimization, like CL */
+                false /* shred composite rooting markers */);
+        }
+
+        private static ITaskItem[] GetTlogs(string trackerLogDirectory, string kind)
+        {
+            return new ITaskItem[]
+            {
+                new TaskItem(Path.Combine(trackerLogDirectory, $"CL.{kind}.1.tlog")),
+                new TaskItem(Path.Combine(trackerLogDirectory, $"CL.*.{kind}.1.tlog"))
+            };
+        }
+    }
+}
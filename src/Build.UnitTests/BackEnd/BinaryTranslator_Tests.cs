@@ -144,6 +144,50 @@ namespace Microsoft.Build.UnitTests.BackEnd
             HelperTestList(null, StringComparer.Ordinal);
         }
 
+        /// <summary>
+        /// Tests serializing strings with a string table shared by successive serializers.
+        /// </summary>
+        [Fact]
+        public void TestSerializeStringsWithStringTable()
+        {
+            var writeTable = new Dictionary<string, int>(StringComparer.Ordinal);
+            var readTable = new List<string>();
+            string longString = new string('x', 5000);
+
+            MemoryStream stream = new MemoryStream();
+            foreach (string[] strings in new[] { new[] { "foo", "bar", "foo" }, new[] { "bar", longString, "", "baz" } })
+            {
+                ITranslator writeTranslator = BinaryTranslator.GetWriteTranslator(stream, writeTable);
+                string[] value = strings;
+                writeTranslator.Translate(ref value);
+                string single = "foo";
+                writeTranslator.Translate(ref single);
+            }
+
+            stream.Seek(0, SeekOrigin.Begin);
+
+            string[] firstRead = null;
+            string[] secondRead = null;
+            ITranslator readTranslator = BinaryTranslator.GetReadTranslator(stream, null, readTable);
+            readTranslator.Translate(ref firstRead);
+            string firstSingle = null;
+            readTranslator.Translate(ref firstSingle);
+
+            readTranslator = BinaryTranslator.GetReadTranslator(stream, null, readTable);
+            readTranslator.Translate(ref secondRead);
+            string secondSingle = null;
+            readTranslator.Translate(ref secondSingle);
+
+            firstRead.ShouldBe(new[] { "foo", "bar", "foo" });
+            secondRead.ShouldBe(new[] { "bar", longString, "", "baz" });
+            firstSingle.ShouldBe("foo");
+            secondSingle.ShouldBe("foo");
+
+            // Strings are read once, and too long ones aren't added to the table
+            readTable.ShouldBe(new[] { "foo", "bar", "", "baz" });
+            secondRead[0].ShouldBeSameAs(firstRead[1]);
+        }
+
         /// <summary>
         /// Tests serializing DateTimes.
         /// </summary>
@@ -141,6 +141,144 @@ namespace Microsoft.Build.UnitTests.BackEnd
             Assert.Equal("InitialProperty3", propertyValue);
         }
 
+        /// <summary>
+        /// Verify that the timings of a build are recorded in the scheduling history, and that the next build can read them.
+        /// </summary>
+        [Fact]
+        public void SchedulingHistoryIsWrittenForTheNextBuild()
+        {
+            string historyPath = Path.Combine(_env.CreateFolder().Path, "build.schedulinghistory");
+            _env.SetEnvironmentVariable("MSBUILDSCHEDULINGHISTORYFILE", historyPath);
+
+            TransientTestFile referencedProject = _env.CreateFile("referenced.proj", CleanupFileContents(@"
+<Project xmlns='msbuildnamespace' ToolsVersion='msbuilddefaulttoolsversion'>
+ <Target Name='Build'>
+    <Message Text='[referenced]'/>
+ </Target>
+</Project>
+"));
+            TransientTestFile project = _env.CreateFile("main.proj", CleanupFileContents($@"
+<Project xmlns='msbuildnamespace' ToolsVersion='msbuilddefaulttoolsversion'>
+ <Target Name='Build'>
+    <MSBuild Projects='{referencedProject.Path}'/>
+    <Message Text='[success]'/>
+ </Target>
+</Project>
+"));
+
+            var data = new BuildRequestData(project.Path, new Dictionary<string, string>(), null, new[] { "Build" }, null);
+            _buildManager.Build(_parameters, data).OverallResult.ShouldBe(BuildResultCode.Success);
+            _logger.AssertLogContains("[referenced]");
+
+            var history = new SchedulingHistory(null, historyPath);
+            history.Read(new MockLoggingService(), BuildEventContext.Invalid);
+            history.HasHistory.ShouldBeTrue();
+
+            _buildManager.Build(_parameters, data).OverallResult.ShouldBe(BuildResultCode.Success);
+        }
+
+        /// <summary>
+        /// Verify that the evaluation of a project is persisted, and that it is reused until the project changes.
+        /// </summary>
+        [Fact]
+        public void EvaluationCacheReusesTheEvaluationsOfUnchangedProjects()
+        {
+            string cacheDirectory = _env.CreateFolder().Path;
+            _env.SetEnvironmentVariable("MSBUILDEVALUATIONCACHEDIRECTORY", cacheDirectory);
+
+            TransientTestFile project = _env.CreateFile("main.proj", CleanupFileContents(@"
+<Project xmlns='msbuildnamespace' ToolsVersion='msbuilddefaulttoolsversion'>
+ <PropertyGroup>
+    <Value>original</Value>
+ </PropertyGroup>
+ <Target Name='Build'>
+    <Message Text='[$(Value)]'/>
+ </Target>
+</Project>
+"));
+
+            var data = new BuildRequestData(project.Path, new Dictionary<string, string>(), null, new[] { "Build" }, null);
+            _buildManager.Build(_parameters, data).OverallResult.ShouldBe(BuildResultCode.Success);
+            _logger.AssertLogContains("[original]");
+            Directory.GetFiles(cacheDirectory, "*.evaluation").Length.ShouldBe(1);
+
+            _buildManager.Build(_parameters, data).OverallResult.ShouldBe(BuildResultCode.Success);
+            _logger.AssertLogContains("[original]");
+
+            // The reused evaluation is logged as an evaluation of its own
+            _logger.AssertLogContains(ResourceUtilities.FormatResourceStringStripCodeAndKeyword("EvaluationReused", project.Path));
+            _logger.EvaluationFinishedEvents.Select(e => e.BuildEventContext.EvaluationId).Distinct().Count().ShouldBe(2);
+
+            File.WriteAllText(project.Path, File.ReadAllText(project.Path).Replace("original", "changed"));
+            File.SetLastWriteTimeUtc(project.Path, DateTime.UtcNow.AddMinutes(1));
+
+            _buildManager.Build(_parameters, data).OverallResult.ShouldBe(BuildResultCode.Success);
+            _logger.AssertLogContains("[changed]");
+        }
+
+        /// <summary>
+        /// Verify that a persisted evaluation isn't reused once a file it probed for appears, even outside the project directory.
+        /// </summary>
+        [Fact]
+        public void EvaluationCacheEvaluatesAgainWhenProbedFilesAppear()
+        {
+            string cacheDirectory = _env.CreateFolder().Path;
+            _env.SetEnvironmentVariable("MSBUILDEVALUATIONCACHEDIRECTORY", cacheDirectory);
+
+            TransientTestFolder markerFolder = _env.CreateFolder();
+            string marker = Path.Combine(markerFolder.Path, "marker.txt");
+
+            TransientTestFile project = _env.CreateFile("main.proj", CleanupFileContents($@"
+<Project xmlns='msbuildnamespace' ToolsVersion='msbuilddefaulttoolsversion'>
+ <PropertyGroup>
+    <Value>absent</Value>
+    <Value Condition=""Exists('{marker}')"">present</Value>
+ </PropertyGroup>
+ <Target Name='Build'>
+    <Message Text='[$(Value)]'/>
+ </Target>
+</Project>
+"));
+
+            var data = new BuildRequestData(project.Path, new Dictionary<string, string>(), null, new[] { "Build" }, null);
+            _buildManager.Build(_parameters, data).OverallResult.ShouldBe(BuildResultCode.Success);
+            _logger.AssertLogContains("[absent]");
+
+            File.WriteAllText(marker, string.Empty);
+
+            _buildManager.Build(_parameters, data).OverallResult.ShouldBe(BuildResultCode.Success);
+            _logger.AssertLogContains("[present]");
+            _logger.AssertLogDoesntContain(ResourceUtilities.FormatResourceStringStripCodeAndKeyword("EvaluationReused", project.Path));
+        }
+
+        /// <summary>
+        /// Verify that an evaluation which reads the clock is not persisted, since its values would be stale when reused.
+        /// </summary>
+        [Fact]
+        public void EvaluationCacheDoesNotReuseEvaluationsReadingTheClock()
+        {
+            string cacheDirectory = _env.CreateFolder().Path;
+            _env.SetEnvironmentVariable("MSBUILDEVALUATIONCACHEDIRECTORY", cacheDirectory);
+
+            TransientTestFile project = _env.CreateFile("main.proj", CleanupFileContents(@"
+<Project xmlns='msbuildnamespace' ToolsVersion='msbuilddefaulttoolsversion'>
+ <PropertyGroup>
+    <BuildStamp>$([System.DateTime]::Now.Ticks)</BuildStamp>
+ </PropertyGroup>
+ <Target Name='Build'>
+    <Message Text='[$(BuildStamp)]'/>
+ </Target>
+</Project>
+"));
+
+            var data = new BuildRequestData(project.Path, new Dictionary<string, string>(), null, new[] { "Build" }, null);
+            _buildManager.Build(_parameters, data).OverallResult.ShouldBe(BuildResultCode.Success);
+            _buildManager.Build(_parameters, data).OverallResult.ShouldBe(BuildResultCode.Success);
+
+            Directory.GetFiles(cacheDirectory, "*.evaluation").ShouldBeEmpty();
+            _logger.AssertLogDoesntContain(ResourceUtilities.FormatResourceStringStripCodeAndKeyword("EvaluationReused", project.Path));
+        }
+
         [Fact]
         public void SimpleP2PBuildInProc()
         {
@@ -417,6 +555,89 @@ namespace Microsoft.Build.UnitTests.BackEnd
             RunOutOfProcBuild(buildParameters => buildParameters.DisableInProcNode = true);
         }
 
+        /// <summary>
+        /// A simple successful build, out of process only, on a node launched when the build begins.
+        /// </summary>
+#if MONO
+        [Fact(Skip = "https://github.com/Microsoft/msbuild/issues/1240")]
+#else
+        [Fact]
+#endif
+        public void PrelaunchedNodeBuildsOutOfProcess()
+        {
+            _env.SetEnvironmentVariable("MSBUILDPRELAUNCHNODES", "1");
+
+            RunOutOfProcBuild(buildParameters => buildParameters.DisableInProcNode = true);
+        }
+
+        /// <summary>
+        /// Packets sent together by an out-of-proc node are batched into single writes to the pipe, and build results larger
+        /// than the compression threshold are compressed. Verify that messages and results both below and above the threshold
+        /// arrive intact and in the order they were sent.
+        /// </summary>
+#if MONO
+        [Fact(Skip = "https://github.com/Microsoft/msbuild/issues/1240")]
+#else
+        [Fact]
+#endif
+        public void OutOfProcNodePacketsRoundTripBatchedAndCompressed()
+        {
+            string numbers = string.Join(";", Enumerable.Range(1, 500));
+            string padding = new string('x', 64);
+            string contents = CleanupFileContents($@"
+<Project xmlns='msbuildnamespace' ToolsVersion='msbuilddefaulttoolsversion'>
+ <ItemGroup>
+    <Number Include='{numbers}'/>
+ </ItemGroup>
+ <Target Name='Build' Returns='@(Result)'>
+    <MSBuild Projects='$(MSBuildProjectFullPath)' Targets='Small' Properties='Part=1'>
+        <Output TaskParameter='TargetOutputs' ItemName='Result'/>
+    </MSBuild>
+    <MSBuild Projects='$(MSBuildProjectFullPath)' Targets='Large' Properties='Part=2'>
+        <Output TaskParameter='TargetOutputs' ItemName='Result'/>
+    </MSBuild>
+    <MSBuild Projects='$(MSBuildProjectFullPath)' Targets='Small' Properties='Part=3'>
+        <Output TaskParameter='TargetOutputs' ItemName='Result'/>
+    </MSBuild>
+ </Target>
+ <Target Name='Small' Returns='@(SmallItem)'>
+    <Message Text='[message $(Part).%(Number.Identity)]' Importance='High'/>
+    <ItemGroup>
+        <SmallItem Include='small$(Part)'/>
+    </ItemGroup>
+ </Target>
+ <Target Name='Large' Returns='@(LargeItem)'>
+    <ItemGroup>
+        <LargeItem Include=""@(Number->'large%(Identity)')"" Padding='{padding}'/>
+    </ItemGroup>
+ </Target>
+</Project>
+");
+
+            // The large result is over the threshold and the small ones are well under it
+            _env.SetEnvironmentVariable("MSBUILDNODEPACKETCOMPRESSIONTHRESHOLD", "2048");
+
+            TransientTestFile projectFile = _env.CreateFile("roundtrip.proj", contents);
+            var data = new BuildRequestData(projectFile.Path, new Dictionary<string, string>(), null, new[] { "Build" }, null);
+            var customparameters = new BuildParameters { EnableNodeReuse = false, Loggers = new ILogger[] { _logger }, DisableInProcNode = true };
+
+            BuildResult result = _buildManager.Build(customparameters, data);
+            result.OverallResult.ShouldBe(BuildResultCode.Success);
+
+            ITaskItem[] items = result.ResultsByTarget["Build"].Items;
+            items.Length.ShouldBe(502);
+            items[0].ItemSpec.ShouldBe("small1");
+            for (int i = 1; i <= 500; i++)
+            {
+                items[i].ItemSpec.ShouldBe("large" + i);
+                items[i].GetMetadata("Padding").ShouldBe(padding);
+            }
+
+            items[501].ItemSpec.ShouldBe("small3");
+
+            _logger.AssertLogContains(Enumerable.Range(1, 500).Select(i => $"[message 1.{i}]").Concat(Enumerable.Range(1, 500).Select(i => $"[message 3.{i}]")).ToArray());
+        }
+
         /// <summary>
         /// Runs a build and verifies it happens out of proc by checking the process ID.
         /// </summary>
@@ -2,6 +2,7 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 using Microsoft.Build.BackEnd;
+using Microsoft.Build.BackEnd.Components.Caching;
 using Microsoft.Build.BackEnd.Logging;
 using System;
 using Microsoft.Build.BackEnd.SdkResolution;
@@ -59,6 +60,11 @@ namespace Microsoft.Build.UnitTests.BackEnd
 
         private ISdkResolverService _sdkResolverService;
 
+        /// <summary>
+        /// Cache of objects registered by tasks and the engine
+        /// </summary>
+        private IRegisteredTaskObjectCache _registeredTaskObjectCache;
+
         #region SystemParameterFields
 
         #endregion;
@@ -102,6 +108,9 @@ namespace Microsoft.Build.UnitTests.BackEnd
 
             _sdkResolverService = new MockSdkResolverService();
             ((IBuildComponent)_sdkResolverService).InitializeComponent(this);
+
+            _registeredTaskObjectCache = new RegisteredTaskObjectCache();
+            ((IBuildComponent)_registeredTaskObjectCache).InitializeComponent(this);
         }
 
         /// <summary>
@@ -170,6 +179,7 @@ namespace Microsoft.Build.UnitTests.BackEnd
                 BuildComponentType.ResultsCache => (IBuildComponent)_resultsCache,
                 BuildComponentType.RequestBuilder => (IBuildComponent)_requestBuilder,
                 BuildComponentType.SdkResolverService => (IBuildComponent)_sdkResolverService,
+                BuildComponentType.RegisteredTaskObjectCache => (IBuildComponent)_registeredTaskObjectCache,
                 _ => throw new ArgumentException("Unexpected type " + type),
             };
         }
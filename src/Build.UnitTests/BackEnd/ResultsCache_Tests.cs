@@ -205,6 +205,42 @@ namespace Microsoft.Build.UnitTests.BackEnd
             Assert.Null(cache.GetResultForRequest(request));
         }
 
+        [Fact]
+        public void LeastRecentlyUsedResultsAreCachedToDiskPastTheItemLimit()
+        {
+            using TestEnvironment env = TestEnvironment.Create();
+            env.SetEnvironmentVariable("MSBUILDRESULTSCACHEITEMLIMIT", "2");
+
+            ResultsCache cache = new ResultsCache();
+
+            var results = new BuildResult[3];
+            for (int i = 0; i < results.Length; i++)
+            {
+                BuildRequest request = new BuildRequest(1 /* submissionId */, 0, i + 1, new string[1] { "testTarget" }, null, BuildEventContext.Invalid, null);
+                results[i] = new BuildResult(request);
+                results[i].AddResultsForTarget("testTarget", BuildResultUtilities.GetNonEmptySucceedingTargetResult());
+                cache.AddResult(results[i]);
+
+                // Using the first result makes the second the least recently used one
+                cache.GetResultsForConfiguration(1);
+            }
+
+            try
+            {
+                results[0].CountItemsInMemory().ShouldBe(1);
+                results[1].CountItemsInMemory().ShouldBe(0);
+                results[2].CountItemsInMemory().ShouldBe(1);
+
+                // The cached items are read back when they are used
+                cache.GetResultsForConfiguration(2)["testTarget"].Items.ShouldHaveSingleItem().ItemSpec.ShouldBe("i");
+                results[1].CountItemsInMemory().ShouldBe(1);
+            }
+            finally
+            {
+                cache.ClearResults();
+            }
+        }
+
         public static IEnumerable<object[]> CacheSerializationTestData
         {
             get
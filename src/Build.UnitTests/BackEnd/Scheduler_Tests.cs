@@ -5,6 +5,7 @@ using System;
 using System.Xml;
 using System.Collections.Generic;
 using System.IO;
+using System.Text;
 using Microsoft.Build.Framework;
 using Microsoft.Build.BackEnd;
 using Microsoft.Build.Shared;
@@ -506,6 +507,131 @@ namespace Microsoft.Build.UnitTests.BackEnd
             s.ForceAffinityOutOfProc.ShouldBeTrue();
         }
 
+        /// <summary>
+        /// Verify that when there is a history of earlier builds, idle nodes are given the requests which lie on the longest
+        /// remaining path through the build rather than those which were issued first.
+        /// </summary>
+        [Fact]
+        public void SchedulingHistoryAssignsLongestPathFirst()
+        {
+            using TestEnvironment env = TestEnvironment.Create();
+            string historyPath = Path.Combine(env.CreateFolder().Path, "build.schedulinghistory");
+            env.SetEnvironmentVariable("MSBUILDSCHEDULINGHISTORYFILE", historyPath);
+
+            CreateConfiguration(1, "short.proj");
+            CreateConfiguration(2, "medium.proj");
+            CreateConfiguration(3, "long.proj");
+            CreateConfiguration(4, "referencing.proj");
+            CreateConfiguration(5, "referenced.proj");
+
+            // referencing.proj is quick to build itself, but it waits on referenced.proj, which makes its path the longest.
+            WriteSchedulingHistory(
+                historyPath,
+                (1, 10, new int[] { }),
+                (2, 100, new int[] { }),
+                (3, 1000, new int[] { }),
+                (4, 50, new int[] { 5 }),
+                (5, 1000, new int[] { }));
+
+            _host.BuildParameters.MaxNodeCount = 3;
+            _scheduler = new Scheduler();
+            _scheduler.InitializeComponent(_host);
+            _scheduler.ReportNodesCreated(new NodeInfo[] { new NodeInfo(1, NodeProviderType.InProc), new NodeInfo(2, NodeProviderType.OutOfProc), new NodeInfo(3, NodeProviderType.OutOfProc) });
+
+            BuildRequest parentRequest = CreateBuildRequest(99, 99, new string[] { }, null);
+            parentRequest.GlobalRequestId = 99;
+            _scheduler.ReportRequestBlocked(1, new BuildRequestBlocker(-1, new string[] { }, new BuildRequest[] { parentRequest }));
+
+            BuildRequest request1 = CreateBuildRequest(1, 1, new string[] { "foo" }, parentRequest);
+            BuildRequest request2 = CreateBuildRequest(2, 2, new string[] { "foo" }, parentRequest);
+            BuildRequest request3 = CreateBuildRequest(3, 3, new string[] { "foo" }, parentRequest);
+            BuildRequest request4 = CreateBuildRequest(4, 4, new string[] { "foo" }, parentRequest);
+
+            List<ScheduleResponse> response = new List<ScheduleResponse>(_scheduler.ReportRequestBlocked(1, new BuildRequestBlocker(parentRequest.GlobalRequestId, new string[] { }, new BuildRequest[] { request1, request2, request3, request4 })));
+            List<ScheduleResponse> scheduled = response.FindAll(r => r.Action == ScheduleActionType.Schedule || r.Action == ScheduleActionType.ScheduleWithConfiguration);
+
+            // The three nodes take the requests in order of their remaining paths, and the shortest is left until one is free
+            scheduled.Count.ShouldBe(3);
+            scheduled[0].BuildRequest.ShouldBe(request4);
+            scheduled[1].BuildRequest.ShouldBe(request3);
+            scheduled[2].BuildRequest.ShouldBe(request2);
+        }
+
+        /// <summary>
+        /// Verify that the requests a node issues are queued on that node, and that an idle node steals the ones which are
+        /// still waiting once the node is busy.
+        /// </summary>
+        [Fact]
+        public void WorkStealingMovesQueuedRequestsToIdleNodes()
+        {
+            using TestEnvironment env = TestEnvironment.Create();
+            env.SetEnvironmentVariable("MSBUILDSCHEDULERWORKSTEALING", "1");
+
+            BuildRequest parentRequest = StartWorkStealingBuild();
+
+            CreateConfiguration(1, "foo.proj");
+            CreateConfiguration(2, "bar.proj");
+            BuildRequest request1 = CreateBuildRequest(1, 1, new string[] { "foo" }, parentRequest);
+            request1.GlobalRequestId = 1;
+            BuildRequest request2 = CreateBuildRequest(2, 2, new string[] { "foo" }, parentRequest);
+            request2.GlobalRequestId = 2;
+
+            List<ScheduleResponse> response = new List<ScheduleResponse>(_scheduler.ReportRequestBlocked(1, new BuildRequestBlocker(parentRequest.GlobalRequestId, new string[] { }, new BuildRequest[] { request1, request2 })));
+
+            // Both requests are queued on node 1, which runs the first one, and idle node 2 takes the second one
+            response.ShouldContain(r => r.BuildRequest == request1 && r.NodeId == 1);
+            response.ShouldContain(r => r.BuildRequest == request2 && r.NodeId == 2);
+            _scheduler.StolenRequestsCount.ShouldBe(1);
+        }
+
+        /// <summary>
+        /// Verify that an idle node does not steal a request whose configuration has already built on a busy node, since the
+        /// state set by the targets which ran there would be lost.
+        /// </summary>
+        [Fact]
+        public void WorkStealingLeavesBuiltConfigurationsOnTheirNode()
+        {
+            using TestEnvironment env = TestEnvironment.Create();
+            env.SetEnvironmentVariable("MSBUILDSCHEDULERWORKSTEALING", "1");
+
+            BuildRequest parentRequest = StartWorkStealingBuild();
+
+            CreateConfiguration(1, "foo.proj");
+            CreateConfiguration(2, "bar.proj");
+            CreateConfiguration(3, "baz.proj");
+            CreateConfiguration(4, "qux.proj");
+            BuildRequest request1 = CreateBuildRequest(1, 1, new string[] { "foo" }, parentRequest);
+            request1.GlobalRequestId = 1;
+            BuildRequest request2 = CreateBuildRequest(2, 2, new string[] { "foo" }, parentRequest);
+            request2.GlobalRequestId = 2;
+
+            List<ScheduleResponse> response = new List<ScheduleResponse>(_scheduler.ReportRequestBlocked(1, new BuildRequestBlocker(parentRequest.GlobalRequestId, new string[] { }, new BuildRequest[] { request1, request2 })));
+            response.ShouldContain(r => r.BuildRequest == request1 && r.NodeId == 1);
+            response.ShouldContain(r => r.BuildRequest == request2 && r.NodeId == 2);
+
+            // The first configuration finishes on node 1, which then steals a new configuration queued on node 2
+            _scheduler.ReportResult(1, CreateBuildResult(request1, "foo", BuildResultUtilities.GetSuccessResult()));
+
+            BuildRequest request3 = CreateBuildRequest(3, 3, new string[] { "foo" }, request2);
+            request3.GlobalRequestId = 3;
+            BuildRequest request4 = CreateBuildRequest(4, 4, new string[] { "foo" }, request2);
+            request4.GlobalRequestId = 4;
+
+            response = new List<ScheduleResponse>(_scheduler.ReportRequestBlocked(2, new BuildRequestBlocker(request2.GlobalRequestId, new string[] { }, new BuildRequest[] { request3, request4 })));
+            response.ShouldContain(r => r.BuildRequest == request3 && r.NodeId == 2);
+            response.ShouldContain(r => r.BuildRequest == request4 && r.NodeId == 1);
+
+            // The first configuration is needed again while node 1 is busy and node 2 is idle
+            BuildRequest request5 = CreateBuildRequest(5, 1, new string[] { "bar" }, request3);
+            request5.GlobalRequestId = 5;
+
+            response = new List<ScheduleResponse>(_scheduler.ReportRequestBlocked(2, new BuildRequestBlocker(request3.GlobalRequestId, new string[] { }, new BuildRequest[] { request5 })));
+
+            // The request waits for node 1
+            response.ShouldNotContain(r => r.BuildRequest == request5);
+            _scheduler.StolenRequestsCount.ShouldBe(2);
+        }
+
         /// <summary>
         /// Make sure that traversal projects are marked with an affinity of "InProc", which means that
         /// even if multiple are available, we should still only have the single inproc node.
@@ -703,6 +829,59 @@ namespace Microsoft.Build.UnitTests.BackEnd
             _logger.AssertLogContains(reader.ReadLine());
         }
 
+        /// <summary>
+        /// Creates a scheduler with an in-proc and an out-of-proc node, with a top level request executing on the in-proc node.
+        /// </summary>
+        private BuildRequest StartWorkStealingBuild()
+        {
+            _host.BuildParameters.MaxNodeCount = 2;
+            _scheduler = new Scheduler();
+            _scheduler.InitializeComponent(_host);
+            _scheduler.ReportNodesCreated(new NodeInfo[] { new NodeInfo(1, NodeProviderType.InProc), new NodeInfo(2, NodeProviderType.OutOfProc) });
+
+            BuildRequest parentRequest = CreateBuildRequest(99, 99, new string[] { }, null);
+            parentRequest.GlobalRequestId = 99;
+            _scheduler.ReportRequestBlocked(1, new BuildRequestBlocker(-1, new string[] { }, new BuildRequest[] { parentRequest }));
+
+            return parentRequest;
+        }
+
+        /// <summary>
+        /// Writes a scheduling history in which the project of each configuration took the given milliseconds to build and
+        /// referenced the projects of the given configurations.
+        /// </summary>
+        private void WriteSchedulingHistory(string historyPath, params (int configId, double duration, int[] references)[] projects)
+        {
+            IConfigCache configCache = (IConfigCache)_host.GetComponent(BuildComponentType.ConfigCache);
+            Dictionary<int, int> indices = new Dictionary<int, int>();
+            for (int i = 0; i < projects.Length; i++)
+            {
+                indices[projects[i].configId] = i;
+            }
+
+            using (BinaryWriter writer = new BinaryWriter(File.Create(historyPath), Encoding.UTF8))
+            {
+                writer.Write(SchedulingHistory.FileFormatVersion);
+                writer.Write(projects.Length);
+                foreach (var project in projects)
+                {
+                    writer.Write(SchedulingHistory.GetProjectKey(configCache[project.configId]));
+                    writer.Write(project.duration);
+                    writer.Write(0); // built in the last build
+                    writer.Write(0); // no target list timings
+                }
+
+                foreach (var project in projects)
+                {
+                    writer.Write(project.references.Length);
+                    foreach (int reference in project.references)
+                    {
+                        writer.Write(indices[reference]);
+                    }
+                }
+            }
+        }
+
         /// <summary>
         /// Creates a configuration and stores it in the cache.
         /// </summary>
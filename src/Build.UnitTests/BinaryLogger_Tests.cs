@@ -1,5 +1,7 @@
 ﻿using System;
 using System.Collections.Generic;
+using System.IO;
+using System.IO.Compression;
 using System.Text;
 
 using Microsoft.Build.BackEnd.Logging;
@@ -136,6 +138,27 @@ namespace Microsoft.Build.UnitTests
             ObjectModelHelpers.BuildProjectExpectSuccess(s_testProject, binaryLogger);
         }
 
+        [Fact]
+        public void BinaryLoggerRoundtripsWhenCompressingInParallel()
+        {
+            var binaryLogger = new BinaryLogger();
+            binaryLogger.Parameters = $"LogFile={_logFile};Compression=Parallel";
+
+            var mockLogFromBuild = new MockLogger();
+            ObjectModelHelpers.BuildProjectExpectSuccess(s_testProject, binaryLogger, mockLogFromBuild);
+
+            var mockLogFromPlayback = new MockLogger();
+            var binaryLogReader = new BinaryLogReplayEventSource();
+            mockLogFromPlayback.Initialize(binaryLogReader);
+            binaryLogReader.Replay(_logFile);
+
+            mockLogFromPlayback.FullLog.ShouldContainWithoutWhitespace(mockLogFromBuild.FullLog);
+
+            // the blocks are gzip members, so the log is still readable as a single gzip stream
+            using var stream = new GZipStream(File.OpenRead(_logFile), CompressionMode.Decompress);
+            new BinaryReader(stream).ReadInt32().ShouldBe(BinaryLogger.FileFormatVersion);
+        }
+
         [Fact]
         public void BinaryLoggerShouldNotThrowWhenMetadataCannotBeExpanded()
         {
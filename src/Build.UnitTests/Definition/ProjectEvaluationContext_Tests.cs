@@ -1,4 +1,4 @@
-// Copyright (c) Microsoft. All rights reserved.
+﻿// Copyright (c) Microsoft. All rights reserved.
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 using System;
@@ -13,6 +13,8 @@ using Microsoft.Build.Evaluation;
 using Microsoft.Build.Evaluation.Context;
 using Microsoft.Build.Execution;
 using Microsoft.Build.Framework;
+using Microsoft.Build.Shared;
+using Microsoft.Build.Shared.FileSystem;
 using Microsoft.Build.Unittest;
 using Shouldly;
 using Xunit;
@@ -879,6 +881,99 @@ namespace Microsoft.Build.UnitTests.Definition
             evaluationCount.ShouldBe(2);
         }
 
+        [Fact]
+        public void DirectoryIndexEnumeratesOnlyTheDirectoriesThatChanged()
+        {
+            var index = new DirectoryIndex(FileSystems.Default);
+
+            var projectDirectory = _env.DefaultTestDirectory.CreateDirectory("project");
+            var sourceDirectory = projectDirectory.CreateDirectory("src");
+            sourceDirectory.CreateFile("a.cpp");
+            projectDirectory.CreateFile("b.cpp");
+
+            var fileMatcher = new FileMatcher(FileSystems.Default, index.GetFileSystemEntries);
+
+            fileMatcher.GetFiles(projectDirectory.Path, "**/*.cpp").OrderBy(f => f).ShouldBe(new[] { "b.cpp", Path.Combine("src", "a.cpp") });
+            index.Count.ShouldBe(2);
+
+            // Moving the timestamp guards against file systems that don't update it within the resolution of the test
+            sourceDirectory.CreateFile("c.cpp");
+            Directory.SetLastWriteTimeUtc(sourceDirectory.Path, DateTime.UtcNow.AddMinutes(1));
+
+            fileMatcher.GetFiles(projectDirectory.Path, "**/*.cpp").OrderBy(f => f).ShouldBe(new[] { "b.cpp", Path.Combine("src", "a.cpp"), Path.Combine("src", "c.cpp") });
+
+            Directory.Delete(sourceDirectory.Path, true);
+
+            fileMatcher.GetFiles(projectDirectory.Path, "**/*.cpp").ShouldBe(new[] { "b.cpp" });
+        }
+
+        [Fact]
+        public void DirectoryIndexMatchesWithFileSystemCaseSensitivity()
+        {
+            var index = new DirectoryIndex(FileSystems.Default);
+
+            var projectDirectory = _env.DefaultTestDirectory.CreateDirectory("project");
+            projectDirectory.CreateFile("a.cpp");
+            projectDirectory.CreateFile("B.CPP");
+
+            var fileMatcher = new FileMatcher(FileSystems.Default, index.GetFileSystemEntries);
+            var expected = FileUtilities.GetIsFileSystemCaseSensitive()
+                ? new[] { "a.cpp" }
+                : new[] { "B.CPP", "a.cpp" };
+
+            fileMatcher.GetFiles(projectDirectory.Path, "*.cpp").OrderBy(f => f, StringComparer.Ordinal).ShouldBe(expected);
+        }
+
+        [Fact]
+        public void InstallationDirectoryFileSystemRemembersOnlyInstalledFiles()
+        {
+            var fileSystem = new ExistenceCountingFileSystem();
+            var installationDirectoryFileSystem = new InstallationDirectoryFileSystem(fileSystem);
+
+            // Any file the build may write is checked every time
+            string projectFile = Path.Combine(_env.DefaultTestDirectory.Path, "a.props");
+            installationDirectoryFileSystem.FileExists(projectFile).ShouldBeFalse();
+            installationDirectoryFileSystem.FileExists(projectFile).ShouldBeFalse();
+            fileSystem.ExistenceChecks.ShouldBe(2);
+
+            string programFiles = Environment.GetFolderPath(Environment.SpecialFolder.ProgramFiles);
+            if (Path.IsPathRooted(programFiles))
+            {
+                string installedFile = Path.Combine(programFiles, Guid.NewGuid().ToString("N"), "a.props");
+                installationDirectoryFileSystem.FileExists(installedFile).ShouldBeFalse();
+                installationDirectoryFileSystem.FileExists(installedFile).ShouldBeFalse();
+                fileSystem.ExistenceChecks.ShouldBe(3);
+
+                InstallationDirectoryFileSystem.Clear();
+
+                installationDirectoryFileSystem.FileExists(installedFile).ShouldBeFalse();
+                fileSystem.ExistenceChecks.ShouldBe(4);
+            }
+        }
+
+        [Fact]
+        public void InstallationDirectoryFileSystemIsOnlySharedDuringBuilds()
+        {
+            // Evaluations outside a build, like those of API hosts, have nothing to tell them when an installation changes
+            InstallationDirectoryFileSystem.IsEnabled.ShouldBeFalse();
+
+            using (new Helpers.BuildManagerSession(_env))
+            {
+                InstallationDirectoryFileSystem.IsEnabled.ShouldBeTrue();
+
+                string programFiles = Environment.GetFolderPath(Environment.SpecialFolder.ProgramFiles);
+                if (Path.IsPathRooted(programFiles))
+                {
+                    InstallationDirectoryFileSystem.Default.FileExists(Path.Combine(programFiles, Guid.NewGuid().ToString("N"), "a.props")).ShouldBeFalse();
+                    InstallationDirectoryFileSystem.Count.ShouldBeGreaterThan(0);
+                }
+            }
+
+            // What the build saw is forgotten once it ends
+            InstallationDirectoryFileSystem.IsEnabled.ShouldBeFalse();
+            InstallationDirectoryFileSystem.Count.ShouldBe(0);
+        }
+
         private void EvaluateProjects(IEnumerable<string> projectContents, EvaluationContext context, Action<Project> afterEvaluationAction)
         {
             EvaluateProjects(
@@ -887,6 +982,39 @@ namespace Microsoft.Build.UnitTests.Definition
                 afterEvaluationAction);
         }
 
+        private class ExistenceCountingFileSystem : IFileSystem
+        {
+            public int ExistenceChecks { get; private set; }
+
+            public TextReader ReadFile(string path) => throw new NotImplementedException();
+
+            public Stream GetFileStream(string path, FileMode mode, FileAccess access, FileShare share) => throw new NotImplementedException();
+
+            public string ReadFileAllText(string path) => throw new NotImplementedException();
+
+            public byte[] ReadFileAllBytes(string path) => throw new NotImplementedException();
+
+            public IEnumerable<string> EnumerateFiles(string path, string searchPattern = "*", SearchOption searchOption = SearchOption.TopDirectoryOnly) => throw new NotImplementedException();
+
+            public IEnumerable<string> EnumerateDirectories(string path, string searchPattern = "*", SearchOption searchOption = SearchOption.TopDirectoryOnly) => throw new NotImplementedException();
+
+            public IEnumerable<string> EnumerateFileSystemEntries(string path, string searchPattern = "*", SearchOption searchOption = SearchOption.TopDirectoryOnly) => throw new NotImplementedException();
+
+            public FileAttributes GetAttributes(string path) => throw new NotImplementedException();
+
+            public DateTime GetLastWriteTimeUtc(string path) => throw new NotImplementedException();
+
+            public bool DirectoryExists(string path) => throw new NotImplementedException();
+
+            public bool FileExists(string path)
+            {
+                ExistenceChecks++;
+                return false;
+            }
+
+            public bool FileOrDirectoryExists(string path) => throw new NotImplementedException();
+        }
+
         private struct ProjectSpecification
         {
             public string ProjectFilePath { get; }
@@ -1488,6 +1488,38 @@ namespace Microsoft.Build.UnitTests.Evaluation
                 expander.ExpandIntoStringLeaveEscaped(xmlattribute.Value, ExpanderOptions.ExpandAll, MockElementLocation.Instance));
         }
 
+        /// <summary>
+        /// Expanding the same metadata expression again, as batching does for every bucket, expands it with the metadata at hand.
+        /// </summary>
+        [Fact]
+        public void ExpandMetadataOfTheSameExpressionForEachBucket()
+        {
+            const string expression = @"obj\%(Filename).obj;%( Culture );%(Compile.Culture)%(Identity)";
+
+            foreach (string name in new[] { "a", "b" })
+            {
+                var itemMetadataTable = new Dictionary<string, string>(StringComparer.OrdinalIgnoreCase)
+                {
+                    { "Filename", name },
+                    { "Identity", name + ".cpp" },
+                    { "Culture", name + "-culture" },
+                    { "Compile.Culture", name + "-compile" },
+                };
+                var expander = new Expander<ProjectPropertyInstance, ProjectItemInstance>(
+                    new PropertyDictionary<ProjectPropertyInstance>(),
+                    new ItemDictionary<ProjectItemInstance>(),
+                    new StringMetadataTable(itemMetadataTable),
+                    FileSystems.Default);
+
+                expander.ExpandIntoStringLeaveEscaped(expression, ExpanderOptions.ExpandMetadata, MockElementLocation.Instance)
+                    .ShouldBe($@"obj\{name}.obj;{name}-culture;{name}-compile{name}.cpp");
+                expander.ExpandIntoStringLeaveEscaped(expression, ExpanderOptions.ExpandBuiltInMetadata, MockElementLocation.Instance)
+                    .ShouldBe($@"obj\{name}.obj;%( Culture );%(Compile.Culture){name}.cpp");
+                expander.ExpandIntoStringLeaveEscaped("%(Identity)", ExpanderOptions.ExpandMetadata, MockElementLocation.Instance)
+                    .ShouldBe(name + ".cpp");
+            }
+        }
+
         /// <summary>
         /// Exercises ExpandIntoStringAndUnescape and ExpanderOptions.Truncate
         /// </summary>
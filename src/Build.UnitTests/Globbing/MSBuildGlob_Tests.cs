@@ -322,6 +322,30 @@ namespace Microsoft.Build.Engine.UnitTests.Globbing
             Assert.False(glob.IsMatch(@"../x/d13/../x/d12/d23/../a.cs"));
         }
 
+        [Theory]
+        [InlineData("**/*.cs", "a.cs", true)]
+        [InlineData("**/*.cs", "b/c/A.CS", true)]
+        [InlineData("**/*.cs", "b/a.csx", false)]
+        [InlineData("*.cs", "b/a.cs", false)]
+        [InlineData("b/**", "b/c/d.txt", true)]
+        [InlineData("b/**", "c/d.txt", false)]
+        [InlineData("b/*.*", "b/d", true)]
+        [InlineData("b/a*b*c", "b/abbc", true)]
+        [InlineData("b/a*b*c", "b/ac", false)]
+        [InlineData("b/*ab*ab", "b/abab", true)]
+        [InlineData("b/*ab*ab", "b/aba", false)]
+        [InlineData("b/c.cs", "B/C.cs", true)]
+        [InlineData("b/?.cs", "b/c.cs", true)]
+        [InlineData("b/*c*/*.cs", "b/acb/d.cs", true)]
+        public void GlobMatchingWithoutTheRegexAgreesWithTheRegex(string fileSpec, string stringToMatch, bool expectedIsMatch)
+        {
+            var globRoot = NativeMethodsShared.IsWindows ? @"c:\a\" : "/a/";
+            var glob = MSBuildGlob.Parse(globRoot, fileSpec);
+
+            Assert.Equal(expectedIsMatch, glob.IsMatch(stringToMatch));
+            Assert.Equal(expectedIsMatch, glob.TestOnlyRegex.IsMatch(Path.Combine(globRoot, stringToMatch)));
+        }
+
         [Theory]
         [InlineData(
             @"a/b\c",
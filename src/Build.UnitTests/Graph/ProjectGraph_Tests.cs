@@ -7,6 +7,7 @@ using System.Collections.Immutable;
 using System.IO;
 using System.Linq;
 using System.Text.RegularExpressions;
+using System.Threading;
 using Microsoft.Build.Evaluation;
 using Microsoft.Build.Exceptions;
 using Microsoft.Build.Execution;
@@ -2324,6 +2325,55 @@ $@"
             }
         }
 
+        [Fact]
+        public void PersistedGraphReusesTheProjectsWhoseFilesDidNotChange()
+        {
+            var cacheFile = Path.Combine(_env.CreateFolder().Path, "graph.cache");
+
+            // Makes the evaluations record the environment variables they read
+            _env.SetEnvironmentVariable("MSBUILDPROJECTGRAPHCACHEFILE", cacheFile);
+
+            var entryProject = CreateProjectFile(_env, 1, new[] {2, 3});
+            var changedProject = CreateProjectFile(_env, 2);
+            CreateProjectFile(_env, 3);
+
+            ConstructGraph(out int reusedCount).ProjectNodes.Count.ShouldBe(3);
+            reusedCount.ShouldBe(0);
+
+            var graph = ConstructGraph(out reusedCount);
+            reusedCount.ShouldBe(3);
+            graph.Edges.Count.ShouldBe(2);
+            graph.ProjectNodes.ShouldAllBe(n => n.ProjectInstance.ImportPaths != null);
+
+            File.WriteAllText(changedProject.Path, "<Project><PropertyGroup><Changed>true</Changed></PropertyGroup></Project>");
+            File.SetLastWriteTimeUtc(changedProject.Path, DateTime.UtcNow.AddMinutes(1));
+
+            graph = ConstructGraph(out reusedCount);
+            reusedCount.ShouldBe(2);
+            GetFirstNodeWithProjectNumber(graph, 2).ProjectInstance.GetPropertyValue("Changed").ShouldBe("true");
+
+            ProjectGraph ConstructGraph(out int reused)
+            {
+                var graphCache = ProjectGraphCache.Load(
+                    cacheFile,
+                    new BuildParameters().EnvironmentPropertiesInternal,
+                    ProjectCollection.GlobalProjectCollection.ProjectRootElementCache);
+
+                var projectGraph = new ProjectGraph(
+                    new[] {new ProjectGraphEntryPoint(entryProject.Path)},
+                    ProjectCollection.GlobalProjectCollection,
+                    null,
+                    1,
+                    CancellationToken.None,
+                    graphCache);
+
+                graphCache.Save(cacheFile, projectGraph);
+
+                reused = graphCache.ReusedCount;
+                return projectGraph;
+            }
+        }
+
         public void Dispose()
         {
             _env.Dispose();
@@ -1351,6 +1351,137 @@ namespace Microsoft.Build.Engine.UnitTests.ProjectCache
             cache.QueryStartStops.Count.ShouldBe(graph.ProjectNodes.Count * 2);
         }
 
+        [Fact]
+        public void ContentAddressedCacheRestoresOutputsOfUnchangedProjects()
+        {
+            var cacheDirectory = _env.CreateFolder().Path;
+
+            var graph = Helpers.CreateProjectGraph(
+                _env,
+                new Dictionary<int, int[]>
+                {
+                    {1, new[] {2}}
+                },
+                extraContentPerProjectNumber: null,
+                extraContentForAllNodes: @"
+<Target Name='Build' Returns='$(MSBuildProjectDirectory)\$(MSBuildProjectName).out'>
+    <WriteLinesToFile File='$(MSBuildProjectName).out' Lines='$(MSBuildProjectName)' Overwrite='true' />
+</Target>
+");
+
+            var outputs = graph.ProjectNodes.Select(n => Path.ChangeExtension(n.ProjectInstance.FullPath, ".out")).ToArray();
+
+            BuildWithCache().ShouldContain("0 hits, 2 misses, 2 projects added to the store");
+
+            foreach (var output in outputs)
+            {
+                File.Delete(output);
+            }
+
+            BuildWithCache().ShouldContain("2 hits, 0 misses, 0 projects added to the store");
+
+            foreach (var output in outputs)
+            {
+                File.ReadAllText(output).Trim().ShouldBe(Path.GetFileNameWithoutExtension(output));
+            }
+
+            string BuildWithCache()
+            {
+                var buildSession = new Helpers.BuildManagerSession(
+                    _env,
+                    new BuildParameters
+                    {
+                        ProjectCacheDescriptor = ProjectCacheDescriptor.FromInstance(
+                            new ContentAddressedProjectCache(),
+                            null,
+                            graph,
+                            new Dictionary<string, string>
+                            {
+                                {"CacheDirectory", cacheDirectory}
+                            })
+                    });
+
+                // The plugin logs its statistics when the session ends
+                using (buildSession)
+                {
+                    buildSession.BuildGraph(graph).OverallResult.ShouldBe(BuildResultCode.Success);
+                }
+
+                return buildSession.Logger.FullLog;
+            }
+        }
+
+        [Fact]
+        public void ContentAddressedCacheMissesProjectsWithChangedInputs()
+        {
+            var cacheDirectory = _env.CreateFolder().Path;
+            var projectDirectory = _env.CreateFolder().Path;
+
+            var source = Path.Combine(projectDirectory, "source.cpp");
+            var header = Path.Combine(projectDirectory, "header.h");
+            File.WriteAllText(source, "source");
+            File.WriteAllText(header, "header");
+
+            // The header is only known to the cache through the read tlog the build writes
+            var project = Path.Combine(projectDirectory, "main.proj");
+            File.WriteAllText(project, $@"
+<Project>
+    <PropertyGroup>
+        <Configuration Condition=`'$(Configuration)' == ''`>Debug</Configuration>
+        <TLogLocation>$(MSBuildProjectDirectory)\tlogs\</TLogLocation>
+    </PropertyGroup>
+    <ItemGroup>
+        <ClCompile Include=`source.cpp` />
+    </ItemGroup>
+    <Target Name=`Build` Returns=`$(MSBuildProjectDirectory)\main.out`>
+        <WriteLinesToFile File=`main.out` Lines=`$(Configuration)` Overwrite=`true` />
+        <WriteLinesToFile File=`$(TLogLocation)CL.read.1.tlog` Lines=`^{source};{header}` Overwrite=`true` />
+    </Target>
+</Project>".Cleanup());
+
+            BuildWithCache().ShouldContain("0 hits, 1 misses, 1 projects added to the store");
+            BuildWithCache().ShouldContain("1 hits, 0 misses, 0 projects added to the store");
+
+            File.WriteAllText(source, "changed source");
+            BuildWithCache().ShouldContain("0 hits, 1 misses, 1 projects added to the store");
+
+            File.WriteAllText(header, "changed header");
+            BuildWithCache().ShouldContain("0 hits, 1 misses, 1 projects added to the store");
+
+            BuildWithCache(new Dictionary<string, string> { { "Configuration", "Release" } }).ShouldContain("0 hits, 1 misses, 1 projects added to the store");
+
+            _env.SetEnvironmentVariable("Configuration", "Checked");
+            BuildWithCache().ShouldContain("0 hits, 1 misses, 1 projects added to the store");
+            File.ReadAllText(Path.Combine(projectDirectory, "main.out")).Trim().ShouldBe("Checked");
+
+            string BuildWithCache(Dictionary<string, string>? globalProperties = null)
+            {
+                var graph = new ProjectGraph(new ProjectGraphEntryPoint(project, globalProperties ?? new Dictionary<string, string>()));
+
+                var buildSession = new Helpers.BuildManagerSession(
+                    _env,
+                    new BuildParameters
+                    {
+                        ProjectCacheDescriptor = ProjectCacheDescriptor.FromInstance(
+                            new ContentAddressedProjectCache(),
+                            null,
+                            graph,
+                            new Dictionary<string, string>
+                            {
+                                {"CacheDirectory", cacheDirectory}
+                            })
+                    });
+
+                // The plugin logs its statistics when the session ends
+                using (buildSession)
+                {
+                    buildSession.BuildGraph(graph).OverallResult.ShouldBe(BuildResultCode.Success);
+                }
+
+                return buildSession.Logger.FullLog;
+            }
+        }
+
         private static void StringShouldContainSubstring(string aString, string substring, int expectedOccurrences)
         {
             aString.ShouldContain(substring);
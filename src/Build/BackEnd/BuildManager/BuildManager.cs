@@ -22,6 +22,7 @@ using Microsoft.Build.BackEnd.SdkResolution;
 using Microsoft.Build.Collections;
 using Microsoft.Build.Construction;
 using Microsoft.Build.Evaluation;
+using Microsoft.Build.Evaluation.Context;
 using Microsoft.Build.Eventing;
 using Microsoft.Build.Exceptions;
 using Microsoft.Build.Experimental.ProjectCache;
@@ -31,6 +32,7 @@ using Microsoft.Build.Internal;
 using Microsoft.Build.Logging;
 using Microsoft.Build.Shared;
 using Microsoft.Build.Shared.FileSystem;
+using Microsoft.Build.Utilities;
 using ForwardingLoggerRecord = Microsoft.Build.Logging.ForwardingLoggerRecord;
 using LoggerDescription = Microsoft.Build.Logging.LoggerDescription;
 
@@ -442,6 +444,12 @@ namespace Microsoft.Build.Execution
                 // Initialize components.
                 _nodeManager = ((IBuildComponentHost)this).GetComponent(BuildComponentType.NodeManager) as INodeManager;
 
+                if (Traits.Instance.PrelaunchNodes && !_buildParameters.EnableNodeReuse)
+                {
+                    // Reused nodes are already warm, while new ones start up during the evaluation of the first projects
+                    (_nodeManager as NodeManager)?.PrelaunchNodes();
+                }
+
                 var loggingService = InitializeLoggingService();
 
                 LogDeferredMessages(loggingService, _deferredBuildMessages);
@@ -479,6 +487,9 @@ namespace Microsoft.Build.Execution
 
                 _buildManagerState = BuildManagerState.Building;
 
+                // Evaluations in the build share what exists in installation directories until it ends
+                InstallationDirectoryFileSystem.BuildStarted();
+
                 _noActiveSubmissionsEvent.Set();
                 _noNodesActiveEvent.Set();
             }
@@ -835,6 +846,8 @@ namespace Microsoft.Build.Execution
                     SerializeCaches();
                 }
 
+                _scheduler.WriteSchedulingHistory();
+
                 projectCacheShutdown?.Wait();
 
 #if DEBUG
@@ -905,6 +918,8 @@ namespace Microsoft.Build.Execution
                         _legacyThreadingData.MainThreadSubmissionId = -1;
                     }
 
+                    InstallationDirectoryFileSystem.BuildFinished();
+
                     Reset();
                     _buildManagerState = BuildManagerState.Idle;
 
@@ -1709,6 +1724,12 @@ namespace Microsoft.Build.Execution
                 var projectGraph = submission.BuildRequestData.ProjectGraph;
                 if (projectGraph == null)
                 {
+                    string graphCacheFile = Traits.Instance.ProjectGraphCacheFile;
+                    var graphCache = string.IsNullOrEmpty(graphCacheFile) ? null : ProjectGraphCache.Load(
+                        graphCacheFile,
+                        _buildParameters.EnvironmentPropertiesInternal,
+                        _buildParameters.ProjectRootElementCache);
+
                     projectGraph = new ProjectGraph(
                         submission.BuildRequestData.ProjectGraphEntryPoints,
                         ProjectCollection.GlobalProjectCollection,
@@ -1742,7 +1763,12 @@ namespace Microsoft.Build.Execution
                                 SdkResolverService,
                                 submission.SubmissionId,
                                 projectLoadSettings);
-                        });
+                        },
+                        NativeMethodsShared.GetLogicalCoreCount(),
+                        CancellationToken.None,
+                        graphCache);
+
+                    graphCache?.Save(graphCacheFile, projectGraph);
                 }
 
                 LogMessage(
@@ -2595,6 +2621,12 @@ namespace Microsoft.Build.Execution
                         submission.CompleteLogging(waitForLoggingThread: false);
                     }
 
+                    // Let the project cache record what was built before the build can end and shut it down.
+                    if (_projectCacheService?.Status == TaskStatus.RanToCompletion)
+                    {
+                        _projectCacheService.Result.PostProjectFinished(result);
+                    }
+
                     submission.CompleteResults(result);
 
                     _overallBuildSuccess = _overallBuildSuccess && (_buildSubmissions[result.SubmissionId].BuildResult.OverallResult == BuildResultCode.Success);
@@ -2682,6 +2714,9 @@ namespace Microsoft.Build.Execution
 #endif
                 }
 
+                // Installations may change between builds
+                InstallationDirectoryFileSystem.Clear();
+
                 _noActiveSubmissionsEvent.Set();
             }
         }
@@ -7,6 +7,7 @@ using System.Collections.Generic;
 using System.Collections.Concurrent;
 using Microsoft.Build.Execution;
 using Microsoft.Build.Shared;
+using Microsoft.Build.Utilities;
 
 namespace Microsoft.Build.BackEnd
 {
@@ -21,17 +22,42 @@ namespace Microsoft.Build.BackEnd
         /// </summary>
         private ConcurrentDictionary<int, BuildResult> _resultsByConfiguration;
 
+        /// <summary>
+        /// The number of result items to hold in memory before the items of the least recently used results are
+        /// cached to disk, or zero to hold all of them.
+        /// </summary>
+        private int _itemLimit;
+
+        /// <summary>
+        /// The number of result items held in memory. Items read back from disk are not counted until the
+        /// count next passes the limit and is taken again.
+        /// </summary>
+        private int _itemsInMemory;
+
+        /// <summary>
+        /// The use of <see cref="_useCount"/> at which the results of each configuration were last added or retrieved,
+        /// kept only while there is an item limit.
+        /// </summary>
+        private Dictionary<int, long> _lastUseByConfiguration;
+
+        /// <summary>
+        /// The number of times results have been added or retrieved.
+        /// </summary>
+        private long _useCount;
+
         /// <summary>
         /// Creates an empty results cache.
         /// </summary>
         public ResultsCache()
         {
             _resultsByConfiguration = new ConcurrentDictionary<int, BuildResult>();
+            InitializeItemLimit();
         }
 
         public ResultsCache(ITranslator translator)
         {
             Translate(translator);
+            InitializeItemLimit();
         }
 
         /// <summary>
@@ -75,6 +101,17 @@ namespace Microsoft.Build.BackEnd
                         ErrorUtilities.ThrowInternalError("Failed to add result for configuration {0}", result.ConfigurationId);
                     }
                 }
+
+                if (_itemLimit > 0)
+                {
+                    RecordUse(result.ConfigurationId);
+
+                    _itemsInMemory += result.CountItemsInMemory();
+                    if (_itemsInMemory > _itemLimit)
+                    {
+                        WriteLeastRecentlyUsedResultsToDisk();
+                    }
+                }
             }
         }
 
@@ -91,6 +128,8 @@ namespace Microsoft.Build.BackEnd
                 }
 
                 _resultsByConfiguration.Clear();
+                _lastUseByConfiguration?.Clear();
+                _itemsInMemory = 0;
             }
         }
 
@@ -112,6 +151,7 @@ namespace Microsoft.Build.BackEnd
                         ErrorUtilities.VerifyThrow(result.HasResultsForTarget(target), "No results in cache for target " + target);
                     }
 
+                    RecordUse(request.ConfigurationId);
                     return result;
                 }
             }
@@ -129,7 +169,10 @@ namespace Microsoft.Build.BackEnd
             BuildResult results;
             lock (_resultsByConfiguration)
             {
-                _resultsByConfiguration.TryGetValue(configurationId, out results);
+                if (_resultsByConfiguration.TryGetValue(configurationId, out results))
+                {
+                    RecordUse(configurationId);
+                }
             }
 
             return results;
@@ -160,6 +203,8 @@ namespace Microsoft.Build.BackEnd
             {
                 if (_resultsByConfiguration.TryGetValue(request.ConfigurationId, out BuildResult allResults))
                 {
+                    RecordUse(request.ConfigurationId);
+
                     // Check for targets explicitly specified.
                     bool explicitTargetsSatisfied = CheckResults(allResults, request.Targets, response.ExplicitTargetsToBuild, skippedResultsDoNotCauseCacheMiss);
 
@@ -224,6 +269,7 @@ namespace Microsoft.Build.BackEnd
             {
                 BuildResult removedResult;
                 _resultsByConfiguration.TryRemove(configurationId, out removedResult);
+                _lastUseByConfiguration?.Remove(configurationId);
 
                 removedResult?.ClearCachedFiles();
             }
@@ -256,6 +302,8 @@ namespace Microsoft.Build.BackEnd
                 {
                     resultToCache.CacheIfPossible();
                 }
+
+                _itemsInMemory = 0;
             }
         }
 
@@ -278,6 +326,8 @@ namespace Microsoft.Build.BackEnd
         public void ShutdownComponent()
         {
             _resultsByConfiguration.Clear();
+            _lastUseByConfiguration?.Clear();
+            _itemsInMemory = 0;
         }
 
         #endregion
@@ -291,6 +341,88 @@ namespace Microsoft.Build.BackEnd
             return new ResultsCache();
         }
 
+        /// <summary>
+        /// Reads the item limit, set with MSBUILDRESULTSCACHEITEMLIMIT.
+        /// </summary>
+        private void InitializeItemLimit()
+        {
+            _itemLimit = Traits.Instance.ResultsCacheItemLimit;
+            if (_itemLimit > 0)
+            {
+                _lastUseByConfiguration = new Dictionary<int, long>();
+            }
+        }
+
+        /// <summary>
+        /// Records that the results of the configuration have just been used, if that is being tracked.
+        /// Must be called under the lock.
+        /// </summary>
+        private void RecordUse(int configurationId)
+        {
+            if (_itemLimit > 0)
+            {
+                _lastUseByConfiguration[configurationId] = ++_useCount;
+            }
+        }
+
+        /// <summary>
+        /// Caches the items of the least recently used results to disk until a quarter of the item limit is free, so that
+        /// the next results added don't immediately cause more to be cached. The items are read back from disk if they
+        /// are used again. Must be called under the lock.
+        /// </summary>
+        private void WriteLeastRecentlyUsedResultsToDisk()
+        {
+            // Items which were read back from disk since the last count are in memory again, so count them all
+            var resultsInMemory = new List<BuildResult>();
+            _itemsInMemory = 0;
+            foreach (BuildResult result in _resultsByConfiguration.Values)
+            {
+                int itemCount = result.CountItemsInMemory();
+                if (itemCount > 0)
+                {
+                    resultsInMemory.Add(result);
+                    _itemsInMemory += itemCount;
+                }
+            }
+
+            int itemsToKeep = _itemLimit - (_itemLimit / 4);
+            if (_itemsInMemory <= itemsToKeep)
+            {
+                return;
+            }
+
+            resultsInMemory.Sort((x, y) => GetLastUse(x.ConfigurationId).CompareTo(GetLastUse(y.ConfigurationId)));
+
+            try
+            {
+                foreach (BuildResult result in resultsInMemory)
+                {
+                    int itemCount = result.CountItemsInMemory();
+                    result.CacheIfPossible();
+                    _itemsInMemory -= itemCount - result.CountItemsInMemory();
+
+                    if (_itemsInMemory <= itemsToKeep)
+                    {
+                        break;
+                    }
+                }
+            }
+            catch (Exception e) when (ExceptionHandling.IsIoRelatedException(e))
+            {
+                // Hold the remaining results in memory as if there were no limit, rather than failing the build
+                _itemLimit = 0;
+            }
+        }
+
+        /// <summary>
+        /// Gets when the results of the configuration were last used.
+        /// </summary>
+        private long GetLastUse(int configurationId)
+        {
+            _lastUseByConfiguration.TryGetValue(configurationId, out long lastUse);
+            return lastUse;
+        }
+
         /// <summary>
         /// Looks for results for the specified targets.
         /// </summary>
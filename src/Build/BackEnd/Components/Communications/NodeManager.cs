@@ -165,6 +165,19 @@ namespace Microsoft.Build.BackEnd
 
         #endregion
 
+        /// <summary>
+        /// Launches the out-of-proc nodes ahead of the requests for them.
+        /// </summary>
+        internal void PrelaunchNodes()
+        {
+            if (_outOfProcNodeProvider is NodeProviderOutOfProc outOfProcNodeProvider)
+            {
+                // The nodes are shut down at the end of the build even if the build doesn't use them
+                _nodesShutdown = false;
+                outOfProcNodeProvider.PrelaunchNodes();
+            }
+        }
+
         #region IBuildComponent Members
 
         /// <summary>
@@ -82,11 +82,7 @@ namespace Microsoft.Build.BackEnd
                 return false;
             }
 
-            // Start the new process.  We pass in a node mode with a node number of 1, to indicate that we
-            // want to start up just a standard MSBuild out-of-proc node.
-            // Note: We need to always pass /nodeReuse to ensure the value for /nodeReuse from msbuild.rsp
-            // (next to msbuild.exe) is ignored.
-            string commandLineArgs = $"/nologo /nodemode:1 /nodeReuse:{ComponentHost.BuildParameters.EnableNodeReuse.ToString().ToLower()} /low:{ComponentHost.BuildParameters.LowPriority.ToString().ToLower()}";
+            string commandLineArgs = GetCommandLineArgs();
 
             // Make it here.
             CommunicationsUtilities.Trace("Starting to acquire a new or existing node to establish node ID {0}...", nodeId);
@@ -110,6 +106,22 @@ namespace Microsoft.Build.BackEnd
             throw new BuildAbortedException(ResourceUtilities.FormatResourceStringStripCodeAndKeyword("CouldNotConnectToMSBuildExe", ComponentHost.BuildParameters.NodeExeLocation));
         }
 
+        /// <summary>
+        /// Launches the out-of-proc nodes the build may use in the background, so that they start up, and load the common
+        /// imports, while the build evaluates the first projects instead of when the scheduler assigns them work.
+        /// </summary>
+        internal void PrelaunchNodes()
+        {
+            int count = ComponentHost.BuildParameters.MaxNodeCount - (ComponentHost.BuildParameters.DisableInProcNode ? 0 : 1);
+            if (count <= 0)
+            {
+                return;
+            }
+
+            CommunicationsUtilities.Trace("Prelaunching {0} nodes...", count);
+            PrelaunchNodes(count, GetCommandLineArgs());
+        }
+
         /// <summary>
         /// Sends data to the specified node.
         /// </summary>
@@ -128,6 +140,8 @@ namespace Microsoft.Build.BackEnd
         /// <param name="enableReuse">Flag indicating if nodes should prepare for reuse.</param>
         public void ShutdownConnectedNodes(bool enableReuse)
         {
+            TerminatePrelaunchedNodes();
+
             // Send the build completion message to the nodes, causing them to shutdown or reset.
             List<NodeContext> contextsToShutDown;
 
@@ -150,6 +164,8 @@ namespace Microsoft.Build.BackEnd
             // they must have been started with node reuse.
             bool nodeReuse = ComponentHost.BuildParameters?.EnableNodeReuse ?? true;
 
+            TerminatePrelaunchedNodes();
+
             // To avoid issues with mismatched priorities not shutting
             // down all the nodes on exit, we will attempt to shutdown
             // all matching nodes with and without the priority bit set.
@@ -189,6 +205,18 @@ namespace Microsoft.Build.BackEnd
             return new NodeProviderOutOfProc();
         }
 
+        /// <summary>
+        /// Gets the command line of the nodes of the build.
+        /// </summary>
+        private string GetCommandLineArgs()
+        {
+            // Start the new process.  We pass in a node mode with a node number of 1, to indicate that we
+            // want to start up just a standard MSBuild out-of-proc node.
+            // Note: We need to always pass /nodeReuse to ensure the value for /nodeReuse from msbuild.rsp
+            // (next to msbuild.exe) is ignored.
+            return $"/nologo /nodemode:1 /nodeReuse:{ComponentHost.BuildParameters.EnableNodeReuse.ToString().ToLower()} /low:{ComponentHost.BuildParameters.LowPriority.ToString().ToLower()}";
+        }
+
         /// <summary>
         /// Method called when a context terminates.
         /// </summary>
@@ -7,6 +7,7 @@ using System.Collections.Generic;
 using System.Collections.Concurrent;
 using System.Globalization;
 using System.IO;
+using System.IO.Compression;
 using System.IO.Pipes;
 using System.Diagnostics;
 using System.Threading;
@@ -69,6 +70,16 @@ namespace Microsoft.Build.BackEnd
         /// </summary>
         private HashSet<string> _processesToIgnore = new HashSet<string>();
 
+        /// <summary>
+        /// The processes launched ahead of the requests for nodes, which nothing connected to yet.
+        /// </summary>
+        private readonly ConcurrentQueue<Process> _prelaunchedNodes = new ConcurrentQueue<Process>();
+
+        /// <summary>
+        /// The task launching the processes of <see cref="_prelaunchedNodes"/>.
+        /// </summary>
+        private Task _prelaunchNodesTask = Task.CompletedTask;
+
         /// <summary>
         /// Delegate used to tell the node provider that a context has terminated.
         /// </summary>
@@ -176,6 +187,49 @@ namespace Microsoft.Build.BackEnd
             }
         }
 
+        /// <summary>
+        /// Launches nodes in the background, ahead of the requests for them, so that they start up while the build evaluates
+        /// projects. <see cref="GetNode"/> connects to them before launching any other node.
+        /// </summary>
+        /// <param name="count">The number of nodes to launch.</param>
+        /// <param name="commandLineArgs">The command line of the nodes, which must be that of the nodes requested later.</param>
+        protected void PrelaunchNodes(int count, string commandLineArgs)
+        {
+            string msbuildLocation = GetNodeLocation(null);
+
+            _prelaunchNodesTask = Task.Run(() =>
+            {
+                for (int i = 0; i < count; i++)
+                {
+                    try
+                    {
+                        _prelaunchedNodes.Enqueue(LaunchNode(msbuildLocation, commandLineArgs));
+                    }
+                    catch (Exception e) when (e is NodeFailedToLaunchException || e is BuildAbortedException)
+                    {
+                        // The node fails to launch again when it's requested, which reports the error
+                        CommunicationsUtilities.Trace("Failed to prelaunch a node. {0}", e.Message);
+                        break;
+                    }
+                }
+            });
+        }
+
+        /// <summary>
+        /// Terminates the nodes launched ahead of the requests for them that the build didn't need.
+        /// </summary>
+        protected void TerminatePrelaunchedNodes()
+        {
+            _prelaunchNodesTask.Wait();
+
+            while (_prelaunchedNodes.TryDequeue(out Process process))
+            {
+                CommunicationsUtilities.Trace("Terminating unused prelaunched node with PID {0}", process.Id);
+                process.KillTree(TimeoutForWaitForExit);
+                process.Dispose();
+            }
+        }
+
         /// <summary>
         /// Finds or creates a child process which can act as a node.
         /// </summary>
@@ -189,21 +243,7 @@ namespace Microsoft.Build.BackEnd
             }
 #endif
 
-            if (String.IsNullOrEmpty(msbuildLocation))
-            {
-                msbuildLocation = _componentHost.BuildParameters.NodeExeLocation;
-            }
-
-            if (String.IsNullOrEmpty(msbuildLocation))
-            {
-                string msbuildExeName = Environment.GetEnvironmentVariable("MSBUILD_EXE_NAME");
-
-                if (!String.IsNullOrEmpty(msbuildExeName))
-                {
-                    // we assume that MSBUILD_EXE_NAME is, in fact, just the name.
-                    msbuildLocation = Path.Combine(msbuildExeName, ".exe");
-                }
-            }
+            msbuildLocation = GetNodeLocation(msbuildLocation);
 
 #if FEATURE_NODE_REUSE
             // Try to connect to idle nodes if node reuse is enabled.
@@ -241,6 +281,22 @@ namespace Microsoft.Build.BackEnd
             }
 #endif
 
+            // Connect to a node launched ahead of the request, unless it failed to start up
+            while (_prelaunchedNodes.TryDequeue(out Process prelaunchedProcess))
+            {
+                _processesToIgnore.Add(GetProcessesToIgnoreKey(hostHandshake, prelaunchedProcess.Id));
+
+                Stream nodeStream = TryConnectToProcess(prelaunchedProcess.Id, TimeoutForNewNodeCreation, hostHandshake);
+                if (nodeStream != null)
+                {
+                    CommunicationsUtilities.Trace("Successfully connected to prelaunched node {0} which is PID {1}", nodeId, prelaunchedProcess.Id);
+                    return new NodeContext(nodeId, prelaunchedProcess, nodeStream, factory, terminateNode);
+                }
+
+                prelaunchedProcess.KillTree(TimeoutForWaitForExit);
+                prelaunchedProcess.Dispose();
+            }
+
             // None of the processes we tried to connect to allowed a connection, so create a new one.
             // We try this in a loop because it is possible that there is another MSBuild multiproc
             // host process running somewhere which is also trying to create nodes right now.  It might
@@ -295,6 +351,30 @@ namespace Microsoft.Build.BackEnd
             return null;
         }
 
+        /// <summary>
+        /// Gets the executable of the nodes, if the caller doesn't specify it.
+        /// </summary>
+        private string GetNodeLocation(string msbuildLocation)
+        {
+            if (String.IsNullOrEmpty(msbuildLocation))
+            {
+                msbuildLocation = _componentHost.BuildParameters.NodeExeLocation;
+            }
+
+            if (String.IsNullOrEmpty(msbuildLocation))
+            {
+                string msbuildExeName = Environment.GetEnvironmentVariable("MSBUILD_EXE_NAME");
+
+                if (!String.IsNullOrEmpty(msbuildExeName))
+                {
+                    // we assume that MSBUILD_EXE_NAME is, in fact, just the name.
+                    msbuildLocation = Path.Combine(msbuildExeName, ".exe");
+                }
+            }
+
+            return msbuildLocation;
+        }
+
         /// <summary>
         /// Finds processes named after either msbuild or msbuildtaskhost.
         /// </summary>
@@ -656,6 +736,16 @@ namespace Microsoft.Build.BackEnd
             /// </summary>
             private MemoryStream _writeBufferMemoryStream;
 
+            /// <summary>
+            /// A reusable buffer for the bodies of compressed packets once decompressed.
+            /// </summary>
+            private MemoryStream _decompressedBufferMemoryStream;
+
+            /// <summary>
+            /// The strings the node sent once for this connection, indexed by their id, see Traits.UseNodePacketStringTable.
+            /// </summary>
+            private List<string> _stringTable;
+
             /// <summary>
             /// A queue used for enqueuing packets to write to the stream asynchronously.
             /// </summary>
@@ -761,7 +851,7 @@ namespace Microsoft.Build.BackEnd
                     }
 
                     // Read and route the packet.
-                    if (!ReadAndRoutePacket(packetType, packetData, packetLength))
+                    if (!ReadAndRoutePacket(ref packetType, packetData, packetLength))
                     {
                         return;
                     }
@@ -813,21 +903,19 @@ namespace Microsoft.Build.BackEnd
                     // running is about 100-200 microseconds (unless there's thread pool saturation)
                     _packetWriteDrainTask = _packetWriteDrainTask.ContinueWith(_ =>
                     {
-                        while (_packetWriteQueue.TryTake(out var packet))
-                        {
-                            SendDataCore(packet);
-                        }
+                        SendDataCore();
                     }, TaskScheduler.Default);
                 }
             }
 
             /// <summary>
-            /// Actually writes and sends the packet. This can't be called in parallel
-            /// because it reuses the _writeBufferMemoryStream, and this is why we use
-            /// the _packetWriteDrainTask to serially chain invocations one after another.
+            /// Actually writes and sends the queued packets. Packets queued together are
+            /// framed back to back in the buffer and sent with as few writes as possible.
+            /// This can't be called in parallel because it reuses the _writeBufferMemoryStream,
+            /// and this is why we use the _packetWriteDrainTask to serially chain invocations
+            /// one after another.
             /// </summary>
-            /// <param name="packet">The packet to send.</param>
-            private void SendDataCore(INodePacket packet)
+            private void SendDataCore()
             {
                 MemoryStream writeStream = _writeBufferMemoryStream;
 
@@ -835,31 +923,35 @@ namespace Microsoft.Build.BackEnd
                 writeStream.SetLength(0);
 
                 ITranslator writeTranslator = BinaryTranslator.GetWriteTranslator(writeStream);
+                bool exitPacketWritten = false;
                 try
                 {
-                    writeStream.WriteByte((byte)packet.Type);
+                    while (_packetWriteQueue.TryTake(out var packet))
+                    {
+                        int packetStart = (int)writeStream.Position;
 
-                    // Pad for the packet length
-                    WriteInt32(writeStream, 0);
-                    packet.Translate(writeTranslator);
+                        writeStream.WriteByte((byte)packet.Type);
 
-                    int writeStreamLength = (int)writeStream.Position;
+                        // Pad for the packet length
+                        WriteInt32(writeStream, 0);
+                        packet.Translate(writeTranslator);
 
-                    // Now plug in the real packet length
-                    writeStream.Position = 1;
-                    WriteInt32(writeStream, writeStreamLength - 5);
+                        int writeStreamLength = (int)writeStream.Position;
 
-                    byte[] writeStreamBuffer = writeStream.GetBuffer();
+                        // Now plug in the real packet length
+                        writeStream.Position = packetStart + 1;
+                        WriteInt32(writeStream, writeStreamLength - packetStart - 5);
+                        writeStream.Position = writeStreamLength;
 
-                    for (int i = 0; i < writeStreamLength; i += MaxPacketWriteSize)
-                    {
-                        int lengthToWrite = Math.Min(writeStreamLength - i, MaxPacketWriteSize);
-                        _serverToClientStream.Write(writeStreamBuffer, i, lengthToWrite);
-                    }
-                    if (IsExitPacket(packet))
-                    {
-                        _exitPacketState = ExitPacketState.ExitPacketSent;
+                        exitPacketWritten |= IsExitPacket(packet);
+
+                        if (writeStreamLength >= MaxPacketWriteSize)
+                        {
+                            WriteBufferedPackets(writeStream, exitPacketWritten);
+                        }
                     }
+
+                    WriteBufferedPackets(writeStream, exitPacketWritten);
                 }
                 catch (IOException e)
                 {
@@ -872,6 +964,28 @@ namespace Microsoft.Build.BackEnd
                 }
             }
 
+            /// <summary>
+            /// Sends the packets framed in the buffer and clears it.
+            /// </summary>
+            private void WriteBufferedPackets(MemoryStream writeStream, bool exitPacketWritten)
+            {
+                int writeStreamLength = (int)writeStream.Length;
+                byte[] writeStreamBuffer = writeStream.GetBuffer();
+
+                for (int i = 0; i < writeStreamLength; i += MaxPacketWriteSize)
+                {
+                    int lengthToWrite = Math.Min(writeStreamLength - i, MaxPacketWriteSize);
+                    _serverToClientStream.Write(writeStreamBuffer, i, lengthToWrite);
+                }
+
+                writeStream.SetLength(0);
+
+                if (exitPacketWritten)
+                {
+                    _exitPacketState = ExitPacketState.ExitPacketSent;
+                }
+            }
+
             private static bool IsExitPacket(INodePacket packet)
             {
                 return packet is NodeBuildComplete buildCompletePacket && !buildCompletePacket.PrepareForReuse;
@@ -1052,7 +1166,10 @@ namespace Microsoft.Build.BackEnd
                 return true;
             }
 
-            private bool ReadAndRoutePacket(NodePacketType packetType, byte [] packetData, int packetLength)
+            /// <summary>
+            /// Deserializes and routes a packet, clearing the flags of its type.
+            /// </summary>
+            private bool ReadAndRoutePacket(ref NodePacketType packetType, byte [] packetData, int packetLength)
             {
                 try
                 {
@@ -1060,7 +1177,25 @@ namespace Microsoft.Build.BackEnd
                     // Since the buffer is publicly visible dispose right away to discourage outsiders from holding a reference to it.
                     using (var packetStream = new MemoryStream(packetData, 0, packetLength, /*writeable*/ false, /*bufferIsPubliclyVisible*/ true))
                     {
-                        ITranslator readTranslator = BinaryTranslator.GetReadTranslator(packetStream, _sharedReadBuffer);
+                        Stream readStream = packetStream;
+                        List<string> stringTable = null;
+
+                        if (((byte)packetType & CommunicationsUtilities.StringTablePacketFlag) != 0)
+                        {
+                            packetType = (NodePacketType)((byte)packetType & ~CommunicationsUtilities.StringTablePacketFlag);
+                            stringTable = _stringTable ??= new List<string>();
+                        }
+
+                        // Nodes compress large build results when asked to, see Traits.NodePacketCompressionThreshold.
+                        if (((byte)packetType & CommunicationsUtilities.CompressedPacketFlag) != 0)
+                        {
+                            packetType = (NodePacketType)((byte)packetType & ~CommunicationsUtilities.CompressedPacketFlag);
+                            readStream = DecompressPacketBody(packetStream);
+                        }
+
+                        ITranslator readTranslator = stringTable == null
+                            ? BinaryTranslator.GetReadTranslator(readStream, _sharedReadBuffer)
+                            : BinaryTranslator.GetReadTranslator(readStream, _sharedReadBuffer, stringTable);
                         _packetFactory.DeserializeAndRoutePacket(_nodeId, packetType, readTranslator);
                     }
                 }
@@ -1074,6 +1209,25 @@ namespace Microsoft.Build.BackEnd
                 return true;
             }
 
+            /// <summary>
+            /// Decompresses the body of a compressed packet into a reusable buffer.
+            /// </summary>
+            private MemoryStream DecompressPacketBody(MemoryStream packetStream)
+            {
+                _decompressedBufferMemoryStream ??= new MemoryStream();
+
+                MemoryStream decompressedStream = _decompressedBufferMemoryStream;
+                decompressedStream.SetLength(0);
+
+                using (var deflateStream = new DeflateStream(packetStream, CompressionMode.Decompress, leaveOpen: true))
+                {
+                    deflateStream.CopyTo(decompressedStream);
+                }
+
+                decompressedStream.Position = 0;
+                return decompressedStream;
+            }
+
 #if FEATURE_APM
             /// <summary>
             /// Method called when the body of a packet has been read.
@@ -1115,7 +1269,7 @@ namespace Microsoft.Build.BackEnd
                 }
 
                 // Read and route the packet.
-                if (!ReadAndRoutePacket(packetType, packetData, packetLength))
+                if (!ReadAndRoutePacket(ref packetType, packetData, packetLength))
                 {
                     return;
                 }
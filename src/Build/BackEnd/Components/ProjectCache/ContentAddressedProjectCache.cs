@@ -0,0 +1,861 @@
+﻿// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#nullable enable
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+using System.Linq;
+using System.Security.Cryptography;
+using System.Text;
+using System.Threading;
+using System.Threading.Tasks;
+using Microsoft.Build.BackEnd;
+using Microsoft.Build.Collections;
+using Microsoft.Build.Evaluation;
+using Microsoft.Build.Exceptions;
+using Microsoft.Build.Execution;
+using Microsoft.Build.FileSystem;
+using Microsoft.Build.Framework;
+using Microsoft.Build.Graph;
+using Microsoft.Build.Internal;
+using Microsoft.Build.Shared;
+using TaskItem = Microsoft.Build.Execution.ProjectItemInstance.TaskItem;
+
+namespace Microsoft.Build.Experimental.ProjectCache
+{
+    /// <summary>
+    ///     A project cache that looks up the outputs of projects in a content-addressed store, keyed by a hash of
+    ///     their evaluated inputs, and adds the outputs of the projects it misses once they have been built.
+    /// </summary>
+    /// <remarks>
+    ///     The store is a directory given by the CacheDirectory setting, which may be shared between machines that
+    ///     build from the same directory. Setting ReadOnly to true looks projects up without adding to the store.
+    ///     It can be loaded from the ProjectCachePlugin item by pointing it at Microsoft.Build.dll.
+    ///
+    ///     A project is keyed by the requested targets, its global and evaluated properties, its items and their
+    ///     metadata, the contents of its imports and of the files its items refer to, and the outputs of the
+    ///     projects it references. Properties that come from the environment are only left out when the evaluation
+    ///     recorded that it didn't read them, which it does when the evaluation cache is enabled; otherwise a change
+    ///     to any environment variable misses. Files a project reads that aren't in its evaluation, such as the
+    ///     headers read by a C++ compiler, are taken from its read tlogs once it has been built and recorded with
+    ///     the outputs, which are only used while those files are unchanged.
+    ///
+    ///     The outputs of a project are the files named by its target results, those listed in its
+    ///     FileListAbsolute.txt and those in its tlog directory, including the files its write tlogs name.
+    ///     A hit copies them back into place.
+    /// </remarks>
+    public sealed class ContentAddressedProjectCache : ProjectCachePluginBase
+    {
+        private const string CacheDirectorySetting = "CacheDirectory";
+
+        private const string ReadOnlySetting = "ReadOnly";
+
+        /// <summary>
+        ///     The version of the entries and of the keys; entries written by other versions are never found.
+        /// </summary>
+        private const int FormatVersion = 1;
+
+        private const string BinaryTlogSignature = "MSBTLOG";
+
+        private string _cacheDirectory = null!;
+
+        private bool _readOnly;
+
+        private MSBuildFileSystemBase _fileSystem = null!;
+
+        private readonly Dictionary<ProjectInstance, ProjectGraphNode> _nodesByProject = new Dictionary<ProjectInstance, ProjectGraphNode>();
+
+        private readonly Dictionary<string, ProjectGraphNode> _nodesByKey = new Dictionary<string, ProjectGraphNode>(StringComparer.OrdinalIgnoreCase);
+
+        /// <summary>
+        ///     The hashes of the evaluated inputs of projects, excluding their references.
+        /// </summary>
+        private readonly ConcurrentDictionary<ProjectInstance, string> _inputHashes = new ConcurrentDictionary<ProjectInstance, string>();
+
+        /// <summary>
+        ///     The hashes of the outputs of the projects that were looked up, set once they are restored or built,
+        ///     or to null if they weren't built successfully.
+        /// </summary>
+        private readonly ConcurrentDictionary<ProjectGraphNode, TaskCompletionSource<string?>> _outputHashes = new ConcurrentDictionary<ProjectGraphNode, TaskCompletionSource<string?>>();
+
+        /// <summary>
+        ///     The projects that were missed, to add to the store once they have been built.
+        /// </summary>
+        private readonly ConcurrentDictionary<BuildRequestData, MissedProject> _missedProjects = new ConcurrentDictionary<BuildRequestData, MissedProject>();
+
+        private readonly ConcurrentDictionary<string, FileHash> _fileHashes = new ConcurrentDictionary<string, FileHash>(StringComparer.OrdinalIgnoreCase);
+
+        private int _hits;
+
+        private int _misses;
+
+        private int _stored;
+
+        public override Task BeginBuildAsync(CacheContext context, PluginLoggerBase logger, CancellationToken cancellationToken)
+        {
+            if (!context.PluginSettings.TryGetValue(CacheDirectorySetting, out string? cacheDirectory) || string.IsNullOrWhiteSpace(cacheDirectory))
+            {
+                logger.LogError($"{nameof(ContentAddressedProjectCache)}: the {CacheDirectorySetting} setting must be set to the directory of the store.");
+                return Task.CompletedTask;
+            }
+
+            _cacheDirectory = FileUtilities.NormalizePath(EscapingUtilities.UnescapeAll(cacheDirectory));
+            _readOnly = context.PluginSettings.TryGetValue(ReadOnlySetting, out string? readOnly) &&
+                        ConversionUtilities.ConvertStringToBool(readOnly, nullOrWhitespaceIsFalse: true);
+            _fileSystem = context.FileSystem;
+
+            // The outputs of references are part of a project's key, so the plugin needs the graph. Build one if MSBuild didn't.
+            ProjectGraph? graph = context.Graph;
+            if (graph == null && context.GraphEntryPoints != null)
+            {
+                try
+                {
+                    graph = new ProjectGraph(context.GraphEntryPoints.Where(e => !FileUtilities.IsSolutionFilename(e.ProjectFile)));
+                }
+                catch (Exception e) when (e is InvalidProjectFileException || e is CircularDependencyException)
+                {
+                    logger.LogWarning($"{nameof(ContentAddressedProjectCache)}: could not build the project graph, so referenced projects won't be part of keys: {e.Message}");
+                }
+            }
+
+            if (graph != null)
+            {
+                foreach (ProjectGraphNode node in graph.ProjectNodes)
+                {
+                    _nodesByProject[node.ProjectInstance] = node;
+                    _nodesByKey[GetProjectKey(node.ProjectInstance.FullPath, node.ProjectInstance.GlobalProperties)] = node;
+                }
+            }
+
+            logger.LogMessage($"{nameof(ContentAddressedProjectCache)}: using the store in {_cacheDirectory}{(_readOnly ? " (read only)" : string.Empty)}.", MessageImportance.High);
+
+            return Task.CompletedTask;
+        }
+
+        public override async Task<CacheResult> GetCacheResultAsync(BuildRequestData buildRequest, PluginLoggerBase logger, CancellationToken cancellationToken)
+        {
+            if (FileUtilities.IsSolutionFilename(buildRequest.ProjectFullPath) || !TryGetProject(buildRequest, logger, out ProjectInstance project, out ProjectGraphNode? node))
+            {
+                return CacheResult.IndicateNonCacheHit(CacheResultType.CacheNotApplicable);
+            }
+
+            var outputHash = new TaskCompletionSource<string?>();
+            if (node != null && !_outputHashes.TryAdd(node, outputHash))
+            {
+                // Already looked up during this build, so whatever it was has been restored or built
+                return CacheResult.IndicateNonCacheHit(CacheResultType.CacheNotApplicable);
+            }
+
+            string? key = null;
+            try
+            {
+                key = await GetRequestKeyAsync(buildRequest, project, node, cancellationToken);
+
+                CacheResult? cacheResult = TryRestoreEntry(key, project, logger, out string? restoredOutputHash);
+                if (cacheResult != null)
+                {
+                    Interlocked.Increment(ref _hits);
+                    outputHash.TrySetResult(restoredOutputHash);
+                    return cacheResult;
+                }
+            }
+            catch (Exception e) when (ExceptionHandling.IsIoRelatedException(e))
+            {
+                logger.LogWarning($"{nameof(ContentAddressedProjectCache)}: could not look up {project.FullPath}: {e.Message}");
+            }
+            catch
+            {
+                // Don't leave the projects referencing this one waiting for its outputs
+                outputHash.TrySetResult(null);
+                throw;
+            }
+
+            Interlocked.Increment(ref _misses);
+            _missedProjects[buildRequest] = new MissedProject(key, project, outputHash);
+
+            return CacheResult.IndicateNonCacheHit(CacheResultType.CacheMiss);
+        }
+
+        public override Task HandleProjectFinishedAsync(BuildRequestData buildRequest, BuildResult buildResult, PluginLoggerBase logger, CancellationToken cancellationToken)
+        {
+            if (!_missedProjects.TryRemove(buildRequest, out MissedProject? missedProject))
+            {
+                return Task.CompletedTask;
+            }
+
+            string? outputHash = null;
+            try
+            {
+                if (buildResult.OverallResult == BuildResultCode.Success &&
+                    buildResult.ResultsByTarget.Values.All(r => r.ResultCode == TargetResultCode.Success || r.ResultCode == TargetResultCode.Skipped))
+                {
+                    outputHash = StoreEntry(missedProject, buildResult, logger);
+                }
+            }
+            catch (Exception e) when (ExceptionHandling.IsIoRelatedException(e))
+            {
+                logger.LogWarning($"{nameof(ContentAddressedProjectCache)}: could not add {missedProject.Project.FullPath} to the store: {e.Message}");
+            }
+            finally
+            {
+                // Projects referencing this one are keyed by its outputs, or by its inputs when there are none
+                missedProject.OutputHash.TrySetResult(outputHash);
+            }
+
+            return Task.CompletedTask;
+        }
+
+        public override Task EndBuildAsync(PluginLoggerBase logger, CancellationToken cancellationToken)
+        {
+            if (_cacheDirectory != null)
+            {
+                logger.LogMessage($"{nameof(ContentAddressedProjectCache)}: {_hits} hits, {_misses} misses, {_stored} projects added to the store.", MessageImportance.High);
+            }
+
+            return Task.CompletedTask;
+        }
+
+        private bool TryGetProject(BuildRequestData buildRequest, PluginLoggerBase logger, out ProjectInstance project, out ProjectGraphNode? node)
+        {
+            if (buildRequest.ProjectInstance != null && _nodesByProject.TryGetValue(buildRequest.ProjectInstance, out node))
+            {
+                project = node.ProjectInstance;
+                return true;
+            }
+
+            var globalProperties = buildRequest.GlobalProperties.ToDictionary(p => p.Name, p => p.EvaluatedValue, StringComparer.OrdinalIgnoreCase);
+            if (_nodesByKey.TryGetValue(GetProjectKey(buildRequest.ProjectFullPath, globalProperties), out node))
+            {
+                project = node.ProjectInstance;
+                return true;
+            }
+
+            node = null;
+            try
+            {
+                project = buildRequest.ProjectInstance ?? new ProjectInstance(buildRequest.ProjectFullPath, globalProperties, buildRequest.ExplicitlySpecifiedToolsVersion);
+                return true;
+            }
+            catch (InvalidProjectFileException e)
+            {
+                // Let MSBuild build it and report the error
+                logger.LogMessage($"{nameof(ContentAddressedProjectCache)}: could not evaluate {buildRequest.ProjectFullPath}: {e.Message}");
+                project = null!;
+                return false;
+            }
+        }
+
+        private static string GetProjectKey(string projectFullPath, IDictionary<string, string> globalProperties)
+        {
+            var builder = new StringBuilder(FileUtilities.NormalizePath(projectFullPath));
+            foreach (KeyValuePair<string, string> property in globalProperties.OrderBy(p => p.Key, StringComparer.OrdinalIgnoreCase))
+            {
+                builder.Append('|').Append(property.Key).Append('=').Append(property.Value);
+            }
+
+            return builder.ToString();
+        }
+
+        private async Task<string> GetRequestKeyAsync(BuildRequestData buildRequest, ProjectInstance project, ProjectGraphNode? node, CancellationToken cancellationToken)
+        {
+            using var hash = new KeyHash();
+            hash.Append(FormatVersion.ToString(CultureInfo.InvariantCulture));
+            hash.Append(node != null ? await GetNodeHashAsync(node, cancellationToken) : GetInputHash(project));
+
+            // The results of a project depend on the targets that are built
+            IEnumerable<string> targets = buildRequest.TargetNames.Count > 0 ? buildRequest.TargetNames : project.DefaultTargets;
+            foreach (string target in targets)
+            {
+                hash.Append(target.ToUpperInvariant());
+            }
+
+            return hash.Finish();
+        }
+
+        /// <summary>
+        ///     Hashes the inputs of a project together with the outputs of the projects it references.
+        /// </summary>
+        private async Task<string> GetNodeHashAsync(ProjectGraphNode node, CancellationToken cancellationToken)
+        {
+            using var hash = new KeyHash();
+            hash.Append(GetInputHash(node.ProjectInstance));
+
+            foreach (ProjectGraphNode reference in node.ProjectReferences.OrderBy(r => r.ProjectInstance.FullPath, StringComparer.OrdinalIgnoreCase))
+            {
+                string? outputHash = null;
+                if (_outputHashes.TryGetValue(reference, out TaskCompletionSource<string?>? referenceOutputHash))
+                {
+                    // References are built before the projects referencing them are looked up, but the outputs they
+                    // were built with may still be being added to the store
+                    Task completed = await Task.WhenAny(referenceOutputHash.Task, Task.Delay(Timeout.Infinite, cancellationToken));
+                    if (completed != referenceOutputHash.Task)
+                    {
+                        cancellationToken.ThrowIfCancellationRequested();
+                    }
+
+                    outputHash = referenceOutputHash.Task.Result;
+                }
+
+                hash.Append(outputHash != null ? "outputs:" + outputHash : "inputs:" + await GetNodeHashAsync(reference, cancellationToken));
+            }
+
+            return hash.Finish();
+        }
+
+        /// <summary>
+        ///     Hashes the evaluated state of a project and the contents of the files it refers to.
+        /// </summary>
+        private string GetInputHash(ProjectInstance project)
+        {
+            return _inputHashes.GetOrAdd(project, p =>
+            {
+                using var hash = new KeyHash();
+                hash.Append(p.FullPath);
+                hash.Append(GetFileHash(p.FullPath) ?? string.Empty);
+
+                foreach (string import in p.ImportPaths)
+                {
+                    hash.Append(import);
+                    hash.Append(GetFileHash(import) ?? string.Empty);
+                }
+
+                foreach (KeyValuePair<string, string> property in p.GlobalProperties.OrderBy(gp => gp.Key, StringComparer.OrdinalIgnoreCase))
+                {
+                    hash.Append(property.Key);
+                    hash.Append(property.Value);
+                }
+
+                // Properties from the environment hold machine specific values, like PATH, which can be left out if the
+                // evaluation didn't read them. Those it did read, like Configuration, may change what is built.
+                PropertyDictionary<ProjectPropertyInstance> environmentProperties =
+                    ((IEvaluatorData<ProjectPropertyInstance, ProjectItemInstance, ProjectMetadataInstance, ProjectItemDefinitionInstance>)p).EnvironmentVariablePropertiesDictionary;
+                IReadOnlyCollection<string>? environmentVariablesRead = p.EnvironmentVariablesRead;
+
+                foreach (ProjectPropertyInstance property in p.Properties.OrderBy(pp => pp.Name, StringComparer.OrdinalIgnoreCase))
+                {
+                    if (ReservedPropertyNames.IsReservedProperty(property.Name) ||
+                        (environmentVariablesRead != null &&
+                         !environmentVariablesRead.Contains(property.Name) &&
+                         environmentProperties[property.Name]?.EvaluatedValue == property.EvaluatedValue))
+                    {
+                        continue;
+                    }
+
+                    hash.Append(property.Name);
+                    hash.Append(property.EvaluatedValue);
+                }
+
+                foreach (ProjectItemInstance item in p.Items)
+                {
+                    hash.Append(item.ItemType);
+                    hash.Append(item.EvaluatedInclude);
+
+                    foreach (ProjectMetadataInstance metadata in item.Metadata.OrderBy(m => m.Name, StringComparer.OrdinalIgnoreCase))
+                    {
+                        hash.Append(metadata.Name);
+                        hash.Append(metadata.EvaluatedValue);
+                    }
+
+                    if (FileUtilities.IsSolutionFilename(item.EvaluatedInclude) || item.EvaluatedInclude.IndexOfAny(FileUtilities.InvalidPathChars) >= 0)
+                    {
+                        continue;
+                    }
+
+                    string? fileHash = GetFileHash(FileUtilities.NormalizePath(p.Directory, item.EvaluatedInclude));
+                    if (fileHash != null)
+                    {
+                        hash.Append(fileHash);
+                    }
+                }
+
+                return hash.Finish();
+            });
+        }
+
+        /// <summary>
+        ///     Finds an entry for the key whose tracked inputs are unchanged and copies its outputs into place.
+        /// </summary>
+        private CacheResult? TryRestoreEntry(string key, ProjectInstance project, PluginLoggerBase logger, out string? outputHash)
+        {
+            outputHash = null;
+
+            string entriesDirectory = GetEntriesDirectory(key);
+            if (!_fileSystem.DirectoryExists(entriesDirectory))
+            {
+                return null;
+            }
+
+            foreach (string entryPath in _fileSystem.EnumerateFiles(entriesDirectory, "*.entry"))
+            {
+                Entry? entry = Entry.Read(entryPath);
+                if (entry == null ||
+                    !entry.TrackedInputs.All(input => GetFileHash(input.Path) == input.Hash) ||
+                    !entry.Outputs.All(output => _fileSystem.FileExists(GetBlobPath(output.Hash))))
+                {
+                    continue;
+                }
+
+                foreach (FileEntry output in entry.Outputs)
+                {
+                    if (GetFileHash(output.Path) != output.Hash)
+                    {
+                        Directory.CreateDirectory(Path.GetDirectoryName(output.Path)!);
+                        File.Copy(GetBlobPath(output.Hash), output.Path, overwrite: true);
+                    }
+                }
+
+                logger.LogMessage($"{nameof(ContentAddressedProjectCache)}: restored {entry.Outputs.Count} outputs of {project.FullPath}.");
+
+                outputHash = HashFiles(entry.Outputs);
+                return CacheResult.IndicateCacheHit(entry.CreateBuildResult());
+            }
+
+            return null;
+        }
+
+        /// <summary>
+        ///     Adds the outputs of a project that was built to the store.
+        /// </summary>
+        /// <returns>The hash of the outputs</returns>
+        private string? StoreEntry(MissedProject missedProject, BuildResult buildResult, PluginLoggerBase logger)
+        {
+            ProjectInstance project = missedProject.Project;
+
+            var outputPaths = new HashSet<string>(StringComparer.OrdinalIgnoreCase);
+            foreach (TargetResult targetResult in buildResult.ResultsByTarget.Values)
+            {
+                foreach (ITaskItem item in targetResult.Items)
+                {
+                    AddOutput(item.ItemSpec);
+                }
+            }
+
+            string fileList = Path.Combine(project.GetPropertyValue("IntermediateOutputPath"), project.GetPropertyValue("CleanFile"));
+            if (project.GetPropertyValue("CleanFile").Length > 0)
+            {
+                foreach (string line in ReadLinesIfExists(FileUtilities.NormalizePath(project.Directory, fileList)))
+                {
+                    AddOutput(line);
+                }
+            }
+
+            var trackedInputPaths = new HashSet<string>(StringComparer.OrdinalIgnoreCase);
+            string tlogDirectory = project.GetPropertyValue("TLogLocation");
+            if (tlogDirectory.Length > 0)
+            {
+                tlogDirectory = FileUtilities.NormalizePath(project.Directory, tlogDirectory);
+                if (_fileSystem.DirectoryExists(tlogDirectory))
+                {
+                    foreach (string tlog in _fileSystem.EnumerateFiles(tlogDirectory, "*.tlog"))
+                    {
+                        AddOutput(tlog);
+
+                        bool isReadTlog = Path.GetFileName(tlog).IndexOf(".read.", StringComparison.OrdinalIgnoreCase) >= 0;
+                        bool isWriteTlog = Path.GetFileName(tlog).IndexOf(".write.", StringComparison.OrdinalIgnoreCase) >= 0;
+                        if (!isReadTlog && !isWriteTlog)
+                        {
+                            continue;
+                        }
+
+                        List<string>? tlogPaths = ReadTlog(tlog, includeRoots: isReadTlog);
+                        if (tlogPaths == null)
+                        {
+                            logger.LogMessage($"{nameof(ContentAddressedProjectCache)}: not adding {project.FullPath} to the store because {tlog} is a binary tlog.");
+                            return null;
+                        }
+
+                        foreach (string path in tlogPaths)
+                        {
+                            if (isWriteTlog)
+                            {
+                                AddOutput(path);
+                            }
+                            else
+                            {
+                                trackedInputPaths.Add(path);
+                            }
+                        }
+                    }
+                }
+            }
+
+            var outputs = new List<FileEntry>();
+            foreach (string path in outputPaths)
+            {
+                if (!_fileSystem.FileExists(path))
+                {
+                    continue;
+                }
+
+                // Hash what was built rather than what was seen before
+                _fileHashes.TryRemove(path, out _);
+                string hash = GetFileHash(path)!;
+                outputs.Add(new FileEntry(path, hash));
+
+                if (!_readOnly)
+                {
+                    StoreBlob(path, hash);
+                }
+            }
+
+            string outputHash = HashFiles(outputs);
+            if (_readOnly || missedProject.Key == null)
+            {
+                return outputHash;
+            }
+
+            // Files the project writes and then reads, like precompiled headers, are restored with the outputs
+            var trackedInputs = new List<FileEntry>();
+            foreach (string path in trackedInputPaths)
+            {
+                if (!outputPaths.Contains(path))
+                {
+                    string? hash = GetFileHash(path);
+                    if (hash != null)
+                    {
+                        trackedInputs.Add(new FileEntry(path, hash));
+                    }
+                }
+            }
+
+            var entry = new Entry(trackedInputs, outputs, buildResult.ResultsByTarget);
+            string entryPath = Path.Combine(GetEntriesDirectory(missedProject.Key), HashFiles(trackedInputs) + ".entry");
+            WriteAtomically(entryPath, entry.Write);
+
+            Interlocked.Increment(ref _stored);
+            logger.LogMessage($"{nameof(ContentAddressedProjectCache)}: added {outputs.Count} outputs of {project.FullPath} to the store.");
+
+            return outputHash;
+
+            void AddOutput(string path)
+            {
+                if (path.Length == 0 || path.IndexOfAny(FileUtilities.InvalidPathChars) >= 0)
+                {
+                    return;
+                }
+
+                path = FileUtilities.NormalizePath(project.Directory, path);
+                if (!path.StartsWith(_cacheDirectory, StringComparison.OrdinalIgnoreCase))
+                {
+                    outputPaths.Add(path);
+                }
+            }
+        }
+
+        /// <summary>
+        ///     Reads the paths from a text tlog, or returns null for a binary one.
+        /// </summary>
+        /// <param name="tlog">The tlog to read</param>
+        /// <param name="includeRoots">Whether to include the sources named by the rooting markers</param>
+        private List<string>? ReadTlog(string tlog, bool includeRoots)
+        {
+            var paths = new List<string>();
+
+            using (var reader = new StreamReader(_fileSystem.GetFileStream(tlog, FileMode.Open, FileAccess.Read, FileShare.Read), detectEncodingFromByteOrderMarks: true))
+            {
+                string? line;
+                bool firstLine = true;
+                while ((line = reader.ReadLine()) != null)
+                {
+                    if (firstLine && line.StartsWith(BinaryTlogSignature, StringComparison.Ordinal))
+                    {
+                        return null;
+                    }
+
+                    firstLine = false;
+                    if (line.Length == 0 || line[0] == '#')
+                    {
+                        continue;
+                    }
+
+                    // Rooting markers name the sources, possibly several joined by '|'
+                    if (line[0] == '^')
+                    {
+                        if (includeRoots)
+                        {
+                            paths.AddRange(line.Substring(1).Split(MSBuildConstants.PipeChar, StringSplitOptions.RemoveEmptyEntries));
+                        }
+                    }
+                    else
+                    {
+                        paths.Add(line);
+                    }
+                }
+            }
+
+            return paths;
+        }
+
+        private IEnumerable<string> ReadLinesIfExists(string path)
+        {
+            if (!_fileSystem.FileExists(path))
+            {
+                return Array.Empty<string>();
+            }
+
+            var lines = new List<string>();
+            using (TextReader reader = _fileSystem.ReadFile(path))
+            {
+                string? line;
+                while ((line = reader.ReadLine()) != null)
+                {
+                    lines.Add(line.Trim());
+                }
+            }
+
+            return lines;
+        }
+
+        private string GetEntriesDirectory(string key) => Path.Combine(_cacheDirectory, "entries", key.Substring(0, 2), key);
+
+        private string GetBlobPath(string hash) => Path.Combine(_cacheDirectory, "blobs", hash.Substring(0, 2), hash);
+
+        private void StoreBlob(string path, string hash)
+        {
+            string blobPath = GetBlobPath(hash);
+            if (!_fileSystem.FileExists(blobPath))
+            {
+                WriteAtomically(blobPath, stream =>
+                {
+                    using Stream source = _fileSystem.GetFileStream(path, FileMode.Open, FileAccess.Read, FileShare.Read);
+                    source.CopyTo(stream);
+                });
+            }
+        }
+
+        /// <summary>
+        ///     Writes a file of the store so that readers, possibly on other machines, never see it partially written.
+        /// </summary>
+        private static void WriteAtomically(string path, Action<Stream> write)
+        {
+            Directory.CreateDirectory(Path.GetDirectoryName(path)!);
+
+            string temporaryPath = path + "." + Guid.NewGuid().ToString("N") + ".tmp";
+            try
+            {
+                using (var stream = new FileStream(temporaryPath, FileMode.CreateNew, FileAccess.Write))
+                {
+                    write(stream);
+                }
+
+                File.Move(temporaryPath, path);
+            }
+            catch (IOException) when (File.Exists(path))
+            {
+                // Written by someone else in the meantime. Blobs are named by the hash of their contents and entries by the
+                // hash of their tracked inputs, so the file that is there stands for the same outputs.
+            }
+            finally
+            {
+                if (File.Exists(temporaryPath))
+                {
+                    File.Delete(temporaryPath);
+                }
+            }
+        }
+
+        /// <summary>
+        ///     Gets the hash of the contents of a file, or null if it doesn't exist. Hashes are reused for
+        ///     as long as the size and timestamp of the file don't change.
+        /// </summary>
+        private string? GetFileHash(string path)
+        {
+            if (!_fileSystem.FileExists(path))
+            {
+                return null;
+            }
+
+            DateTime lastWriteTimeUtc = _fileSystem.GetLastWriteTimeUtc(path);
+            using Stream stream = _fileSystem.GetFileStream(path, FileMode.Open, FileAccess.Read, FileShare.Read | FileShare.Delete);
+
+            if (_fileHashes.TryGetValue(path, out FileHash? fileHash) &&
+                fileHash.LastWriteTimeUtc == lastWriteTimeUtc &&
+                fileHash.Length == stream.Length)
+            {
+                return fileHash.Hash;
+            }
+
+            string hash;
+            using (var sha = SHA256.Create())
+            {
+                hash = ToHex(sha.ComputeHash(stream));
+            }
+
+            _fileHashes[path] = new FileHash(lastWriteTimeUtc, stream.Length, hash);
+            return hash;
+        }
+
+        private static string HashFiles(IEnumerable<FileEntry> files)
+        {
+            using var hash = new KeyHash();
+            foreach (FileEntry file in files.OrderBy(f => f.Path, StringComparer.OrdinalIgnoreCase))
+            {
+                hash.Append(file.Path.ToUpperInvariant());
+                hash.Append(file.Hash);
+            }
+
+            return hash.Finish();
+        }
+
+        private static string ToHex(byte[] bytes)
+        {
+            var builder = new StringBuilder(bytes.Length * 2);
+            foreach (byte b in bytes)
+            {
+                builder.Append(b.ToString("x2", CultureInfo.InvariantCulture));
+            }
+
+            return builder.ToString();
+        }
+
+        private sealed record FileHash(DateTime LastWriteTimeUtc, long Length, string Hash);
+
+        private sealed record FileEntry(string Path, string Hash);
+
+        private sealed record MissedProject(string? Key, ProjectInstance Project, TaskCompletionSource<string?> OutputHash);
+
+        /// <summary>
+        ///     A SHA256 hash of a sequence of strings.
+        /// </summary>
+        private sealed class KeyHash : IDisposable
+        {
+            private readonly IncrementalHash _hash = IncrementalHash.CreateHash(HashAlgorithmName.SHA256);
+
+            public void Append(string value)
+            {
+                byte[] bytes = Encoding.UTF8.GetBytes(value);
+                _hash.AppendData(BitConverter.GetBytes(bytes.Length));
+                _hash.AppendData(bytes);
+            }
+
+            public string Finish() => ToHex(_hash.GetHashAndReset());
+
+            public void Dispose() => _hash.Dispose();
+        }
+
+        /// <summary>
+        ///     The outputs of a build of a project with a given key, and the files outside of its evaluation that it read.
+        /// </summary>
+        private sealed class Entry
+        {
+            public Entry(IReadOnlyList<FileEntry> trackedInputs, IReadOnlyList<FileEntry> outputs, IDictionary<string, TargetResult> targetResults)
+            {
+                TrackedInputs = trackedInputs;
+                Outputs = outputs;
+                TargetResults = targetResults;
+            }
+
+            public IReadOnlyList<FileEntry> TrackedInputs { get; }
+
+            public IReadOnlyList<FileEntry> Outputs { get; }
+
+            public IDictionary<string, TargetResult> TargetResults { get; }
+
+            public BuildResult CreateBuildResult()
+            {
+                var buildResult = new BuildResult();
+                foreach (KeyValuePair<string, TargetResult> targetResult in TargetResults)
+                {
+                    buildResult.AddResultsForTarget(targetResult.Key, targetResult.Value);
+                }
+
+                return buildResult;
+            }
+
+            public static Entry? Read(string path)
+            {
+                using var reader = new BinaryReader(File.OpenRead(path), Encoding.UTF8);
+                if (reader.ReadInt32() != FormatVersion)
+                {
+                    return null;
+                }
+
+                List<FileEntry> trackedInputs = ReadFiles(reader);
+                List<FileEntry> outputs = ReadFiles(reader);
+
+                var targetResults = new Dictionary<string, TargetResult>(StringComparer.OrdinalIgnoreCase);
+                int targetCount = reader.ReadInt32();
+                for (int i = 0; i < targetCount; i++)
+                {
+                    string targetName = reader.ReadString();
+                    bool skipped = reader.ReadBoolean();
+
+                    var items = new TaskItem[reader.ReadInt32()];
+                    for (int j = 0; j < items.Length; j++)
+                    {
+                        items[j] = new TaskItem(reader.ReadString(), definingFileEscaped: null);
+
+                        int metadataCount = reader.ReadInt32();
+                        for (int k = 0; k < metadataCount; k++)
+                        {
+                            items[j].SetMetadata(reader.ReadString(), reader.ReadString());
+                        }
+                    }
+
+                    targetResults[targetName] = new TargetResult(
+                        items,
+                        skipped
+                            ? new WorkUnitResult(WorkUnitResultCode.Skipped, WorkUnitActionCode.Continue, null)
+                            : new WorkUnitResult(WorkUnitResultCode.Success, WorkUnitActionCode.Continue, null));
+                }
+
+                return new Entry(trackedInputs, outputs, targetResults);
+            }
+
+            public void Write(Stream stream)
+            {
+                using var writer = new BinaryWriter(stream, Encoding.UTF8);
+                writer.Write(FormatVersion);
+                WriteFiles(writer, TrackedInputs);
+                WriteFiles(writer, Outputs);
+
+                writer.Write(TargetResults.Count);
+                foreach (KeyValuePair<string, TargetResult> targetResult in TargetResults)
+                {
+                    writer.Write(targetResult.Key);
+                    writer.Write(targetResult.Value.ResultCode == TargetResultCode.Skipped);
+
+                    ITaskItem[] items = targetResult.Value.Items;
+                    writer.Write(items.Length);
+                    foreach (ITaskItem2 item in items)
+                    {
+                        writer.Write(item.EvaluatedIncludeEscaped);
+
+                        var metadata = item.CloneCustomMetadataEscaped();
+                        writer.Write(metadata.Count);
+                        foreach (System.Collections.DictionaryEntry pair in metadata)
+                        {
+                            writer.Write((string)pair.Key);
+                            writer.Write((string)pair.Value!);
+                        }
+                    }
+                }
+            }
+
+            private static List<FileEntry> ReadFiles(BinaryReader reader)
+            {
+                var files = new List<FileEntry>();
+                int count = reader.ReadInt32();
+                for (int i = 0; i < count; i++)
+                {
+                    files.Add(new FileEntry(reader.ReadString(), reader.ReadString()));
+                }
+
+                return files;
+            }
+
+            private static void WriteFiles(BinaryWriter writer, IReadOnlyList<FileEntry> files)
+            {
+                writer.Write(files.Count);
+                foreach (FileEntry file in files)
+                {
+                    writer.Write(file.Path);
+                    writer.Write(file.Hash);
+                }
+            }
+        }
+    }
+}
@@ -35,6 +35,20 @@ namespace Microsoft.Build.Experimental.ProjectCache
             PluginLoggerBase logger,
             CancellationToken cancellationToken);
 
+        /// <summary>
+        ///     Called once for each build request the plugin didn't return a cache hit for, after MSBuild built it,
+        ///     to let the plugin record its results. Called before <see cref="EndBuildAsync" />.
+        ///     Errors are checked via <see cref="PluginLoggerBase.HasLoggedErrors" />.
+        /// </summary>
+        public virtual Task HandleProjectFinishedAsync(
+            BuildRequestData buildRequest,
+            BuildResult buildResult,
+            PluginLoggerBase logger,
+            CancellationToken cancellationToken)
+        {
+            return Task.CompletedTask;
+        }
+
         /// <summary>
         ///     Called once after all the build to let the plugin do any post build operations (log metrics, cleanup, etc).
         ///     Errors are checked via <see cref="PluginLoggerBase.HasLoggedErrors" />.
@@ -3,9 +3,11 @@
 
 #nullable enable
 using System;
+using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.Linq;
 using System.Reflection;
+using System.Runtime.ExceptionServices;
 using System.Threading;
 using System.Threading.Tasks;
 using Microsoft.Build.BackEnd;
@@ -35,6 +37,16 @@ namespace Microsoft.Build.Experimental.ProjectCache
         private readonly CancellationToken _cancellationToken;
         private readonly ProjectCachePluginBase _projectCachePlugin;
 
+        /// <summary>
+        /// The requests the plugin didn't return a cache hit for, by submission id, to tell it about once they are built.
+        /// </summary>
+        private readonly ConcurrentDictionary<int, BuildRequestData> _requestsToBuild = new ConcurrentDictionary<int, BuildRequestData>();
+
+        /// <summary>
+        /// The calls to <see cref="ProjectCachePluginBase.HandleProjectFinishedAsync"/>, awaited before the plugin is shut down.
+        /// </summary>
+        private readonly List<Task> _projectFinishedTasks = new List<Task>();
+
         /// <summary>
         /// An instanatiable version of MSBuildFileSystemBase not overriding any methods,
         /// i.e. falling back to FileSystem.Default.
@@ -165,6 +177,13 @@ namespace Microsoft.Build.Experimental.ProjectCache
 
             Assembly LoadAssembly(string resolverPath)
             {
+                // The plugins that ship with MSBuild must come from the loaded engine for their base type to match.
+                Assembly engineAssembly = typeof(ProjectCachePluginBase).Assembly;
+                if (string.Equals(FileUtilities.NormalizePath(resolverPath), engineAssembly.Location, StringComparison.OrdinalIgnoreCase))
+                {
+                    return engineAssembly;
+                }
+
 #if !FEATURE_ASSEMBLYLOADCONTEXT
                 return Assembly.LoadFrom(resolverPath);
 #else
@@ -196,6 +215,12 @@ namespace Microsoft.Build.Experimental.ProjectCache
                 try
                 {
                     var cacheResult = await ProcessCacheRequest(cacheRequest);
+
+                    if (cacheResult.ResultType != CacheResultType.CacheHit)
+                    {
+                        _requestsToBuild[cacheRequest.Submission.SubmissionId] = cacheRequest.Submission.BuildRequestData;
+                    }
+
                     _buildManager.PostCacheResult(cacheRequest, cacheResult);
                 }
                 catch (Exception e)
@@ -355,8 +380,60 @@ namespace Microsoft.Build.Experimental.ProjectCache
             return cacheResult;
         }
 
+        /// <summary>
+        /// Tells the plugin about the result of a request it didn't return a cache hit for.
+        /// </summary>
+        public void PostProjectFinished(BuildResult buildResult)
+        {
+            if (!_requestsToBuild.TryRemove(buildResult.SubmissionId, out BuildRequestData? buildRequest))
+            {
+                return;
+            }
+
+            var task = Task.Run(async () =>
+            {
+                var logger = _loggerFactory();
+
+                try
+                {
+                    await _projectCachePlugin.HandleProjectFinishedAsync(buildRequest, buildResult, logger, _cancellationToken);
+                }
+                catch (Exception e)
+                {
+                    HandlePluginException(e, nameof(ProjectCachePluginBase.HandleProjectFinishedAsync));
+                }
+
+                if (logger.HasLoggedErrors)
+                {
+                    ProjectCacheException.ThrowForErrorLoggedInsideTheProjectCache("ProjectCacheHandleProjectFinishedFailed", buildRequest.ProjectFullPath);
+                }
+            });
+
+            lock (_projectFinishedTasks)
+            {
+                _projectFinishedTasks.Add(task);
+            }
+        }
+
         public async Task ShutDown()
         {
+            Task[] projectFinishedTasks;
+            lock (_projectFinishedTasks)
+            {
+                projectFinishedTasks = _projectFinishedTasks.ToArray();
+            }
+
+            Task allProjectsFinished = Task.WhenAll(projectFinishedTasks);
+            try
+            {
+                await allProjectsFinished;
+            }
+            catch
+            {
+                // The plugin still ends the build if it failed to handle a finished project, and the
+                // failure is reported afterwards
+            }
+
             var logger = _loggerFactory();
 
             try
@@ -372,6 +449,11 @@ namespace Microsoft.Build.Experimental.ProjectCache
             {
                 ProjectCacheException.ThrowForErrorLoggedInsideTheProjectCache("ProjectCacheShutdownFailed");
             }
+
+            if (allProjectsFinished.IsFaulted)
+            {
+                ExceptionDispatchInfo.Capture(allProjectsFinished.Exception!.InnerException!).Throw();
+            }
         }
 
         private static void HandlePluginException(Exception e, string apiExceptionWasThrownFrom)
@@ -2,6 +2,7 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 using System;
+using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.IO;
 using System.Linq;
@@ -52,6 +53,14 @@ namespace Microsoft.Build.BackEnd
         /// Creates an instance of this class for the given target.
         /// </summary>
         internal TargetUpToDateChecker(ProjectInstance project, ProjectTargetInstance targetToAnalyze, ILoggingService loggingServices, BuildEventContext buildEventContext)
+            : this(project, targetToAnalyze, loggingServices, buildEventContext, null)
+        {
+        }
+
+        /// <summary>
+        /// Creates an instance of this class for the given target, which shares file timestamps with the rest of the build.
+        /// </summary>
+        internal TargetUpToDateChecker(ProjectInstance project, ProjectTargetInstance targetToAnalyze, ILoggingService loggingServices, BuildEventContext buildEventContext, ConcurrentDictionary<string, DateTime> sharedFileTimestamps)
         {
             ErrorUtilities.VerifyThrow(project != null, "Need a project.");
             ErrorUtilities.VerifyThrow(targetToAnalyze != null, "Need a target to analyze.");
@@ -62,6 +71,7 @@ namespace Microsoft.Build.BackEnd
             _targetOutputSpecification = targetToAnalyze.Outputs;
             _loggingService = loggingServices;
             _buildEventContext = buildEventContext;
+            _sharedFileTimestamps = sharedFileTimestamps;
         }
 
         #endregion
@@ -1180,10 +1190,10 @@ namespace Microsoft.Build.BackEnd
                 "Need to specify paths to compare.");
 
             path1 = Path.Combine(_project.Directory, path1);
-            var path1WriteTime = NativeMethodsShared.GetLastWriteFileUtcTime(path1);
+            var path1WriteTime = SharedFileTimestampCache.GetLastWriteFileUtcTime(path1, _sharedFileTimestamps);
 
             path2 = Path.Combine(_project.Directory, path2);
-            var path2WriteTime = NativeMethodsShared.GetLastWriteFileUtcTime(path2);
+            var path2WriteTime = SharedFileTimestampCache.GetLastWriteFileUtcTime(path2, _sharedFileTimestamps);
 
             path1DoesNotExist = (path1WriteTime == DateTime.MinValue);
             path2DoesNotExist = (path2WriteTime == DateTime.MinValue);
@@ -1231,6 +1241,9 @@ namespace Microsoft.Build.BackEnd
         // Event context information where event is raised from
         private BuildEventContext _buildEventContext;
 
+        // File timestamps shared with the rest of the build, if any
+        private ConcurrentDictionary<string, DateTime> _sharedFileTimestamps;
+
         /// <summary>
         /// By default we do not sort target inputs and outputs as it has significant perf impact.
         /// But allow suites to enable this so they get consistent results.
@@ -70,6 +70,11 @@ namespace Microsoft.Build.BackEnd
         /// </summary>
         void WriteDetailedSummary(int submissionId);
 
+        /// <summary>
+        /// Writes the timings of the build to the scheduling history, if one is being kept.
+        /// </summary>
+        void WriteSchedulingHistory();
+
         /// <summary>
         /// Requests CPU resources.
         /// </summary>
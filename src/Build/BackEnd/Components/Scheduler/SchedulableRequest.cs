@@ -295,6 +295,12 @@ namespace Microsoft.Build.BackEnd
         /// </summary>
         public int GrantedCores { get; set; }
 
+        /// <summary>
+        /// The node which this request's configuration was taken from when an idle node stole the request, or
+        /// Scheduler.InvalidNodeId if the request was not stolen.
+        /// </summary>
+        public int StolenFromNode { get; set; } = Scheduler.InvalidNodeId;
+
         /// <summary>
         /// Gets the amount of time we spent in the specified state.
         /// </summary>
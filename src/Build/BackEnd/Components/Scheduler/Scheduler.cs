@@ -138,6 +138,21 @@ namespace Microsoft.Build.BackEnd
         /// </summary>
         private bool _debugDumpState;
 
+        /// <summary>
+        /// Flag indicating that idle nodes may take requests for configurations assigned to busy nodes, set by MSBUILDSCHEDULERWORKSTEALING.
+        /// </summary>
+        private bool _workStealingEnabled;
+
+        /// <summary>
+        /// The number of requests idle nodes have taken from busy nodes in this build.
+        /// </summary>
+        private int _stolenRequestsCount;
+
+        /// <summary>
+        /// The number of requests idle nodes have taken from busy nodes in this build.
+        /// </summary>
+        internal int StolenRequestsCount => _stolenRequestsCount;
+
         /// <summary>
         /// Flag used for debugging by forcing all scheduling to go out-of-proc.
         /// </summary>
@@ -162,6 +177,16 @@ namespace Microsoft.Build.BackEnd
         /// </summary>
         private SchedulingPlan _schedulingPlan;
 
+        /// <summary>
+        /// If MSBUILDSCHEDULINGHISTORYFILE is set, the file in which project timings are kept from one build to the next.
+        /// </summary>
+        private string _schedulingHistoryPath;
+
+        /// <summary>
+        /// The project timings from previous builds, and those of this build so far.
+        /// </summary>
+        private SchedulingHistory _schedulingHistory;
+
         /// <summary>
         /// If MSBUILDCUSTOMSCHEDULER is set, contains the requested scheduling algorithm
         /// </summary>
@@ -177,8 +202,10 @@ namespace Microsoft.Build.BackEnd
         public Scheduler()
         {
             _debugDumpState = Environment.GetEnvironmentVariable("MSBUILDDEBUGSCHEDULER") == "1";
+            _workStealingEnabled = Environment.GetEnvironmentVariable("MSBUILDSCHEDULERWORKSTEALING") == "1";
             _debugDumpPath = Environment.GetEnvironmentVariable("MSBUILDDEBUGPATH");
             _schedulingUnlimitedVariable = Environment.GetEnvironmentVariable("MSBUILDSCHEDULINGUNLIMITED");
+            _schedulingHistoryPath = Environment.GetEnvironmentVariable("MSBUILDSCHEDULINGHISTORYFILE");
             _nodeLimitOffset = 0;
 
             if (!String.IsNullOrEmpty(_schedulingUnlimitedVariable))
@@ -377,6 +404,7 @@ namespace Microsoft.Build.BackEnd
                 // Tell the request to which this result belongs than it is done.
                 SchedulableRequest request = _schedulingData.GetExecutingRequest(result.GlobalRequestId);
                 request.Complete(result);
+                RecordCompletedRequestInSchedulingHistory(request);
 
                 // Report results to our parent, or report submission complete as necessary.            
                 if (request.Parent != null)
@@ -453,6 +481,7 @@ namespace Microsoft.Build.BackEnd
 
                         // Mark the request as complete (and the parent is no longer blocked by this request.)
                         unscheduledRequest.Complete(newResult);
+                        RecordCompletedRequestInSchedulingHistory(unscheduledRequest);
                     }
                 }
             }
@@ -522,6 +551,7 @@ namespace Microsoft.Build.BackEnd
             DumpConfigurations();
             DumpRequests();
             _schedulingPlan = null;
+            _schedulingHistory = null;
             _schedulingData = new SchedulingData();
             _availableNodes = new Dictionary<int, NodeInfo>(8);
             _pendingRequestCoresCallbacks = new Queue<TaskCompletionSource<int>>();
@@ -529,6 +559,7 @@ namespace Microsoft.Build.BackEnd
             _currentOutOfProcNodeCount = 0;
 
             _nextGlobalRequestId = 0;
+            _stolenRequestsCount = 0;
             _customRequestSchedulingAlgorithm = null;
         }
 
@@ -554,6 +585,14 @@ namespace Microsoft.Build.BackEnd
             WriteNodeUtilizationGraph(loggingService, context, false /* useConfigurations */);
         }
 
+        /// <summary>
+        /// Writes the timings of the build to the scheduling history, if one is being kept.
+        /// </summary>
+        public void WriteSchedulingHistory()
+        {
+            _schedulingHistory?.Write(_componentHost.LoggingService, BuildEventContext.Invalid);
+        }
+
         /// <summary>
         /// Requests CPU resources.
         /// </summary>
@@ -808,7 +847,11 @@ namespace Microsoft.Build.BackEnd
                         return;
                     }
 
-                    if (haveValidPlan)
+                    if (_schedulingHistory?.HasHistory == true)
+                    {
+                        AssignUnscheduledRequestsByCriticalPath(responses, idleNodes);
+                    }
+                    else if (haveValidPlan)
                     {
                         if (_componentHost.BuildParameters.MaxNodeCount == 2)
                         {
@@ -824,6 +867,11 @@ namespace Microsoft.Build.BackEnd
                         AssignUnscheduledRequestsWithConfigurationCountLevelling(responses, idleNodes);
                     }
                 }
+
+                if (_workStealingEnabled)
+                {
+                    AssignUnscheduledRequestsByStealingFromBusyNodes(responses, idleNodes);
+                }
             }
         }
 
@@ -960,6 +1008,112 @@ namespace Microsoft.Build.BackEnd
             }
         }
 
+        /// <summary>
+        /// Assigns requests to nodes based on those which lie on the longest remaining path through the build, according to the
+        /// timings of previous builds.
+        /// </summary>
+        private void AssignUnscheduledRequestsByCriticalPath(List<ScheduleResponse> responses, HashSet<int> idleNodes)
+        {
+            foreach (int idleNodeId in idleNodes)
+            {
+                List<SchedulableRequest> requestsWhichCanBeScheduledToThisNode = new List<SchedulableRequest>();
+                foreach (SchedulableRequest request in _schedulingData.UnscheduledRequestsWhichCanBeScheduled)
+                {
+                    if (CanScheduleRequestToNode(request, idleNodeId))
+                    {
+                        requestsWhichCanBeScheduledToThisNode.Add(request);
+                    }
+                }
+
+                if (requestsWhichCanBeScheduledToThisNode.Count > 0)
+                {
+                    SchedulableRequest requestToSchedule = _schedulingHistory.GetRequestOnLongestPath(requestsWhichCanBeScheduledToThisNode);
+                    AssignUnscheduledRequestToNode(requestToSchedule, idleNodeId, responses);
+                }
+            }
+        }
+
+        /// <summary>
+        /// Assigns to nodes which are still idle the requests which are only waiting because their configurations are queued on
+        /// nodes which are now busy, preferring configurations the idle node has already loaded.
+        /// </summary>
+        /// <remarks>
+        /// New requests are queued on the node of the request which issued them (see <see cref="HandleRequestBlockedByNewRequests"/>),
+        /// and a configuration may only move while it is still queued, before any of its requests has executed anywhere, so that no
+        /// state set by targets which already ran on its node is lost.
+        /// </remarks>
+        private void AssignUnscheduledRequestsByStealingFromBusyNodes(List<ScheduleResponse> responses, HashSet<int> idleNodes)
+        {
+            foreach (int idleNodeId in idleNodes)
+            {
+                if (_schedulingData.IsNodeWorking(idleNodeId))
+                {
+                    continue;
+                }
+
+                if (AtSchedulingLimit())
+                {
+                    break;
+                }
+
+                SchedulableRequest requestToSteal = null;
+                foreach (SchedulableRequest request in _schedulingData.UnscheduledRequestsWhichCanBeScheduled)
+                {
+                    if (CanStealRequestToNode(request, idleNodeId))
+                    {
+                        requestToSteal = request;
+                        if (_availableNodes[idleNodeId].HasConfiguration(request.BuildRequest.ConfigurationId))
+                        {
+                            break;
+                        }
+                    }
+                }
+
+                if (requestToSteal != null)
+                {
+                    int configurationId = requestToSteal.BuildRequest.ConfigurationId;
+                    int busyNodeId = _schedulingData.GetAssignedNodeForRequestConfiguration(configurationId);
+
+                    _schedulingData.UnassignNodeForUnscheduledRequestConfiguration(configurationId);
+                    requestToSteal.StolenFromNode = busyNodeId;
+                    _stolenRequestsCount++;
+
+                    TraceScheduler("Idle node {0} stealing request {1} for configuration {2} from busy node {3} after it waited {4}ms", idleNodeId, requestToSteal.BuildRequest.GlobalRequestId, configurationId, busyNodeId, (_schedulingData.EventTime - requestToSteal.CreationTime).TotalMilliseconds);
+                    AssignUnscheduledRequestToNode(requestToSteal, idleNodeId, responses);
+                }
+            }
+        }
+
+        /// <summary>
+        /// Returns true if the request is waiting for the busy node its configuration is assigned to, and could instead be
+        /// scheduled to the specified node.
+        /// </summary>
+        private bool CanStealRequestToNode(SchedulableRequest request, int nodeId)
+        {
+            int configurationId = request.BuildRequest.ConfigurationId;
+            int assignedNodeId = _schedulingData.GetAssignedNodeForRequestConfiguration(configurationId);
+            if (assignedNodeId == InvalidNodeId || assignedNodeId == nodeId || !_schedulingData.IsNodeWorking(assignedNodeId))
+            {
+                return false;
+            }
+
+            // A configuration gets its results node the first time one of its requests executes, so only queued configurations have none
+            if (_configCache[configurationId].ResultsNodeId != InvalidNodeId)
+            {
+                return false;
+            }
+
+            foreach (SchedulableRequest configurationRequest in _schedulingData.GetRequestsAssignedToConfiguration(configurationId))
+            {
+                if (configurationRequest.State != SchedulableRequestState.Unscheduled)
+                {
+                    return false;
+                }
+            }
+
+            return _availableNodes[nodeId].CanServiceRequestWithAffinity(GetNodeAffinityForRequest(request.BuildRequest));
+        }
+
         /// <summary>
         /// Assigns requests preferring those which are traversal projects as determined by filename.
         /// </summary>
@@ -1695,6 +1849,12 @@ namespace Microsoft.Build.BackEnd
                 int nodeForResults = (parentRequest == null) ? InvalidNodeId : parentRequest.AssignedNode;
                 TraceScheduler("Received request {0} (node request {1}) with parent {2} from node {3}", request.GlobalRequestId, request.NodeRequestId, request.ParentGlobalRequestId, nodeForResults);
 
+                if (parentRequest == null)
+                {
+                    // This is a new submission, so any history of earlier builds is needed from here on.
+                    ReadSchedulingHistory(new BuildEventContext(request.SubmissionId, 0, 0, 0, 0, 0));
+                }
+
                 // First, determine if we have already built this request and have results for it.  If we do, we prepare the responses for it
                 // directly here.  We COULD simply report these as blocking the parent request and let the scheduler pick them up later when the parent
                 // comes back up as schedulable, but we prefer to send the results back immediately so this request can (potentially) continue uninterrupted.
@@ -1792,12 +1952,35 @@ namespace Microsoft.Build.BackEnd
                         BuildRequest requestToAdd = requestsToAdd.Pop();
                         SchedulableRequest blockingRequest = _schedulingData.CreateRequest(requestToAdd, parentRequest);
 
+                        if (_workStealingEnabled && parentRequest != null)
+                        {
+                            QueueRequestConfigurationOnParentNode(blockingRequest, parentRequest.AssignedNode);
+                        }
+
                         parentRequest?.BlockByRequest(blockingRequest, blocker.TargetsInProgress);
                     }
                 }
             }
         }
 
+        /// <summary>
+        /// Queues the configuration of a new request on the node of the request which issued it, if the configuration is not assigned
+        /// to a node yet.  The node runs the request when it is free, unless an idle node steals it first.
+        /// </summary>
+        private void QueueRequestConfigurationOnParentNode(SchedulableRequest request, int parentNodeId)
+        {
+            int configurationId = request.BuildRequest.ConfigurationId;
+            if (_schedulingData.GetAssignedNodeForRequestConfiguration(configurationId) != InvalidNodeId ||
+                _configCache[configurationId].ResultsNodeId != InvalidNodeId ||
+                !_availableNodes[parentNodeId].CanServiceRequestWithAffinity(GetNodeAffinityForRequest(request.BuildRequest)))
+            {
+                return;
+            }
+
+            TraceScheduler("Queueing request {0} for configuration {1} on node {2}", request.BuildRequest.GlobalRequestId, configurationId, parentNodeId);
+            _schedulingData.AssignNodeForUnscheduledRequestConfiguration(configurationId, parentNodeId);
+        }
+
         /// <summary>
         /// Resumes executing a request which was in the Ready state for the specified node, if any.
         /// </summary>
@@ -1846,6 +2029,7 @@ namespace Microsoft.Build.BackEnd
                 {
                     LogRequestHandledFromCache(request.BuildRequest, response.Unblocker.Result);
                     request.Complete(response.Unblocker.Result);
+                    RecordCompletedRequestInSchedulingHistory(request);
 
                     TraceScheduler("Reporting results for request {0} with parent {1} to node {2} from cache.", request.BuildRequest.GlobalRequestId, request.BuildRequest.ParentGlobalRequestId, response.NodeId);
                     if (response.NodeId != InvalidNodeId)
@@ -2518,6 +2702,11 @@ namespace Microsoft.Build.BackEnd
                         file.WriteLine("Scheduler state at timestamp {0}:", _schedulingData.EventTime.Ticks);
                         file.WriteLine("------------------------------------------------");
 
+                        if (_workStealingEnabled)
+                        {
+                            file.WriteLine("Requests stolen by idle nodes: {0}", _stolenRequestsCount);
+                        }
+
                         foreach (int nodeId in _availableNodes.Keys)
                         {
                             file.WriteLine(
@@ -2710,7 +2899,7 @@ namespace Microsoft.Build.BackEnd
             var buildRequest = request.BuildRequest;
 
             file.WriteLine(
-                "{0}{1}{2}: [{3}] {4}{5} ({6}){7} ({8})",
+                "{0}{1}{2}: [{3}] {4}{5} ({6}){7} ({8}){9}",
                 new string(' ', indent * 2),
                 prefix ?? "",
                 buildRequest.GlobalRequestId,
@@ -2721,7 +2910,10 @@ namespace Microsoft.Build.BackEnd
                 request.State,
                 buildRequest.ConfigurationId,
                 _configCache[buildRequest.ConfigurationId].ProjectFullPath,
-                string.Join(", ", buildRequest.Targets.ToArray()));
+                string.Join(", ", buildRequest.Targets.ToArray()),
+                request.StolenFromNode != InvalidNodeId
+                    ? String.Format(CultureInfo.InvariantCulture, " stolen from node {0} after waiting {1}ms", request.StolenFromNode, request.GetTimeSpentInState(SchedulableRequestState.Unscheduled).TotalMilliseconds)
+                    : "");
         }
 
         /// <summary>
@@ -2733,6 +2925,27 @@ namespace Microsoft.Build.BackEnd
             plan.WritePlan(submissionId, _componentHost.LoggingService, new BuildEventContext(submissionId, 0, 0, 0, 0, 0));
         }
 
+        /// <summary>
+        /// Reads in the scheduling history if one is being kept and has not previously been read.
+        /// </summary>
+        /// <param name="submissionContext">The context of the submission whose request is being scheduled, to which any problem reading the history is logged.</param>
+        private void ReadSchedulingHistory(BuildEventContext submissionContext)
+        {
+            if (_schedulingHistory == null && !String.IsNullOrEmpty(_schedulingHistoryPath))
+            {
+                _schedulingHistory = new SchedulingHistory(_configCache, _schedulingHistoryPath);
+                _schedulingHistory.Read(_componentHost.LoggingService, submissionContext);
+            }
+        }
+
+        /// <summary>
+        /// Records the time a completed request spent executing, so that later builds can schedule by it.
+        /// </summary>
+        private void RecordCompletedRequestInSchedulingHistory(SchedulableRequest request)
+        {
+            _schedulingHistory?.RecordCompletedRequest(request);
+        }
+
         /// <summary>
         /// Retrieves the scheduling plan from the previous run.
         /// </summary>
@@ -694,6 +694,40 @@ namespace Microsoft.Build.BackEnd
             _configurationToNode.Remove(configurationId);
         }
 
+        /// <summary>
+        /// Assigns a node to a configuration none of whose requests have been scheduled yet, so that they wait for that node.
+        /// </summary>
+        internal void AssignNodeForUnscheduledRequestConfiguration(int configurationId, int nodeId)
+        {
+            ErrorUtilities.VerifyThrow(
+                !_configurationToNode.ContainsKey(configurationId),
+                "Configuration with ID {0} is already assigned to node {1}.",
+                configurationId,
+                GetAssignedNodeForRequestConfiguration(configurationId));
+
+            _configurationToNode[configurationId] = nodeId;
+        }
+
+        /// <summary>
+        /// Unassigns the node associated with a particular configuration so that its waiting requests may be scheduled elsewhere.
+        /// </summary>
+        /// <remarks>
+        /// The operation is only valid when none of the configuration's requests have been scheduled.
+        /// </remarks>
+        internal void UnassignNodeForUnscheduledRequestConfiguration(int configurationId)
+        {
+            foreach (SchedulableRequest request in GetRequestsAssignedToConfiguration(configurationId))
+            {
+                ErrorUtilities.VerifyThrow(
+                    request.State == SchedulableRequestState.Unscheduled,
+                    "Configuration with ID {0} cannot be unassigned from a node, because request {1} with that configuration is scheduled.",
+                    configurationId,
+                    request.BuildRequest.GlobalRequestId);
+            }
+
+            _configurationToNode.Remove(configurationId);
+        }
+
         /// <summary>
         /// Gets a schedulable request with the specified global request id if it is currently scheduled.
         /// </summary>
@@ -0,0 +1,496 @@
+﻿// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+using System.Text;
+using Microsoft.Build.BackEnd.Logging;
+using Microsoft.Build.Execution;
+using Microsoft.Build.Framework;
+using Microsoft.Build.Shared;
+using Microsoft.Build.Shared.FileSystem;
+
+namespace Microsoft.Build.BackEnd
+{
+    /// <summary>
+    /// The time each project took to build, and the projects it referenced, as recorded over previous builds.  The scheduler
+    /// uses this to find the requests which lie on the longest remaining path through the build, so that they can be started
+    /// first rather than left until the end of the build.
+    /// </summary>
+    /// <remarks>
+    /// Projects are identified by their full path, tools version and global properties, because configuration ids are not
+    /// stable from one build to the next.  Each time a project is built its timings replace those from the previous build;
+    /// projects which are not seen for a number of builds are dropped.  The history is only accessed from the scheduler's
+    /// thread.
+    /// </remarks>
+    internal class SchedulingHistory
+    {
+        /// <summary>
+        /// The version of the history file format.
+        /// </summary>
+        internal const int FileFormatVersion = 1;
+
+        /// <summary>
+        /// The number of builds a project may go unbuilt before it is dropped from the history.
+        /// </summary>
+        private const int MaximumProjectAge = 16;
+
+        /// <summary>
+        /// The configuration cache.
+        /// </summary>
+        private readonly IConfigCache _configCache;
+
+        /// <summary>
+        /// The file the history is read from and written to.
+        /// </summary>
+        private readonly string _historyPath;
+
+        /// <summary>
+        /// Mapping of project keys to their history.
+        /// </summary>
+        private readonly Dictionary<string, ProjectHistory> _projectsByKey = new Dictionary<string, ProjectHistory>(StringComparer.OrdinalIgnoreCase);
+
+        /// <summary>
+        /// Mapping of configuration ids in this build to the history of their projects.
+        /// </summary>
+        private readonly Dictionary<int, ProjectHistory> _projectsByConfigurationId = new Dictionary<int, ProjectHistory>();
+
+        /// <summary>
+        /// Whether anything has been built since the longest paths were last computed.
+        /// </summary>
+        private bool _longestPathsAreStale = true;
+
+        /// <summary>
+        /// Constructor.
+        /// </summary>
+        public SchedulingHistory(IConfigCache configCache, string historyPath)
+        {
+            _configCache = configCache;
+            _historyPath = historyPath;
+        }
+
+        /// <summary>
+        /// Returns true if timings were read from a previous build.
+        /// </summary>
+        public bool HasHistory
+        {
+            get;
+            private set;
+        }
+
+        /// <summary>
+        /// Reads the history recorded by previous builds, if there is any.
+        /// </summary>
+        public void Read(ILoggingService loggingService, BuildEventContext buildEventContext)
+        {
+            if (!FileSystems.Default.FileExists(_historyPath))
+            {
+                return;
+            }
+
+            try
+            {
+                using (BinaryReader reader = new BinaryReader(File.OpenRead(_historyPath), Encoding.UTF8))
+                {
+                    if (reader.ReadInt32() != FileFormatVersion)
+                    {
+                        throw new InvalidDataException("Unknown scheduling history version.");
+                    }
+
+                    var projects = new ProjectHistory[reader.ReadInt32()];
+                    for (int i = 0; i < projects.Length; i++)
+                    {
+                        var project = new ProjectHistory(reader.ReadString());
+                        project.Duration = reader.ReadDouble();
+                        project.Age = reader.ReadInt32();
+
+                        int targetListCount = reader.ReadInt32();
+                        for (int j = 0; j < targetListCount; j++)
+                        {
+                            project.TargetListDurations[reader.ReadString()] = reader.ReadDouble();
+                        }
+
+                        projects[i] = project;
+                    }
+
+                    foreach (ProjectHistory project in projects)
+                    {
+                        int referenceCount = reader.ReadInt32();
+                        for (int j = 0; j < referenceCount; j++)
+                        {
+                            project.References.Add(projects[reader.ReadInt32()]);
+                        }
+                    }
+
+                    foreach (ProjectHistory project in projects)
+                    {
+                        _projectsByKey[project.Key] = project;
+                    }
+                }
+
+                HasHistory = _projectsByKey.Count > 0;
+            }
+            catch (Exception e) when (e is InvalidDataException || e is EndOfStreamException || e is IndexOutOfRangeException || e is OverflowException)
+            {
+                _projectsByKey.Clear();
+                loggingService.LogCommentFromText(buildEventContext, MessageImportance.Low, ResourceUtilities.FormatResourceStringStripCodeAndKeyword("BuildPlanCorrupt", _historyPath));
+            }
+            catch (Exception e) when (ExceptionHandling.IsIoRelatedException(e))
+            {
+                _projectsByKey.Clear();
+                loggingService.LogCommentFromText(buildEventContext, MessageImportance.Low, ResourceUtilities.FormatResourceStringStripCodeAndKeyword("CantReadBuildPlan", _historyPath));
+            }
+        }
+
+        /// <summary>
+        /// Writes the history, updated with the timings of this build.
+        /// </summary>
+        public void Write(ILoggingService loggingService, BuildEventContext buildEventContext)
+        {
+            var projects = new List<ProjectHistory>(_projectsByKey.Count);
+            var indices = new Dictionary<ProjectHistory, int>();
+            foreach (ProjectHistory project in _projectsByKey.Values)
+            {
+                if (project.WasBuilt || project.Age < MaximumProjectAge)
+                {
+                    indices[project] = projects.Count;
+                    projects.Add(project);
+                }
+            }
+
+            try
+            {
+                string directory = Path.GetDirectoryName(Path.GetFullPath(_historyPath));
+                Directory.CreateDirectory(directory);
+
+                using (BinaryWriter writer = new BinaryWriter(File.Open(_historyPath, FileMode.Create), Encoding.UTF8))
+                {
+                    writer.Write(FileFormatVersion);
+                    writer.Write(projects.Count);
+
+                    foreach (ProjectHistory project in projects)
+                    {
+                        Dictionary<string, double> targetListDurations = project.WasBuilt ? project.BuiltTargetListDurations : project.TargetListDurations;
+
+                        writer.Write(project.Key);
+                        writer.Write(project.WasBuilt ? project.BuiltDuration : project.Duration);
+                        writer.Write(project.WasBuilt ? 0 : project.Age + 1);
+                        writer.Write(targetListDurations.Count);
+                        foreach (KeyValuePair<string, double> targetListDuration in targetListDurations)
+                        {
+                            writer.Write(targetListDuration.Key);
+                            writer.Write(targetListDuration.Value);
+                        }
+                    }
+
+                    foreach (ProjectHistory project in projects)
+                    {
+                        // References which were dropped from the history are dropped from the references as well.
+                        HashSet<ProjectHistory> references = project.WasBuilt ? project.BuiltReferences : project.References;
+                        var referenceIndices = new List<int>(references.Count);
+                        foreach (ProjectHistory reference in references)
+                        {
+                            if (indices.TryGetValue(reference, out int index))
+                            {
+                                referenceIndices.Add(index);
+                            }
+                        }
+
+                        writer.Write(referenceIndices.Count);
+                        foreach (int index in referenceIndices)
+                        {
+                            writer.Write(index);
+                        }
+                    }
+                }
+            }
+            catch (Exception e) when (ExceptionHandling.IsIoRelatedException(e))
+            {
+                loggingService.LogCommentFromText(buildEventContext, MessageImportance.Low, ResourceUtilities.FormatResourceStringStripCodeAndKeyword("CantWriteBuildPlan", _historyPath));
+            }
+        }
+
+        /// <summary>
+        /// Records the time spent executing a request which has completed, and that its parent's project references its project.
+        /// </summary>
+        public void RecordCompletedRequest(SchedulableRequest request)
+        {
+            ProjectHistory project = GetProjectHistory(request.BuildRequest.ConfigurationId);
+            double duration = request.GetTimeSpentInState(SchedulableRequestState.Executing).TotalMilliseconds;
+
+            project.WasBuilt = true;
+            project.BuiltDuration += duration;
+
+            string targetList = String.Join(";", request.BuildRequest.Targets);
+            project.BuiltTargetListDurations.TryGetValue(targetList, out double targetListDuration);
+            project.BuiltTargetListDurations[targetList] = targetListDuration + duration;
+
+            if (request.Parent != null)
+            {
+                ProjectHistory parent = GetProjectHistory(request.Parent.BuildRequest.ConfigurationId);
+                if (parent != project && parent.BuiltReferences.Add(project))
+                {
+                    _longestPathsAreStale = true;
+                }
+            }
+
+            if (duration > 0)
+            {
+                _longestPathsAreStale = true;
+            }
+        }
+
+        /// <summary>
+        /// Given the requests which could be scheduled, returns the one whose project lies on the longest remaining path through
+        /// the build, preferring the request whose targets took the longest when the paths are equally long.  Requests for projects
+        /// which are not in the history are only returned if there is nothing else to schedule.
+        /// </summary>
+        public SchedulableRequest GetRequestOnLongestPath(IEnumerable<SchedulableRequest> requests)
+        {
+            if (_longestPathsAreStale)
+            {
+                ComputeLongestPaths();
+            }
+
+            SchedulableRequest bestRequest = null;
+            double bestPathLength = -1;
+            double bestTargetListDuration = -1;
+
+            foreach (SchedulableRequest request in requests)
+            {
+                ProjectHistory project = GetProjectHistory(request.BuildRequest.ConfigurationId);
+                double pathLength = project.LongestPathToReferences + project.LongestPathToReferrers - project.RemainingDuration;
+
+                project.TargetListDurations.TryGetValue(String.Join(";", request.BuildRequest.Targets), out double targetListDuration);
+
+                if (pathLength > bestPathLength || (pathLength == bestPathLength && targetListDuration > bestTargetListDuration))
+                {
+                    bestRequest = request;
+                    bestPathLength = pathLength;
+                    bestTargetListDuration = targetListDuration;
+                }
+            }
+
+            return bestRequest;
+        }
+
+        /// <summary>
+        /// Gets the history for the project of the specified configuration, adding it if it is new.
+        /// </summary>
+        private ProjectHistory GetProjectHistory(int configurationId)
+        {
+            if (!_projectsByConfigurationId.TryGetValue(configurationId, out ProjectHistory project))
+            {
+                string key = GetProjectKey(_configCache[configurationId]);
+                if (!_projectsByKey.TryGetValue(key, out project))
+                {
+                    project = new ProjectHistory(key);
+                    _projectsByKey[key] = project;
+                }
+
+                _projectsByConfigurationId[configurationId] = project;
+            }
+
+            return project;
+        }
+
+        /// <summary>
+        /// Computes, for each project, the longest chain of remaining work through its references and through its referrers.
+        /// </summary>
+        /// <remarks>
+        /// A project's references must finish before it can, and it must finish before its referrers can, so the longest path
+        /// through a project is the longest chain of references below it plus the longest chain of referrers above it.
+        /// </remarks>
+        private void ComputeLongestPaths()
+        {
+            foreach (ProjectHistory project in _projectsByKey.Values)
+            {
+                project.Referrers.Clear();
+                project.LongestPathToReferences = -1;
+                project.LongestPathToReferrers = -1;
+            }
+
+            foreach (ProjectHistory project in _projectsByKey.Values)
+            {
+                foreach (ProjectHistory reference in project.References)
+                {
+                    reference.Referrers.Add(project);
+                }
+
+                foreach (ProjectHistory reference in project.BuiltReferences)
+                {
+                    if (!project.References.Contains(reference))
+                    {
+                        reference.Referrers.Add(project);
+                    }
+                }
+            }
+
+            foreach (ProjectHistory project in _projectsByKey.Values)
+            {
+                ComputeLongestPathToReferences(project);
+                ComputeLongestPathToReferrers(project);
+            }
+
+            _longestPathsAreStale = false;
+        }
+
+        /// <summary>
+        /// Computes the longest chain of remaining work from the project through its references, including its own.
+        /// </summary>
+        private static double ComputeLongestPathToReferences(ProjectHistory project)
+        {
+            if (project.LongestPathToReferences < 0)
+            {
+                // Guard against cycles, which histories merged from different builds may contain.
+                project.LongestPathToReferences = 0;
+
+                double longestReferencePath = 0;
+                foreach (ProjectHistory reference in project.References)
+                {
+                    longestReferencePath = Math.Max(longestReferencePath, ComputeLongestPathToReferences(reference));
+                }
+
+                foreach (ProjectHistory reference in project.BuiltReferences)
+                {
+                    longestReferencePath = Math.Max(longestReferencePath, ComputeLongestPathToReferences(reference));
+                }
+
+                project.LongestPathToReferences = project.RemainingDuration + longestReferencePath;
+            }
+
+            return project.LongestPathToReferences;
+        }
+
+        /// <summary>
+        /// Computes the longest chain of remaining work from the project through its referrers, including its own.
+        /// </summary>
+        private static double ComputeLongestPathToReferrers(ProjectHistory project)
+        {
+            if (project.LongestPathToReferrers < 0)
+            {
+                project.LongestPathToReferrers = 0;
+
+                double longestReferrerPath = 0;
+                foreach (ProjectHistory referrer in project.Referrers)
+                {
+                    longestReferrerPath = Math.Max(longestReferrerPath, ComputeLongestPathToReferrers(referrer));
+                }
+
+                project.LongestPathToReferrers = project.RemainingDuration + longestReferrerPath;
+            }
+
+            return project.LongestPathToReferrers;
+        }
+
+        /// <summary>
+        /// Gets the key identifying a configuration's project from one build to the next.
+        /// </summary>
+        internal static string GetProjectKey(BuildRequestConfiguration configuration)
+        {
+            var globalProperties = new List<string>();
+            foreach (ProjectPropertyInstance property in configuration.GlobalProperties)
+            {
+                globalProperties.Add(property.Name + "=" + property.EvaluatedValue);
+            }
+
+            globalProperties.Sort(StringComparer.OrdinalIgnoreCase);
+
+            // Global properties can be long (solution builds pass the whole solution configuration to each project),
+            // so they are stored as a hash.
+            ulong hash = 14695981039346656037;
+            foreach (string property in globalProperties)
+            {
+                foreach (char c in property)
+                {
+                    hash = unchecked((hash ^ char.ToUpperInvariant(c)) * 1099511628211);
+                }
+
+                hash = unchecked((hash ^ ';') * 1099511628211);
+            }
+
+            return String.Format(CultureInfo.InvariantCulture, "{0}|{1}|{2:X16}", configuration.ProjectFullPath, configuration.ToolsVersion, hash);
+        }
+
+        /// <summary>
+        /// The history of a project.
+        /// </summary>
+        private class ProjectHistory
+        {
+            /// <summary>
+            /// Constructor.
+            /// </summary>
+            public ProjectHistory(string key)
+            {
+                Key = key;
+            }
+
+            /// <summary>
+            /// Gets the key identifying the project.
+            /// </summary>
+            public string Key { get; }
+
+            /// <summary>
+            /// Gets or sets the milliseconds spent executing the project in the last build which built it.
+            /// </summary>
+            public double Duration { get; set; }
+
+            /// <summary>
+            /// Gets or sets the number of builds since the project was last built.
+            /// </summary>
+            public int Age { get; set; }
+
+            /// <summary>
+            /// Gets the milliseconds spent executing each list of targets requested of the project in the last build which built it.
+            /// </summary>
+            public Dictionary<string, double> TargetListDurations { get; } = new Dictionary<string, double>(StringComparer.OrdinalIgnoreCase);
+
+            /// <summary>
+            /// Gets the projects this one referenced in the last build which built it.
+            /// </summary>
+            public HashSet<ProjectHistory> References { get; } = new HashSet<ProjectHistory>();
+
+            /// <summary>
+            /// Gets the projects this one has referenced so far in this build, which replace its earlier references.
+            /// </summary>
+            public HashSet<ProjectHistory> BuiltReferences { get; } = new HashSet<ProjectHistory>();
+
+            /// <summary>
+            /// Gets the projects which reference this one, as computed with the longest paths.
+            /// </summary>
+            public List<ProjectHistory> Referrers { get; } = new List<ProjectHistory>();
+
+            /// <summary>
+            /// Gets or sets whether any request for the project has completed in this build.
+            /// </summary>
+            public bool WasBuilt { get; set; }
+
+            /// <summary>
+            /// Gets or sets the milliseconds spent executing the project so far in this build.
+            /// </summary>
+            public double BuiltDuration { get; set; }
+
+            /// <summary>
+            /// Gets the milliseconds spent executing each list of targets requested of the project so far in this build.
+            /// </summary>
+            public Dictionary<string, double> BuiltTargetListDurations { get; } = new Dictionary<string, double>(StringComparer.OrdinalIgnoreCase);
+
+            /// <summary>
+            /// Gets the milliseconds the project is expected to spend executing for the rest of this build.
+            /// </summary>
+            public double RemainingDuration => Math.Max(0, Duration - BuiltDuration);
+
+            /// <summary>
+            /// Gets or sets the longest chain of remaining work through the project's references, or -1 if not yet computed.
+            /// </summary>
+            public double LongestPathToReferences { get; set; }
+
+            /// <summary>
+            /// Gets or sets the longest chain of remaining work through the project's referrers, or -1 if not yet computed.
+            /// </summary>
+            public double LongestPathToReferrers { get; set; }
+        }
+    }
+}
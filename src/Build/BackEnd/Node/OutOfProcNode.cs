@@ -11,10 +11,14 @@ using System.Globalization;
 using System.Threading;
 using Microsoft.Build.BackEnd;
 using Microsoft.Build.BackEnd.Logging;
+using Microsoft.Build.Construction;
 using Microsoft.Build.Evaluation;
+using Microsoft.Build.Evaluation.Context;
 using Microsoft.Build.Framework;
 using Microsoft.Build.Shared;
+using Microsoft.Build.Shared.FileSystem;
 using Microsoft.Build.Internal;
+using Microsoft.Build.Utilities;
 using Microsoft.Build.BackEnd.Components.Caching;
 using Microsoft.Build.BackEnd.SdkResolution;
 using SdkResult = Microsoft.Build.BackEnd.SdkResolution.SdkResult;
@@ -38,6 +42,11 @@ namespace Microsoft.Build.Execution
         /// </summary>
         private static ProjectRootElementCacheBase s_projectRootElementCacheBase;
 
+        /// <summary>
+        /// The names of the imports of MSBuild and of the C++ build that most projects share.
+        /// </summary>
+        private static readonly string[] s_commonImportPatterns = { "Microsoft.Common*.props", "Microsoft.Common*.targets", "Microsoft.Cpp*.props", "Microsoft.Cpp*.targets" };
+
         /// <summary>
         /// The endpoint used to talk to the host.
         /// </summary>
@@ -252,6 +261,12 @@ namespace Microsoft.Build.Execution
             _nodeEndpoint.OnLinkStatusChanged += OnLinkStatusChanged;
             _nodeEndpoint.Listen(this);
 
+            if (Traits.Instance.PrelaunchNodes)
+            {
+                // The host launches the node ahead of its first request, which leaves it the time to load the common imports
+                ThreadPool.QueueUserWorkItem(_ => PreloadCommonImports());
+            }
+
             var waitHandles = new WaitHandle[] { _shutdownEvent, _packetReceivedEvent };
 
             // Get the current directory before doing any work. We need this so we can restore the directory when the node shutsdown.
@@ -450,6 +465,9 @@ namespace Microsoft.Build.Execution
             // Signal the SDK resolver service to shutdown
             ((IBuildComponent)_sdkResolverService).ShutdownComponent();
 
+            // Installations may change between builds
+            InstallationDirectoryFileSystem.BuildFinished();
+
             // Dispose of any build registered objects
             IRegisteredTaskObjectCache objectCache = (IRegisteredTaskObjectCache)(_componentFactories.GetComponent(BuildComponentType.RegisteredTaskObjectCache));
             objectCache.DisposeCacheObjects(RegisteredTaskObjectLifetime.Build);
@@ -523,6 +541,72 @@ namespace Microsoft.Build.Execution
             return _shutdownReason;
         }
 
+        /// <summary>
+        /// Loads the imports that most projects share into the project root element cache, which also compiles the code parsing
+        /// them, so that the first request of the node doesn't wait for either.
+        /// </summary>
+        private static void PreloadCommonImports()
+        {
+            ProjectRootElementCacheBase projectRootElementCache = s_projectRootElementCacheBase;
+            if (projectRootElementCache == null)
+            {
+                return;
+            }
+
+            try
+            {
+                foreach (string import in GetCommonImports())
+                {
+                    ProjectRootElement.Open(import, projectRootElementCache, isExplicitlyLoaded: false, preserveFormatting: null);
+                }
+            }
+            catch (Exception e) when (!ExceptionHandling.IsCriticalException(e))
+            {
+                // An import that fails to load fails the evaluations that import it instead
+                CommunicationsUtilities.Trace("Failed to preload the common imports. {0}", e.Message);
+            }
+        }
+
+        /// <summary>
+        /// Finds the common props and targets of MSBuild, and those of the C++ build installed in its extensions directory.
+        /// </summary>
+        private static List<string> GetCommonImports()
+        {
+            var directories = new List<string> { BuildEnvironmentHelper.Instance.CurrentMSBuildToolsDirectory };
+
+            string extensionsDirectory = BuildEnvironmentHelper.Instance.MSBuildExtensionsPath;
+            if (!string.IsNullOrEmpty(extensionsDirectory))
+            {
+                directories.Add(Path.Combine(extensionsDirectory, MSBuildConstants.CurrentToolsVersion));
+
+                // VCTargetsPath of each installed version of the C++ build
+                string vcDirectory = Path.Combine(extensionsDirectory, "Microsoft", "VC");
+                if (FileSystems.Default.DirectoryExists(vcDirectory))
+                {
+                    directories.AddRange(FileSystems.Default.EnumerateDirectories(vcDirectory, "v*"));
+                }
+            }
+
+            var imports = new List<string>();
+            foreach (string directory in directories)
+            {
+                if (string.IsNullOrEmpty(directory) || !FileSystems.Default.DirectoryExists(directory))
+                {
+                    continue;
+                }
+
+                foreach (string pattern in s_commonImportPatterns)
+                {
+                    foreach (string import in FileSystems.Default.EnumerateFiles(directory, pattern))
+                    {
+                        imports.Add(FileUtilities.NormalizePath(import));
+                    }
+                }
+            }
+
+            return imports;
+        }
+
         /// <summary>
         /// Clears all the caches used during the build.
         /// </summary>
@@ -670,6 +754,9 @@ namespace Microsoft.Build.Execution
             // Grab the system parameters.
             _buildParameters = configuration.BuildParameters;
 
+            // Evaluations on this node share what exists in installation directories until the build ends
+            InstallationDirectoryFileSystem.BuildStarted();
+
             _buildParameters.ProjectRootElementCache = s_projectRootElementCacheBase;
 
             // Snapshot the current environment
@@ -15,6 +15,7 @@ using Microsoft.Build.Evaluation;
 using Microsoft.Build.Framework;
 using Microsoft.Build.Globbing;
 using Microsoft.Build.Shared.FileSystem;
+using Microsoft.Build.Utilities;
 
 namespace Microsoft.Build.BackEnd
 {
@@ -464,23 +465,50 @@ namespace Microsoft.Build.BackEnd
                 {
                     projectLoadSettings |= ProjectLoadSettings.FailOnUnresolvedSdk;
                 }
-                return new ProjectInstance(
+
+                var buildEventContext = new BuildEventContext(
+                    submissionId,
+                    nodeId,
+                    BuildEventContext.InvalidEvaluationId,
+                    BuildEventContext.InvalidProjectInstanceId,
+                    BuildEventContext.InvalidProjectContextId,
+                    BuildEventContext.InvalidTargetId,
+                    BuildEventContext.InvalidTaskId);
+
+                EvaluationCache evaluationCache = null;
+                string evaluationCacheDirectory = Traits.Instance.EvaluationCacheDirectory;
+
+                if (!string.IsNullOrEmpty(evaluationCacheDirectory))
+                {
+                    evaluationCache = new EvaluationCache(evaluationCacheDirectory, ProjectFullPath, globalProperties, toolsVersionOverride, projectLoadSettings);
+
+                    ProjectInstance cachedInstance = evaluationCache.TryGet(
+                        componentHost.BuildParameters.EnvironmentPropertiesInternal,
+                        componentHost.BuildParameters.ProjectRootElementCache,
+                        componentHost.LoggingService,
+                        buildEventContext);
+
+                    if (cachedInstance != null)
+                    {
+                        cachedInstance.LateInitialize(componentHost.BuildParameters.ProjectRootElementCache, componentHost.BuildParameters.HostServices);
+                        return cachedInstance;
+                    }
+                }
+
+                var projectInstance = new ProjectInstance(
                     ProjectFullPath,
                     globalProperties,
                     toolsVersionOverride,
                     componentHost.BuildParameters,
                     componentHost.LoggingService,
-                    new BuildEventContext(
-                        submissionId,
-                        nodeId,
-                        BuildEventContext.InvalidEvaluationId,
-                        BuildEventContext.InvalidProjectInstanceId,
-                        BuildEventContext.InvalidProjectContextId,
-                        BuildEventContext.InvalidTargetId,
-                        BuildEventContext.InvalidTaskId),
+                    buildEventContext,
                     sdkResolverService,
                     submissionId,
                     projectLoadSettings);
+
+                evaluationCache?.Save(projectInstance);
+
+                return projectInstance;
             });
         }
 
@@ -566,6 +566,20 @@ namespace Microsoft.Build.Execution
             }
         }
 
+        /// <summary>
+        /// Counts the items of all of the target results which are held in memory rather than cached.
+        /// </summary>
+        internal int CountItemsInMemory()
+        {
+            int count = 0;
+            foreach (TargetResult targetResult in _resultsByTarget.Values)
+            {
+                count += targetResult.ItemsInMemoryCount;
+            }
+
+            return count;
+        }
+
         /// <summary>
         /// Clear cached files from disk.
         /// </summary>
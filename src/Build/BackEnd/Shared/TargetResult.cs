@@ -107,6 +107,20 @@ namespace Microsoft.Build.Execution
             }
         }
 
+        /// <summary>
+        /// The number of items held in memory, not counting those which have been cached to disk.
+        /// </summary>
+        internal int ItemsInMemoryCount
+        {
+            get
+            {
+                lock (_result)
+                {
+                    return _items?.Length ?? 0;
+                }
+            }
+        }
+
         /// <summary>
         /// Returns the result code for the target.
         /// </summary>
@@ -243,6 +257,13 @@ namespace Microsoft.Build.Execution
                     return;
                 }
 
+                if (_cacheInfo.TargetName != null)
+                {
+                    // These items were retrieved from the cache, which still holds them.
+                    _items = null;
+                    return;
+                }
+
                 using ITranslator translator = GetResultsCacheTranslator(configId, targetName, TranslationDirection.WriteToStream);
 
                 // If the translator is null, it means these results were cached once before.  Since target results are immutable once they
@@ -279,8 +300,8 @@ namespace Microsoft.Build.Execution
                 {
                     using ITranslator translator = GetResultsCacheTranslator(_cacheInfo.ConfigId, _cacheInfo.TargetName, TranslationDirection.ReadFromStream);
 
+                    // Keep the cache info so that the items can be released again without being written again.
                     TranslateItems(translator);
-                    _cacheInfo = new CacheInfo();
                 }
             }
         }
@@ -0,0 +1,136 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using Microsoft.Build.Shared;
+using Microsoft.Build.Shared.FileSystem;
+using Microsoft.Build.Utilities;
+
+namespace Microsoft.Build.Evaluation.Context
+{
+    /// <summary>
+    /// The entries of the directories that glob expansions enumerated, shared by every evaluation in the process.
+    /// </summary>
+    /// <remarks>
+    /// Adding, removing or renaming an entry of a directory updates its last write time, so an indexed directory is enumerated
+    /// again only when its timestamp changed. Successive evaluations of globs over a large source tree then cost one timestamp
+    /// query per directory instead of one enumeration, and long-lived nodes keep the index from one build to the next.
+    /// </remarks>
+    internal sealed class DirectoryIndex
+    {
+        private static readonly Lazy<DirectoryIndex> s_shared = new Lazy<DirectoryIndex>(() => new DirectoryIndex(FileSystems.Default));
+
+        private static readonly bool s_ignoreCase = FileUtilities.PathComparison == StringComparison.OrdinalIgnoreCase;
+
+        private readonly IFileSystem _fileSystem;
+
+        private readonly ConcurrentDictionary<string, DirectoryEntries> _directories = new ConcurrentDictionary<string, DirectoryEntries>(StringComparer.Ordinal);
+
+        internal DirectoryIndex(IFileSystem fileSystem)
+        {
+            _fileSystem = fileSystem;
+        }
+
+        /// <summary>
+        /// Whether evaluations that read the file system directly should enumerate directories through <see cref="Shared"/>.
+        /// </summary>
+        internal static bool IsEnabled => Traits.Instance.UseDirectoryIndex;
+
+        internal static DirectoryIndex Shared => s_shared.Value;
+
+        /// <summary>
+        /// The number of directories in the index.
+        /// </summary>
+        internal int Count => _directories.Count;
+
+        /// <summary>
+        /// Gets the entries of a directory matching a pattern, with the signature of <see cref="FileMatcher.GetFileSystemEntries"/>.
+        /// </summary>
+        internal IReadOnlyList<string> GetFileSystemEntries(
+            FileMatcher.FileSystemEntity entityType,
+            string path,
+            string pattern,
+            string projectDirectory,
+            bool stripProjectDirectory)
+        {
+            path = FileUtilities.FixFilePath(path);
+
+            // Relative paths depend on the current directory, which differs between the evaluations sharing the index
+            if (!Path.IsPathRooted(path))
+            {
+                return FileMatcher.GetAccessibleFileSystemEntries(_fileSystem, entityType, path, pattern, projectDirectory, stripProjectDirectory);
+            }
+
+            DirectoryEntries directory = GetDirectoryEntries(path);
+            if (directory == null)
+            {
+                return Array.Empty<string>();
+            }
+
+            IEnumerable<string> entries = entityType switch
+            {
+                FileMatcher.FileSystemEntity.Files => directory.Files,
+                FileMatcher.FileSystemEntity.Directories => directory.Directories,
+                FileMatcher.FileSystemEntity.FilesAndDirectories => directory.Files.Concat(directory.Directories),
+                _ => throw new NotImplementedException()
+            };
+
+            // Match with the case sensitivity of the file system, as enumerating with the pattern would
+            if (pattern != null && !FileMatcher.IsAllFilesWildcard(pattern))
+            {
+                entries = entries.Where(o => FileMatcher.IsMatch(Path.GetFileName(o), pattern, s_ignoreCase));
+            }
+
+            return stripProjectDirectory
+                ? FileMatcher.RemoveProjectDirectory(entries, projectDirectory).ToArray()
+                : entries.ToArray();
+        }
+
+        /// <summary>
+        /// Gets the indexed entries of a directory, enumerating it again if it changed since it was indexed.
+        /// </summary>
+        /// <returns>The entries, or null if the directory doesn't exist</returns>
+        private DirectoryEntries GetDirectoryEntries(string path)
+        {
+            if (!NativeMethodsShared.GetLastWriteDirectoryUtcTime(path, out DateTime timestamp))
+            {
+                _directories.TryRemove(path, out _);
+                return null;
+            }
+
+            if (_directories.TryGetValue(path, out DirectoryEntries directory) && directory.Timestamp == timestamp)
+            {
+                return directory;
+            }
+
+            // The timestamp is taken before enumerating, so that entries added meanwhile change it for the next query
+            directory = new DirectoryEntries(
+                timestamp,
+                FileMatcher.GetAccessibleFileSystemEntries(_fileSystem, FileMatcher.FileSystemEntity.Files, path, null, null, false),
+                FileMatcher.GetAccessibleFileSystemEntries(_fileSystem, FileMatcher.FileSystemEntity.Directories, path, null, null, false));
+
+            _directories[path] = directory;
+            return directory;
+        }
+
+        private sealed class DirectoryEntries
+        {
+            internal DirectoryEntries(DateTime timestamp, IReadOnlyList<string> files, IReadOnlyList<string> directories)
+            {
+                Timestamp = timestamp;
+                Files = files;
+                Directories = directories;
+            }
+
+            internal DateTime Timestamp { get; }
+
+            internal IReadOnlyList<string> Files { get; }
+
+            internal IReadOnlyList<string> Directories { get; }
+        }
+    }
+}
@@ -62,7 +62,25 @@ namespace Microsoft.Build.Evaluation.Context
 
             SdkResolverService = new CachingSdkResolverService();
             FileEntryExpansionCache = new ConcurrentDictionary<string, IReadOnlyList<string>>();
-            FileSystem = fileSystem ?? new CachingFileSystemWrapper(FileSystems.Default);
+            // A shared context remembers what exists itself, for as long as its owner keeps it. Isolated contexts, which
+            // evaluate a single project each, share what exists in installation directories while a build is in progress.
+            FileSystem = fileSystem ?? new CachingFileSystemWrapper(policy == SharingPolicy.Isolated && InstallationDirectoryFileSystem.IsEnabled
+                ? InstallationDirectoryFileSystem.Default
+                : FileSystems.Default);
+
+            // The shared directory index reads the disk, so it can't stand in for a file system given by the caller
+            EngineFileUtilities = new EngineFileUtilities(fileSystem == null && DirectoryIndex.IsEnabled
+                ? new FileMatcher(FileSystem, DirectoryIndex.Shared.GetFileSystemEntries, FileEntryExpansionCache)
+                : new FileMatcher(FileSystem, FileEntryExpansionCache));
+        }
+
+        private EvaluationContext(IFileSystem fileSystem, ISdkResolverService sdkResolverService)
+        {
+            Policy = SharingPolicy.Isolated;
+
+            SdkResolverService = sdkResolverService;
+            FileEntryExpansionCache = new ConcurrentDictionary<string, IReadOnlyList<string>>();
+            FileSystem = fileSystem;
             EngineFileUtilities = new EngineFileUtilities(new FileMatcher(FileSystem, FileEntryExpansionCache));
         }
 
@@ -106,6 +124,23 @@ namespace Microsoft.Build.Evaluation.Context
             return context;
         }
 
+        /// <summary>
+        ///     Creates the context of a single evaluation that reads the file system and resolves SDKs through this context,
+        ///     recording every file and directory the evaluation reads in <see cref="RecordingFileSystem"/>.
+        /// </summary>
+        /// <remarks>
+        ///     Glob expansions aren't shared with this context, since those served from its cache wouldn't be recorded.
+        /// </remarks>
+        internal EvaluationContext CreateRecordingContext()
+        {
+            return new EvaluationContext(new RecordingFileSystem(FileSystem), SdkResolverService);
+        }
+
+        /// <summary>
+        ///     What the evaluation of this context read, if it was created by <see cref="CreateRecordingContext"/>.
+        /// </summary>
+        internal RecordingFileSystem RecordingFileSystem => FileSystem as RecordingFileSystem;
+
         internal EvaluationContext ContextForNewProject()
         {
             // Projects using isolated contexts need to get a new context instance 
@@ -0,0 +1,133 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.IO;
+using System.Threading;
+using Microsoft.Build.Shared;
+using Microsoft.Build.Shared.FileSystem;
+using Microsoft.Build.Utilities;
+
+namespace Microsoft.Build.Evaluation.Context
+{
+    /// <summary>
+    /// The file system of isolated evaluations during a build, remembering whether files and directories beneath installation
+    /// directories exist for every evaluation in the process, until the build completes.
+    /// </summary>
+    /// <remarks>
+    /// Imports like Microsoft.Cpp.*.props and .targets check the existence of the same files of Visual Studio and the SDKs,
+    /// through Exists() conditions and imports, in every project. Evaluations don't share their file system during a build,
+    /// as anything else may be written by the build, but the build doesn't write to installation directories.
+    /// Outside a build nothing says when an installation may change, so evaluations there, like those of API hosts, only
+    /// share what a context with <see cref="EvaluationContext.SharingPolicy.Shared"/> remembers for its own lifetime.
+    /// </remarks>
+    internal sealed class InstallationDirectoryFileSystem : IFileSystem
+    {
+        private static readonly ConcurrentDictionary<string, bool> s_fileExistence = new ConcurrentDictionary<string, bool>(StringComparer.OrdinalIgnoreCase);
+        private static readonly ConcurrentDictionary<string, bool> s_directoryExistence = new ConcurrentDictionary<string, bool>(StringComparer.OrdinalIgnoreCase);
+        private static readonly ConcurrentDictionary<string, bool> s_fileOrDirectoryExistence = new ConcurrentDictionary<string, bool>(StringComparer.OrdinalIgnoreCase);
+
+        private static int s_buildsInProgress;
+
+        private readonly IFileSystem _fileSystem;
+
+        internal InstallationDirectoryFileSystem(IFileSystem fileSystem)
+        {
+            _fileSystem = fileSystem;
+        }
+
+        internal static InstallationDirectoryFileSystem Default { get; } = new InstallationDirectoryFileSystem(FileSystems.Default);
+
+        /// <summary>
+        /// Whether isolated evaluations that read the file system directly should read it through <see cref="Default"/>,
+        /// which is only while a build is in progress in the process.
+        /// </summary>
+        internal static bool IsEnabled => Volatile.Read(ref s_buildsInProgress) > 0 && !Traits.Instance.EscapeHatches.DisableSharedFileExistenceCache;
+
+        /// <summary>
+        /// The number of paths whose existence is remembered.
+        /// </summary>
+        internal static int Count => s_fileExistence.Count + s_directoryExistence.Count + s_fileOrDirectoryExistence.Count;
+
+        /// <summary>
+        /// Notes that a build has started in the process, so that its evaluations share the existence of installed files.
+        /// </summary>
+        internal static void BuildStarted()
+        {
+            Interlocked.Increment(ref s_buildsInProgress);
+        }
+
+        /// <summary>
+        /// Notes that a build has finished, forgetting the existence of every path once no build is left in progress.
+        /// A build which was never noted as started, like a node shut down before it was configured, is ignored.
+        /// </summary>
+        internal static void BuildFinished()
+        {
+            int buildsInProgress = Volatile.Read(ref s_buildsInProgress);
+            while (buildsInProgress > 0)
+            {
+                int previousBuildsInProgress = Interlocked.CompareExchange(ref s_buildsInProgress, buildsInProgress - 1, buildsInProgress);
+                if (previousBuildsInProgress == buildsInProgress)
+                {
+                    if (buildsInProgress == 1)
+                    {
+                        Clear();
+                    }
+
+                    return;
+                }
+
+                buildsInProgress = previousBuildsInProgress;
+            }
+        }
+
+        /// <summary>
+        /// Forgets the existence of every path, when the build completes and installations may change.
+        /// </summary>
+        internal static void Clear()
+        {
+            s_fileExistence.Clear();
+            s_directoryExistence.Clear();
+            s_fileOrDirectoryExistence.Clear();
+        }
+
+        public bool FileExists(string path) => CachedExistenceCheck(s_fileExistence, path, _fileSystem.FileExists);
+
+        public bool DirectoryExists(string path) => CachedExistenceCheck(s_directoryExistence, path, _fileSystem.DirectoryExists);
+
+        public bool FileOrDirectoryExists(string path) => CachedExistenceCheck(s_fileOrDirectoryExistence, path, _fileSystem.FileOrDirectoryExists);
+
+        public FileAttributes GetAttributes(string path) => _fileSystem.GetAttributes(path);
+
+        public DateTime GetLastWriteTimeUtc(string path) => _fileSystem.GetLastWriteTimeUtc(path);
+
+        public TextReader ReadFile(string path) => _fileSystem.ReadFile(path);
+
+        public Stream GetFileStream(string path, FileMode mode, FileAccess access, FileShare share) => _fileSystem.GetFileStream(path, mode, access, share);
+
+        public string ReadFileAllText(string path) => _fileSystem.ReadFileAllText(path);
+
+        public byte[] ReadFileAllBytes(string path) => _fileSystem.ReadFileAllBytes(path);
+
+        public IEnumerable<string> EnumerateFiles(string path, string searchPattern = "*", SearchOption searchOption = SearchOption.TopDirectoryOnly)
+            => _fileSystem.EnumerateFiles(path, searchPattern, searchOption);
+
+        public IEnumerable<string> EnumerateDirectories(string path, string searchPattern = "*", SearchOption searchOption = SearchOption.TopDirectoryOnly)
+            => _fileSystem.EnumerateDirectories(path, searchPattern, searchOption);
+
+        public IEnumerable<string> EnumerateFileSystemEntries(string path, string searchPattern = "*", SearchOption searchOption = SearchOption.TopDirectoryOnly)
+            => _fileSystem.EnumerateFileSystemEntries(path, searchPattern, searchOption);
+
+        private static bool CachedExistenceCheck(ConcurrentDictionary<string, bool> cache, string path, Func<string, bool> existenceCheck)
+        {
+            if (path == null || !SharedFileTimestampCache.IsUnderImmutableDirectory(path))
+            {
+                return existenceCheck(path);
+            }
+
+            return cache.GetOrAdd(path, existenceCheck);
+        }
+    }
+}
@@ -0,0 +1,127 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.IO;
+using Microsoft.Build.Shared;
+using Microsoft.Build.Shared.FileSystem;
+
+namespace Microsoft.Build.Evaluation.Context
+{
+    /// <summary>
+    /// The file system of a single evaluation, recording every file and directory the evaluation read, probed or enumerated,
+    /// so that a snapshot of the evaluation can tell whether evaluating the project again would read the same.
+    /// </summary>
+    /// <remarks>
+    /// Evaluations can also depend on what they don't read through their file system, like the SDKs they resolve or the
+    /// files, registry keys and environment variables property functions read. Those mark the recording as untracked.
+    /// </remarks>
+    internal sealed class RecordingFileSystem : IFileSystem
+    {
+        private readonly ConcurrentDictionary<string, bool> _paths = new ConcurrentDictionary<string, bool>(StringComparer.OrdinalIgnoreCase);
+
+        private readonly IFileSystem _fileSystem;
+
+        private volatile string _untrackedRead;
+
+        internal RecordingFileSystem(IFileSystem fileSystem)
+        {
+            _fileSystem = fileSystem;
+        }
+
+        /// <summary>
+        /// The full paths of the files and directories the evaluation read, probed or enumerated, whether they exist or not.
+        /// </summary>
+        internal ICollection<string> Paths => _paths.Keys;
+
+        /// <summary>
+        /// What the evaluation depended on that isn't recorded, or null if everything it depended on is.
+        /// </summary>
+        internal string UntrackedRead => _untrackedRead;
+
+        /// <summary>
+        /// Records that the evaluation depended on something it didn't read through the file system.
+        /// </summary>
+        internal void MarkUntracked(string read)
+        {
+            _untrackedRead ??= read;
+        }
+
+        /// <summary>
+        /// Records that an evaluation depended on something it didn't read through the file system, if its file system records.
+        /// </summary>
+        internal static void MarkUntracked(IFileSystem fileSystem, string read)
+        {
+            (fileSystem as RecordingFileSystem)?.MarkUntracked(read);
+        }
+
+        public bool FileExists(string path) => _fileSystem.FileExists(Record(path));
+
+        public bool DirectoryExists(string path) => _fileSystem.DirectoryExists(Record(path));
+
+        public bool FileOrDirectoryExists(string path) => _fileSystem.FileOrDirectoryExists(Record(path));
+
+        public FileAttributes GetAttributes(string path) => _fileSystem.GetAttributes(Record(path));
+
+        public DateTime GetLastWriteTimeUtc(string path) => _fileSystem.GetLastWriteTimeUtc(Record(path));
+
+        public TextReader ReadFile(string path) => _fileSystem.ReadFile(Record(path));
+
+        public Stream GetFileStream(string path, FileMode mode, FileAccess access, FileShare share) => _fileSystem.GetFileStream(Record(path), mode, access, share);
+
+        public string ReadFileAllText(string path) => _fileSystem.ReadFileAllText(Record(path));
+
+        public byte[] ReadFileAllBytes(string path) => _fileSystem.ReadFileAllBytes(Record(path));
+
+        public IEnumerable<string> EnumerateFiles(string path, string searchPattern = "*", SearchOption searchOption = SearchOption.TopDirectoryOnly)
+            => RecordEntries(_fileSystem.EnumerateFiles(Record(path), searchPattern, searchOption), searchOption);
+
+        public IEnumerable<string> EnumerateDirectories(string path, string searchPattern = "*", SearchOption searchOption = SearchOption.TopDirectoryOnly)
+            => RecordEntries(_fileSystem.EnumerateDirectories(Record(path), searchPattern, searchOption), searchOption);
+
+        public IEnumerable<string> EnumerateFileSystemEntries(string path, string searchPattern = "*", SearchOption searchOption = SearchOption.TopDirectoryOnly)
+            => RecordEntries(_fileSystem.EnumerateFileSystemEntries(Record(path), searchPattern, searchOption), searchOption);
+
+        private string Record(string path)
+        {
+            if (string.IsNullOrEmpty(path) || path.IndexOfAny(FileUtilities.InvalidPathChars) >= 0)
+            {
+                return path;
+            }
+
+            try
+            {
+                _paths.TryAdd(Path.GetFullPath(path), true);
+            }
+            catch (Exception e) when (ExceptionHandling.IsIoRelatedException(e))
+            {
+                // The file system rejects the path the same way when it is read
+            }
+
+            return path;
+        }
+
+        /// <summary>
+        /// Records the directories of recursively enumerated entries, since entries added to or removed from them change
+        /// their timestamps rather than that of the enumerated directory.
+        /// </summary>
+        private IEnumerable<string> RecordEntries(IEnumerable<string> entries, SearchOption searchOption)
+        {
+            if (searchOption == SearchOption.TopDirectoryOnly)
+            {
+                return entries;
+            }
+
+            var recordedEntries = new List<string>();
+            foreach (string entry in entries)
+            {
+                Record(Path.GetDirectoryName(entry));
+                recordedEntries.Add(entry);
+            }
+
+            return recordedEntries;
+        }
+    }
+}
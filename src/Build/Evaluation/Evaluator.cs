@@ -202,7 +202,8 @@ namespace Microsoft.Build.Evaluation
             bool profileEvaluation,
             bool interactive,
             ILoggingService loggingService,
-            BuildEventContext buildEventContext)
+            BuildEventContext buildEventContext,
+            ISet<string> environmentVariablesRead)
         {
             ErrorUtilities.VerifyThrowInternalNull(data, nameof(data));
             ErrorUtilities.VerifyThrowInternalNull(projectRootElementCache, nameof(projectRootElementCache));
@@ -215,10 +216,11 @@ namespace Microsoft.Build.Evaluation
                 string.IsNullOrEmpty(projectRootElement.ProjectFileLocation.File) ? "(null)" : projectRootElement.ProjectFileLocation.File);
 
             // If someone sets the 'MsBuildLogPropertyTracking' environment variable to a non-zero value, wrap property accesses for event reporting.
-            if (Traits.Instance.LogPropertyTracking > 0)
+            // Also wrap them when the caller wants to know which environment variables the evaluation depends on.
+            if (Traits.Instance.LogPropertyTracking > 0 || environmentVariablesRead != null)
             {
                 // Wrap the IEvaluatorData<> object passed in.
-                data = new PropertyTrackingEvaluatorDataWrapper<P, I, M, D>(data, _evaluationLoggingContext, Traits.Instance.LogPropertyTracking);
+                data = new PropertyTrackingEvaluatorDataWrapper<P, I, M, D>(data, _evaluationLoggingContext, Traits.Instance.LogPropertyTracking, environmentVariablesRead);
             }
             _evaluationContext = evaluationContext ?? EvaluationContext.Create(EvaluationContext.SharingPolicy.Isolated);
 
@@ -296,7 +298,8 @@ namespace Microsoft.Build.Evaluation
             ISdkResolverService sdkResolverService,
             int submissionId,
             EvaluationContext evaluationContext = null,
-            bool interactive = false)
+            bool interactive = false,
+            ISet<string> environmentVariablesRead = null)
         {
             MSBuildEventSource.Log.EvaluateStart(root.ProjectFileLocation.File);
             var profileEvaluation = (loadSettings & ProjectLoadSettings.ProfileEvaluation) != 0 || loggingService.IncludeEvaluationProfile;
@@ -315,7 +318,8 @@ namespace Microsoft.Build.Evaluation
                 profileEvaluation,
                 interactive,
                 loggingService,
-                buildEventContext);
+                buildEventContext,
+                environmentVariablesRead);
 
             evaluator.Evaluate();
             MSBuildEventSource.Log.EvaluateStop(root.ProjectFileLocation.File);
@@ -1787,6 +1791,9 @@ namespace Microsoft.Build.Evaluation
                 // Combine SDK path with the "project" relative path
                 sdkResult = _sdkResolverService.ResolveSdk(_submissionId, sdkReference, _evaluationLoggingContext, importElement.Location, solutionPath, projectPath, _interactive, _isRunningInVisualStudio);
 
+                // Resolvers read global.json, NuGet configuration and package folders the file system doesn't see
+                RecordingFileSystem.MarkUntracked(_evaluationContext.FileSystem, sdkReference.ToString());
+
                 if (!sdkResult.Success)
                 {
                     if (_loadSettings.HasFlag(ProjectLoadSettings.IgnoreMissingImports) && (!ChangeWaves.AreFeaturesEnabled(ChangeWaves.Wave16_10) || !_loadSettings.HasFlag(ProjectLoadSettings.FailOnUnresolvedSdk)))
@@ -2190,7 +2197,7 @@ namespace Microsoft.Build.Evaluation
                         // Perhaps the import tag has a typo in, for example.
 
                         // There's a specific message for file not existing
-                        if (!FileSystems.Default.FileExists(importFileUnescaped))
+                        if (!_evaluationContext.FileSystem.FileExists(importFileUnescaped))
                         {
                             bool ignoreMissingImportsFlagSet = (_loadSettings & ProjectLoadSettings.IgnoreMissingImports) != 0;
                             if (!throwOnFileNotExistsError || ignoreMissingImportsFlagSet)
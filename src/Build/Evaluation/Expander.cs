@@ -13,6 +13,7 @@ using System.Reflection;
 using System.Runtime.CompilerServices;
 using System.Text.RegularExpressions;
 using Microsoft.Build.Collections;
+using Microsoft.Build.Evaluation.Context;
 using Microsoft.Build.Execution;
 using Microsoft.Build.Internal;
 using Microsoft.Build.Shared;
@@ -833,6 +834,17 @@ namespace Microsoft.Build.Evaluation
         /// </remarks>
         private static class MetadataExpander
         {
+            /// <summary>
+            /// The number of parsed expressions from which the cache of them is flushed, like the cache of condition expression trees.
+            /// </summary>
+            private const int MaxParsedExpressions = 3000;
+
+            /// <summary>
+            /// The metadata references of the expressions without item vectors expanded so far, so that batching, which expands the
+            /// same expressions for every bucket, doesn't match them with a regex every time.
+            /// </summary>
+            private static ConcurrentDictionary<string, ParsedMetadataExpression> s_parsedExpressions = new ConcurrentDictionary<string, ParsedMetadataExpression>(StringComparer.Ordinal);
+
             /// <summary>
             /// Expands all embedded item metadata in the given string, using the bucketed items.
             /// Metadata may be qualified, like %(Compile.WarningLevel), or unqualified, like %(Compile).
@@ -865,9 +877,8 @@ namespace Microsoft.Build.Evaluation
                     if (s_invariantCompareInfo.IndexOf(expression, "@(", CompareOptions.Ordinal) == -1)
                     {
                         // if there are no item vectors in the string
-                        // run a simpler Regex to find item metadata references
-                        MetadataMatchEvaluator matchEvaluator = new MetadataMatchEvaluator(metadata, options);
-                        result = RegularExpressions.ItemMetadataPattern.Value.Replace(expression, new MatchEvaluator(matchEvaluator.ExpandSingleMetadata));
+                        // expand the item metadata references found by a simpler Regex, once for each expression
+                        result = GetParsedExpression(expression).Expand(metadata, options);
                     }
                     else
                     {
@@ -947,6 +958,150 @@ namespace Microsoft.Build.Evaluation
                 return null;
             }
 
+            /// <summary>
+            /// Gets the metadata references of an expression without item vectors, parsing it the first time.
+            /// </summary>
+            private static ParsedMetadataExpression GetParsedExpression(string expression)
+            {
+                ConcurrentDictionary<string, ParsedMetadataExpression> parsedExpressions = s_parsedExpressions;
+                if (parsedExpressions.TryGetValue(expression, out ParsedMetadataExpression parsedExpression))
+                {
+                    return parsedExpression;
+                }
+
+                // Projects with generated metadata names could fill this cache without end, so clear it out when it gets large
+                if (parsedExpressions.Count >= MaxParsedExpressions)
+                {
+                    parsedExpressions = new ConcurrentDictionary<string, ParsedMetadataExpression>(StringComparer.Ordinal);
+                    s_parsedExpressions = parsedExpressions;
+                }
+
+                parsedExpression = new ParsedMetadataExpression(expression);
+                parsedExpressions.TryAdd(expression, parsedExpression);
+
+                return parsedExpression;
+            }
+
+            /// <summary>
+            /// An expression without item vectors, with the item metadata references that <see cref="RegularExpressions.ItemMetadataPattern"/>
+            /// matches in it. Expanding it appends the literal parts of the expression and the values of the metadata to a
+            /// <see cref="SpanBasedStringBuilder"/>, and returns the value of the metadata as is when the reference is the whole expression.
+            /// </summary>
+            private sealed class ParsedMetadataExpression
+            {
+                private readonly string _expression;
+
+                private readonly MetadataReference[] _references;
+
+                internal ParsedMetadataExpression(string expression)
+                {
+                    _expression = expression;
+
+                    MatchCollection matches = RegularExpressions.ItemMetadataPattern.Value.Matches(expression);
+                    _references = new MetadataReference[matches.Count];
+
+                    for (int i = 0; i < matches.Count; i++)
+                    {
+                        Match match = matches[i];
+                        string name = match.Groups[RegularExpressions.NameGroup].Value;
+
+                        _references[i] = new MetadataReference(
+                            match.Index,
+                            match.Length,
+                            match.Groups[RegularExpressions.ItemSpecificationGroup].Length > 0 ? match.Groups[RegularExpressions.ItemTypeGroup].Value : null,
+                            name,
+                            FileUtilities.ItemSpecModifiers.IsItemSpecModifier(name));
+                    }
+                }
+
+                /// <summary>
+                /// Expands the metadata references, like <see cref="MetadataMatchEvaluator.ExpandSingleMetadata"/>.
+                /// </summary>
+                internal string Expand(IMetadataTable metadata, ExpanderOptions options)
+                {
+                    MetadataReference[] references = _references;
+                    if (references.Length == 0)
+                    {
+                        return _expression;
+                    }
+
+                    if (references.Length == 1 && references[0].Length == _expression.Length)
+                    {
+                        return GetValue(references[0], metadata, options) ?? _expression;
+                    }
+
+                    using SpanBasedStringBuilder builder = Strings.GetSpanBasedStringBuilder();
+
+                    int start = 0;
+                    foreach (MetadataReference reference in references)
+                    {
+                        builder.Append(_expression, start, reference.Index - start);
+
+                        string value = GetValue(reference, metadata, options);
+                        if (value == null)
+                        {
+                            builder.Append(_expression, reference.Index, reference.Length);
+                        }
+                        else
+                        {
+                            builder.Append(value);
+                        }
+
+                        start = reference.Index + reference.Length;
+                    }
+
+                    builder.Append(_expression, start, _expression.Length - start);
+
+                    return builder.ToString();
+                }
+
+                /// <returns>The escaped value of the metadata, or null if the options don't expand it</returns>
+                private static string GetValue(MetadataReference reference, IMetadataTable metadata, ExpanderOptions options)
+                {
+                    if ((reference.IsBuiltIn && ((options & ExpanderOptions.ExpandBuiltInMetadata) == 0)) ||
+                        (!reference.IsBuiltIn && ((options & ExpanderOptions.ExpandCustomMetadata) == 0)))
+                    {
+                        return null;
+                    }
+
+                    string value = metadata.GetEscapedValue(reference.ItemType, reference.Name);
+                    if (IsTruncationEnabled(options) && value.Length > CharacterLimitPerExpansion)
+                    {
+                        value = value.Substring(0, CharacterLimitPerExpansion - 3) + "...";
+                    }
+
+                    return value;
+                }
+            }
+
+            /// <summary>
+            /// An item metadata reference, like %(Compile.WarningLevel), and its position in the expression.
+            /// </summary>
+            private readonly struct MetadataReference
+            {
+                internal MetadataReference(int index, int length, string itemType, string name, bool isBuiltIn)
+                {
+                    Index = index;
+                    Length = length;
+                    ItemType = itemType;
+                    Name = name;
+                    IsBuiltIn = isBuiltIn;
+                }
+
+                internal int Index { get; }
+
+                internal int Length { get; }
+
+                /// <summary>
+                /// The item type qualifying the metadata, or null if it isn't qualified.
+                /// </summary>
+                internal string ItemType { get; }
+
+                internal string Name { get; }
+
+                internal bool IsBuiltIn { get; }
+            }
+
             /// <summary>
             /// A functor that returns the value of the metadata in the match
             /// that is contained in the metadata dictionary it was created with.
@@ -1163,6 +1318,7 @@ namespace Microsoft.Build.Evaluation
 
                             // If the property body starts with any of our special objects, then deal with them
                             // This is a registry reference, like $(Registry:HKEY_LOCAL_MACHINE\Software\Vendor\Tools@TaskLocation)
+                            RecordingFileSystem.MarkUntracked(fileSystem, propertyBody);
                             propertyValue = ExpandRegistryValue(propertyBody, elementLocation); // This func returns an empty string if not FEATURE_WIN32_REGISTRY
                         }
 
@@ -2333,7 +2489,7 @@ namespace Microsoft.Build.Evaluation
                             ProjectErrorUtilities.ThrowInvalidProject(elementLocation, "InvalidItemFunctionExpression", functionName, item.Key, e.Message);
                         }
 
-                        if (File.Exists(rootedPath) || Directory.Exists(rootedPath))
+                        if (expander._fileSystem.FileOrDirectoryExists(rootedPath))
                         {
                             yield return item;
                         }
@@ -3341,6 +3497,11 @@ namespace Microsoft.Build.Evaluation
                             ProjectErrorUtilities.ThrowInvalidProject(elementLocation, "InvalidFunctionMethodUnavailable", _methodMethodName, _receiverType.FullName);
                         }
 
+                        if (ReadsUntrackedState(_receiverType, _methodMethodName))
+                        {
+                            RecordingFileSystem.MarkUntracked(_fileSystem, _receiverType.FullName + "::" + _methodMethodName);
+                        }
+
                         _bindingFlags |= BindingFlags.Static;
 
                         // For our intrinsic function we need to support calling of internal methods
@@ -5017,6 +5178,52 @@ namespace Microsoft.Build.Evaluation
                 return AvailableStaticMethods.GetTypeInformationFromTypeCache(receiverType.FullName, methodName) != null;
             }
 
+            /// <summary>
+            /// Whether the static method reads the file system, the registry, the environment or the clock on its own, or returns
+            /// a new value each time, rather than depending only on its arguments and the file system and properties of the evaluation.
+            /// </summary>
+            private static bool ReadsUntrackedState(Type receiverType, string methodName)
+            {
+                if (receiverType == typeof(Microsoft.Build.Evaluation.IntrinsicFunctions))
+                {
+                    return String.Equals(methodName, nameof(IntrinsicFunctions.GetRegistryValue), StringComparison.OrdinalIgnoreCase) ||
+                           String.Equals(methodName, nameof(IntrinsicFunctions.GetRegistryValueFromView), StringComparison.OrdinalIgnoreCase) ||
+                           String.Equals(methodName, nameof(IntrinsicFunctions.DoesTaskHostExist), StringComparison.OrdinalIgnoreCase);
+                }
+
+                if (receiverType == typeof(Environment))
+                {
+                    // Everything else describes the process, the machine or the user running the build
+                    return !String.Equals(methodName, nameof(Environment.NewLine), StringComparison.OrdinalIgnoreCase) &&
+                           !String.Equals(methodName, nameof(Environment.Is64BitOperatingSystem), StringComparison.OrdinalIgnoreCase) &&
+                           !String.Equals(methodName, nameof(Environment.Is64BitProcess), StringComparison.OrdinalIgnoreCase);
+                }
+
+                if (receiverType == typeof(DateTime))
+                {
+                    return String.Equals(methodName, nameof(DateTime.Now), StringComparison.OrdinalIgnoreCase) ||
+                           String.Equals(methodName, nameof(DateTime.UtcNow), StringComparison.OrdinalIgnoreCase) ||
+                           String.Equals(methodName, nameof(DateTime.Today), StringComparison.OrdinalIgnoreCase);
+                }
+
+                if (receiverType == typeof(Guid))
+                {
+                    return String.Equals(methodName, nameof(Guid.NewGuid), StringComparison.OrdinalIgnoreCase);
+                }
+
+                if (receiverType == typeof(Path))
+                {
+                    return String.Equals(methodName, nameof(Path.GetTempPath), StringComparison.OrdinalIgnoreCase) ||
+                           String.Equals(methodName, nameof(Path.GetTempFileName), StringComparison.OrdinalIgnoreCase) ||
+                           String.Equals(methodName, nameof(Path.GetRandomFileName), StringComparison.OrdinalIgnoreCase);
+                }
+
+                return receiverType == typeof(File) ||
+                       receiverType == typeof(Directory) ||
+                       String.Equals(receiverType.FullName, "Microsoft.Build.Utilities.ToolLocationHelper", StringComparison.Ordinal) ||
+                       receiverType.FullName.StartsWith("Microsoft.Win32.Registry", StringComparison.Ordinal);
+            }
+
             /// <summary>
             /// Construct and instance of objectType based on the constructor or method arguments provided.
             /// Arguments must never be null.
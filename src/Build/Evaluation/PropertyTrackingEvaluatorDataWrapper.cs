@@ -32,6 +32,7 @@ namespace Microsoft.Build.Evaluation
         private readonly HashSet<string> _overwrittenEnvironmentVariables = new HashSet<string>(StringComparer.OrdinalIgnoreCase);
         private readonly EvaluationLoggingContext _evaluationLoggingContext;
         private readonly PropertyTrackingSetting _settings;
+        private readonly ISet<string> _environmentVariablesRead;
 
         /// <summary>
         /// Creates an instance of the PropertyTrackingEvaluatorDataWrapper class.
@@ -39,7 +40,11 @@ namespace Microsoft.Build.Evaluation
         /// <param name="dataToWrap">The underlying <see cref="IEvaluatorData{P,I,M,D}"/> to wrap for property tracking.</param>
         /// <param name="evaluationLoggingContext">The <see cref="EvaluationLoggingContext"/> used to log relevant events.</param>
         /// <param name="settingValue">Property tracking setting value</param>
-        public PropertyTrackingEvaluatorDataWrapper(IEvaluatorData<P, I, M, D> dataToWrap, EvaluationLoggingContext evaluationLoggingContext, int settingValue)
+        /// <param name="environmentVariablesRead">
+        /// When not null, collects the names of the environment variables the evaluation read, and of the properties it read before
+        /// they were defined, which an environment variable would have defined.
+        /// </param>
+        public PropertyTrackingEvaluatorDataWrapper(IEvaluatorData<P, I, M, D> dataToWrap, EvaluationLoggingContext evaluationLoggingContext, int settingValue, ISet<string> environmentVariablesRead = null)
         {
             ErrorUtilities.VerifyThrowInternalNull(dataToWrap, nameof(dataToWrap));
             ErrorUtilities.VerifyThrowInternalNull(evaluationLoggingContext, nameof(evaluationLoggingContext));
@@ -47,6 +52,7 @@ namespace Microsoft.Build.Evaluation
             _wrapped = dataToWrap;
             _evaluationLoggingContext = evaluationLoggingContext;
             _settings = (PropertyTrackingSetting)settingValue;
+            _environmentVariablesRead = environmentVariablesRead;
         }
 
         #region IEvaluatorData<> members with tracking-related code in them.
@@ -169,10 +175,12 @@ namespace Microsoft.Build.Evaluation
             // track it as an environment variable read.
             if (_wrapped.EnvironmentVariablePropertiesDictionary.Contains(name) && !_overwrittenEnvironmentVariables.Contains(name))
             {
+                _environmentVariablesRead?.Add(name);
                 this.TrackEnvironmentVariableRead(name);
             }
             else if (property == null)
             {
+                _environmentVariablesRead?.Add(name);
                 this.TrackUninitializedPropertyRead(name);
             }
         }
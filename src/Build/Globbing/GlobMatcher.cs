@@ -0,0 +1,225 @@
+﻿// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using Microsoft.Build.Shared;
+
+namespace Microsoft.Build.Globbing
+{
+    /// <summary>
+    ///     Matches paths against the common shapes of globs without the regular expression that
+    ///     <see cref="FileMatcher.RegularExpressionFromFileSpec" /> builds for them, and with the same results:
+    ///     - literal paths: "a/b/c.cs"
+    ///     - file name patterns of literals and "*", in the fixed directory or under it: "a/*.cs", "a/**/*.cs", "a/**"
+    ///     Globs of any other shape, with "?", wildcards in directories, or file names with a trailing dot, need the regex.
+    /// </summary>
+    /// <remarks>
+    ///     Matching compares the literal runs of the glob with ordinal case insensitive comparisons, which .NET Core vectorizes,
+    ///     and doesn't allocate.
+    /// </remarks>
+    internal sealed class GlobMatcher
+    {
+        private static readonly char[] s_slashes = FileUtilities.Slashes;
+
+        /// <summary>
+        ///     The fixed directory part, with a trailing slash and no repeated slashes.
+        /// </summary>
+        private readonly string _fixedDirectoryPart;
+
+        /// <summary>
+        ///     Whether the wildcard directory part is "**/", so that the file name can be in any directory under the fixed one.
+        /// </summary>
+        private readonly bool _isRecursive;
+
+        /// <summary>
+        ///     The literals of the file name part between its "*" wildcards. A single literal means there is no wildcard.
+        /// </summary>
+        private readonly string[] _filenameLiterals;
+
+        private GlobMatcher(string fixedDirectoryPart, bool isRecursive, string[] filenameLiterals)
+        {
+            _fixedDirectoryPart = fixedDirectoryPart;
+            _isRecursive = isRecursive;
+            _filenameLiterals = filenameLiterals;
+        }
+
+        /// <summary>
+        ///     Creates a matcher for the parts of a legal glob whose fixed directory part is a full path.
+        /// </summary>
+        /// <returns>The matcher, or null if the glob needs a regex to be matched</returns>
+        internal static GlobMatcher TryCreate(string fixedDirectoryPart, string wildcardDirectoryPart, string filenamePart)
+        {
+            if (fixedDirectoryPart.Length == 0 || !FileUtilities.IsAnySlash(fixedDirectoryPart[fixedDirectoryPart.Length - 1]))
+            {
+                return null;
+            }
+
+            // The regex collapses repeated slashes and "/./" in the fixed directory part, and keeps the leading ones of UNC paths
+            for (int i = 0; i < fixedDirectoryPart.Length - 1; i++)
+            {
+                if (FileUtilities.IsAnySlash(fixedDirectoryPart[i]) &&
+                    (FileUtilities.IsAnySlash(fixedDirectoryPart[i + 1]) ||
+                     (fixedDirectoryPart[i + 1] == '.' && i + 2 < fixedDirectoryPart.Length && FileUtilities.IsAnySlash(fixedDirectoryPart[i + 2]))))
+                {
+                    return null;
+                }
+            }
+
+            bool isRecursive;
+            if (wildcardDirectoryPart.Length == 0)
+            {
+                isRecursive = false;
+            }
+            else if (wildcardDirectoryPart.Length == 3 &&
+                     wildcardDirectoryPart[0] == '*' &&
+                     wildcardDirectoryPart[1] == '*' &&
+                     FileUtilities.IsAnySlash(wildcardDirectoryPart[2]))
+            {
+                isRecursive = true;
+            }
+            else
+            {
+                return null;
+            }
+
+            if (filenamePart.IndexOf('?') >= 0 ||
+                filenamePart.IndexOfAny(s_slashes) >= 0 ||
+                (filenamePart.Length > 0 && filenamePart[filenamePart.Length - 1] == '.'))
+            {
+                return null;
+            }
+
+            // Like the regex, treat "*.*" as "*"
+            string filenamePattern = filenamePart.Contains("*.*") ? filenamePart.Replace("*.*", "*") : filenamePart;
+
+            return new GlobMatcher(fixedDirectoryPart, isRecursive, filenamePattern.Split('*'));
+        }
+
+        /// <summary>
+        ///     Matches a full path against the glob.
+        /// </summary>
+        internal bool IsMatch(string path)
+        {
+            // Like the regex, whose end of line anchor also matches before a final line break
+            return IsMatch(path, path.Length) ||
+                   (path.Length > 0 && path[path.Length - 1] == '\n' && IsMatch(path, path.Length - 1));
+        }
+
+        /// <summary>
+        ///     Matches the first <paramref name="length" /> characters of a path against the glob.
+        /// </summary>
+        private bool IsMatch(string path, int length)
+        {
+            int filenameStart = MatchFixedDirectoryPart(path, length);
+            if (filenameStart < 0)
+            {
+                return false;
+            }
+
+            int lastSlash = length == 0 ? -1 : path.LastIndexOfAny(s_slashes, length - 1);
+            if (lastSlash >= filenameStart)
+            {
+                // Only the recursive wildcard matches directories after the fixed ones, and like "." in the regex, not line breaks
+                if (!_isRecursive || path.IndexOf('\n', filenameStart, lastSlash - filenameStart) >= 0)
+                {
+                    return false;
+                }
+
+                filenameStart = lastSlash + 1;
+            }
+
+            return MatchFilename(path, filenameStart, length);
+        }
+
+        /// <summary>
+        ///     Matches the start of a path against the fixed directory part, where each slash matches a sequence of slashes.
+        /// </summary>
+        /// <returns>The index in the path after the fixed directory part, or -1 if it doesn't match</returns>
+        private int MatchFixedDirectoryPart(string path, int length)
+        {
+            string fixedDirectoryPart = _fixedDirectoryPart;
+            int pathIndex = 0;
+            int fixedIndex = 0;
+
+            while (fixedIndex < fixedDirectoryPart.Length)
+            {
+                if (FileUtilities.IsAnySlash(fixedDirectoryPart[fixedIndex]))
+                {
+                    if (pathIndex >= length || !FileUtilities.IsAnySlash(path[pathIndex]))
+                    {
+                        return -1;
+                    }
+
+                    do
+                    {
+                        pathIndex++;
+                    }
+                    while (pathIndex < length && FileUtilities.IsAnySlash(path[pathIndex]));
+
+                    fixedIndex++;
+                    continue;
+                }
+
+                // The fixed directory part ends with a slash, so every run of it ends before one
+                int runLength = fixedDirectoryPart.IndexOfAny(s_slashes, fixedIndex) - fixedIndex;
+                if (length - pathIndex < runLength ||
+                    string.Compare(path, pathIndex, fixedDirectoryPart, fixedIndex, runLength, StringComparison.OrdinalIgnoreCase) != 0)
+                {
+                    return -1;
+                }
+
+                pathIndex += runLength;
+                fixedIndex += runLength;
+            }
+
+            return pathIndex;
+        }
+
+        /// <summary>
+        ///     Matches the characters of a path from <paramref name="start" /> to <paramref name="length" />, which have no slashes,
+        ///     against the literals of the file name part.
+        ///     Matching each literal between wildcards at its first occurrence leaves the most room for the following ones.
+        /// </summary>
+        private bool MatchFilename(string path, int start, int length)
+        {
+            string[] literals = _filenameLiterals;
+            string first = literals[0];
+
+            if (literals.Length == 1)
+            {
+                return length - start == first.Length &&
+                       string.Compare(path, start, first, 0, first.Length, StringComparison.OrdinalIgnoreCase) == 0;
+            }
+
+            string last = literals[literals.Length - 1];
+            int end = length - last.Length;
+
+            if (end - start < first.Length ||
+                string.Compare(path, start, first, 0, first.Length, StringComparison.OrdinalIgnoreCase) != 0 ||
+                string.Compare(path, end, last, 0, last.Length, StringComparison.OrdinalIgnoreCase) != 0)
+            {
+                return false;
+            }
+
+            int index = start + first.Length;
+            for (int i = 1; i < literals.Length - 1; i++)
+            {
+                string literal = literals[i];
+                if (literal.Length == 0)
+                {
+                    continue;
+                }
+
+                int found = path.IndexOf(literal, index, end - index, StringComparison.OrdinalIgnoreCase);
+                if (found < 0)
+                {
+                    return false;
+                }
+
+                index = found + literal.Length;
+            }
+
+            return true;
+        }
+    }
+}
@@ -30,9 +30,17 @@ namespace Microsoft.Build.Globbing
             public string WildcardDirectoryPart { get; }
             public string FilenamePart { get; }
             public bool NeedsRecursion { get; }
-            public Regex Regex { get; }
+            public Regex Regex => _regex?.Value;
 
-            public GlobState(string globRoot, string fileSpec, bool isLegal, string fixedDirectoryPart, string wildcardDirectoryPart, string filenamePart, bool needsRecursion, Regex regex)
+            /// <summary>
+            ///     Matches the glob without its regex, when it has one of the common shapes.
+            /// </summary>
+            public GlobMatcher Matcher { get; }
+
+            // Only created when needed, since globs with a matcher rarely need it
+            private readonly Lazy<Regex> _regex;
+
+            public GlobState(string globRoot, string fileSpec, bool isLegal, string fixedDirectoryPart, string wildcardDirectoryPart, string filenamePart, bool needsRecursion, Lazy<Regex> regex, GlobMatcher matcher)
             {
                 GlobRoot = globRoot;
                 FileSpec = fileSpec;
@@ -41,7 +49,8 @@ namespace Microsoft.Build.Globbing
                 WildcardDirectoryPart = wildcardDirectoryPart;
                 FilenamePart = filenamePart;
                 NeedsRecursion = needsRecursion;
-                Regex = regex;
+                Matcher = matcher;
+                _regex = regex;
             }
         }
 
@@ -104,7 +113,7 @@ namespace Microsoft.Build.Globbing
 
             var normalizedString = NormalizeMatchInput(stringToMatch);
 
-            return _state.Value.Regex.IsMatch(normalizedString);
+            return _state.Value.Matcher?.IsMatch(normalizedString) ?? _state.Value.Regex.IsMatch(normalizedString);
         }
 
         /// <summary>
@@ -194,47 +203,57 @@ namespace Microsoft.Build.Globbing
                         return (normalizedFixedPart, wildcardDirPart, filePart);
                     });
 
-                Regex regex = null;
+                Lazy<Regex> regex = null;
+                GlobMatcher matcher = null;
                 if (isLegalFileSpec)
                 {
                     string matchFileExpression = FileMatcher.RegularExpressionFromFileSpec(fixedDirectoryPart, wildcardDirectoryPart, filenamePart);
 
-                    lock (s_regexCache)
-                    {
-                        s_regexCache.TryGetValue(matchFileExpression, out regex);
-                    }
+                    regex = new Lazy<Regex>(() => GetRegex(matchFileExpression), true);
+                    matcher = GlobMatcher.TryCreate(fixedDirectoryPart, wildcardDirectoryPart, filenamePart);
+                }
+                return new GlobState(globRoot, fileSpec, isLegalFileSpec, fixedDirectoryPart, wildcardDirectoryPart, filenamePart, needsRecursion, regex, matcher);
+            },
+            true);
 
-                    if (regex == null)
-                    {
-                        RegexOptions regexOptions = FileMatcher.DefaultRegexOptions;
-                        // compile the regex since it's expected to be used multiple times
-                        // For the kind of regexes used here, compilation on .NET Framework tends to be expensive and not worth the small
-                        // run-time boost so it's enabled only on .NET Core by default.
+            return new MSBuildGlob(lazyState);
+        }
+
+        private static Regex GetRegex(string matchFileExpression)
+        {
+            Regex regex;
+            lock (s_regexCache)
+            {
+                s_regexCache.TryGetValue(matchFileExpression, out regex);
+            }
+
+            if (regex == null)
+            {
+                RegexOptions regexOptions = FileMatcher.DefaultRegexOptions;
+                // compile the regex since it's expected to be used multiple times
+                // For the kind of regexes used here, compilation on .NET Framework tends to be expensive and not worth the small
+                // run-time boost so it's enabled only on .NET Core by default.
 #if RUNTIME_TYPE_NETCORE
-                        bool compileRegex = true;
+                bool compileRegex = true;
 #else
-                        bool compileRegex = !ChangeWaves.AreFeaturesEnabled(ChangeWaves.Wave17_0);
+                bool compileRegex = !ChangeWaves.AreFeaturesEnabled(ChangeWaves.Wave17_0);
 #endif
-                        if (compileRegex)
-                        {
-                            regexOptions |= RegexOptions.Compiled;
-                        }
-                        Regex newRegex = new Regex(matchFileExpression, regexOptions);
-                        lock (s_regexCache)
-                        {
-                            if (!s_regexCache.TryGetValue(matchFileExpression, out regex))
-                            {
-                                s_regexCache[matchFileExpression] = newRegex;
-                            }
-                        }
-                        regex ??= newRegex;
+                if (compileRegex)
+                {
+                    regexOptions |= RegexOptions.Compiled;
+                }
+                Regex newRegex = new Regex(matchFileExpression, regexOptions);
+                lock (s_regexCache)
+                {
+                    if (!s_regexCache.TryGetValue(matchFileExpression, out regex))
+                    {
+                        s_regexCache[matchFileExpression] = newRegex;
                     }
                 }
-                return new GlobState(globRoot, fileSpec, isLegalFileSpec, fixedDirectoryPart, wildcardDirectoryPart, filenamePart, needsRecursion, regex);
-            },
-            true);
+                regex ??= newRegex;
+            }
 
-            return new MSBuildGlob(lazyState);
+            return regex;
         }
 
         private static string NormalizeTheFixedDirectoryPartAgainstTheGlobRoot(string fixedDirPart, string globRoot)
@@ -44,6 +44,8 @@ namespace Microsoft.Build.Graph
         private readonly ProjectInterpretation _projectInterpretation;
 
         private readonly ProjectGraph.ProjectInstanceFactoryFunc _projectInstanceFactory;
+
+        private readonly ProjectGraphCache _graphCache;
         private IReadOnlyDictionary<string, IReadOnlyCollection<string>> _solutionDependencies;
 
         public GraphBuilder(
@@ -52,7 +54,8 @@ namespace Microsoft.Build.Graph
             ProjectGraph.ProjectInstanceFactoryFunc projectInstanceFactory,
             ProjectInterpretation projectInterpretation,
             int degreeOfParallelism,
-            CancellationToken cancellationToken)
+            CancellationToken cancellationToken,
+            ProjectGraphCache graphCache = null)
         {
             var (actualEntryPoints, solutionDependencies) = ExpandSolutionIfPresent(entryPoints.ToImmutableArray());
 
@@ -70,6 +73,7 @@ namespace Microsoft.Build.Graph
             _projectCollection = projectCollection;
             _projectInstanceFactory = projectInstanceFactory;
             _projectInterpretation = projectInterpretation;
+            _graphCache = graphCache;
         }
 
         public void BuildGraph()
@@ -493,13 +497,16 @@ namespace Microsoft.Build.Graph
 
         private ParsedProject ParseProject(ConfigurationMetadata configurationMetadata)
         {
-            // TODO: ProjectInstance just converts the dictionary back to a PropertyDictionary, so find a way to directly provide it.
-            var globalProperties = configurationMetadata.GlobalProperties.ToDictionary();
+            if (_graphCache == null || !_graphCache.TryGetProjectInstance(configurationMetadata, _projectCollection.LoggingService, out ProjectInstance projectInstance))
+            {
+                // TODO: ProjectInstance just converts the dictionary back to a PropertyDictionary, so find a way to directly provide it.
+                var globalProperties = configurationMetadata.GlobalProperties.ToDictionary();
 
-            var projectInstance = _projectInstanceFactory(
-                configurationMetadata.ProjectFullPath,
-                globalProperties,
-                _projectCollection);
+                projectInstance = _projectInstanceFactory(
+                    configurationMetadata.ProjectFullPath,
+                    globalProperties,
+                    _projectCollection);
+            }
 
             if (projectInstance == null)
             {
@@ -412,6 +412,27 @@ namespace Microsoft.Build.Graph
             ProjectInstanceFactoryFunc projectInstanceFactory,
             int degreeOfParallelism,
             CancellationToken cancellationToken)
+            : this(
+                entryPoints,
+                projectCollection,
+                projectInstanceFactory,
+                degreeOfParallelism,
+                cancellationToken,
+                graphCache: null)
+        {
+        }
+
+        /// <summary>
+        ///     Constructs a graph starting from the given graph entry points, reusing the evaluations of the projects
+        ///     in <paramref name="graphCache" /> whose files haven't changed instead of calling <paramref name="projectInstanceFactory" />.
+        /// </summary>
+        internal ProjectGraph(
+            IEnumerable<ProjectGraphEntryPoint> entryPoints,
+            ProjectCollection projectCollection,
+            ProjectInstanceFactoryFunc projectInstanceFactory,
+            int degreeOfParallelism,
+            CancellationToken cancellationToken,
+            ProjectGraphCache graphCache)
         {
             ErrorUtilities.VerifyThrowArgumentNull(projectCollection, nameof(projectCollection));
 
@@ -425,7 +446,8 @@ namespace Microsoft.Build.Graph
                 projectInstanceFactory,
                 ProjectInterpretation.Instance,
                 degreeOfParallelism,
-                cancellationToken);
+                cancellationToken,
+                graphCache);
             graphBuilder.BuildGraph();
 
             EntryPointNodes = graphBuilder.EntryPointNodes;
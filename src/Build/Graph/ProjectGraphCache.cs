@@ -0,0 +1,176 @@
+﻿// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.IO;
+using Microsoft.Build.BackEnd;
+using Microsoft.Build.BackEnd.Logging;
+using Microsoft.Build.Collections;
+using Microsoft.Build.Evaluation;
+using Microsoft.Build.Framework;
+using Microsoft.Build.Execution;
+using Microsoft.Build.Shared;
+
+namespace Microsoft.Build.Graph
+{
+    /// <summary>
+    /// The evaluated projects of a project graph persisted to disk, so that the next graph constructed with the same MSBuild
+    /// can reuse the evaluations of the projects whose inputs haven't changed, as told by <see cref="ProjectInstanceSnapshot"/>.
+    /// </summary>
+    internal sealed class ProjectGraphCache
+    {
+        private const int FormatVersion = 1;
+
+        private readonly Dictionary<ConfigurationMetadata, ProjectInstanceSnapshot> _entries;
+
+        private readonly PropertyDictionary<ProjectPropertyInstance> _environmentProperties;
+
+        private readonly ProjectRootElementCacheBase _projectRootElementCache;
+
+        /// <summary>
+        /// The snapshots of the project instances that were reused, to persist them again without translating them.
+        /// </summary>
+        private readonly ConcurrentDictionary<ProjectInstance, ProjectInstanceSnapshot> _reusedEntries = new ConcurrentDictionary<ProjectInstance, ProjectInstanceSnapshot>();
+
+        private ProjectGraphCache(
+            Dictionary<ConfigurationMetadata, ProjectInstanceSnapshot> entries,
+            PropertyDictionary<ProjectPropertyInstance> environmentProperties,
+            ProjectRootElementCacheBase projectRootElementCache)
+        {
+            _entries = entries;
+            _environmentProperties = environmentProperties;
+            _projectRootElementCache = projectRootElementCache;
+        }
+
+        /// <summary>
+        /// The number of projects that were reused rather than evaluated.
+        /// </summary>
+        internal int ReusedCount => _reusedEntries.Count;
+
+        /// <summary>
+        /// Loads the persisted graph, or an empty one when there is none or it was persisted by another MSBuild.
+        /// </summary>
+        /// <param name="cacheFile">The file the graph was persisted to</param>
+        /// <param name="environmentProperties">The environment the projects of the graph are evaluated with</param>
+        /// <param name="projectRootElementCache">The cache the projects of the graph are evaluated from</param>
+        internal static ProjectGraphCache Load(
+            string cacheFile,
+            PropertyDictionary<ProjectPropertyInstance> environmentProperties,
+            ProjectRootElementCacheBase projectRootElementCache)
+        {
+            var entries = new Dictionary<ConfigurationMetadata, ProjectInstanceSnapshot>();
+
+            try
+            {
+                if (File.Exists(cacheFile))
+                {
+                    using var fileStream = File.OpenRead(cacheFile);
+                    using var translator = BinaryTranslator.GetReadTranslator(fileStream, null);
+
+                    int version = 0;
+                    translator.Translate(ref version);
+
+                    if (version == FormatVersion && ProjectInstanceSnapshot.TranslateEngine(translator))
+                    {
+                        int count = 0;
+                        translator.Translate(ref count);
+
+                        for (int i = 0; i < count; i++)
+                        {
+                            var configuration = new ConfigurationMetadata(translator);
+                            entries[configuration] = ProjectInstanceSnapshot.FactoryForDeserialization(translator);
+                        }
+                    }
+                }
+            }
+            catch (Exception e) when (!ExceptionHandling.IsCriticalException(e))
+            {
+                // A missing or corrupt cache only means that every project is evaluated
+                entries.Clear();
+            }
+
+            return new ProjectGraphCache(entries, environmentProperties, projectRootElementCache);
+        }
+
+        /// <summary>
+        /// Gets the persisted evaluation of a project if none of its files changed since.
+        /// Called concurrently by the workers constructing the graph, which deserialize the projects in parallel.
+        /// </summary>
+        /// <param name="configuration">The project and global properties to get the evaluation of</param>
+        /// <param name="loggingService">The logging service the evaluation would be logged to</param>
+        /// <param name="projectInstance">The project instance, or null</param>
+        internal bool TryGetProjectInstance(ConfigurationMetadata configuration, ILoggingService loggingService, out ProjectInstance projectInstance)
+        {
+            if (_entries.TryGetValue(configuration, out ProjectInstanceSnapshot entry) && entry.IsUpToDate(_environmentProperties, _projectRootElementCache))
+            {
+                try
+                {
+                    // Graphs are constructed outside of any build submission
+                    projectInstance = entry.CreateProjectInstance(loggingService, BuildEventContext.Invalid);
+                    _reusedEntries[projectInstance] = entry;
+                    return true;
+                }
+                catch (Exception e) when (!ExceptionHandling.IsCriticalException(e))
+                {
+                    // Evaluate the project instead
+                }
+            }
+
+            projectInstance = null;
+            return false;
+        }
+
+        /// <summary>
+        /// Persists the projects of a graph, unless it consists exactly of the projects that were reused.
+        /// </summary>
+        internal void Save(string cacheFile, ProjectGraph graph)
+        {
+            if (_reusedEntries.Count == graph.ProjectNodes.Count && _entries.Count == graph.ProjectNodes.Count)
+            {
+                return;
+            }
+
+            try
+            {
+                string fullPath = FileUtilities.NormalizePath(cacheFile);
+                Directory.CreateDirectory(Path.GetDirectoryName(fullPath));
+
+                using var fileStream = new FileStream(fullPath, FileMode.Create, FileAccess.Write);
+                var translator = BinaryTranslator.GetWriteTranslator(fileStream);
+
+                int version = FormatVersion;
+                translator.Translate(ref version);
+                ProjectInstanceSnapshot.TranslateEngine(translator);
+
+                var entries = new List<(ConfigurationMetadata Configuration, ProjectInstanceSnapshot Snapshot)>(graph.ProjectNodes.Count);
+                foreach (ProjectGraphNode node in graph.ProjectNodes)
+                {
+                    ProjectInstanceSnapshot snapshot = _reusedEntries.TryGetValue(node.ProjectInstance, out ProjectInstanceSnapshot reusedEntry)
+                        ? reusedEntry
+                        : ProjectInstanceSnapshot.Create(node.ProjectInstance);
+
+                    // Instances from factories that didn't record what they read from the environment are evaluated again
+                    if (snapshot != null)
+                    {
+                        entries.Add((node.ToConfigurationMetadata(), snapshot));
+                    }
+                }
+
+                int count = entries.Count;
+                translator.Translate(ref count);
+
+                foreach (var entry in entries)
+                {
+                    entry.Configuration.Translate(translator);
+                    entry.Snapshot.Translate(translator);
+                }
+            }
+            catch (Exception e) when (ExceptionHandling.IsIoRelatedException(e))
+            {
+                // Not persisting the graph only means that the next one is evaluated from scratch
+            }
+        }
+    }
+}
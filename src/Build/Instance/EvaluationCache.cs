@@ -0,0 +1,185 @@
+﻿// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using System.Security.Cryptography;
+using System.Text;
+using Microsoft.Build.BackEnd;
+using Microsoft.Build.BackEnd.Logging;
+using Microsoft.Build.Collections;
+using Microsoft.Build.Evaluation;
+using Microsoft.Build.Framework;
+using Microsoft.Build.Shared;
+
+namespace Microsoft.Build.Execution
+{
+    /// <summary>
+    /// The evaluations of the projects that builds loaded, persisted to a directory with one file per project and set of
+    /// global properties, so that later builds with the same MSBuild can reuse those whose inputs haven't changed,
+    /// as told by <see cref="ProjectInstanceSnapshot"/>, instead of evaluating them again.
+    /// </summary>
+    /// <remarks>
+    /// Each file is replaced as a whole, so concurrent builds sharing the directory at worst evaluate a project again.
+    /// </remarks>
+    internal sealed class EvaluationCache
+    {
+        private const int FormatVersion = 1;
+
+        private readonly string _directory;
+
+        private readonly string _key;
+
+        /// <summary>
+        /// Creates the cache entry of a project evaluated with the given settings.
+        /// </summary>
+        internal EvaluationCache(
+            string directory,
+            string projectFullPath,
+            IDictionary<string, string> globalProperties,
+            string toolsVersionOverride,
+            ProjectLoadSettings projectLoadSettings)
+        {
+            _directory = directory;
+
+            var key = new StringBuilder();
+            key.Append(projectFullPath).Append('\n');
+            key.Append(toolsVersionOverride).Append('\n');
+            key.Append((int)projectLoadSettings).Append('\n');
+
+            foreach (KeyValuePair<string, string> property in globalProperties.OrderBy(p => p.Key, StringComparer.OrdinalIgnoreCase))
+            {
+                key.Append(property.Key).Append('=').Append(property.Value).Append('\n');
+            }
+
+            _key = key.ToString();
+        }
+
+        private string EntryPath
+        {
+            get
+            {
+                using var sha256 = SHA256.Create();
+                byte[] hash = sha256.ComputeHash(Encoding.UTF8.GetBytes(_key));
+
+                var fileName = new StringBuilder(hash.Length * 2);
+                foreach (byte b in hash)
+                {
+                    fileName.Append(b.ToString("x2"));
+                }
+
+                return Path.Combine(_directory, fileName.Append(".evaluation").ToString());
+            }
+        }
+
+        /// <summary>
+        /// Gets the persisted evaluation of the project if none of what it depended on changed since.
+        /// </summary>
+        /// <param name="environmentProperties">The environment the project would be evaluated with</param>
+        /// <param name="projectRootElementCache">The cache the project would be evaluated from</param>
+        /// <param name="loggingService">The logging service the evaluation would be logged to</param>
+        /// <param name="buildEventContext">The context the evaluation would be logged in</param>
+        /// <returns>The project instance, still to be initialized with node specific state, or null</returns>
+        internal ProjectInstance TryGet(
+            PropertyDictionary<ProjectPropertyInstance> environmentProperties,
+            ProjectRootElementCacheBase projectRootElementCache,
+            ILoggingService loggingService,
+            BuildEventContext buildEventContext)
+        {
+            try
+            {
+                string path = EntryPath;
+                if (!File.Exists(path))
+                {
+                    return null;
+                }
+
+                ProjectInstanceSnapshot snapshot;
+                using (var fileStream = File.OpenRead(path))
+                using (var translator = BinaryTranslator.GetReadTranslator(fileStream, null))
+                {
+                    int version = 0;
+                    translator.Translate(ref version);
+                    if (version != FormatVersion || !ProjectInstanceSnapshot.TranslateEngine(translator))
+                    {
+                        return null;
+                    }
+
+                    // The key guards against hash collisions
+                    string key = null;
+                    translator.Translate(ref key);
+                    if (!string.Equals(key, _key, StringComparison.Ordinal))
+                    {
+                        return null;
+                    }
+
+                    snapshot = ProjectInstanceSnapshot.FactoryForDeserialization(translator);
+                }
+
+                return snapshot.IsUpToDate(environmentProperties, projectRootElementCache) ? snapshot.CreateProjectInstance(loggingService, buildEventContext) : null;
+            }
+            catch (Exception e) when (!ExceptionHandling.IsCriticalException(e))
+            {
+                // A missing or corrupt entry only means that the project is evaluated
+                return null;
+            }
+        }
+
+        /// <summary>
+        /// Persists the evaluation of the project.
+        /// </summary>
+        internal void Save(ProjectInstance projectInstance)
+        {
+            ProjectInstanceSnapshot snapshot = ProjectInstanceSnapshot.Create(projectInstance);
+            if (snapshot == null)
+            {
+                return;
+            }
+
+            string path = EntryPath;
+            string temporaryPath = path + "." + Guid.NewGuid().ToString("N") + ".tmp";
+
+            try
+            {
+                Directory.CreateDirectory(_directory);
+
+                using (var fileStream = new FileStream(temporaryPath, FileMode.CreateNew, FileAccess.Write))
+                {
+                    ITranslator translator = BinaryTranslator.GetWriteTranslator(fileStream);
+
+                    int version = FormatVersion;
+                    translator.Translate(ref version);
+                    ProjectInstanceSnapshot.TranslateEngine(translator);
+
+                    string key = _key;
+                    translator.Translate(ref key);
+
+                    snapshot.Translate(translator);
+                }
+
+                if (File.Exists(path))
+                {
+                    File.Delete(path);
+                }
+
+                File.Move(temporaryPath, path);
+            }
+            catch (Exception e) when (ExceptionHandling.IsIoRelatedException(e))
+            {
+                // Not persisting the evaluation only means that the next build evaluates the project again
+            }
+            finally
+            {
+                try
+                {
+                    File.Delete(temporaryPath);
+                }
+                catch (Exception e) when (ExceptionHandling.IsIoRelatedException(e))
+                {
+                }
+            }
+        }
+    }
+}
@@ -92,6 +92,16 @@ namespace Microsoft.Build.Execution
 
         private List<string> _importPathsIncludingDuplicates;
 
+        /// <summary>
+        /// The names of the environment variables the evaluation depended on, when recorded for <see cref="ProjectInstanceSnapshot"/>.
+        /// </summary>
+        private HashSet<string> _environmentVariablesRead;
+
+        /// <summary>
+        /// The files and directories the evaluation read, when recorded for <see cref="ProjectInstanceSnapshot"/>.
+        /// </summary>
+        private RecordingFileSystem _recordedFileSystem;
+
         /// <summary>
         /// The global properties evaluation occurred with.
         /// Needed by the build as they traverse between projects.
@@ -909,6 +919,16 @@ namespace Microsoft.Build.Execution
         /// </summary>
         public IReadOnlyList<string> ImportPathsIncludingDuplicates { get; private set; }
 
+        /// <summary>
+        /// The names of the environment variables the evaluation depended on, or null if they weren't recorded.
+        /// </summary>
+        internal IReadOnlyCollection<string> EnvironmentVariablesRead => _environmentVariablesRead;
+
+        /// <summary>
+        /// The files and directories the evaluation read, or null if they weren't recorded.
+        /// </summary>
+        internal RecordingFileSystem RecordedFileSystem => _recordedFileSystem;
+
         /// <summary>
         /// DefaultTargets specified in the project, or
         /// the logically first target if no DefaultTargets is
@@ -2161,6 +2181,21 @@ namespace Microsoft.Build.Execution
             }
         }
 
+        /// <summary>
+        /// Translate the import paths, which aren't translated between nodes, for project instances persisted with a project graph.
+        /// </summary>
+        internal void TranslateImportPaths(ITranslator translator)
+        {
+            translator.Translate(ref _importPaths);
+            translator.Translate(ref _importPathsIncludingDuplicates);
+
+            if (translator.Mode == TranslationDirection.ReadFromStream)
+            {
+                ImportPaths = _importPaths?.AsReadOnly();
+                ImportPathsIncludingDuplicates = _importPathsIncludingDuplicates?.AsReadOnly();
+            }
+        }
+
         #endregion
 
         /// <summary>
@@ -2759,6 +2794,13 @@ namespace Microsoft.Build.Execution
 
             evaluationContext = evaluationContext?.ContextForNewProject() ?? EvaluationContext.Create(EvaluationContext.SharingPolicy.Isolated);
 
+            if (ProjectInstanceSnapshot.IsEnabled)
+            {
+                evaluationContext = evaluationContext.CreateRecordingContext();
+                _recordedFileSystem = evaluationContext.RecordingFileSystem;
+                _environmentVariablesRead = new HashSet<string>(StringComparer.OrdinalIgnoreCase);
+            }
+
             Evaluator<ProjectPropertyInstance, ProjectItemInstance, ProjectMetadataInstance, ProjectItemDefinitionInstance>.Evaluate(
                 this,
                 xml,
@@ -2773,7 +2815,8 @@ namespace Microsoft.Build.Execution
                 sdkResolverService ?? evaluationContext.SdkResolverService, /* Use override ISdkResolverService if specified */
                 submissionId,
                 evaluationContext,
-                interactive: buildParameters.Interactive);
+                interactive: buildParameters.Interactive,
+                environmentVariablesRead: _environmentVariablesRead);
 
             ErrorUtilities.VerifyThrow(EvaluationId != BuildEventContext.InvalidEvaluationId, "Evaluation should produce an evaluation ID");
         }
@@ -0,0 +1,240 @@
+﻿// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections;
+using System.Collections.Generic;
+using System.IO;
+using Microsoft.Build.BackEnd;
+using Microsoft.Build.BackEnd.Components.Logging;
+using Microsoft.Build.BackEnd.Logging;
+using Microsoft.Build.Collections;
+using Microsoft.Build.Construction;
+using Microsoft.Build.Evaluation;
+using Microsoft.Build.Evaluation.Context;
+using Microsoft.Build.Framework;
+using Microsoft.Build.Shared;
+using Microsoft.Build.Utilities;
+
+namespace Microsoft.Build.Execution
+{
+    /// <summary>
+    /// A project instance translated with its entire state, together with what its evaluation depended on, so that it can be
+    /// reused instead of evaluating the project again for as long as none of that changed.
+    /// </summary>
+    /// <remarks>
+    /// The evaluation depended on the project file, its imports, every file and directory it read, probed or enumerated,
+    /// whether they existed or not, and the environment variables it read. Evaluations that also depended on what their
+    /// file system doesn't see, like resolved SDKs or property functions reading the disk, registry or environment, aren't
+    /// snapshotted.
+    /// </remarks>
+    internal sealed class ProjectInstanceSnapshot : ITranslatable
+    {
+        /// <summary>
+        /// The timestamps of the files and directories the evaluation depended on.
+        /// </summary>
+        private Dictionary<string, DateTime> _timestamps;
+
+        /// <summary>
+        /// The values of the environment variables the evaluation read, null for those that weren't defined.
+        /// </summary>
+        private Dictionary<string, string> _environment;
+
+        private byte[] _projectInstance;
+
+        private ProjectInstanceSnapshot()
+        {
+        }
+
+        /// <summary>
+        /// Whether evaluations need to record what they read from the environment, for a snapshot to be taken of them.
+        /// </summary>
+        internal static bool IsEnabled =>
+            !string.IsNullOrEmpty(Traits.Instance.EvaluationCacheDirectory) || !string.IsNullOrEmpty(Traits.Instance.ProjectGraphCacheFile);
+
+        /// <summary>
+        /// Takes a snapshot of an evaluated project instance.
+        /// </summary>
+        /// <returns>The snapshot, or null if the evaluation didn't record everything it read</returns>
+        internal static ProjectInstanceSnapshot Create(ProjectInstance projectInstance)
+        {
+            RecordingFileSystem recordedFileSystem = projectInstance.RecordedFileSystem;
+            if (projectInstance.EnvironmentVariablesRead == null || recordedFileSystem == null || recordedFileSystem.UntrackedRead != null)
+            {
+                return null;
+            }
+
+            var environmentProperties = ((IEvaluatorData<ProjectPropertyInstance, ProjectItemInstance, ProjectMetadataInstance, ProjectItemDefinitionInstance>)projectInstance)
+                .EnvironmentVariablePropertiesDictionary;
+
+            var environment = new Dictionary<string, string>(StringComparer.OrdinalIgnoreCase);
+            foreach (string name in projectInstance.EnvironmentVariablesRead)
+            {
+                environment[name] = environmentProperties[name]?.EvaluatedValue;
+            }
+
+            var timestamps = new Dictionary<string, DateTime>(StringComparer.OrdinalIgnoreCase);
+
+            timestamps[projectInstance.FullPath] = GetTimestamp(projectInstance.FullPath);
+            foreach (string import in projectInstance.ImportPathsIncludingDuplicates)
+            {
+                timestamps[import] = GetTimestamp(import);
+            }
+
+            timestamps[projectInstance.Directory] = GetTimestamp(projectInstance.Directory);
+
+            // Paths that didn't exist are recorded too, so that creating them makes the snapshot stale
+            foreach (string path in recordedFileSystem.Paths)
+            {
+                if (!timestamps.ContainsKey(path))
+                {
+                    timestamps[path] = GetTimestamp(path);
+                }
+            }
+
+            // Nodes need the entire state, since they won't be able to evaluate the project the way it was evaluated
+            bool translateEntireState = projectInstance.TranslateEntireState;
+            projectInstance.TranslateEntireState = true;
+
+            try
+            {
+                using var stream = new MemoryStream();
+                ITranslator translator = BinaryTranslator.GetWriteTranslator(stream);
+                ((ITranslatable)projectInstance).Translate(translator);
+                projectInstance.TranslateImportPaths(translator);
+
+                return new ProjectInstanceSnapshot
+                {
+                    _timestamps = timestamps,
+                    _environment = environment,
+                    _projectInstance = stream.ToArray()
+                };
+            }
+            finally
+            {
+                projectInstance.TranslateEntireState = translateEntireState;
+            }
+        }
+
+        /// <summary>
+        /// Translates the MSBuild the snapshots are taken by, since other versions may translate project instances differently.
+        /// </summary>
+        /// <returns>Whether snapshots read after it were taken by this MSBuild</returns>
+        internal static bool TranslateEngine(ITranslator translator)
+        {
+            string engine = typeof(ProjectInstance).Assembly.Location;
+            DateTime engineTimestamp = NativeMethodsShared.GetLastWriteFileUtcTime(engine);
+
+            string persistedEngine = engine;
+            DateTime persistedEngineTimestamp = engineTimestamp;
+
+            translator.Translate(ref persistedEngine);
+            translator.Translate(ref persistedEngineTimestamp);
+
+            return string.Equals(persistedEngine, engine, StringComparison.OrdinalIgnoreCase) &&
+                   persistedEngineTimestamp == engineTimestamp;
+        }
+
+        internal static ProjectInstanceSnapshot FactoryForDeserialization(ITranslator translator)
+        {
+            var snapshot = new ProjectInstanceSnapshot();
+            snapshot.Translate(translator);
+            return snapshot;
+        }
+
+        public void Translate(ITranslator translator)
+        {
+            translator.TranslateDictionary(ref _timestamps, StringComparer.OrdinalIgnoreCase);
+            translator.TranslateDictionary(ref _environment, StringComparer.OrdinalIgnoreCase);
+            translator.Translate(ref _projectInstance);
+        }
+
+        /// <summary>
+        /// Whether evaluating the project again would produce the same instance.
+        /// </summary>
+        /// <param name="environmentProperties">The environment the project would be evaluated with</param>
+        /// <param name="projectRootElementCache">
+        /// The cache the project would be evaluated from, whose edited project files take precedence over those on disk
+        /// </param>
+        internal bool IsUpToDate(PropertyDictionary<ProjectPropertyInstance> environmentProperties, ProjectRootElementCacheBase projectRootElementCache)
+        {
+            foreach (KeyValuePair<string, string> variable in _environment)
+            {
+                if (environmentProperties[variable.Key]?.EvaluatedValue != variable.Value)
+                {
+                    return false;
+                }
+            }
+
+            foreach (KeyValuePair<string, DateTime> timestamp in _timestamps)
+            {
+                if (GetTimestamp(timestamp.Key) != timestamp.Value)
+                {
+                    return false;
+                }
+
+                ProjectRootElement projectRootElement = projectRootElementCache?.TryGet(timestamp.Key);
+                if (projectRootElement?.HasUnsavedChanges == true)
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        /// <summary>
+        /// Creates the project instance the snapshot was taken of, logging it as an evaluation of its own, since the
+        /// evaluation id it was given belongs to the build that evaluated it.
+        /// </summary>
+        /// <param name="loggingService">The logging service the evaluation would have been logged to</param>
+        /// <param name="buildEventContext">The context the evaluation would have been logged in</param>
+        internal ProjectInstance CreateProjectInstance(ILoggingService loggingService, BuildEventContext buildEventContext)
+        {
+            ProjectInstance projectInstance;
+            // The reader of the translator reads strings straight from the buffer of the stream
+            using (var stream = new MemoryStream(_projectInstance, 0, _projectInstance.Length, writable: false, publiclyVisible: true))
+            using (var translator = BinaryTranslator.GetReadTranslator(stream, null))
+            {
+                projectInstance = ProjectInstance.FactoryForDeserialization(translator);
+                projectInstance.TranslateImportPaths(translator);
+            }
+
+            var evaluationLoggingContext = new EvaluationLoggingContext(loggingService, buildEventContext, projectInstance.FullPath);
+            projectInstance.EvaluationId = evaluationLoggingContext.BuildEventContext.EvaluationId;
+
+            evaluationLoggingContext.LogProjectEvaluationStarted();
+            evaluationLoggingContext.LogComment(MessageImportance.Low, "EvaluationReused", projectInstance.FullPath);
+
+            IEnumerable globalProperties = null;
+            IEnumerable properties = null;
+            IEnumerable items = null;
+
+            if (loggingService.IncludeEvaluationPropertiesAndItems)
+            {
+                var data = (IEvaluatorData<ProjectPropertyInstance, ProjectItemInstance, ProjectMetadataInstance, ProjectItemDefinitionInstance>)projectInstance;
+                globalProperties = data.GlobalPropertiesDictionary;
+                properties = data.Properties;
+                items = data.Items;
+            }
+
+            evaluationLoggingContext.LogProjectEvaluationFinished(globalProperties, properties, items, null);
+
+            return projectInstance;
+        }
+
+        /// <summary>
+        /// Gets the last write time of a file or directory, or DateTime.MinValue if it doesn't exist.
+        /// </summary>
+        private static DateTime GetTimestamp(string path)
+        {
+            DateTime timestamp = NativeMethodsShared.GetLastWriteFileUtcTime(path);
+            if (timestamp == DateTime.MinValue && !NativeMethodsShared.GetLastWriteDirectoryUtcTime(path, out timestamp))
+            {
+                timestamp = DateTime.MinValue;
+            }
+
+            return timestamp;
+        }
+    }
+}
@@ -41,7 +41,10 @@ namespace Microsoft.Build.Logging
         {
             using (var stream = new FileStream(sourceFilePath, FileMode.Open, FileAccess.Read, FileShare.Read))
             {
-                var gzipStream = new GZipStream(stream, CompressionMode.Decompress, leaveOpen: true);
+                // logs whose blocks were compressed in parallel are decompressed in parallel too
+                Stream gzipStream = BlockGZipFormat.IsBlockGZip(stream)
+                    ? new BlockGZipReadStream(stream)
+                    : new GZipStream(stream, CompressionMode.Decompress, leaveOpen: true);
 
                 // wrapping the GZipStream in a buffered stream significantly improves performance
                 // and the max throughput is reached with a 32K buffer. See details here:
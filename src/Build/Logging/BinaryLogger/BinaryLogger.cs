@@ -59,6 +59,7 @@ namespace Microsoft.Build.Logging
         private ProjectImportsCollector projectImportsCollector;
         private string _initialTargetOutputLogging;
         private bool _initialLogImports;
+        private bool _compressInParallel;
 
         /// <summary>
         /// Describes whether to collect the project files (including imported project files) used during the build.
@@ -158,7 +159,10 @@ namespace Microsoft.Build.Logging
                 throw new LoggerException(message, e, errorCode, helpKeyword);
             }
 
-            stream = new GZipStream(stream, CompressionLevel.Optimal);
+            // blocks compressed in parallel are members of a gzip file, see BlockGZipFormat
+            stream = _compressInParallel
+                ? new BlockGZipWriteStream(stream, CompressionLevel.Optimal)
+                : new GZipStream(stream, CompressionLevel.Optimal);
 
             // wrapping the GZipStream in a buffered stream significantly improves performance
             // and the max throughput is reached with a 32K buffer. See details here:
@@ -296,6 +300,10 @@ namespace Microsoft.Build.Logging
                 {
                     CollectProjectImports = ProjectImportsCollectionMode.ZipFile;
                 }
+                else if (string.Equals(parameter, "Compression=Parallel", StringComparison.OrdinalIgnoreCase))
+                {
+                    _compressInParallel = true;
+                }
                 else if (parameter.EndsWith(".binlog", StringComparison.OrdinalIgnoreCase))
                 {
                     FilePath = parameter;
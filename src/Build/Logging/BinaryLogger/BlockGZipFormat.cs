@@ -0,0 +1,216 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.IO;
+using System.IO.Compression;
+
+namespace Microsoft.Build.Logging
+{
+    /// <summary>
+    /// A gzip file made of independently compressed blocks, each of them a gzip member whose header records the size of the
+    /// member in an extra field, in the manner of BGZF. Any gzip reader that reads multiple members decompresses the file as
+    /// a whole, while <see cref="BlockGZipReadStream"/> finds the blocks from their headers, without decompressing them, to
+    /// decompress them in parallel.
+    /// </summary>
+    internal static class BlockGZipFormat
+    {
+        /// <summary>
+        /// The number of uncompressed bytes in a block, small enough for the buffers of the blocks to stay off the large object heap.
+        /// </summary>
+        internal const int BlockSize = 64 * 1024;
+
+        /// <summary>
+        /// The size of the header of a block: the fixed gzip header, the length of the extra field, and its subfield holding the
+        /// size of the block.
+        /// </summary>
+        internal const int HeaderLength = 20;
+
+        /// <summary>
+        /// The size of the gzip trailer of a block: the CRC-32 and the length of the uncompressed data.
+        /// </summary>
+        internal const int TrailerLength = 8;
+
+        private const byte Id1 = 0x1f;
+        private const byte Id2 = 0x8b;
+        private const byte DeflateMethod = 8;
+        private const byte ExtraFieldFlag = 4;
+        private const byte UnknownOperatingSystem = 255;
+        private const byte SubfieldId1 = (byte)'M';
+        private const byte SubfieldId2 = (byte)'B';
+
+        private static readonly uint[] s_crcTable = CreateCrcTable();
+
+        /// <summary>
+        /// The number of blocks compressed or decompressed at the same time.
+        /// </summary>
+        internal static int MaxPendingBlocks => Math.Max(2, Math.Min(Environment.ProcessorCount, 16));
+
+        /// <summary>
+        /// Whether a stream starts with a block, leaving its position unchanged.
+        /// </summary>
+        internal static bool IsBlockGZip(Stream stream)
+        {
+            if (!stream.CanSeek)
+            {
+                return false;
+            }
+
+            long position = stream.Position;
+            var header = new byte[HeaderLength];
+
+            int read = 0;
+            while (read < HeaderLength)
+            {
+                int count = stream.Read(header, read, HeaderLength - read);
+                if (count == 0)
+                {
+                    break;
+                }
+
+                read += count;
+            }
+
+            stream.Position = position;
+
+            return read == HeaderLength && TryGetBlockLength(header, out _);
+        }
+
+        /// <summary>
+        /// Gets the size of a block from its header.
+        /// </summary>
+        /// <returns>False if the header isn't that of a block</returns>
+        internal static bool TryGetBlockLength(byte[] header, out int blockLength)
+        {
+            blockLength = header[16] | (header[17] << 8) | (header[18] << 16) | (header[19] << 24);
+
+            return header[0] == Id1 &&
+                   header[1] == Id2 &&
+                   header[2] == DeflateMethod &&
+                   header[3] == ExtraFieldFlag &&
+                   header[10] == 8 &&
+                   header[11] == 0 &&
+                   header[12] == SubfieldId1 &&
+                   header[13] == SubfieldId2 &&
+                   header[14] == 4 &&
+                   header[15] == 0 &&
+                   blockLength >= HeaderLength + TrailerLength;
+        }
+
+        /// <summary>
+        /// Compresses data into a block.
+        /// </summary>
+        internal static byte[] Compress(byte[] buffer, int count, CompressionLevel compressionLevel)
+        {
+            using var block = new MemoryStream(HeaderLength + (count / 2) + TrailerLength);
+
+            block.Write(new byte[HeaderLength], 0, HeaderLength);
+            using (var deflateStream = new DeflateStream(block, compressionLevel, leaveOpen: true))
+            {
+                deflateStream.Write(buffer, 0, count);
+            }
+
+            WriteUInt32(block, ComputeCrc(buffer, 0, count));
+            WriteUInt32(block, (uint)count);
+
+            byte[] bytes = block.ToArray();
+
+            bytes[0] = Id1;
+            bytes[1] = Id2;
+            bytes[2] = DeflateMethod;
+            bytes[3] = ExtraFieldFlag;
+            bytes[9] = UnknownOperatingSystem;
+            bytes[10] = 8;
+            bytes[12] = SubfieldId1;
+            bytes[13] = SubfieldId2;
+            bytes[14] = 4;
+            bytes[16] = (byte)bytes.Length;
+            bytes[17] = (byte)(bytes.Length >> 8);
+            bytes[18] = (byte)(bytes.Length >> 16);
+            bytes[19] = (byte)(bytes.Length >> 24);
+
+            return bytes;
+        }
+
+        /// <summary>
+        /// Decompresses a block, checking the integrity of its data.
+        /// </summary>
+        internal static byte[] Decompress(byte[] block)
+        {
+            int trailer = block.Length - TrailerLength;
+            uint crc = ReadUInt32(block, trailer);
+            uint length = ReadUInt32(block, trailer + 4);
+            if (length > BlockSize)
+            {
+                throw new InvalidDataException();
+            }
+
+            var data = new byte[length];
+            int dataLength = data.Length;
+
+            using (var compressed = new MemoryStream(block, HeaderLength, trailer - HeaderLength, writable: false))
+            using (var deflateStream = new DeflateStream(compressed, CompressionMode.Decompress))
+            {
+                int read = 0;
+                while (read < dataLength)
+                {
+                    int count = deflateStream.Read(data, read, dataLength - read);
+                    if (count == 0)
+                    {
+                        throw new InvalidDataException();
+                    }
+
+                    read += count;
+                }
+            }
+
+            if (ComputeCrc(data, 0, dataLength) != crc)
+            {
+                throw new InvalidDataException();
+            }
+
+            return data;
+        }
+
+        private static uint ComputeCrc(byte[] buffer, int offset, int count)
+        {
+            uint crc = 0xffffffff;
+            for (int i = offset; i < offset + count; i++)
+            {
+                crc = s_crcTable[(crc ^ buffer[i]) & 0xff] ^ (crc >> 8);
+            }
+
+            return ~crc;
+        }
+
+        private static uint[] CreateCrcTable()
+        {
+            var table = new uint[256];
+            for (uint i = 0; i < table.Length; i++)
+            {
+                uint crc = i;
+                for (int bit = 0; bit < 8; bit++)
+                {
+                    crc = (crc & 1) != 0 ? 0xedb88320 ^ (crc >> 1) : crc >> 1;
+                }
+
+                table[i] = crc;
+            }
+
+            return table;
+        }
+
+        private static void WriteUInt32(Stream stream, uint value)
+        {
+            stream.WriteByte((byte)value);
+            stream.WriteByte((byte)(value >> 8));
+            stream.WriteByte((byte)(value >> 16));
+            stream.WriteByte((byte)(value >> 24));
+        }
+
+        private static uint ReadUInt32(byte[] buffer, int offset)
+        {
+            return (uint)(buffer[offset] | (buffer[offset + 1] << 8) | (buffer[offset + 2] << 16) | (buffer[offset + 3] << 24));
+        }
+    }
+}
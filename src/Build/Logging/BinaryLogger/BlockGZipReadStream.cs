@@ -0,0 +1,169 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Threading.Tasks;
+
+namespace Microsoft.Build.Logging
+{
+    /// <summary>
+    /// Reads data in the <see cref="BlockGZipFormat"/>, decompressing the blocks ahead of the reader on thread pool threads.
+    /// </summary>
+    internal sealed class BlockGZipReadStream : Stream
+    {
+        private readonly Stream _stream;
+        private readonly int _maxPendingBlocks = BlockGZipFormat.MaxPendingBlocks;
+        private readonly Queue<Task<byte[]>> _pendingBlocks = new Queue<Task<byte[]>>();
+        private readonly byte[] _header = new byte[BlockGZipFormat.HeaderLength];
+
+        private byte[] _block = Array.Empty<byte>();
+        private int _blockPosition;
+        private bool _isEndOfStream;
+
+        public BlockGZipReadStream(Stream stream)
+        {
+            _stream = stream;
+        }
+
+        public override bool CanRead => true;
+
+        public override bool CanSeek => false;
+
+        public override bool CanWrite => false;
+
+        public override long Length => throw new NotSupportedException();
+
+        public override long Position
+        {
+            get => throw new NotSupportedException();
+            set => throw new NotSupportedException();
+        }
+
+        public override int Read(byte[] buffer, int offset, int count)
+        {
+            if (count == 0)
+            {
+                return 0;
+            }
+
+            while (_blockPosition == _block.Length)
+            {
+                if (!NextBlock())
+                {
+                    return 0;
+                }
+            }
+
+            int length = Math.Min(count, _block.Length - _blockPosition);
+            Buffer.BlockCopy(_block, _blockPosition, buffer, offset, length);
+            _blockPosition += length;
+
+            return length;
+        }
+
+        public override int ReadByte()
+        {
+            while (_blockPosition == _block.Length)
+            {
+                if (!NextBlock())
+                {
+                    return -1;
+                }
+            }
+
+            return _block[_blockPosition++];
+        }
+
+        public override void Flush()
+        {
+        }
+
+        public override long Seek(long offset, SeekOrigin origin) => throw new NotSupportedException();
+
+        public override void SetLength(long value) => throw new NotSupportedException();
+
+        public override void Write(byte[] buffer, int offset, int count) => throw new NotSupportedException();
+
+        private bool NextBlock()
+        {
+            ReadAhead();
+
+            if (_pendingBlocks.Count == 0)
+            {
+                return false;
+            }
+
+            _block = _pendingBlocks.Dequeue().GetAwaiter().GetResult();
+            _blockPosition = 0;
+
+            ReadAhead();
+
+            return true;
+        }
+
+        /// <summary>
+        /// Reads blocks from the stream, up to the number that are decompressed at the same time.
+        /// </summary>
+        private void ReadAhead()
+        {
+            while (!_isEndOfStream && _pendingBlocks.Count < _maxPendingBlocks)
+            {
+                byte[] block = ReadCompressedBlock();
+                if (block == null)
+                {
+                    _isEndOfStream = true;
+                    break;
+                }
+
+                _pendingBlocks.Enqueue(Task.Run(() => BlockGZipFormat.Decompress(block)));
+            }
+        }
+
+        /// <returns>The block, or null at the end of the stream</returns>
+        private byte[] ReadCompressedBlock()
+        {
+            int read = ReadFully(_header, 0, _header.Length);
+            if (read == 0)
+            {
+                return null;
+            }
+
+            // A compressed block is larger than its data only for data that doesn't compress
+            if (read < _header.Length ||
+                !BlockGZipFormat.TryGetBlockLength(_header, out int blockLength) ||
+                blockLength > 2 * BlockGZipFormat.BlockSize)
+            {
+                throw new InvalidDataException();
+            }
+
+            var block = new byte[blockLength];
+            Buffer.BlockCopy(_header, 0, block, 0, _header.Length);
+
+            if (ReadFully(block, _header.Length, blockLength - _header.Length) < blockLength - _header.Length)
+            {
+                throw new EndOfStreamException();
+            }
+
+            return block;
+        }
+
+        private int ReadFully(byte[] buffer, int offset, int count)
+        {
+            int read = 0;
+            while (read < count)
+            {
+                int length = _stream.Read(buffer, offset + read, count - read);
+                if (length == 0)
+                {
+                    break;
+                }
+
+                read += length;
+            }
+
+            return read;
+        }
+    }
+}
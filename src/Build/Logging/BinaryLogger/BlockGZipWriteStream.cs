@@ -0,0 +1,138 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.IO.Compression;
+using System.Threading.Tasks;
+
+namespace Microsoft.Build.Logging
+{
+    /// <summary>
+    /// Writes data in the <see cref="BlockGZipFormat"/>, compressing its blocks on thread pool threads so that the writer
+    /// only copies the data. The blocks are written in order, as soon as they are compressed.
+    /// </summary>
+    internal sealed class BlockGZipWriteStream : Stream
+    {
+        private readonly Stream _stream;
+        private readonly CompressionLevel _compressionLevel;
+        private readonly int _maxPendingBlocks = BlockGZipFormat.MaxPendingBlocks;
+        private readonly Queue<Task<byte[]>> _pendingBlocks = new Queue<Task<byte[]>>();
+
+        private byte[] _block = new byte[BlockGZipFormat.BlockSize];
+        private int _blockLength;
+
+        public BlockGZipWriteStream(Stream stream, CompressionLevel compressionLevel)
+        {
+            _stream = stream;
+            _compressionLevel = compressionLevel;
+        }
+
+        public override bool CanRead => false;
+
+        public override bool CanSeek => false;
+
+        public override bool CanWrite => true;
+
+        public override long Length => throw new NotSupportedException();
+
+        public override long Position
+        {
+            get => throw new NotSupportedException();
+            set => throw new NotSupportedException();
+        }
+
+        public override void Write(byte[] buffer, int offset, int count)
+        {
+            while (count > 0)
+            {
+                int length = Math.Min(count, _block.Length - _blockLength);
+                Buffer.BlockCopy(buffer, offset, _block, _blockLength, length);
+
+                _blockLength += length;
+                offset += length;
+                count -= length;
+
+                if (_blockLength == _block.Length)
+                {
+                    CompressBlock();
+                }
+            }
+        }
+
+        public override void WriteByte(byte value)
+        {
+            _block[_blockLength++] = value;
+
+            if (_blockLength == _block.Length)
+            {
+                CompressBlock();
+            }
+        }
+
+        /// <summary>
+        /// Compresses the data written so far into a block, even if it doesn't fill one, and writes every block.
+        /// </summary>
+        public override void Flush()
+        {
+            if (_blockLength > 0)
+            {
+                CompressBlock();
+            }
+
+            while (_pendingBlocks.Count > 0)
+            {
+                WriteBlock();
+            }
+
+            _stream.Flush();
+        }
+
+        public override int Read(byte[] buffer, int offset, int count) => throw new NotSupportedException();
+
+        public override long Seek(long offset, SeekOrigin origin) => throw new NotSupportedException();
+
+        public override void SetLength(long value) => throw new NotSupportedException();
+
+        protected override void Dispose(bool disposing)
+        {
+            try
+            {
+                if (disposing)
+                {
+                    Flush();
+                    _stream.Dispose();
+                }
+            }
+            finally
+            {
+                base.Dispose(disposing);
+            }
+        }
+
+        private void CompressBlock()
+        {
+            byte[] block = _block;
+            int blockLength = _blockLength;
+            CompressionLevel compressionLevel = _compressionLevel;
+
+            _pendingBlocks.Enqueue(Task.Run(() => BlockGZipFormat.Compress(block, blockLength, compressionLevel)));
+
+            _block = new byte[BlockGZipFormat.BlockSize];
+            _blockLength = 0;
+
+            // Wait for the oldest block only when too many are pending, to bound the memory they hold
+            while (_pendingBlocks.Count > _maxPendingBlocks || (_pendingBlocks.Count > 0 && _pendingBlocks.Peek().IsCompleted))
+            {
+                WriteBlock();
+            }
+        }
+
+        private void WriteBlock()
+        {
+            byte[] block = _pendingBlocks.Dequeue().GetAwaiter().GetResult();
+            _stream.Write(block, 0, block.Length);
+        }
+    }
+}
@@ -1,6 +1,7 @@
 ﻿// Copyright (c) Microsoft. All rights reserved.
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
+using Microsoft.Build.Globbing;
 using Microsoft.Build.Shared;
 using System;
 using System.Diagnostics;
@@ -15,8 +16,9 @@ namespace Microsoft.Build.Internal
         private readonly string _unescapedFileSpec;
         private readonly string _filenamePattern;
         private readonly Regex _regex;
+        private readonly GlobMatcher _matcher;
         
-        private FileSpecMatcherTester(string currentDirectory, string unescapedFileSpec, string filenamePattern, Regex regex)
+        private FileSpecMatcherTester(string currentDirectory, string unescapedFileSpec, string filenamePattern, Regex regex, GlobMatcher matcher)
         {
             Debug.Assert(!string.IsNullOrEmpty(unescapedFileSpec));
             Debug.Assert(currentDirectory != null);
@@ -25,6 +27,7 @@ namespace Microsoft.Build.Internal
             _unescapedFileSpec = unescapedFileSpec;
             _filenamePattern = filenamePattern;
             _regex = regex;
+            _matcher = matcher;
         }
 
         public static FileSpecMatcherTester Parse(string currentDirectory, string fileSpec)
@@ -32,20 +35,27 @@ namespace Microsoft.Build.Internal
             string unescapedFileSpec = EscapingUtilities.UnescapeAll(fileSpec);
             string filenamePattern = null;
             Regex regex = null;
+            GlobMatcher matcher = null;
 
             if (EngineFileUtilities.FilespecHasWildcards(fileSpec))
             {
-                CreateRegexOrFilenamePattern(unescapedFileSpec, currentDirectory, out filenamePattern, out regex);
+                CreateRegexOrFilenamePattern(unescapedFileSpec, currentDirectory, out filenamePattern, out regex, out matcher);
             }
 
-            return new FileSpecMatcherTester(currentDirectory, unescapedFileSpec, filenamePattern, regex);
+            return new FileSpecMatcherTester(currentDirectory, unescapedFileSpec, filenamePattern, regex, matcher);
         }
 
         public bool IsMatch(string fileToMatch)
         {
             Debug.Assert(!string.IsNullOrEmpty(fileToMatch));
 
-            // We do the matching using one of three code paths, depending on the value of _filenamePattern and _regex.
+            // We do the matching using one of four code paths, depending on the value of _filenamePattern, _matcher and _regex.
+            if (_matcher != null)
+            {
+                string normalizedFileToMatch = FileUtilities.GetFullPathNoThrow(Path.Combine(_currentDirectory, fileToMatch));
+                return _matcher.IsMatch(normalizedFileToMatch);
+            }
+
             if (_regex != null)
             {
                 string normalizedFileToMatch = FileUtilities.GetFullPathNoThrow(Path.Combine(_currentDirectory, fileToMatch));
@@ -72,7 +82,7 @@ namespace Microsoft.Build.Internal
         // without this normalization step, strings pointing outside the globbing cone would still match when they shouldn't
         // for example, we dont want "**/*.cs" to match "../Shared/Foo.cs"
         // todo: glob rooting knowledge partially duplicated with MSBuildGlob.Parse and FileMatcher.ComputeFileEnumerationCacheKey
-        private static void CreateRegexOrFilenamePattern(string unescapedFileSpec, string currentDirectory, out string filenamePattern, out Regex regex)
+        private static void CreateRegexOrFilenamePattern(string unescapedFileSpec, string currentDirectory, out string filenamePattern, out Regex regex, out GlobMatcher matcher)
         {
             FileMatcher.Default.SplitFileSpec(
                 unescapedFileSpec,
@@ -80,6 +90,8 @@ namespace Microsoft.Build.Internal
                 out string wildcardDirectoryPart,
                 out string filenamePart);
 
+            matcher = null;
+
             if (FileUtilities.PathIsInvalid(fixedDirPart))
             {
                 filenamePattern = null;
@@ -105,14 +117,26 @@ namespace Microsoft.Build.Internal
 
             var recombinedFileSpec = string.Concat(normalizedFixedDirPart, wildcardDirectoryPart, filenamePart);
 
-            FileMatcher.Default.GetFileSpecInfoWithRegexObject(
+            FileMatcher.Default.GetFileSpecInfo(
                 recombinedFileSpec,
-                out Regex regexObject,
+                out string fixedDirectoryPart,
+                out wildcardDirectoryPart,
+                out filenamePart,
                 out bool _,
                 out bool isLegal);
 
             filenamePattern = null;
-            regex = isLegal ? regexObject : null;
+            regex = null;
+
+            if (isLegal)
+            {
+                // The regex is only needed for the globs the matcher can't handle
+                matcher = GlobMatcher.TryCreate(fixedDirectoryPart, wildcardDirectoryPart, filenamePart);
+                if (matcher == null)
+                {
+                    regex = new Regex(FileMatcher.RegularExpressionFromFileSpec(fixedDirectoryPart, wildcardDirectoryPart, filenamePart), FileMatcher.DefaultRegexOptions);
+                }
+            }
         }
     }
 }
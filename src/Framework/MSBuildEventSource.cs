@@ -417,6 +417,93 @@ namespace Microsoft.Build.Eventing
         {
             WriteEvent(55, size);
         }
+
+        /// <summary>
+        /// Call this method to notify listeners of the tlogs of a tracked task being read into a dependency table.
+        /// </summary>
+        /// <param name="tlogs">The tlogs being read.</param>
+        [Event(56, Keywords = Keywords.All)]
+        public void ReadTrackingLogsStart(string tlogs)
+        {
+            WriteEvent(56, tlogs);
+        }
+
+        /// <param name="tlogs">The tlogs that were read.</param>
+        /// <param name="bytesRead">The total size of the tlogs.</param>
+        /// <param name="linesRead">The number of lines parsed from the tlogs.</param>
+        [Event(57, Keywords = Keywords.All)]
+        public void ReadTrackingLogsStop(string tlogs, long bytesRead, int linesRead)
+        {
+            WriteEvent(57, tlogs, bytesRead, linesRead);
+        }
+
+        /// <summary>
+        /// Call this method to notify listeners of a dependency table being found in the dependency table cache.
+        /// </summary>
+        /// <param name="tlogs">The tlogs the table was built from.</param>
+        [Event(58, Keywords = Keywords.All)]
+        public void DependencyTableCacheHit(string tlogs)
+        {
+            WriteEvent(58, tlogs);
+        }
+
+        /// <summary>
+        /// Call this method to notify listeners of a dependency table missing from, or out of date in, the dependency table cache.
+        /// </summary>
+        /// <param name="tlogs">The tlogs the table is to be built from.</param>
+        [Event(59, Keywords = Keywords.All)]
+        public void DependencyTableCacheMiss(string tlogs)
+        {
+            WriteEvent(59, tlogs);
+        }
+
+        /// <summary>
+        /// Call this method to notify listeners of a tracked task checking its tracked inputs and outputs are up to date.
+        /// </summary>
+        /// <param name="tlogs">The tlogs the inputs were read from.</param>
+        [Event(60, Keywords = Keywords.All)]
+        public void TrackedDependenciesUpToDateCheckStart(string tlogs)
+        {
+            WriteEvent(60, tlogs);
+        }
+
+        /// <param name="tlogs">The tlogs the inputs were read from.</param>
+        /// <param name="filesChecked">The number of distinct files whose timestamps were checked.</param>
+        /// <param name="itemsOutOfDate">The number of sources found to be out of date, or 1 if the task as a whole is.</param>
+        [Event(61, Keywords = Keywords.All)]
+        public void TrackedDependenciesUpToDateCheckStop(string tlogs, int filesChecked, int itemsOutOfDate)
+        {
+            WriteEvent(61, tlogs, filesChecked, itemsOutOfDate);
+        }
+
+        /// <summary>
+        /// Call this method to notify listeners of a compacted tlog being written.
+        /// </summary>
+        /// <param name="tlog">The tlog being written.</param>
+        [Event(62, Keywords = Keywords.All)]
+        public void SaveTrackingLogStart(string tlog)
+        {
+            WriteEvent(62, tlog);
+        }
+
+        /// <param name="tlog">The tlog that was written.</param>
+        /// <param name="entries">The number of entries written.</param>
+        [Event(63, Keywords = Keywords.All)]
+        public void SaveTrackingLogStop(string tlog, int entries)
+        {
+            WriteEvent(63, tlog, entries);
+        }
+
+        /// <summary>
+        /// Call this method to notify listeners of a compacted tlog which could not be written in the background.
+        /// </summary>
+        /// <param name="tlog">The tlog which was to be written.</param>
+        /// <param name="message">The error which stopped it being written.</param>
+        [Event(64, Keywords = Keywords.All)]
+        public void SaveTrackingLogFailed(string tlog, string message)
+        {
+            WriteEvent(64, tlog, message);
+        }
         #endregion
     }
 }
@@ -21,13 +21,50 @@ namespace Microsoft.Build.BackEnd
     /// </summary>
     static internal class BinaryTranslator
     {
+        /// <summary>
+        /// The most strings a string table holds. Strings written once it is full are written in full.
+        /// </summary>
+        private const int MaxStringTableCount = 256 * 1024;
+
+        /// <summary>
+        /// The length of the longest string added to a string table. Longer strings, like the texts of messages, rarely repeat.
+        /// </summary>
+        private const int MaxStringTableStringLength = 4096;
+
+        /// <summary>
+        /// Written before a string, in full, that isn't added to the string table.
+        /// </summary>
+        private const int UntabledString = 0;
+
+        /// <summary>
+        /// Written before a string, in full, that is added to the string table with the next id.
+        /// </summary>
+        private const int TabledString = 1;
+
+        /// <summary>
+        /// Added to the id of a string already in the string table, which is written instead of the string.
+        /// </summary>
+        private const int StringTableIdOffset = 2;
+
         /// <summary>
         /// Returns a read-only serializer.
         /// </summary>
         /// <returns>The serializer.</returns>
         static internal ITranslator GetReadTranslator(Stream stream, SharedReadBuffer buffer)
         {
-            return new BinaryReadTranslator(stream, buffer);
+            return new BinaryReadTranslator(stream, buffer, stringTable: null);
+        }
+
+        /// <summary>
+        /// Returns a read-only serializer for data written by a serializer with a string table.
+        /// </summary>
+        /// <param name="stream">The stream containing the data to deserialize.</param>
+        /// <param name="buffer">The buffer shared by the readers of the stream.</param>
+        /// <param name="stringTable">The strings read so far from the serializers sharing the string table, indexed by their id.</param>
+        /// <returns>The serializer.</returns>
+        static internal ITranslator GetReadTranslator(Stream stream, SharedReadBuffer buffer, List<string> stringTable)
+        {
+            return new BinaryReadTranslator(stream, buffer, stringTable);
         }
 
         /// <summary>
@@ -37,7 +74,19 @@ namespace Microsoft.Build.BackEnd
         /// <returns>The serializer.</returns>
         static internal ITranslator GetWriteTranslator(Stream stream)
         {
-            return new BinaryWriteTranslator(stream);
+            return new BinaryWriteTranslator(stream, stringTable: null);
+        }
+
+        /// <summary>
+        /// Returns a write-only serializer which writes each string once, and then its id in the string table. The data must be read
+        /// in the order it was written, by serializers sharing one string table too.
+        /// </summary>
+        /// <param name="stream">The stream containing data to serialize.</param>
+        /// <param name="stringTable">The ids of the strings written so far by the serializers sharing the string table.</param>
+        /// <returns>The serializer.</returns>
+        static internal ITranslator GetWriteTranslator(Stream stream, Dictionary<string, int> stringTable)
+        {
+            return new BinaryWriteTranslator(stream, stringTable);
         }
 
         /// <summary>
@@ -55,13 +104,19 @@ namespace Microsoft.Build.BackEnd
             /// </summary>
             private BinaryReader _reader;
 
+            /// <summary>
+            /// The strings read from the string table, or null if strings are read in full.
+            /// </summary>
+            private List<string> _stringTable;
+
             /// <summary>
             /// Constructs a serializer from the specified stream, operating in the designated mode.
             /// </summary>
-            public BinaryReadTranslator(Stream packetStream, SharedReadBuffer buffer)
+            public BinaryReadTranslator(Stream packetStream, SharedReadBuffer buffer, List<string> stringTable)
             {
                 _packetStream = packetStream;
                 _reader = InterningBinaryReader.Create(packetStream, buffer);
+                _stringTable = stringTable;
             }
 
             /// <summary>
@@ -176,7 +231,7 @@ namespace Microsoft.Build.BackEnd
                     return;
                 }
 
-                value = _reader.ReadString();
+                value = ReadString();
             }
 
             /// <summary>
@@ -228,7 +283,7 @@ namespace Microsoft.Build.BackEnd
 
                 for (int i = 0; i < count; i++)
                 {
-                    array[i] = _reader.ReadString();
+                    array[i] = ReadString();
                 }
             }
 
@@ -245,7 +300,7 @@ namespace Microsoft.Build.BackEnd
 
                 for (int i = 0; i < count; i++)
                 {
-                    set.Add(_reader.ReadString());
+                    set.Add(ReadString());
                 }
             }
 
@@ -265,7 +320,7 @@ namespace Microsoft.Build.BackEnd
 
                 for (int i = 0; i < count; i++)
                 {
-                    list.Add(_reader.ReadString());
+                    list.Add(ReadString());
                 }
             }
 
@@ -697,6 +752,52 @@ namespace Microsoft.Build.BackEnd
                 bool haveRef = _reader.ReadBoolean();
                 return haveRef;
             }
+
+            /// <summary>
+            /// Reads a string in full, or its id in the string table.
+            /// </summary>
+            private string ReadString()
+            {
+                if (_stringTable == null)
+                {
+                    return _reader.ReadString();
+                }
+
+                int id = Read7BitEncodedInt();
+                if (id >= StringTableIdOffset)
+                {
+                    return _stringTable[id - StringTableIdOffset];
+                }
+
+                string value = _reader.ReadString();
+                if (id == TabledString)
+                {
+                    _stringTable.Add(value);
+                }
+
+                return value;
+            }
+
+            private int Read7BitEncodedInt()
+            {
+                int value = 0;
+                int shift = 0;
+                byte b;
+                do
+                {
+                    if (shift == 5 * 7)
+                    {
+                        throw new FormatException();
+                    }
+
+                    b = _reader.ReadByte();
+                    value |= (b & 0x7F) << shift;
+                    shift += 7;
+                }
+                while ((b & 0x80) != 0);
+
+                return value;
+            }
         }
 
         /// <summary>
@@ -714,14 +815,21 @@ namespace Microsoft.Build.BackEnd
             /// </summary>
             private BinaryWriter _writer;
 
+            /// <summary>
+            /// The ids of the strings in the string table, or null if strings are written in full.
+            /// </summary>
+            private Dictionary<string, int> _stringTable;
+
             /// <summary>
             /// Constructs a serializer from the specified stream, operating in the designated mode.
             /// </summary>
             /// <param name="packetStream">The stream serving as the source or destination of data.</param>
-            public BinaryWriteTranslator(Stream packetStream)
+            /// <param name="stringTable">The ids of the strings in the string table, or null to write strings in full.</param>
+            public BinaryWriteTranslator(Stream packetStream, Dictionary<string, int> stringTable)
             {
                 _packetStream = packetStream;
                 _writer = new BinaryWriter(packetStream);
+                _stringTable = stringTable;
             }
 
             /// <summary>
@@ -836,7 +944,7 @@ namespace Microsoft.Build.BackEnd
                     return;
                 }
 
-                _writer.Write(value);
+                WriteString(value);
             }
 
             /// <summary>
@@ -855,7 +963,7 @@ namespace Microsoft.Build.BackEnd
 
                 for (int i = 0; i < count; i++)
                 {
-                    _writer.Write(array[i]);
+                    WriteString(array[i]);
                 }
             }
 
@@ -875,7 +983,7 @@ namespace Microsoft.Build.BackEnd
 
                 for (int i = 0; i < count; i++)
                 {
-                    _writer.Write(list[i]);
+                    WriteString(list[i]);
                 }
             }
 
@@ -892,7 +1000,7 @@ namespace Microsoft.Build.BackEnd
 
                 foreach (var item in set)
                 {
-                    _writer.Write(item);
+                    WriteString(item);
                 }
             }
 
@@ -1324,6 +1432,48 @@ namespace Microsoft.Build.BackEnd
                 _writer.Write(haveRef);
                 return haveRef;
             }
+
+            /// <summary>
+            /// Writes a string in full the first time, and its id in the string table the next ones.
+            /// </summary>
+            private void WriteString(string value)
+            {
+                if (_stringTable == null)
+                {
+                    _writer.Write(value);
+                    return;
+                }
+
+                if (_stringTable.TryGetValue(value, out int id))
+                {
+                    Write7BitEncodedInt(id + StringTableIdOffset);
+                    return;
+                }
+
+                if (value.Length <= MaxStringTableStringLength && _stringTable.Count < MaxStringTableCount)
+                {
+                    _stringTable.Add(value, _stringTable.Count);
+                    Write7BitEncodedInt(TabledString);
+                }
+                else
+                {
+                    Write7BitEncodedInt(UntabledString);
+                }
+
+                _writer.Write(value);
+            }
+
+            private void Write7BitEncodedInt(int value)
+            {
+                uint v = (uint)value;
+                while (v >= 0x80)
+                {
+                    _writer.Write((byte)(v | 0x80));
+                    v >>= 7;
+                }
+
+                _writer.Write((byte)v);
+            }
         }
     }
 }
@@ -248,6 +248,78 @@ namespace Microsoft.Build.Shared
             return result;
         }
 
+        /// <summary>
+        /// Whether the first characters of a message contain "error" or "warning" where either canonical message
+        /// pattern could match it as the category. Both patterns need the category to follow the start of the line,
+        /// a whitespace or a colon, and to be followed by a colon, optionally after whitespace or a space and a code.
+        /// </summary>
+        /// <remarks>Like the scan this replaces, the comparisons are ordinal, so they don't depend on the culture.</remarks>
+        private static bool ContainsCategory(string message, int length)
+        {
+            return ContainsCategory(message, length, "error") || ContainsCategory(message, length, "warning");
+        }
+
+        private static bool ContainsCategory(string message, int length, string category)
+        {
+            int index = 0;
+            while (index <= length - category.Length)
+            {
+                int found = message.IndexOf(category, index, length - index, StringComparison.OrdinalIgnoreCase);
+                if (found < 0)
+                {
+                    return false;
+                }
+
+                if ((found == 0 || char.IsWhiteSpace(message[found - 1]) || message[found - 1] == ':') &&
+                    IsFollowedByCode(message, found + category.Length, length))
+                {
+                    return true;
+                }
+
+                index = found + 1;
+            }
+
+            return false;
+        }
+
+        /// <summary>
+        /// Whether the characters from <paramref name="start"/> match the "( \s*[^: ]*)?\s*:" that follows the category
+        /// in the canonical message pattern: whitespace, or a space, whitespace, a code without spaces and whitespace,
+        /// followed by a colon.
+        /// </summary>
+        private static bool IsFollowedByCode(string message, int start, int length)
+        {
+            int colon = message.IndexOf(':', start, length - start);
+            if (colon < 0)
+            {
+                return false;
+            }
+
+            int codeStart = start;
+            while (codeStart < colon && char.IsWhiteSpace(message[codeStart]))
+            {
+                codeStart++;
+            }
+
+            if (codeStart == colon)
+            {
+                return true;
+            }
+
+            if (message[start] != ' ')
+            {
+                return false;
+            }
+
+            int codeEnd = colon;
+            while (char.IsWhiteSpace(message[codeEnd - 1]))
+            {
+                codeEnd--;
+            }
+
+            return message.IndexOf(' ', codeStart, codeEnd - codeStart) < 0;
+        }
+
         /// <summary>
         /// Decompose an error or warning message into constituent parts. If the message isn't in the canonical form, return null.
         /// </summary>
@@ -260,20 +332,21 @@ namespace Microsoft.Build.Shared
             // To avoid that, only scan the first 400 characters. That's enough for
             // the longest possible prefix: MAX_PATH, plus a huge subcategory string, and an error location.
             // After the regex is done, we can append the overflow.
-            string messageOverflow = String.Empty;
-            if (message.Length > 400)
+            const int maxScannedLength = 400;
+
+            // If a tool has a large amount of output that isn't an error or warning (eg., "dir /s %hugetree%",
+            // or cl.exe /showIncludes) the regexes below are slow. It's faster to pre-scan for a category that
+            // they could match, and bail out before allocating anything if there is none.
+            if (!ContainsCategory(message, Math.Min(message.Length, maxScannedLength)))
             {
-                messageOverflow = message.Substring(400);
-                message = message.Substring(0, 400);
+                return null;
             }
 
-            // If a tool has a large amount of output that isn't an error or warning (eg., "dir /s %hugetree%")
-            // the regex below is slow. It's faster to pre-scan for "warning" and "error"
-            // and bail out if neither are present.
-            if (message.IndexOf("warning", StringComparison.OrdinalIgnoreCase) == -1 &&
-                message.IndexOf("error", StringComparison.OrdinalIgnoreCase) == -1)
+            string messageOverflow = String.Empty;
+            if (message.Length > maxScannedLength)
             {
-                return null;
+                messageOverflow = message.Substring(maxScannedLength);
+                message = message.Substring(0, maxScannedLength);
             }
 
             Parts parsedMessage = new Parts();
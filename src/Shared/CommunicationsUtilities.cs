@@ -123,6 +123,16 @@ namespace Microsoft.Build.Internal
         /// </summary>
         internal const byte handshakeVersion = 0x01;
 
+        /// <summary>
+        /// Set in the type byte of a packet whose body has been compressed with <see cref="System.IO.Compression.DeflateStream"/>.
+        /// </summary>
+        internal const byte CompressedPacketFlag = 0x80;
+
+        /// <summary>
+        /// Set in the type byte of a packet whose strings have been written once per connection, and then referred to by their id.
+        /// </summary>
+        internal const byte StringTablePacketFlag = 0x40;
+
         /// <summary>
         /// The timeout to connect to a node.
         /// </summary>
@@ -2,16 +2,21 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 using System;
+using System.Collections.Generic;
 #if CLR2COMPATIBILITY
 using Microsoft.Build.Shared.Concurrent;
 #else
 using System.Collections.Concurrent;
 #endif
 using System.IO;
+#if !CLR2COMPATIBILITY
+using System.IO.Compression;
+#endif
 using System.IO.Pipes;
 using System.Threading;
 using Microsoft.Build.Internal;
 using Microsoft.Build.Shared;
+using Microsoft.Build.Utilities;
 #if FEATURE_SECURITY_PERMISSIONS || FEATURE_PIPE_SECURITY
 using System.Security.AccessControl;
 #endif
@@ -43,6 +48,11 @@ namespace Microsoft.Build.BackEnd
         /// </summary>
         private const int PipeBufferSize = 131072;
 
+        /// <summary>
+        /// The size past which queued packets are written to the pipe rather than coalesced with the packets after them.
+        /// </summary>
+        private const int MaxPacketBatchSize = 1048576;
+
         /// <summary>
         /// Flag indicating if we should debug communications or not.
         /// </summary>
@@ -109,6 +119,23 @@ namespace Microsoft.Build.BackEnd
         /// </summary>
         private BinaryWriter _binaryWriter;
 
+        /// <summary>
+        /// The size from which the bodies of build results are compressed before being sent, or zero not to compress them.
+        /// </summary>
+        private int _packetCompressionThreshold;
+
+        /// <summary>
+        /// Whether the strings of the packets sent are written once per connection, and then referred to by their id.
+        /// </summary>
+        private bool _useStringTable;
+
+#if !CLR2COMPATIBILITY
+        /// <summary>
+        /// A way to cache a byte array when compressing packets
+        /// </summary>
+        private MemoryStream _compressedPacketStream;
+#endif
+
 #endregion
 
 #region INodeEndpoint Events
@@ -201,6 +228,8 @@ namespace Microsoft.Build.BackEnd
 
             _packetStream = new MemoryStream();
             _binaryWriter = new BinaryWriter(_packetStream);
+            _packetCompressionThreshold = Traits.Instance.NodePacketCompressionThreshold;
+            _useStringTable = Traits.Instance.UseNodePacketStringTable;
 
 #if FEATURE_PIPE_SECURITY && FEATURE_NAMED_PIPE_SECURITY_CONSTRUCTOR
             if (!NativeMethodsShared.IsMono)
@@ -510,6 +539,10 @@ namespace Microsoft.Build.BackEnd
             // spammed to the endpoint and it never gets an opportunity to shutdown.
             CommunicationsUtilities.Trace("Entering read loop.");
             byte[] headerByte = new byte[5];
+
+            // The string table lives as long as the connection, like the one reading the packets on the other end
+            Dictionary<string, int> stringTable = _useStringTable ? new Dictionary<string, int>(StringComparer.Ordinal) : null;
+
 #if FEATURE_APM
             IAsyncResult result = localReadPipe.BeginRead(headerByte, 0, headerByte.Length, null, null);
 #else
@@ -599,30 +632,55 @@ namespace Microsoft.Build.BackEnd
                     case 2:
                         try
                         {
-                            // Write out all the queued packets.
+                            // Write out all the queued packets. Packets queued together, like the bursts of messages
+                            // logged at diagnostic verbosity, are framed back to back and written to the pipe at once.
+                            var packetStream = _packetStream;
+                            packetStream.SetLength(0);
+
+                            ITranslator writeTranslator = stringTable == null
+                                ? BinaryTranslator.GetWriteTranslator(packetStream)
+                                : BinaryTranslator.GetWriteTranslator(packetStream, stringTable);
+
                             INodePacket packet;
                             while (localPacketQueue.TryDequeue(out packet))
                             {
-                                var packetStream = _packetStream;
-                                packetStream.SetLength(0);
-
-                                ITranslator writeTranslator = BinaryTranslator.GetWriteTranslator(packetStream);
+                                int packetStart = (int)packetStream.Position;
 
-                                packetStream.WriteByte((byte)packet.Type);
+                                packetStream.WriteByte(stringTable == null
+                                    ? (byte)packet.Type
+                                    : (byte)((byte)packet.Type | CommunicationsUtilities.StringTablePacketFlag));
 
                                 // Pad for packet length
                                 _binaryWriter.Write(0);
 
-                                // Reset the position in the write buffer.
                                 packet.Translate(writeTranslator);
 
+                                int packetLength = (int)packetStream.Position - packetStart - 5;
+
+#if !CLR2COMPATIBILITY
+                                if (_packetCompressionThreshold > 0 && packet.Type == NodePacketType.BuildResult && packetLength >= _packetCompressionThreshold)
+                                {
+                                    packetLength = CompressPacketBody(packetStream, packetStart, packetLength);
+                                }
+#endif
+
                                 int packetStreamLength = (int)packetStream.Position;
 
                                 // Now write in the actual packet length
-                                packetStream.Position = 1;
-                                _binaryWriter.Write(packetStreamLength - 5);
+                                packetStream.Position = packetStart + 1;
+                                _binaryWriter.Write(packetLength);
+                                packetStream.Position = packetStreamLength;
 
-                                localWritePipe.Write(packetStream.GetBuffer(), 0, packetStreamLength);
+                                if (packetStreamLength >= MaxPacketBatchSize)
+                                {
+                                    localWritePipe.Write(packetStream.GetBuffer(), 0, packetStreamLength);
+                                    packetStream.SetLength(0);
+                                }
+                            }
+
+                            if (packetStream.Length > 0)
+                            {
+                                localWritePipe.Write(packetStream.GetBuffer(), 0, (int)packetStream.Length);
                             }
                         }
                         catch (Exception e)
@@ -652,6 +710,42 @@ namespace Microsoft.Build.BackEnd
             while (!exitLoop);
         }
 
+#if !CLR2COMPATIBILITY
+        /// <summary>
+        /// Compresses the body of the packet written last to the packet stream, if that makes it smaller, and marks
+        /// its type as compressed. The stream is left positioned at the end of the packet.
+        /// </summary>
+        /// <param name="packetStream">The stream the packet was written to.</param>
+        /// <param name="packetStart">The position of the packet's type in the stream.</param>
+        /// <param name="packetLength">The length of the packet's body.</param>
+        /// <returns>The length of the packet's body as it is to be sent.</returns>
+        private int CompressPacketBody(MemoryStream packetStream, int packetStart, int packetLength)
+        {
+            _compressedPacketStream ??= new MemoryStream();
+
+            MemoryStream compressedStream = _compressedPacketStream;
+            compressedStream.SetLength(0);
+
+            using (var deflateStream = new DeflateStream(compressedStream, CompressionLevel.Fastest, leaveOpen: true))
+            {
+                deflateStream.Write(packetStream.GetBuffer(), packetStart + 5, packetLength);
+            }
+
+            int compressedLength = (int)compressedStream.Length;
+            if (compressedLength >= packetLength)
+            {
+                return packetLength;
+            }
+
+            packetStream.Position = packetStart + 5;
+            packetStream.Write(compressedStream.GetBuffer(), 0, compressedLength);
+            packetStream.SetLength(packetStream.Position);
+            packetStream.GetBuffer()[packetStart] |= CommunicationsUtilities.CompressedPacketFlag;
+
+            return compressedLength;
+        }
+#endif
+
 #endregion
 
 #endregion
@@ -0,0 +1,160 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.IO;
+using Microsoft.Build.Framework;
+using Microsoft.Build.Utilities;
+
+#if BUILD_ENGINE
+using Microsoft.Build.BackEnd.Components.Caching;
+#endif
+
+namespace Microsoft.Build.Shared
+{
+    /// <summary>
+    /// A cache of file timestamps that is shared by everything that checks up-to-dateness during a single build,
+    /// so that widely shared inputs such as SDK and compiler headers are only checked on disk once per build.
+    /// </summary>
+    /// <remarks>
+    /// The cache is registered as a build-lifetime task object, so the engine and the tasks running in a node
+    /// share it and it is thrown away when the build completes. It is keyed and typed using only framework
+    /// types so that every assembly that compiles this file sees the same object.
+    ///
+    /// Only files beneath installation directories (Program Files and the Visual Studio install root), which the
+    /// build itself is not expected to write to, are cached. Anything else, including the Windows directory with
+    /// the temp directories of service accounts beneath it, may be produced by an earlier target or task in the
+    /// same build, and so is always checked on disk.
+    /// </remarks>
+    internal static class SharedFileTimestampCache
+    {
+        /// <summary>
+        /// The key the cache is registered under.
+        /// </summary>
+        private const string RegisteredTaskObjectKey = "Microsoft.Build.Shared.SharedFileTimestampCache";
+
+        /// <summary>
+        /// The directories beneath which file timestamps can be cached for the duration of a build.
+        /// </summary>
+        private static readonly Lazy<string[]> s_immutableDirectories = new Lazy<string[]>(GetImmutableDirectories);
+
+        /// <summary>
+        /// Get the cache for the current build from the build engine the task is running in.
+        /// </summary>
+        /// <param name="buildEngine">The build engine, which may be null or not support registered task objects</param>
+        /// <returns>The cache, or null if there is no build to share it with</returns>
+        internal static ConcurrentDictionary<string, DateTime> GetForBuild(IBuildEngine buildEngine)
+        {
+            if (Traits.Instance.EscapeHatches.DisableSharedFileTimestampCache || !(buildEngine is IBuildEngine4 buildEngine4))
+            {
+                return null;
+            }
+
+            if (!(buildEngine4.GetRegisteredTaskObject(RegisteredTaskObjectKey, RegisteredTaskObjectLifetime.Build) is ConcurrentDictionary<string, DateTime> cache))
+            {
+                buildEngine4.RegisterTaskObject(RegisteredTaskObjectKey, new ConcurrentDictionary<string, DateTime>(StringComparer.OrdinalIgnoreCase), RegisteredTaskObjectLifetime.Build, allowEarlyCollection: false);
+
+                // Someone else may have registered theirs first
+                cache = buildEngine4.GetRegisteredTaskObject(RegisteredTaskObjectKey, RegisteredTaskObjectLifetime.Build) as ConcurrentDictionary<string, DateTime>;
+            }
+
+            return cache;
+        }
+
+#if BUILD_ENGINE
+        /// <summary>
+        /// Get the cache for the current build from the node's registered task object cache.
+        /// </summary>
+        /// <param name="objectCache">The registered task object cache</param>
+        /// <returns>The cache, or null if it is disabled</returns>
+        internal static ConcurrentDictionary<string, DateTime> GetForBuild(IRegisteredTaskObjectCache objectCache)
+        {
+            if (Traits.Instance.EscapeHatches.DisableSharedFileTimestampCache || objectCache == null)
+            {
+                return null;
+            }
+
+            if (!(objectCache.GetRegisteredTaskObject(RegisteredTaskObjectKey, RegisteredTaskObjectLifetime.Build) is ConcurrentDictionary<string, DateTime> cache))
+            {
+                objectCache.RegisterTaskObject(RegisteredTaskObjectKey, new ConcurrentDictionary<string, DateTime>(StringComparer.OrdinalIgnoreCase), RegisteredTaskObjectLifetime.Build, allowEarlyCollection: false);
+
+                // Someone else may have registered theirs first
+                cache = objectCache.GetRegisteredTaskObject(RegisteredTaskObjectKey, RegisteredTaskObjectLifetime.Build) as ConcurrentDictionary<string, DateTime>;
+            }
+
+            return cache;
+        }
+#endif
+
+        /// <summary>
+        /// Get the last write time of the given file, from the cache if the file is one that can be cached.
+        /// </summary>
+        /// <param name="fullPath">The full path to the file</param>
+        /// <param name="cache">The cache for the current build, or null if there is none</param>
+        /// <returns>The last write time of the file in UTC, or DateTime.MinValue if it does not exist</returns>
+        internal static DateTime GetLastWriteFileUtcTime(string fullPath, ConcurrentDictionary<string, DateTime> cache)
+        {
+            if (cache == null || !IsUnderImmutableDirectory(fullPath))
+            {
+                return NativeMethodsShared.GetLastWriteFileUtcTime(fullPath);
+            }
+
+            if (!cache.TryGetValue(fullPath, out DateTime lastWriteTimeUtc))
+            {
+                lastWriteTimeUtc = NativeMethodsShared.GetLastWriteFileUtcTime(fullPath);
+                cache[fullPath] = lastWriteTimeUtc;
+            }
+
+            return lastWriteTimeUtc;
+        }
+
+        /// <summary>
+        /// Determine whether the file is beneath one of the installation directories the build doesn't write to.
+        /// </summary>
+        internal static bool IsUnderImmutableDirectory(string fullPath)
+        {
+            // A path that climbs back out of an installation directory may refer to anything
+            if (fullPath.IndexOf("..", StringComparison.Ordinal) >= 0)
+            {
+                return false;
+            }
+
+            foreach (string directory in s_immutableDirectories.Value)
+            {
+                if (fullPath.StartsWith(directory, StringComparison.OrdinalIgnoreCase))
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        /// <summary>
+        /// Get the installation directories, leaving out any of them that contain the temp directory.
+        /// </summary>
+        private static string[] GetImmutableDirectories()
+        {
+            var directories = new List<string>();
+
+            void AddDirectory(string directory)
+            {
+                if (!string.IsNullOrEmpty(directory) && Path.IsPathRooted(directory))
+                {
+                    directories.Add(FileUtilities.EnsureTrailingSlash(directory));
+                }
+            }
+
+            AddDirectory(Environment.GetFolderPath(Environment.SpecialFolder.ProgramFiles));
+            AddDirectory(Environment.GetFolderPath(Environment.SpecialFolder.ProgramFilesX86));
+            AddDirectory(BuildEnvironmentHelper.Instance.VisualStudioInstallRootDirectory);
+
+            string tempDirectory = FileUtilities.EnsureTrailingSlash(Path.GetTempPath());
+            directories.RemoveAll(directory => tempDirectory.StartsWith(directory, StringComparison.OrdinalIgnoreCase));
+
+            return directories.ToArray();
+        }
+    }
+}
@@ -51,6 +51,11 @@ namespace Microsoft.Build.Utilities
         /// </summary>
         public readonly bool MSBuildCacheFileEnumerations = !string.IsNullOrEmpty(Environment.GetEnvironmentVariable("MsBuildCacheFileEnumerations"));
 
+        /// <summary>
+        /// Share the directory entries that evaluations enumerate for the entire process, validated against the timestamps of the directories
+        /// </summary>
+        public readonly bool UseDirectoryIndex = Environment.GetEnvironmentVariable("MSBUILDDIRECTORYINDEX") == "1";
+
         public readonly bool EnableAllPropertyFunctions = Environment.GetEnvironmentVariable("MSBUILDENABLEALLPROPERTYFUNCTIONS") == "1";
 
         /// <summary>
@@ -86,6 +91,66 @@ namespace Microsoft.Build.Utilities
         /// </summary>
         public readonly int LogPropertyTracking = ParseIntFromEnvironmentVariableOrDefault("MsBuildLogPropertyTracking", 0); // Default to logging nothing via the property tracker.
 
+        /// <summary>
+        /// Write compacted tracking logs in the binary tlog format instead of text.
+        /// </summary>
+        public readonly bool WriteBinaryTlogs = Environment.GetEnvironmentVariable("MSBUILDWRITEBINARYTLOGS") == "1";
+
+        /// <summary>
+        /// Write compacted tracking logs in the background, handing their contents to readers in the process from memory.
+        /// </summary>
+        public readonly bool WriteTlogsInBackground = Environment.GetEnvironmentVariable("MSBUILDWRITETLOGSINBACKGROUND") == "1";
+
+        /// <summary>
+        /// Persist dependency tables built from tracking logs next to the tlogs, so that new processes don't need to re-parse them.
+        /// </summary>
+        public readonly bool PersistDependencyTableCache = Environment.GetEnvironmentVariable("MSBUILDPERSISTDEPENDENCYTABLECACHE") == "1";
+
+        /// <summary>
+        /// The maximum number of dependency tables built from tracking logs to keep in memory. Zero or less means unbounded.
+        /// </summary>
+        public readonly int DependencyTableCacheCapacity = ParseIntFromEnvironmentVariableOrDefault("MSBUILDDEPENDENCYTABLECACHECAPACITY", 1024);
+
+        /// <summary>
+        /// When a tracked input of CanonicalTrackedInputFiles is newer than its outputs, compare its contents with those
+        /// recorded at the previous up to date check before deciding that it has changed.
+        /// </summary>
+        public readonly bool UseContentHashesForTrackedInputs = Environment.GetEnvironmentVariable("MSBUILDUSECONTENTHASHESFORTRACKEDINPUTS") == "1";
+
+        /// <summary>
+        /// Compress the build results that out of proc nodes send back when they are at least this many bytes. Zero (default) doesn't compress them.
+        /// </summary>
+        public readonly int NodePacketCompressionThreshold = ParseIntFromEnvironmentVariableOrDefault("MSBUILDNODEPACKETCOMPRESSIONTHRESHOLD", 0);
+
+        /// <summary>
+        /// Have out of proc nodes send each string once per connection, and then its id, in the packets they send back.
+        /// </summary>
+        public readonly bool UseNodePacketStringTable = Environment.GetEnvironmentVariable("MSBUILDNODEPACKETSTRINGTABLE") == "1";
+
+        /// <summary>
+        /// The number of target output items the results cache holds in memory before writing those of the least recently used results
+        /// to disk. Zero (default) holds all of them.
+        /// </summary>
+        public readonly int ResultsCacheItemLimit = ParseIntFromEnvironmentVariableOrDefault("MSBUILDRESULTSCACHEITEMLIMIT", 0);
+
+        /// <summary>
+        /// Launch the out of proc nodes of builds without node reuse when the build begins, and have nodes load the common imports
+        /// while they wait for their first request.
+        /// </summary>
+        public readonly bool PrelaunchNodes = Environment.GetEnvironmentVariable("MSBUILDPRELAUNCHNODES") == "1";
+
+        /// <summary>
+        /// Persist the project graphs that graph builds construct to this file, and reuse the evaluations of the projects whose files
+        /// haven't changed since when constructing the next one.
+        /// </summary>
+        public readonly string ProjectGraphCacheFile = Environment.GetEnvironmentVariable("MSBUILDPROJECTGRAPHCACHEFILE");
+
+        /// <summary>
+        /// Persist the evaluations of the projects that builds load to this directory, and reuse them instead of evaluating the
+        /// projects again until their files or the environment variables they read change.
+        /// </summary>
+        public readonly string EvaluationCacheDirectory = Environment.GetEnvironmentVariable("MSBUILDEVALUATIONCACHEDIRECTORY");
+
         private static int ParseIntFromEnvironmentVariableOrDefault(string environmentVariable, int defaultValue)
         {
             return int.TryParse(Environment.GetEnvironmentVariable(environmentVariable), out int result)
@@ -256,6 +321,16 @@ namespace Microsoft.Build.Utilities
         /// </summary>
         public readonly bool DisableSdkResolutionCache = Environment.GetEnvironmentVariable("MSBUILDDISABLESDKCACHE") == "1";
 
+        /// <summary>
+        /// Disable sharing the timestamps of files in installation directories between up-to-date checks in the same build.
+        /// </summary>
+        public readonly bool DisableSharedFileTimestampCache = Environment.GetEnvironmentVariable("MSBUILDDISABLESHAREDTIMESTAMPCACHE") == "1";
+
+        /// <summary>
+        /// Disable sharing whether files in installation directories exist between the evaluations in the same build.
+        /// </summary>
+        public readonly bool DisableSharedFileExistenceCache = Environment.GetEnvironmentVariable("MSBUILDDISABLESHAREDEXISTENCECACHE") == "1";
+
         /// <summary>
         /// Disable the NuGet-based SDK resolver.
         /// </summary>
@@ -281,6 +356,11 @@ namespace Microsoft.Build.Utilities
         /// </summary>
         public readonly bool AvoidUnicodeWhenWritingToolTaskBatch = Environment.GetEnvironmentVariable("MSBUILDAVOIDUNICODE") == "1";
 
+        /// <summary>
+        /// Makes ToolTask receive the output of tools line by line through the events of Process, instead of reading it in chunks.
+        /// </summary>
+        public readonly bool UseProcessDataReceivedEventsInToolTask = Environment.GetEnvironmentVariable("MSBUILDTOOLTASKUSEDATARECEIVEDEVENTS") == "1";
+
         /// <summary>
         /// Workaround for https://github.com/Microsoft/vstest/issues/1503.
         /// </summary>
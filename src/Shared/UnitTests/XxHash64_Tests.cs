@@ -0,0 +1,49 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.IO;
+using System.Text;
+using Microsoft.Build.Shared;
+using Shouldly;
+using Xunit;
+
+namespace Microsoft.Build.UnitTests
+{
+    public sealed class XxHash64_Tests
+    {
+        /// <summary>
+        /// The hashes of the reference implementation with a seed of 0, for input shorter than a stripe and for a whole
+        /// stripe followed by a partial one.
+        /// </summary>
+        [Theory]
+        [InlineData("", 0xEF46DB3751D8E999UL)]
+        [InlineData("a", 0xD24EC4F1A98C6E5BUL)]
+        [InlineData("abc", 0x44BC2CF5AD770999UL)]
+        [InlineData("Nobody inspects the spammish repetition", 0xFBCEA83C8A378BF1UL)]
+        public void HashMatchesKnownAnswers(string input, ulong expectedHash)
+        {
+            using (var stream = new MemoryStream(Encoding.ASCII.GetBytes(input)))
+            {
+                XxHash64.Hash(stream).ShouldBe(expectedHash);
+            }
+        }
+
+        /// <summary>
+        /// A stream longer than the buffer it is read through is hashed the same as the reference implementation.
+        /// </summary>
+        [Fact]
+        public void HashOfStreamLongerThanBufferMatchesKnownAnswer()
+        {
+            var data = new byte[65536 + 100];
+            for (int i = 0; i < data.Length; i++)
+            {
+                data[i] = unchecked((byte)((i * 31) + 7));
+            }
+
+            using (var stream = new MemoryStream(data))
+            {
+                XxHash64.Hash(stream).ShouldBe(0x243B694B676958E8UL);
+            }
+        }
+    }
+}
@@ -0,0 +1,163 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.IO;
+
+namespace Microsoft.Build.Shared
+{
+    /// <summary>
+    /// The 64-bit xxHash algorithm, a fast non-cryptographic hash suitable for detecting whether the
+    /// contents of a file have changed. It must not be used where an adversary can choose the input.
+    /// </summary>
+    internal static class XxHash64
+    {
+        private const ulong Prime1 = 11400714785074694791UL;
+        private const ulong Prime2 = 14029467366897019727UL;
+        private const ulong Prime3 = 1609587929392839161UL;
+        private const ulong Prime4 = 9650029242287828579UL;
+        private const ulong Prime5 = 2870177450012600261UL;
+
+        private const int StripeLength = 32;
+
+        // A multiple of the stripe length, so that only the end of the stream is ever a partial stripe
+        private const int BufferLength = StripeLength * 2048;
+
+        /// <summary>
+        /// Hash the contents of the stream from its current position to its end.
+        /// </summary>
+        internal static ulong Hash(Stream stream)
+        {
+            var state = new State();
+            var buffer = new byte[BufferLength];
+            long length = 0;
+
+            while (true)
+            {
+                // Fill the buffer completely unless the end of the stream is reached
+                int read = 0;
+                int bytesRead;
+                while (read < buffer.Length && (bytesRead = stream.Read(buffer, read, buffer.Length - read)) > 0)
+                {
+                    read += bytesRead;
+                }
+
+                length += read;
+
+                if (read < buffer.Length)
+                {
+                    int stripes = read / StripeLength;
+                    state.ProcessStripes(buffer, 0, stripes);
+                    return state.Complete(buffer, stripes * StripeLength, read - (stripes * StripeLength), length);
+                }
+
+                state.ProcessStripes(buffer, 0, buffer.Length / StripeLength);
+            }
+        }
+
+        private static ulong Round(ulong accumulator, ulong lane)
+        {
+            accumulator += lane * Prime2;
+            accumulator = RotateLeft(accumulator, 31);
+            return accumulator * Prime1;
+        }
+
+        private static ulong MergeAccumulator(ulong hash, ulong accumulator)
+        {
+            hash ^= Round(0, accumulator);
+            return (hash * Prime1) + Prime4;
+        }
+
+        private static ulong RotateLeft(ulong value, int bits) => (value << bits) | (value >> (64 - bits));
+
+        private static ulong ReadUInt64(byte[] data, int offset) => BitConverter.IsLittleEndian
+            ? BitConverter.ToUInt64(data, offset)
+            : (ulong)ReadUInt32(data, offset) | ((ulong)ReadUInt32(data, offset + 4) << 32);
+
+        private static uint ReadUInt32(byte[] data, int offset)
+            => data[offset] | ((uint)data[offset + 1] << 8) | ((uint)data[offset + 2] << 16) | ((uint)data[offset + 3] << 24);
+
+        /// <summary>
+        /// The four accumulators, which consume the input a stripe at a time.
+        /// </summary>
+        private struct State
+        {
+            private bool _started;
+            private ulong _v1;
+            private ulong _v2;
+            private ulong _v3;
+            private ulong _v4;
+
+            internal void ProcessStripes(byte[] data, int offset, int stripes)
+            {
+                if (stripes == 0)
+                {
+                    return;
+                }
+
+                if (!_started)
+                {
+                    _v1 = unchecked(Prime1 + Prime2);
+                    _v2 = Prime2;
+                    _v3 = 0;
+                    _v4 = unchecked(0 - Prime1);
+                    _started = true;
+                }
+
+                for (int i = 0; i < stripes; i++, offset += StripeLength)
+                {
+                    _v1 = Round(_v1, ReadUInt64(data, offset));
+                    _v2 = Round(_v2, ReadUInt64(data, offset + 8));
+                    _v3 = Round(_v3, ReadUInt64(data, offset + 16));
+                    _v4 = Round(_v4, ReadUInt64(data, offset + 24));
+                }
+            }
+
+            internal ulong Complete(byte[] data, int offset, int remaining, long totalLength)
+            {
+                ulong hash;
+                if (_started)
+                {
+                    hash = RotateLeft(_v1, 1) + RotateLeft(_v2, 7) + RotateLeft(_v3, 12) + RotateLeft(_v4, 18);
+                    hash = MergeAccumulator(hash, _v1);
+                    hash = MergeAccumulator(hash, _v2);
+                    hash = MergeAccumulator(hash, _v3);
+                    hash = MergeAccumulator(hash, _v4);
+                }
+                else
+                {
+                    hash = Prime5;
+                }
+
+                hash += (ulong)totalLength;
+
+                for (; remaining >= 8; offset += 8, remaining -= 8)
+                {
+                    hash ^= Round(0, ReadUInt64(data, offset));
+                    hash = (RotateLeft(hash, 27) * Prime1) + Prime4;
+                }
+
+                if (remaining >= 4)
+                {
+                    hash ^= ReadUInt32(data, offset) * Prime1;
+                    hash = (RotateLeft(hash, 23) * Prime2) + Prime3;
+                    offset += 4;
+                    remaining -= 4;
+                }
+
+                for (; remaining > 0; offset++, remaining--)
+                {
+                    hash ^= data[offset] * Prime5;
+                    hash = RotateLeft(hash, 11) * Prime1;
+                }
+
+                hash ^= hash >> 33;
+                hash *= Prime2;
+                hash ^= hash >> 29;
+                hash *= Prime3;
+                hash ^= hash >> 32;
+                return hash;
+            }
+        }
+    }
+}
@@ -2105,6 +2105,33 @@ namespace Microsoft.Build.UnitTests
             Assert.False(result);
             engine.AssertLogContains("MSB3892");
         }
+
+        /// <summary>
+        /// Verifies that cloning a file either makes an identical copy, or fails without leaving one behind
+        /// on volumes that don't support block cloning.
+        /// </summary>
+        [Fact]
+        public void MakeFileCloneCopiesOrLeavesNoFile()
+        {
+            using (var env = TestEnvironment.Create())
+            {
+                TransientTestFile sourceFile = env.CreateFile("source.txt", "This is a source file that will be cloned.");
+                string destinationFile = Path.Combine(env.CreateFolder().Path, "destination.txt");
+
+                string errorMessage = null;
+                if (NativeMethods.MakeFileClone(destinationFile, sourceFile.Path, ref errorMessage))
+                {
+                    Assert.Null(errorMessage);
+                    Assert.Equal(File.ReadAllText(sourceFile.Path), File.ReadAllText(destinationFile));
+                    Assert.Equal(File.GetLastWriteTimeUtc(sourceFile.Path), File.GetLastWriteTimeUtc(destinationFile));
+                }
+                else
+                {
+                    Assert.NotNull(errorMessage);
+                    Assert.False(File.Exists(destinationFile));
+                }
+            }
+        }
     }
 
     public class CopyHardLink_Tests : Copy_Tests
@@ -3,6 +3,7 @@
 
 using System;
 using System.IO;
+using System.Security.Cryptography;
 using Microsoft.Build.Tasks;
 using Microsoft.Build.Tasks.UnitTests.TestResources;
 using Microsoft.Build.Utilities;
@@ -94,5 +95,61 @@ namespace Microsoft.Build.UnitTests
             task.Items.Length.ShouldBe(2);
             task.Items.ShouldAllBe(i => string.Equals(testBinary.FileHash, i.GetMetadata("FileHash"), StringComparison.Ordinal));
         }
+
+        [Fact]
+        public void FileHashCache_ReusesHashOfUnchangedFile()
+        {
+            using (TestEnvironment env = TestEnvironment.Create())
+            {
+                TransientTestFile file = env.CreateFile("file.txt", "original");
+                DateTime lastWriteTimeUtc = DateTime.UtcNow.AddHours(-1);
+                File.SetLastWriteTimeUtc(file.Path, lastWriteTimeUtc);
+                string cacheFile = Path.Combine(env.CreateFolder().Path, "hashes.cache");
+
+                var cache = new FileHashCache(cacheFile);
+                byte[] originalHash = cache.GetHash("SHA256", SHA256.Create, file.Path);
+                cache.Save();
+
+                // A file with the size and last write time it had is assumed unchanged
+                File.WriteAllText(file.Path, "modified");
+                File.SetLastWriteTimeUtc(file.Path, lastWriteTimeUtc);
+
+                cache = new FileHashCache(cacheFile);
+                cache.GetHash("SHA256", SHA256.Create, file.Path).ShouldBe(originalHash);
+
+                File.SetLastWriteTimeUtc(file.Path, lastWriteTimeUtc.AddSeconds(1));
+                cache.GetHash("SHA256", SHA256.Create, file.Path).ShouldBe(GetFileHash.ComputeHash(SHA256.Create, file.Path));
+                cache.GetHash("SHA256", SHA256.Create, file.Path).ShouldNotBe(originalHash);
+            }
+        }
+
+        [Fact]
+        public void FileHashCache_IgnoresTruncatedCacheFile()
+        {
+            using (TestEnvironment env = TestEnvironment.Create())
+            {
+                TransientTestFile file = env.CreateFile("file.txt", "original");
+                DateTime lastWriteTimeUtc = DateTime.UtcNow.AddHours(-1);
+                File.SetLastWriteTimeUtc(file.Path, lastWriteTimeUtc);
+                string cacheFile = Path.Combine(env.CreateFolder().Path, "hashes.cache");
+
+                var cache = new FileHashCache(cacheFile);
+                byte[] originalHash = cache.GetHash("SHA256", SHA256.Create, file.Path);
+                cache.Save();
+
+                // Cut the cache file off within the hash of its last entry
+                using (var stream = new FileStream(cacheFile, FileMode.Open))
+                {
+                    stream.SetLength(stream.Length - 1);
+                }
+
+                File.WriteAllText(file.Path, "modified");
+                File.SetLastWriteTimeUtc(file.Path, lastWriteTimeUtc);
+
+                cache = new FileHashCache(cacheFile);
+                cache.GetHash("SHA256", SHA256.Create, file.Path).ShouldBe(GetFileHash.ComputeHash(SHA256.Create, file.Path));
+                cache.GetHash("SHA256", SHA256.Create, file.Path).ShouldNotBe(originalHash);
+            }
+        }
     }
 }
@@ -87,6 +87,12 @@ namespace Microsoft.Build.Tasks
         /// </summary>
         private static readonly bool s_forceSymlinks = Environment.GetEnvironmentVariable("MSBuildUseSymboliclinksIfPossible") != null;
 
+        /// <summary>
+        /// Global flag to copy files by cloning their blocks on Windows volumes that support it, like ReFS and Dev Drives, falling
+        /// back to copying them. Unlike links, clones are independent copies, so this doesn't change what the copy task does.
+        /// </summary>
+        private static readonly bool s_useClones = NativeMethodsShared.IsWindows && Environment.GetEnvironmentVariable("MSBUILDCOPYUSECLONES") == "1";
+
         private static readonly int s_parallelism = GetParallelismFromEnvironment();
 
         /// <summary>
@@ -296,7 +302,10 @@ namespace Microsoft.Build.Tasks
                 string destinationFilePath = FileUtilities.GetFullPathNoThrow(destinationFileState.Name);
                 Log.LogMessage(MessageImportance.Normal, FileComment, sourceFilePath, destinationFilePath);
 
-                File.Copy(sourceFileState.Name, destinationFileState.Name, true);
+                if (!s_useClones || !NativeMethods.MakeFileClone(destinationFileState.Name, sourceFileState.Name, ref errorMessage))
+                {
+                    File.Copy(sourceFileState.Name, destinationFileState.Name, true);
+                }
             }
 
             destinationFileState.Reset();
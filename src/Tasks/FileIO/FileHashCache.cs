@@ -0,0 +1,249 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.IO;
+using System.Security.Cryptography;
+using Microsoft.Build.Shared;
+
+namespace Microsoft.Build.Tasks
+{
+    /// <summary>
+    /// The hashes that <see cref="GetFileHash"/> computed, by algorithm, path, size and last write time, persisted to a file
+    /// so that builds only read the files that changed since a previous build hashed them.
+    /// </summary>
+    /// <remarks>
+    /// The cache is opt-in, as a file rewritten with the same size and last write time would keep its old hash. To make that
+    /// unlikely, files written in the last few seconds, which could still change within the resolution of their timestamp,
+    /// aren't cached. For the same reason <see cref="VerifyFileHash"/>, which exists to catch tampered or corrupt files,
+    /// doesn't use the cache. Processes sharing the cache file merge their entries into it when they save it.
+    /// </remarks>
+    internal sealed class FileHashCache
+    {
+        /// <summary>
+        /// The environment variable holding the path of the cache file that <see cref="Shared"/> uses.
+        /// </summary>
+        internal const string CacheFileEnvironmentVariable = "MSBUILDFILEHASHCACHE";
+
+        private const int FormatVersion = 1;
+
+        /// <summary>
+        /// The most entries a saved cache keeps from other processes and earlier builds, on top of those used by this process.
+        /// </summary>
+        private const int MaxEntries = 1_000_000;
+
+        /// <summary>
+        /// The size of the largest hash, that of SHA512.
+        /// </summary>
+        private const int MaxHashLength = 64;
+
+        /// <summary>
+        /// How long after a file was written its hash is cached.
+        /// </summary>
+        private static readonly TimeSpan s_minimumAge = TimeSpan.FromSeconds(5);
+
+        private static readonly Lazy<FileHashCache> s_shared = new Lazy<FileHashCache>(() =>
+        {
+            string path = Environment.GetEnvironmentVariable(CacheFileEnvironmentVariable);
+            return string.IsNullOrEmpty(path) ? null : new FileHashCache(path);
+        });
+
+        private readonly string _cacheFilePath;
+
+        private readonly object _saveLock = new object();
+
+        private readonly Lazy<ConcurrentDictionary<string, Entry>> _entries;
+
+        private volatile bool _isDirty;
+
+        internal FileHashCache(string cacheFilePath)
+        {
+            _cacheFilePath = Path.GetFullPath(cacheFilePath);
+            _entries = new Lazy<ConcurrentDictionary<string, Entry>>(() => new ConcurrentDictionary<string, Entry>(Load(_cacheFilePath), StringComparer.Ordinal));
+        }
+
+        /// <summary>
+        /// The cache shared by the process, in the file named by the MSBUILDFILEHASHCACHE environment variable, or null if it isn't set.
+        /// </summary>
+        internal static FileHashCache Shared => s_shared.Value;
+
+        /// <summary>
+        /// Gets the hash of a file, computing it only if the file changed since it was cached.
+        /// </summary>
+        internal byte[] GetHash(string algorithm, Func<HashAlgorithm> algorithmFactory, string filePath)
+        {
+            var fileInfo = new FileInfo(filePath);
+            string key = algorithm.ToUpperInvariant() + "|" + fileInfo.FullName;
+            long length = fileInfo.Length;
+            DateTime lastWriteTimeUtc = fileInfo.LastWriteTimeUtc;
+
+            if (_entries.Value.TryGetValue(key, out Entry entry) &&
+                entry.Length == length &&
+                entry.LastWriteTimeUtcTicks == lastWriteTimeUtc.Ticks)
+            {
+                entry.IsUsed = true;
+                return entry.Hash;
+            }
+
+            // The size and timestamp are read before the file, so that a write while it is hashed changes them for the next build
+            byte[] hash = GetFileHash.ComputeHash(algorithmFactory, filePath);
+
+            if (DateTime.UtcNow - lastWriteTimeUtc > s_minimumAge)
+            {
+                _entries.Value[key] = new Entry(length, lastWriteTimeUtc.Ticks, hash) { IsUsed = true };
+                _isDirty = true;
+            }
+
+            return hash;
+        }
+
+        /// <summary>
+        /// Writes the cache to the cache file if it has new entries, merged with the entries other processes saved.
+        /// Failing to save the cache only costs hashing the files again, so errors are ignored.
+        /// </summary>
+        internal void Save()
+        {
+            if (!_isDirty)
+            {
+                return;
+            }
+
+            lock (_saveLock)
+            {
+                if (!_isDirty)
+                {
+                    return;
+                }
+
+                _isDirty = false;
+
+                ConcurrentDictionary<string, Entry> entries = _entries.Value;
+                foreach (KeyValuePair<string, Entry> saved in Load(_cacheFilePath))
+                {
+                    entries.TryAdd(saved.Key, saved.Value);
+                }
+
+                if (entries.Count > MaxEntries)
+                {
+                    foreach (KeyValuePair<string, Entry> unused in entries)
+                    {
+                        if (!unused.Value.IsUsed)
+                        {
+                            entries.TryRemove(unused.Key, out _);
+                        }
+                    }
+                }
+
+                string temporaryFilePath = _cacheFilePath + "." + Guid.NewGuid().ToString("N") + ".tmp";
+                try
+                {
+                    Directory.CreateDirectory(Path.GetDirectoryName(_cacheFilePath));
+
+                    using (var writer = new BinaryWriter(File.Create(temporaryFilePath)))
+                    {
+                        writer.Write(FormatVersion);
+
+                        var snapshot = entries.ToArray();
+                        writer.Write(snapshot.Length);
+                        foreach (KeyValuePair<string, Entry> pair in snapshot)
+                        {
+                            writer.Write(pair.Key);
+                            writer.Write(pair.Value.Length);
+                            writer.Write(pair.Value.LastWriteTimeUtcTicks);
+                            writer.Write(pair.Value.Hash.Length);
+                            writer.Write(pair.Value.Hash);
+                        }
+                    }
+
+                    // Replacing the file leaves readers with either the old entries or the new ones
+                    if (File.Exists(_cacheFilePath))
+                    {
+                        File.Replace(temporaryFilePath, _cacheFilePath, null);
+                    }
+                    else
+                    {
+                        File.Move(temporaryFilePath, _cacheFilePath);
+                    }
+                }
+                catch (Exception e) when (ExceptionHandling.IsIoRelatedException(e))
+                {
+                    FileUtilities.DeleteNoThrow(temporaryFilePath);
+                }
+            }
+        }
+
+        /// <returns>The entries in the cache file, or none if it doesn't exist or can't be read</returns>
+        private static Dictionary<string, Entry> Load(string cacheFilePath)
+        {
+            var entries = new Dictionary<string, Entry>(StringComparer.Ordinal);
+
+            try
+            {
+                if (!File.Exists(cacheFilePath))
+                {
+                    return entries;
+                }
+
+                using (var reader = new BinaryReader(File.OpenRead(cacheFilePath)))
+                {
+                    if (reader.ReadInt32() != FormatVersion)
+                    {
+                        return entries;
+                    }
+
+                    int count = reader.ReadInt32();
+                    for (int i = 0; i < count; i++)
+                    {
+                        string key = reader.ReadString();
+                        long length = reader.ReadInt64();
+                        long lastWriteTimeUtcTicks = reader.ReadInt64();
+                        int hashLength = reader.ReadInt32();
+                        if (hashLength < 0 || hashLength > MaxHashLength)
+                        {
+                            throw new InvalidDataException();
+                        }
+
+                        // ReadBytes returns what is left of a truncated file rather than throwing
+                        byte[] hash = reader.ReadBytes(hashLength);
+                        if (hash.Length != hashLength)
+                        {
+                            throw new InvalidDataException();
+                        }
+
+                        entries[key] = new Entry(length, lastWriteTimeUtcTicks, hash);
+                    }
+                }
+            }
+            catch (Exception e) when (e is FormatException || e is InvalidDataException || ExceptionHandling.IsIoRelatedException(e))
+            {
+                // A missing, truncated or corrupt cache is as good as an empty one
+                entries.Clear();
+            }
+
+            return entries;
+        }
+
+        private sealed class Entry
+        {
+            internal Entry(long length, long lastWriteTimeUtcTicks, byte[] hash)
+            {
+                Length = length;
+                LastWriteTimeUtcTicks = lastWriteTimeUtcTicks;
+                Hash = hash;
+            }
+
+            internal long Length { get; }
+
+            internal long LastWriteTimeUtcTicks { get; }
+
+            internal byte[] Hash { get; }
+
+            /// <summary>
+            /// Whether this process looked the entry up or added it, to keep it when the cache is trimmed.
+            /// </summary>
+            internal bool IsUsed { get; set; }
+        }
+    }
+}
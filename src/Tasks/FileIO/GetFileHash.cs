@@ -20,6 +20,11 @@ namespace Microsoft.Build.Tasks
         internal const string _defaultFileHashAlgorithm = "SHA256";
         internal const string _hashEncodingHex = "hex";
         internal const string _hashEncodingBase64 = "base64";
+
+        /// <summary>
+        /// The size of the blocks files are read in, small enough for the buffer to stay off the large object heap.
+        /// </summary>
+        private const int ReadBufferSize = 80 * 1024;
         internal static readonly Dictionary<string, Func<HashAlgorithm>> SupportedAlgorithms
             = new Dictionary<string, Func<HashAlgorithm>>(StringComparer.OrdinalIgnoreCase)
             {
@@ -75,6 +80,8 @@ namespace Microsoft.Build.Tasks
                 return false;
             }
 
+            FileHashCache cache = FileHashCache.Shared;
+
             var writeLock = new object();
             Parallel.For(0, Files.Length, index =>
             {
@@ -86,7 +93,9 @@ namespace Microsoft.Build.Tasks
                     return;
                 }
 
-                var hash = ComputeHash(algorithmFactory, file.ItemSpec);
+                var hash = cache != null
+                    ? cache.GetHash(Algorithm, algorithmFactory, file.ItemSpec)
+                    : ComputeHash(algorithmFactory, file.ItemSpec);
                 var encodedHash = EncodeHash(encoding, hash);
 
                 lock (writeLock)
@@ -98,6 +107,8 @@ namespace Microsoft.Build.Tasks
                 }
             });
 
+            cache?.Save();
+
             if (Log.HasLoggedErrors)
             {
                 return false;
@@ -126,12 +137,25 @@ namespace Microsoft.Build.Tasks
         internal static bool TryParseHashEncoding(string value, out HashEncoding encoding)
             => Enum.TryParse<HashEncoding>(value, /*ignoreCase:*/ true, out encoding);
 
+        /// <remarks>
+        /// HashAlgorithm.ComputeHash(Stream) reads the stream 4KB at a time. Files like libraries and symbols are large, so
+        /// they are read unbuffered in larger blocks instead, with a hint that they are read once from start to end.
+        /// </remarks>
         internal static byte[] ComputeHash(Func<HashAlgorithm> algorithmFactory, string filePath)
         {
-            using (var stream = File.OpenRead(filePath))
+            using (var stream = new FileStream(filePath, FileMode.Open, FileAccess.Read, FileShare.Read, bufferSize: 1, FileOptions.SequentialScan))
             using (var algorithm = algorithmFactory())
             {
-                return algorithm.ComputeHash(stream);
+                var buffer = new byte[ReadBufferSize];
+
+                int read;
+                while ((read = stream.Read(buffer, 0, buffer.Length)) > 0)
+                {
+                    algorithm.TransformBlock(buffer, 0, read, null, 0);
+                }
+
+                algorithm.TransformFinalBlock(buffer, 0, 0);
+                return algorithm.Hash;
             }
         }
     }
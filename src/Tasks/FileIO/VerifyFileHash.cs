@@ -54,6 +54,7 @@ namespace Microsoft.Build.Tasks
                 return false;
             }
 
+            // The file hash cache trusts the size and last write time, which is not enough to detect a tampered or corrupt file
             byte[] hash = GetFileHash.ComputeHash(algorithmFactory, File);
             string actualHash = GetFileHash.EncodeHash(encoding, hash);
             var comparison = encoding == Tasks.HashEncoding.Hex
@@ -14,6 +14,7 @@ using System.Linq;
 using System.Runtime.ExceptionServices;
 using System.Text.RegularExpressions;
 using Microsoft.Build.Shared.FileSystem;
+using Microsoft.Win32.SafeHandles;
 
 namespace Microsoft.Build.Tasks
 {
@@ -832,6 +833,163 @@ namespace Microsoft.Build.Tasks
             return symbolicLinkCreated;
         }
 
+        //------------------------------------------------------------------------------
+        // Block cloning
+        //------------------------------------------------------------------------------
+        private const uint FILE_SUPPORTS_BLOCK_REFCOUNTING = 0x08000000;
+        private const uint FSCTL_DUPLICATE_EXTENTS_TO_FILE = 0x00098344;
+        private const uint FSCTL_GET_INTEGRITY_INFORMATION = 0x0009027C;
+        private const uint FSCTL_SET_INTEGRITY_INFORMATION = 0x0009C280;
+
+        /// <summary>
+        /// The most bytes cloned by one FSCTL_DUPLICATE_EXTENTS_TO_FILE, which must clone less than 4GB.
+        /// </summary>
+        private const long MaxCloneChunkSize = 1L << 31;
+
+        [StructLayout(LayoutKind.Sequential)]
+        private struct DUPLICATE_EXTENTS_DATA
+        {
+            internal IntPtr FileHandle;
+            internal long SourceFileOffset;
+            internal long TargetFileOffset;
+            internal long ByteCount;
+        }
+
+        [StructLayout(LayoutKind.Sequential)]
+        private struct FSCTL_GET_INTEGRITY_INFORMATION_BUFFER
+        {
+            internal ushort ChecksumAlgorithm;
+            internal ushort Reserved;
+            internal uint Flags;
+            internal uint ChecksumChunkSizeInBytes;
+            internal uint ClusterSizeInBytes;
+        }
+
+        [StructLayout(LayoutKind.Sequential)]
+        private struct FSCTL_SET_INTEGRITY_INFORMATION_BUFFER
+        {
+            internal ushort ChecksumAlgorithm;
+            internal ushort Reserved;
+            internal uint Flags;
+        }
+
+        [DllImport("kernel32.dll", SetLastError = true, CharSet = CharSet.Unicode)]
+        private static extern bool GetVolumeInformationByHandleW(SafeFileHandle hFile, IntPtr lpVolumeNameBuffer, int nVolumeNameSize, IntPtr lpVolumeSerialNumber, IntPtr lpMaximumComponentLength, out uint lpFileSystemFlags, IntPtr lpFileSystemNameBuffer, int nFileSystemNameSize);
+
+        [DllImport("kernel32.dll", SetLastError = true)]
+        private static extern bool DeviceIoControl(SafeFileHandle hDevice, uint dwIoControlCode, IntPtr lpInBuffer, int nInBufferSize, out FSCTL_GET_INTEGRITY_INFORMATION_BUFFER lpOutBuffer, int nOutBufferSize, out int lpBytesReturned, IntPtr lpOverlapped);
+
+        [DllImport("kernel32.dll", SetLastError = true)]
+        private static extern bool DeviceIoControl(SafeFileHandle hDevice, uint dwIoControlCode, ref FSCTL_SET_INTEGRITY_INFORMATION_BUFFER lpInBuffer, int nInBufferSize, IntPtr lpOutBuffer, int nOutBufferSize, out int lpBytesReturned, IntPtr lpOverlapped);
+
+        [DllImport("kernel32.dll", SetLastError = true)]
+        private static extern bool DeviceIoControl(SafeFileHandle hDevice, uint dwIoControlCode, ref DUPLICATE_EXTENTS_DATA lpInBuffer, int nInBufferSize, IntPtr lpOutBuffer, int nOutBufferSize, out int lpBytesReturned, IntPtr lpOverlapped);
+
+        /// <summary>
+        /// Copies a file by cloning its blocks, on volumes that support block cloning like ReFS and Dev Drives. The copy shares
+        /// the storage of the file until either is written to, so only the file system metadata is written. Like File.Copy, the
+        /// copy has the attributes and last write time of the file.
+        /// </summary>
+        /// <remarks>
+        /// File.Copy already clones files when it can on Linux and macOS in .NET, and on Windows versions whose CopyFile does.
+        /// </remarks>
+        /// <returns>True if the file was cloned. Otherwise the new file doesn't exist, and the error message says why.</returns>
+        internal static bool MakeFileClone(string newFileName, string exitingFileName, ref string errorMessage)
+        {
+            if (!NativeMethodsShared.IsWindows)
+            {
+                errorMessage = "Block cloning is only supported on Windows.";
+                return false;
+            }
+
+            bool cloned = false;
+            bool created = false;
+            try
+            {
+                using (var source = new FileStream(exitingFileName, FileMode.Open, FileAccess.Read, FileShare.Read | FileShare.Delete))
+                {
+                    if (!GetVolumeInformationByHandleW(source.SafeFileHandle, IntPtr.Zero, 0, IntPtr.Zero, IntPtr.Zero, out uint fileSystemFlags, IntPtr.Zero, 0))
+                    {
+                        errorMessage = Marshal.GetExceptionForHR(Marshal.GetHRForLastWin32Error()).Message;
+                        return false;
+                    }
+
+                    if ((fileSystemFlags & FILE_SUPPORTS_BLOCK_REFCOUNTING) == 0)
+                    {
+                        errorMessage = "The volume doesn't support block cloning.";
+                        return false;
+                    }
+
+                    if (!DeviceIoControl(source.SafeFileHandle, FSCTL_GET_INTEGRITY_INFORMATION, IntPtr.Zero, 0, out FSCTL_GET_INTEGRITY_INFORMATION_BUFFER integrity, Marshal.SizeOf<FSCTL_GET_INTEGRITY_INFORMATION_BUFFER>(), out _, IntPtr.Zero))
+                    {
+                        errorMessage = Marshal.GetExceptionForHR(Marshal.GetHRForLastWin32Error()).Message;
+                        return false;
+                    }
+
+                    long length = source.Length;
+                    long clusterSize = integrity.ClusterSizeInBytes;
+
+                    using (var destination = new FileStream(newFileName, FileMode.Create, FileAccess.ReadWrite, FileShare.Delete))
+                    {
+                        created = true;
+
+                        // The clone's integrity streams must match the file's, and its size be set, before its blocks are cloned
+                        if (integrity.ChecksumAlgorithm != 0)
+                        {
+                            var destinationIntegrity = new FSCTL_SET_INTEGRITY_INFORMATION_BUFFER { ChecksumAlgorithm = integrity.ChecksumAlgorithm, Flags = integrity.Flags };
+                            if (!DeviceIoControl(destination.SafeFileHandle, FSCTL_SET_INTEGRITY_INFORMATION, ref destinationIntegrity, Marshal.SizeOf<FSCTL_SET_INTEGRITY_INFORMATION_BUFFER>(), IntPtr.Zero, 0, out _, IntPtr.Zero))
+                            {
+                                errorMessage = Marshal.GetExceptionForHR(Marshal.GetHRForLastWin32Error()).Message;
+                                return false;
+                            }
+                        }
+
+                        destination.SetLength(length);
+
+                        for (long offset = 0; offset < length; offset += MaxCloneChunkSize)
+                        {
+                            // The cloned ranges end at a cluster boundary, even past the end of the file
+                            long byteCount = Math.Min(MaxCloneChunkSize, length - offset);
+                            byteCount = (byteCount + clusterSize - 1) / clusterSize * clusterSize;
+
+                            var extents = new DUPLICATE_EXTENTS_DATA
+                            {
+                                FileHandle = source.SafeFileHandle.DangerousGetHandle(),
+                                SourceFileOffset = offset,
+                                TargetFileOffset = offset,
+                                ByteCount = byteCount
+                            };
+
+                            if (!DeviceIoControl(destination.SafeFileHandle, FSCTL_DUPLICATE_EXTENTS_TO_FILE, ref extents, Marshal.SizeOf<DUPLICATE_EXTENTS_DATA>(), IntPtr.Zero, 0, out _, IntPtr.Zero))
+                            {
+                                errorMessage = Marshal.GetExceptionForHR(Marshal.GetHRForLastWin32Error()).Message;
+                                return false;
+                            }
+                        }
+                    }
+                }
+
+                File.SetLastWriteTimeUtc(newFileName, File.GetLastWriteTimeUtc(exitingFileName));
+                File.SetAttributes(newFileName, File.GetAttributes(exitingFileName));
+
+                cloned = true;
+                errorMessage = null;
+            }
+            catch (Exception e) when (ExceptionHandling.IsIoRelatedException(e))
+            {
+                errorMessage = e.Message;
+            }
+            finally
+            {
+                if (created && !cloned)
+                {
+                    FileUtilities.DeleteNoThrow(newFileName);
+                }
+            }
+
+            return cloned;
+        }
+
         //------------------------------------------------------------------------------
         // MoveFileEx
         //------------------------------------------------------------------------------
@@ -0,0 +1,170 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections;
+using System.Collections.Generic;
+using System.IO;
+using System.Text;
+using BenchmarkDotNet.Attributes;
+using Microsoft.Build.Framework;
+
+namespace Microsoft.Build.Utilities.Benchmark
+{
+    /// <summary>
+    /// Measures the up to date check and tlog compaction of a CL-like task over a synthesized set of sources,
+    /// each of which includes a share of a common pool of headers.
+    /// </summary>
+    [MemoryDiagnoser]
+    public class TrackedDependencies_Benchmark
+    {
+        [Params(100, 1000)]
+        public int NumSources { get; set; }
+
+        [Params(50, 400)]
+        public int HeadersPerSource { get; set; }
+
+        // Headers included by every source, like the SDK and standard library headers of a real project
+        private const int SharedHeaders = 40;
+
+        private string _directory;
+        private ITaskItem[] _sources;
+        private ITaskItem[] _outputs;
+        private ITaskItem[] _readTlogs;
+        private ITaskItem[] _saveTlogs;
+        private CanonicalTrackedInputFiles _saveInputs;
+
+        private readonly BenchmarkTask _task = new BenchmarkTask();
+
+        [GlobalSetup]
+        public void GlobalSetup()
+        {
+            // Files in the temp directory are excluded from tracking, so work in the current directory instead
+            _directory = Path.Combine(Environment.CurrentDirectory, "TrackedDependencies_Benchmark", $"{NumSources}_{HeadersPerSource}");
+            Directory.CreateDirectory(_directory);
+
+            var headers = new string[NumSources + SharedHeaders];
+            for (int i = 0; i < headers.Length; i++)
+            {
+                headers[i] = WriteFile($"header{i}.h");
+            }
+
+            _sources = new ITaskItem[NumSources];
+            var tlog = new List<string>();
+            var random = new Random(NumSources);
+
+            for (int i = 0; i < NumSources; i++)
+            {
+                string source = WriteFile($"source{i}.cpp");
+                _sources[i] = new TaskItem(source);
+
+                tlog.Add("^" + source.ToUpperInvariant());
+                for (int j = 0; j < HeadersPerSource; j++)
+                {
+                    tlog.Add((j < SharedHeaders ? headers[j] : headers[random.Next(headers.Length)]).ToUpperInvariant());
+                }
+            }
+
+            // The outputs are written last, so that everything is up to date
+            _outputs = new ITaskItem[NumSources];
+            for (int i = 0; i < NumSources; i++)
+            {
+                _outputs[i] = new TaskItem(WriteFile($"source{i}.obj"));
+            }
+
+            string readTlog = Path.Combine(_directory, "cl.read.1.tlog");
+            File.WriteAllLines(readTlog, tlog, Encoding.Unicode);
+            _readTlogs = new ITaskItem[] { new TaskItem(readTlog) };
+
+            string saveTlog = Path.Combine(_directory, "save.read.1.tlog");
+            File.WriteAllLines(saveTlog, tlog, Encoding.Unicode);
+            _saveTlogs = new ITaskItem[] { new TaskItem(saveTlog) };
+            _saveInputs = CreateInputs(_saveTlogs);
+        }
+
+        [GlobalCleanup]
+        public void GlobalCleanup()
+        {
+            Directory.Delete(_directory, true);
+        }
+
+        [IterationSetup(Target = nameof(ComputeSourcesNeedingCompilation_TlogsChanged))]
+        public void TouchTlogs()
+        {
+            // A tlog newer than the cached table forces the tlogs to be read again
+            File.SetLastWriteTimeUtc(_readTlogs[0].ItemSpec, DateTime.UtcNow);
+        }
+
+        [Benchmark]
+        public ITaskItem[] ComputeSourcesNeedingCompilation_TlogsChanged()
+        {
+            return CreateInputs(_readTlogs).ComputeSourcesNeedingCompilation();
+        }
+
+        [Benchmark]
+        public ITaskItem[] ComputeSourcesNeedingCompilation_TableCached()
+        {
+            return CreateInputs(_readTlogs).ComputeSourcesNeedingCompilation();
+        }
+
+        [Benchmark]
+        public void SaveTlog()
+        {
+            _saveInputs.SaveTlog();
+        }
+
+        private CanonicalTrackedInputFiles CreateInputs(ITaskItem[] tlogs)
+        {
+            return new CanonicalTrackedInputFiles(_task, tlogs, _sources, null, _outputs, false, false);
+        }
+
+        private string WriteFile(string name)
+        {
+            string path = Path.Combine(_directory, name);
+            File.WriteAllText(path, name);
+            return path;
+        }
+
+        private sealed class BenchmarkTask : Task
+        {
+            public BenchmarkTask()
+            {
+                BuildEngine = new BenchmarkEngine();
+            }
+
+            public override bool Execute() => true;
+        }
+
+        /// <summary>
+        /// Discards everything the tracking classes log.
+        /// </summary>
+        private sealed class BenchmarkEngine : IBuildEngine
+        {
+            public bool ContinueOnError => false;
+
+            public int LineNumberOfTaskNode => 0;
+
+            public int ColumnNumberOfTaskNode => 0;
+
+            public string ProjectFileOfTaskNode => string.Empty;
+
+            public bool BuildProjectFile(string projectFileName, string[] targetNames, IDictionary globalProperties, IDictionary targetOutputs) => false;
+
+            public void LogCustomEvent(CustomBuildEventArgs e)
+            {
+            }
+
+            public void LogErrorEvent(BuildErrorEventArgs e)
+            {
+            }
+
+            public void LogMessageEvent(BuildMessageEventArgs e)
+            {
+            }
+
+            public void LogWarningEvent(BuildWarningEventArgs e)
+            {
+            }
+        }
+    }
+}
@@ -330,6 +330,27 @@ namespace Microsoft.Build.UnitTests
                 string.Empty);
         }
 
+        [Fact]
+        public void ValidateMessagesMentioningCategoriesAreNormal()
+        {
+            ValidateNormalMessage(@"Note: including file:   C:\Program Files\include\error.h");
+            ValidateNormalMessage(@"   Creating library warnings.lib and object warnings.exp");
+            ValidateNormalMessage("Build succeeded. 0 Warning(s) 0 Error(s)");
+            ValidateNormalMessage("error warning, but no colon");
+        }
+
+        [Fact]
+        public void ValidateLongErrorMessage()
+        {
+            string text = "The variable 'foo' is declared but never used " + new string('x', 1000);
+
+            ValidateFileNameLineColumnError("Main.cs(17,20):Command line warning CS0168: " + text,
+                "Main.cs", 17, 20, CanonicalError.Parts.Category.Warning, "CS0168", text);
+
+            // Only the first 400 characters are scanned for the category
+            ValidateNormalMessage(new string('x', 400) + "Main.cs(17,20): warning CS0168: " + text);
+        }
+
         #region Support functions.
 
         private static void ValidateToolError(string message, string tool, CanonicalError.Parts.Category severity, string code, string text)
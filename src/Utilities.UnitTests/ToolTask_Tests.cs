@@ -290,6 +290,36 @@ namespace Microsoft.Build.UnitTests
             }
         }
 
+        /// <summary>
+        /// Every line the tool writes is logged, including the last one without a line break, whether the output is
+        /// read in chunks or through the events of the Process object.
+        /// </summary>
+        [Theory]
+        [InlineData(null)]
+        [InlineData("1")]
+        public void LogEveryLineOfManyLinesOfOutput(string useDataReceivedEvents)
+        {
+            using (TestEnvironment env = TestEnvironment.Create(_output))
+            using (MyTool t = new MyTool())
+            {
+                env.SetEnvironmentVariable("MSBUILDTOOLTASKUSEDATARECEIVEDEVENTS", useDataReceivedEvents);
+
+                MockEngine engine = new MockEngine();
+                t.BuildEngine = engine;
+                t.MockCommandLineCommands = NativeMethodsShared.IsWindows
+                                                ? "/C (for /L %i in (1,1,2000) do @echo line %i) & <nul set /p =last line"
+                                                : @"-c ""for i in $(seq 1 2000); do echo line $i; done; printf 'last line'""";
+
+                t.Execute().ShouldBeTrue();
+
+                engine.AssertLogContains("line 1000");
+                engine.AssertLogContains("line 2000");
+                engine.AssertLogContains("last line");
+                engine.Messages.ShouldBeGreaterThanOrEqualTo(2001);
+                engine.Errors.ShouldBe(0);
+            }
+        }
+
         /// <summary>
         /// When a message is logged to the standard error stream error if LogStandardErrorAsError is true
         /// </summary>
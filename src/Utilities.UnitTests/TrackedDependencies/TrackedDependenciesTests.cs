@@ -4,6 +4,7 @@
 using System;
 using System.Collections.Generic;
 using System.IO;
+using System.Linq;
 using System.Resources;
 using System.Threading;
 
@@ -2856,6 +2857,639 @@ namespace Microsoft.Build.UnitTests.TrackedDependencies
             Assert.False(d3.DependencyTable.ContainsKey(Path.GetFullPath(Path.Combine("TestFiles", "one.cpp"))));
         }
 
+        [Fact]
+        public void SaveCompactedReadTlogBinary()
+        {
+            Console.WriteLine("Test: SaveCompactedReadTlogBinary");
+
+            using (TestEnvironment env = TestEnvironment.Create())
+            {
+                env.SetEnvironmentVariable("MSBUILDWRITEBINARYTLOGS", "1");
+
+                // Prepare files
+                DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one1.h"), "");
+                DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one2.h"), "");
+                DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one.cpp"), "");
+                DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one.obj"), "");
+                DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "two1.h"), "");
+                DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "two.cpp"), "");
+                DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "two.obj"), "");
+
+                Thread.Sleep(_sleepTimeMilliseconds); // need to wait since the timestamp check needs some time to register
+                File.WriteAllLines(Path.Combine("TestFiles", "one1.tlog"), new[] {
+                    "#Command some-command",
+                    "^" + Path.GetFullPath(Path.Combine("TestFiles", "one.cpp")),
+                    Path.GetFullPath(Path.Combine("TestFiles", "one1.h")),
+                    Path.GetFullPath(Path.Combine("TestFiles", "one2.h")),
+                    "^" + Path.GetFullPath(Path.Combine("TestFiles", "two.cpp")),
+                    Path.GetFullPath(Path.Combine("TestFiles", "one1.h")),
+                    Path.GetFullPath(Path.Combine("TestFiles", "two1.h")),
+                });
+
+                ITaskItem[] tlogs = {
+                                        new TaskItem(Path.Combine("TestFiles", "one1.tlog"))
+                                    };
+
+                CanonicalTrackedInputFiles d = new CanonicalTrackedInputFiles
+                    (
+                        DependencyTestHelper.MockTask,
+                        tlogs,
+                        DependencyTestHelper.ItemArray(new TaskItem(Path.Combine("TestFiles", "one.cpp"))),
+                        null,
+                        DependencyTestHelper.ItemArray(new TaskItem(Path.Combine("TestFiles", "one.obj"))),
+                        false, /* no minimal rebuild optimization */
+                        false /* shred composite rooting markers */
+                    );
+
+                ITaskItem[] outofdate = d.ComputeSourcesNeedingCompilation();
+                Assert.Empty(outofdate);
+
+                d.SaveTlog();
+
+                // The compacted tlog is now binary, and must read back to the same table
+                Assert.True(BinaryTlog.IsBinaryTlog(tlogs[0].ItemSpec));
+
+                CanonicalTrackedInputFiles d1 = new CanonicalTrackedInputFiles
+                    (
+                        DependencyTestHelper.MockTask,
+                        tlogs,
+                        DependencyTestHelper.ItemArray(new TaskItem(Path.Combine("TestFiles", "two.cpp"))),
+                        null,
+                        DependencyTestHelper.ItemArray(new TaskItem(Path.Combine("TestFiles", "two.obj"))),
+                        false, /* no minimal rebuild optimization */
+                        false /* shred composite rooting markers */
+                    );
+
+                outofdate = d1.ComputeSourcesNeedingCompilation();
+
+                Assert.Empty(outofdate);
+                Assert.Equal(2, d1.DependencyTable.Count);
+                Assert.Equal(3, d1.DependencyTable[Path.GetFullPath(Path.Combine("TestFiles", "one.cpp"))].Count);
+                Assert.Equal(3, d1.DependencyTable[Path.GetFullPath(Path.Combine("TestFiles", "two.cpp"))].Count);
+
+                // Touching a dependency after the binary tlog was written is still picked up
+                Thread.Sleep(_sleepTimeMilliseconds);
+                DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "two1.h"), "");
+
+                CanonicalTrackedInputFiles d2 = new CanonicalTrackedInputFiles
+                    (
+                        DependencyTestHelper.MockTask,
+                        tlogs,
+                        DependencyTestHelper.ItemArray(new TaskItem(Path.Combine("TestFiles", "two.cpp"))),
+                        null,
+                        DependencyTestHelper.ItemArray(new TaskItem(Path.Combine("TestFiles", "two.obj"))),
+                        false, /* no minimal rebuild optimization */
+                        false /* shred composite rooting markers */
+                    );
+
+                outofdate = d2.ComputeSourcesNeedingCompilation();
+
+                Assert.Single(outofdate);
+                Assert.Equal(Path.Combine("TestFiles", "two.cpp"), outofdate[0].ItemSpec);
+            }
+        }
+
+        [Theory]
+        [InlineData(-1)]
+        [InlineData(int.MinValue)]
+        [InlineData(int.MaxValue)]
+        [InlineData(1000)]
+        public void ReadTlogBinaryWithCorruptHeader(int pathCount)
+        {
+            Console.WriteLine("Test: ReadTlogBinaryWithCorruptHeader");
+
+            // Prepare files
+            DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one1.h"), "");
+            DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one.cpp"), "");
+            DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one.obj"), "");
+
+            // A binary tlog signature followed by a path count that the file can't hold
+            string tlog = Path.Combine("TestFiles", "one.tlog");
+            using (var writer = new BinaryWriter(File.Create(tlog)))
+            {
+                writer.Write(new[] { (byte)'M', (byte)'S', (byte)'B', (byte)'T', (byte)'L', (byte)'O', (byte)'G', (byte)2 });
+                writer.Write(pathCount);
+                writer.Write(0);
+            }
+
+            Assert.True(BinaryTlog.IsBinaryTlog(tlog));
+            Assert.Throws<EndOfStreamException>(() => BinaryTlog.OpenRead(tlog).Dispose());
+
+            MockTask task = DependencyTestHelper.MockTask;
+
+            CanonicalTrackedInputFiles d = new CanonicalTrackedInputFiles
+                (
+                    task,
+                    DependencyTestHelper.ItemArray(new TaskItem(tlog)),
+                    DependencyTestHelper.ItemArray(new TaskItem(Path.Combine("TestFiles", "one.cpp"))),
+                    null,
+                    DependencyTestHelper.ItemArray(new TaskItem(Path.Combine("TestFiles", "one.obj"))),
+                    false, /* no minimal rebuild optimization */
+                    false /* shred composite rooting markers */
+                );
+
+            ITaskItem[] outofdate = d.ComputeSourcesNeedingCompilation();
+
+            // The tlog is treated as unreadable, so the source is rebuilt
+            Assert.Equal(1, ((MockEngine)task.BuildEngine).Warnings);
+            Assert.Single(outofdate);
+            Assert.Empty(d.DependencyTable);
+        }
+
+        [Fact]
+        public void PersistedDependencyTableCache()
+        {
+            Console.WriteLine("Test: PersistedDependencyTableCache");
+
+            using (TestEnvironment env = TestEnvironment.Create())
+            {
+                env.SetEnvironmentVariable("MSBUILDPERSISTDEPENDENCYTABLECACHE", "1");
+
+                string tlogPath = Path.Combine("TestFiles", "persisted.read.1.tlog");
+
+                // Prepare files
+                DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one1.h"), "");
+                DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one2.h"), "");
+                DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one.cpp"), "");
+                DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one.obj"), "");
+                File.WriteAllLines(tlogPath, new[] {
+                    "#Command some-command",
+                    "^" + Path.GetFullPath(Path.Combine("TestFiles", "one.cpp")),
+                    Path.GetFullPath(Path.Combine("TestFiles", "one1.h")),
+                });
+
+                ITaskItem[] tlogs = {
+                                        new TaskItem(tlogPath)
+                                    };
+
+                CanonicalTrackedInputFiles d = new CanonicalTrackedInputFiles
+                    (
+                        DependencyTestHelper.MockTask,
+                        tlogs,
+                        DependencyTestHelper.ItemArray(new TaskItem(Path.Combine("TestFiles", "one.cpp"))),
+                        null,
+                        DependencyTestHelper.ItemArray(new TaskItem(Path.Combine("TestFiles", "one.obj"))),
+                        false, /* no minimal rebuild optimization */
+                        false /* shred composite rooting markers */
+                    );
+
+                Assert.Single(d.DependencyTable);
+                Assert.Single(Directory.GetFiles("TestFiles", "*.inputs.depscache"));
+
+                // Simulate a new process, which only has the persisted table to go on
+                DependencyTableCache.DependencyTable.Clear();
+
+                string tLogRootingMarker = DependencyTableCache.FormatNormalizedTlogRootingMarker(tlogs);
+                DependencyTableCacheEntry cachedEntry = DependencyTableCache.GetCachedEntry(tLogRootingMarker, DependencyTableKind.Inputs, tlogs);
+
+                Assert.NotNull(cachedEntry);
+                var table = (Dictionary<string, Dictionary<string, string>>)cachedEntry.DependencyTable;
+                Assert.Single(table);
+                Assert.Equal(2, table[Path.GetFullPath(Path.Combine("TestFiles", "one.cpp"))].Count);
+
+                // The persisted table must not be used once the tlog has been updated
+                Thread.Sleep(_sleepTimeMilliseconds); // need to wait since the timestamp check needs some time to register
+                File.WriteAllLines(tlogPath, new[] {
+                    "#Command some-command",
+                    "^" + Path.GetFullPath(Path.Combine("TestFiles", "one.cpp")),
+                    Path.GetFullPath(Path.Combine("TestFiles", "one1.h")),
+                    Path.GetFullPath(Path.Combine("TestFiles", "one2.h")),
+                });
+
+                DependencyTableCache.DependencyTable.Clear();
+                Assert.Null(DependencyTableCache.GetCachedEntry(tLogRootingMarker, DependencyTableKind.Inputs, tlogs));
+
+                CanonicalTrackedInputFiles d1 = new CanonicalTrackedInputFiles
+                    (
+                        DependencyTestHelper.MockTask,
+                        tlogs,
+                        DependencyTestHelper.ItemArray(new TaskItem(Path.Combine("TestFiles", "one.cpp"))),
+                        null,
+                        DependencyTestHelper.ItemArray(new TaskItem(Path.Combine("TestFiles", "one.obj"))),
+                        false, /* no minimal rebuild optimization */
+                        false /* shred composite rooting markers */
+                    );
+
+                Assert.Equal(3, d1.DependencyTable[Path.GetFullPath(Path.Combine("TestFiles", "one.cpp"))].Count);
+            }
+        }
+
+        [Fact]
+        public void DependencyTableCacheCoalescesConcurrentLoads()
+        {
+            Console.WriteLine("Test: DependencyTableCacheCoalescesConcurrentLoads");
+
+            string tlogPath = Path.Combine("TestFiles", "coalesced.read.tlog");
+            File.WriteAllText(tlogPath, "");
+
+            ITaskItem[] tlogs = { new TaskItem(tlogPath) };
+            string tLogRootingMarker = DependencyTableCache.FormatNormalizedTlogRootingMarker(tlogs);
+            DependencyTableCache.DependencyTable.TryRemove(tLogRootingMarker, out _);
+
+            int loads = 0;
+            var entries = new DependencyTableCacheEntry[8];
+
+            System.Threading.Tasks.Parallel.For(0, entries.Length, i =>
+            {
+                entries[i] = DependencyTableCache.GetOrLoadEntry(tLogRootingMarker, DependencyTableKind.Files, tlogs, () =>
+                {
+                    Interlocked.Increment(ref loads);
+                    Thread.Sleep(_sleepTimeMilliseconds);
+                    return new Dictionary<string, DateTime>(StringComparer.OrdinalIgnoreCase);
+                },
+                out bool _);
+            });
+
+            // The tlogs were only read once, and everyone got the same table
+            Assert.Equal(1, loads);
+            Assert.All(entries, entry => Assert.Same(entries[0], entry));
+        }
+
+        [Fact]
+        public void DependencyTableCacheEvictsLeastRecentlyUsed()
+        {
+            Console.WriteLine("Test: DependencyTableCacheEvictsLeastRecentlyUsed");
+
+            using (TestEnvironment env = TestEnvironment.Create())
+            {
+                env.SetEnvironmentVariable("MSBUILDDEPENDENCYTABLECACHECAPACITY", "10");
+                DependencyTableCache.DependencyTable.Clear();
+
+                var markers = new string[11];
+                for (int i = 0; i < markers.Length; i++)
+                {
+                    string tlogPath = Path.Combine("TestFiles", "evict" + (char)('a' + i) + ".read.tlog");
+                    File.WriteAllText(tlogPath, "");
+
+                    ITaskItem[] tlogs = { new TaskItem(tlogPath) };
+                    markers[i] = DependencyTableCache.FormatNormalizedTlogRootingMarker(tlogs);
+                    DependencyTableCache.GetOrLoadEntry(markers[i], DependencyTableKind.Files, tlogs, () => new Dictionary<string, DateTime>(StringComparer.OrdinalIgnoreCase), out bool loaded);
+                    Assert.True(loaded);
+
+                    // Keep the first entry in use
+                    Assert.NotNull(DependencyTableCache.GetCachedEntry(markers[0]));
+                }
+
+                // Going over capacity trims the cache to 90%, dropping the least recently used entries
+                Assert.Equal(9, DependencyTableCache.DependencyTable.Count);
+                Assert.NotNull(DependencyTableCache.GetCachedEntry(markers[0]));
+                Assert.Null(DependencyTableCache.GetCachedEntry(markers[1]));
+                Assert.Null(DependencyTableCache.GetCachedEntry(markers[2]));
+                Assert.NotNull(DependencyTableCache.GetCachedEntry(markers[10]));
+            }
+        }
+
+        [Fact]
+        public void ChangedSharedDependencyOnlyRebuildsItsDependents()
+        {
+            Console.WriteLine("Test: ChangedSharedDependencyOnlyRebuildsItsDependents");
+
+            string[] sources = { "one.cpp", "two.cpp", "three.cpp" };
+            string[] headers = { "shared.h", "one.h" };
+            foreach (string file in sources.Concat(headers))
+            {
+                DependencyTestHelper.WriteAll(Path.Combine("TestFiles", file), "");
+            }
+
+            File.WriteAllLines(Path.Combine("TestFiles", "one.tlog"), new[] {
+                "^" + Path.GetFullPath(Path.Combine("TestFiles", "one.cpp")),
+                Path.GetFullPath(Path.Combine("TestFiles", "shared.h")),
+                Path.GetFullPath(Path.Combine("TestFiles", "one.h")),
+                "^" + Path.GetFullPath(Path.Combine("TestFiles", "two.cpp")),
+                Path.GetFullPath(Path.Combine("TestFiles", "shared.h")),
+                "^" + Path.GetFullPath(Path.Combine("TestFiles", "three.cpp")),
+            });
+
+            Thread.Sleep(_sleepTimeMilliseconds); // need to wait since the timestamp check needs some time to register
+            DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one.obj"), "");
+
+            ITaskItem[] tlogs = { new TaskItem(Path.Combine("TestFiles", "one.tlog")) };
+            ITaskItem[] sourceItems = sources.Select(source => (ITaskItem)new TaskItem(Path.Combine("TestFiles", source))).ToArray();
+
+            CanonicalTrackedInputFiles CreateInputs() => new CanonicalTrackedInputFiles
+                (
+                    DependencyTestHelper.MockTask,
+                    tlogs,
+                    sourceItems,
+                    null,
+                    DependencyTestHelper.ItemArray(new TaskItem(Path.Combine("TestFiles", "one.obj"))),
+                    false, /* no minimal rebuild optimization */
+                    false /* shred composite rooting markers */
+                );
+
+            Assert.Empty(CreateInputs().ComputeSourcesNeedingCompilation());
+
+            Thread.Sleep(_sleepTimeMilliseconds);
+            DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one.h"), "");
+
+            ITaskItem[] outofdate = CreateInputs().ComputeSourcesNeedingCompilation();
+            Assert.Single(outofdate);
+            Assert.Equal(Path.Combine("TestFiles", "one.cpp"), outofdate[0].ItemSpec);
+
+            DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "shared.h"), "");
+
+            // Changes to the table after it was first checked are seen as well
+            CanonicalTrackedInputFiles d = CreateInputs();
+            d.RemoveEntriesForSource(sourceItems[2]);
+            outofdate = d.ComputeSourcesNeedingCompilation();
+            Assert.Equal(3, outofdate.Length);
+        }
+
+        [Fact]
+        public void RemovedDependencyIsNotCheckedAfterTableIsIndexed()
+        {
+            Console.WriteLine("Test: RemovedDependencyIsNotCheckedAfterTableIsIndexed");
+
+            string[] sources = { "one.cpp", "two.cpp" };
+            string[] headers = { "one.h", "two.h" };
+            foreach (string file in sources.Concat(headers))
+            {
+                DependencyTestHelper.WriteAll(Path.Combine("TestFiles", file), "");
+            }
+
+            File.WriteAllLines(Path.Combine("TestFiles", "one.tlog"), new[] {
+                "^" + Path.GetFullPath(Path.Combine("TestFiles", "one.cpp")),
+                Path.GetFullPath(Path.Combine("TestFiles", "one.h")),
+                "^" + Path.GetFullPath(Path.Combine("TestFiles", "two.cpp")),
+                Path.GetFullPath(Path.Combine("TestFiles", "two.h")),
+            });
+
+            Thread.Sleep(_sleepTimeMilliseconds); // need to wait since the timestamp check needs some time to register
+            DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one.obj"), "");
+
+            ITaskItem[] tlogs = { new TaskItem(Path.Combine("TestFiles", "one.tlog")) };
+            ITaskItem[] sourceItems = sources.Select(source => (ITaskItem)new TaskItem(Path.Combine("TestFiles", source))).ToArray();
+
+            CanonicalTrackedInputFiles CreateInputs() => new CanonicalTrackedInputFiles
+                (
+                    DependencyTestHelper.MockTask,
+                    tlogs,
+                    sourceItems,
+                    null,
+                    DependencyTestHelper.ItemArray(new TaskItem(Path.Combine("TestFiles", "one.obj"))),
+                    false, /* no minimal rebuild optimization */
+                    false /* shred composite rooting markers */
+                );
+
+            // Index the cached table
+            Assert.Empty(CreateInputs().ComputeSourcesNeedingCompilation());
+
+            Thread.Sleep(_sleepTimeMilliseconds);
+            DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one.h"), "");
+            DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "two.h"), "");
+
+            // Edit the shared table so that two.cpp no longer depends on the changed two.h
+            CanonicalTrackedInputFiles d = CreateInputs();
+            d.RemoveDependencyFromEntry(sourceItems[1], new TaskItem(Path.Combine("TestFiles", "two.h")));
+
+            ITaskItem[] outofdate = d.ComputeSourcesNeedingCompilation();
+            Assert.Single(outofdate);
+            Assert.Equal(Path.Combine("TestFiles", "one.cpp"), outofdate[0].ItemSpec);
+        }
+
+        [Fact]
+        public void TouchedDependencyWithSameContentsIsUpToDate()
+        {
+            Console.WriteLine("Test: TouchedDependencyWithSameContentsIsUpToDate");
+
+            using (TestEnvironment env = TestEnvironment.Create())
+            {
+                env.SetEnvironmentVariable("MSBUILDUSECONTENTHASHESFORTRACKEDINPUTS", "1");
+
+                DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one.cpp"), "one");
+                DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one1.h"), "one1");
+                File.WriteAllLines(Path.Combine("TestFiles", "one.tlog"), new[] {
+                    "^" + Path.GetFullPath(Path.Combine("TestFiles", "one.cpp")),
+                    Path.GetFullPath(Path.Combine("TestFiles", "one1.h")),
+                });
+
+                Thread.Sleep(_sleepTimeMilliseconds); // need to wait since the timestamp check needs some time to register
+                DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one.obj"), "");
+
+                CanonicalTrackedInputFiles CreateInputs() => new CanonicalTrackedInputFiles
+                    (
+                        DependencyTestHelper.MockTask,
+                        DependencyTestHelper.ItemArray(new TaskItem(Path.Combine("TestFiles", "one.tlog"))),
+                        DependencyTestHelper.ItemArray(new TaskItem(Path.Combine("TestFiles", "one.cpp"))),
+                        null,
+                        DependencyTestHelper.ItemArray(new TaskItem(Path.Combine("TestFiles", "one.obj"))),
+                        false, /* no minimal rebuild optimization */
+                        false /* shred composite rooting markers */
+                    );
+
+                // The first check records the contents the output was built from
+                Assert.Empty(CreateInputs().ComputeSourcesNeedingCompilation());
+
+                Thread.Sleep(_sleepTimeMilliseconds);
+                DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one1.h"), "one1");
+
+                Assert.Empty(CreateInputs().ComputeSourcesNeedingCompilation());
+
+                DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one1.h"), "changed");
+
+                Assert.Single(CreateInputs().ComputeSourcesNeedingCompilation());
+            }
+        }
+
+        [Fact]
+        public void FlatTrackingDataTouchedInputWithSameContentsIsUpToDate()
+        {
+            Console.WriteLine("Test: FlatTrackingDataTouchedInputWithSameContentsIsUpToDate");
+
+            DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one1.h"), "one1");
+            DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one2.h"), "one2");
+            File.WriteAllLines(Path.Combine("TestFiles", "one.read.tlog"), new[] {
+                Path.GetFullPath(Path.Combine("TestFiles", "one1.h")),
+                Path.GetFullPath(Path.Combine("TestFiles", "one2.h")),
+            });
+            File.WriteAllLines(Path.Combine("TestFiles", "one.write.tlog"), new[] {
+                Path.GetFullPath(Path.Combine("TestFiles", "one.obj")),
+            });
+
+            Thread.Sleep(_sleepTimeMilliseconds); // need to wait since the timestamp check needs some time to register
+            DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one.obj"), "");
+
+            ITaskItem[] readTlogs = DependencyTestHelper.ItemArray(new TaskItem(Path.Combine("TestFiles", "one.read.tlog")));
+            ITaskItem[] writeTlogs = DependencyTestHelper.ItemArray(new TaskItem(Path.Combine("TestFiles", "one.write.tlog")));
+
+            Assert.True(FlatTrackingData.IsUpToDate(DependencyTestHelper.MockTask, UpToDateCheckType.InputNewerThanOutputAndContentsChanged, readTlogs, writeTlogs));
+
+            Thread.Sleep(_sleepTimeMilliseconds);
+            DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one1.h"), "one1");
+
+            Assert.True(FlatTrackingData.IsUpToDate(DependencyTestHelper.MockTask, UpToDateCheckType.InputNewerThanOutputAndContentsChanged, readTlogs, writeTlogs));
+
+            DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one2.h"), "changed");
+
+            Assert.False(FlatTrackingData.IsUpToDate(DependencyTestHelper.MockTask, UpToDateCheckType.InputNewerThanOutputAndContentsChanged, readTlogs, writeTlogs));
+        }
+
+        [Fact]
+        public void SaveCompactedReadTlogsMergesAndSorts()
+        {
+            Console.WriteLine("Test: SaveCompactedReadTlogsMergesAndSorts");
+
+            using (TestEnvironment env = TestEnvironment.Create())
+            {
+                string oneCpp = Path.GetFullPath(Path.Combine("TestFiles", "one.cpp"));
+                string twoCpp = Path.GetFullPath(Path.Combine("TestFiles", "two.cpp"));
+                string oneH = Path.GetFullPath(Path.Combine("TestFiles", "one1.h"));
+                string twoH = Path.GetFullPath(Path.Combine("TestFiles", "two1.h"));
+
+                foreach (string file in new[] { oneCpp, twoCpp, oneH, twoH })
+                {
+                    DependencyTestHelper.WriteAll(file, "");
+                }
+
+                ITaskItem[] tlogs = {
+                                        new TaskItem(Path.Combine("TestFiles", "cl.1.read.tlog")),
+                                        new TaskItem(Path.Combine("TestFiles", "cl.2.read.tlog"))
+                                    };
+
+                void WriteWorkerTlogs()
+                {
+                    // Each worker records the same headers for its source, in the order it saw them
+                    File.WriteAllLines(tlogs[0].ItemSpec, new[] { "^" + twoCpp, twoH, oneH });
+                    File.WriteAllLines(tlogs[1].ItemSpec, new[] { "^" + oneCpp, oneH, twoH });
+                }
+
+                CanonicalTrackedInputFiles ReadTlogs() => new CanonicalTrackedInputFiles
+                    (
+                        DependencyTestHelper.MockTask,
+                        tlogs,
+                        new ITaskItem[] { new TaskItem(oneCpp), new TaskItem(twoCpp) },
+                        null,
+                        null,
+                        false, /* no minimal rebuild optimization */
+                        false /* shred composite rooting markers */
+                    );
+
+                WriteWorkerTlogs();
+                ReadTlogs().SaveTlog();
+
+                // The tlogs are merged into the first, sorted, and the others are emptied
+                Assert.Equal(new[] { "^" + oneCpp, oneH, twoH, "^" + twoCpp, oneH, twoH }, File.ReadAllLines(tlogs[0].ItemSpec));
+                Assert.Empty(File.ReadAllLines(tlogs[1].ItemSpec));
+
+                // A binary tlog stores the shared set of headers once, and reads back to the same table
+                env.SetEnvironmentVariable("MSBUILDWRITEBINARYTLOGS", "1");
+                WriteWorkerTlogs();
+                ReadTlogs().SaveTlog();
+
+                Assert.True(BinaryTlog.IsBinaryTlog(tlogs[0].ItemSpec));
+
+                CanonicalTrackedInputFiles d = ReadTlogs();
+                Assert.Equal(2, d.DependencyTable.Count);
+                Assert.Equal(new[] { oneCpp, oneH, twoH }, d.DependencyTable[oneCpp].Keys);
+                Assert.Equal(new[] { twoCpp, oneH, twoH }, d.DependencyTable[twoCpp].Keys);
+            }
+        }
+
+        [Fact]
+        public void SaveCompactedReadTlogsInBackground()
+        {
+            Console.WriteLine("Test: SaveCompactedReadTlogsInBackground");
+
+            using (TestEnvironment env = TestEnvironment.Create())
+            {
+                env.SetEnvironmentVariable("MSBUILDWRITETLOGSINBACKGROUND", "1");
+
+                string oneCpp = Path.GetFullPath(Path.Combine("TestFiles", "one.cpp"));
+                string twoCpp = Path.GetFullPath(Path.Combine("TestFiles", "two.cpp"));
+                string threeCpp = Path.GetFullPath(Path.Combine("TestFiles", "three.cpp"));
+                string oneH = Path.GetFullPath(Path.Combine("TestFiles", "one1.h"));
+                string twoH = Path.GetFullPath(Path.Combine("TestFiles", "two1.h"));
+
+                foreach (string file in new[] { oneCpp, twoCpp, threeCpp, oneH, twoH })
+                {
+                    DependencyTestHelper.WriteAll(file, "");
+                }
+
+                ITaskItem[] tlogs = {
+                                        new TaskItem(Path.Combine("TestFiles", "cl.1.read.tlog")),
+                                        new TaskItem(Path.Combine("TestFiles", "cl.2.read.tlog"))
+                                    };
+
+                CanonicalTrackedInputFiles ReadTlogs() => new CanonicalTrackedInputFiles
+                    (
+                        DependencyTestHelper.MockTask,
+                        tlogs,
+                        new ITaskItem[] { new TaskItem(oneCpp), new TaskItem(twoCpp), new TaskItem(threeCpp) },
+                        null,
+                        null,
+                        false, /* no minimal rebuild optimization */
+                        false /* shred composite rooting markers */
+                    );
+
+                File.WriteAllLines(tlogs[0].ItemSpec, new[] { "^" + twoCpp, twoH, oneH });
+                File.WriteAllLines(tlogs[1].ItemSpec, new[] { "^" + oneCpp, oneH, twoH });
+                ReadTlogs().SaveTlog();
+
+                // Once written, the compacted tlog is handed to its next reader in memory, once. A wildcard waits for
+                // the writes of the tlogs in its directory.
+                WrittenTlogCache.WaitForPendingWrites(new ITaskItem[] { new TaskItem(Path.Combine("TestFiles", "cl.*.read.tlog")) });
+                Assert.Equal(new[] { "^" + oneCpp, oneH, twoH, "^" + twoCpp, oneH, twoH }, File.ReadAllLines(tlogs[0].ItemSpec));
+                Assert.Empty(File.ReadAllLines(tlogs[1].ItemSpec));
+                Assert.Empty(Directory.GetFiles("TestFiles", "*.tmp"));
+
+                using (TextReader reader = WrittenTlogCache.TryOpenRead(tlogs[0].ItemSpec))
+                {
+                    Assert.NotNull(reader);
+                    Assert.Equal("^" + oneCpp, reader.ReadLine());
+                }
+
+                Assert.Null(WrittenTlogCache.TryOpenRead(tlogs[0].ItemSpec));
+
+                // The tracking classes read the saved tlogs back to the same table
+                ReadTlogs().SaveTlog();
+
+                CanonicalTrackedInputFiles d = ReadTlogs();
+                Assert.Equal(2, d.DependencyTable.Count);
+                Assert.Equal(new[] { oneCpp, oneH, twoH }, d.DependencyTable[oneCpp].Keys);
+                Assert.Equal(new[] { twoCpp, oneH, twoH }, d.DependencyTable[twoCpp].Keys);
+
+                // A tlog written to after it was saved, as by a tracked tool, is read from disk
+                d.SaveTlog();
+                WrittenTlogCache.WaitForPendingWrites(tlogs);
+                Thread.Sleep(_sleepTimeMilliseconds);
+                File.AppendAllLines(tlogs[1].ItemSpec, new[] { "^" + threeCpp, twoH });
+
+                d = ReadTlogs();
+                Assert.Equal(3, d.DependencyTable.Count);
+                Assert.Equal(new[] { threeCpp, twoH }, d.DependencyTable[threeCpp].Keys);
+            }
+        }
+
+        [Fact]
+        public void SharedFileTimestampCacheSkipsBuildWritableFiles()
+        {
+            Console.WriteLine("Test: SharedFileTimestampCacheSkipsBuildWritableFiles");
+
+            // An engine without registered task objects has no build to share the cache with
+            Assert.Null(SharedFileTimestampCache.GetForBuild(new MockEngine()));
+
+            var cache = new System.Collections.Concurrent.ConcurrentDictionary<string, DateTime>(StringComparer.OrdinalIgnoreCase);
+
+            // Files the build may write to are always checked on disk
+            string file = Path.GetFullPath(Path.Combine("TestFiles", "shared.cpp"));
+            File.WriteAllText(file, "");
+            Assert.Equal(NativeMethodsShared.GetLastWriteFileUtcTime(file), SharedFileTimestampCache.GetLastWriteFileUtcTime(file, cache));
+            Assert.Empty(cache);
+
+            File.Delete(file);
+            Assert.Equal(DateTime.MinValue, SharedFileTimestampCache.GetLastWriteFileUtcTime(file, cache));
+            Assert.Empty(cache);
+
+            // The Windows directory holds the temp directories of service accounts
+            string windowsDirectory = Environment.GetFolderPath(Environment.SpecialFolder.Windows);
+            if (!string.IsNullOrEmpty(windowsDirectory))
+            {
+                Assert.False(SharedFileTimestampCache.IsUnderImmutableDirectory(Path.Combine(windowsDirectory, "Temp", "shared.h")));
+            }
+
+            Assert.False(SharedFileTimestampCache.IsUnderImmutableDirectory(Path.Combine(Path.GetTempPath(), "shared.h")));
+        }
+
         [Fact]
         public void SaveCompactedWriteTlog()
         {
@@ -2953,6 +3587,39 @@ namespace Microsoft.Build.UnitTests.TrackedDependencies
             Assert.True(outputs[2].ItemSpec == Path.GetFullPath(Path.Combine("TestFiles", "three.obj")));
         }
 
+        [Fact]
+        public void SaveCompactedWriteTlogKeepsPrimaryOutputFirst()
+        {
+            Console.WriteLine("Test: SaveCompactedWriteTlogKeepsPrimaryOutputFirst");
+
+            string oneCpp = Path.GetFullPath(Path.Combine("TestFiles", "one.cpp"));
+            string primaryOutput = Path.GetFullPath(Path.Combine("TestFiles", "zebra.obj"));
+            string existingOutput = Path.GetFullPath(Path.Combine("TestFiles", "alpha.pdb"));
+            string missingOutput = Path.GetFullPath(Path.Combine("TestFiles", "beta.pdb"));
+
+            // Only the secondary output exists, and it sorts before the primary output
+            DependencyTestHelper.WriteAll(existingOutput, "");
+            File.Delete(primaryOutput);
+            File.Delete(missingOutput);
+
+            ITaskItem[] tlogs = { new TaskItem(Path.Combine("TestFiles", "one.write.tlog")) };
+            File.WriteAllLines(tlogs[0].ItemSpec, new[] { "^" + oneCpp, primaryOutput, missingOutput, existingOutput });
+
+            new CanonicalTrackedOutputFiles(DependencyTestHelper.MockTask, tlogs).SaveTlog();
+
+            // The outputs are written out in the order they were tracked
+            Assert.Equal(new[] { "^" + oneCpp, primaryOutput, missingOutput, existingOutput }, File.ReadAllLines(tlogs[0].ItemSpec));
+
+            // So the primary output is still the one that is never pruned as missing
+            CanonicalTrackedOutputFiles d = new CanonicalTrackedOutputFiles(DependencyTestHelper.MockTask, tlogs);
+            d.RemoveDependenciesFromEntryIfMissing(new TaskItem(oneCpp));
+
+            ITaskItem[] outputs = d.OutputsForSource(new TaskItem(oneCpp));
+            Assert.Equal(2, outputs.Length);
+            Assert.Equal(primaryOutput, outputs[0].ItemSpec);
+            Assert.Equal(existingOutput, outputs[1].ItemSpec);
+        }
+
         /// <summary>
         /// Make sure that the compacted read tlog contains the correct information when the composite rooting
         /// markers are kept, as in the case where there is a many-to-one relationship between inputs and
@@ -3078,6 +3745,175 @@ namespace Microsoft.Build.UnitTests.TrackedDependencies
             Assert.True(d2.DependencyTable[Path.GetFullPath(Path.Combine("TestFiles", "three.cpp")) + "|" + Path.GetFullPath(Path.Combine("TestFiles", "two.cpp"))].Values.Count == 4);
         }
 
+        [Fact]
+        public void ReadTlogsReturnsContentsInTlogOrder()
+        {
+            Console.WriteLine("Test: ReadTlogsReturnsContentsInTlogOrder");
+
+            ITaskItem[] tlogs = Enumerable.Range(0, 4).Select(i => (ITaskItem)new TaskItem("read" + i + ".tlog")).ToArray();
+
+            // The earlier tlogs take longer to read, so that they finish last when read concurrently
+            TlogContents<string>[] contents = TrackedDependencies.ReadTlogs(tlogs, tlogPath =>
+            {
+                int index = Array.FindIndex(tlogs, tlog => tlog.ItemSpec == tlogPath);
+                Thread.Sleep((tlogs.Length - index) * 50);
+
+                if (index == 2)
+                {
+                    throw new IOException(tlogPath);
+                }
+
+                return tlogPath;
+            });
+
+            Assert.Equal(tlogs.Length, contents.Length);
+            Assert.Equal("read0.tlog", contents[0].Table);
+            Assert.Equal("read1.tlog", contents[1].Table);
+            Assert.Null(contents[2].Table);
+            Assert.Equal("read2.tlog", contents[2].GetIoException().Message);
+            Assert.Equal("read3.tlog", contents[3].Table);
+            Assert.Null(contents[3].GetIoException());
+        }
+
+        [Fact]
+        public void MultipleCanonicalCLAcrossTlogsMergedInTlogOrder()
+        {
+            Console.WriteLine("Test: MultipleCanonicalCLAcrossTlogsMergedInTlogOrder");
+
+            // Prepare files
+            DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one1.h"), "");
+            DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one2.h"), "");
+            DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one3.h"), "");
+            DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one.cpp"), "");
+            Thread.Sleep(_sleepTimeMilliseconds); // need to wait since the timestamp check needs some time to register
+            DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one.obj"), "");
+
+            string root = Path.GetFullPath(Path.Combine("TestFiles", "one.cpp"));
+            string[] headers = { "one3.h", "one1.h", "one2.h" };
+            var tlogs = new ITaskItem[headers.Length];
+            for (int i = 0; i < headers.Length; i++)
+            {
+                tlogs[i] = new TaskItem(Path.Combine("TestFiles", "merged" + i + ".read.tlog"));
+                File.WriteAllLines(tlogs[i].ItemSpec, new[] {
+                    "#Command some-command",
+                    "^" + root,
+                    root,
+                    Path.GetFullPath(Path.Combine("TestFiles", headers[i])),
+                });
+            }
+
+            CanonicalTrackedInputFiles d = new CanonicalTrackedInputFiles
+                (
+                    DependencyTestHelper.MockTask,
+                    tlogs,
+                    DependencyTestHelper.ItemArray(new TaskItem(Path.Combine("TestFiles", "one.cpp"))),
+                    null,
+                    DependencyTestHelper.ItemArray(new TaskItem(Path.Combine("TestFiles", "one.obj"))),
+                    false, /* no minimal rebuild optimization */
+                    false /* shred composite rooting markers */
+                );
+
+            Assert.Empty(d.ComputeSourcesNeedingCompilation());
+
+            // The source stays the first dependency, followed by the headers in the order of their tlogs
+            Assert.Equal(
+                new[] { root }.Concat(headers.Select(header => Path.GetFullPath(Path.Combine("TestFiles", header)))),
+                d.DependencyTable[root].Keys,
+                StringComparer.OrdinalIgnoreCase);
+        }
+
+        [Fact]
+        public void MultipleCanonicalCLAcrossTlogsWithInvalidTlogInTheMiddle()
+        {
+            Console.WriteLine("Test: MultipleCanonicalCLAcrossTlogsWithInvalidTlogInTheMiddle");
+
+            // Prepare files
+            DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one1.h"), "");
+            DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one2.h"), "");
+            DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one.cpp"), "");
+            Thread.Sleep(_sleepTimeMilliseconds); // need to wait since the timestamp check needs some time to register
+            DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one.obj"), "");
+
+            string root = Path.GetFullPath(Path.Combine("TestFiles", "one.cpp"));
+            ITaskItem[] tlogs = {
+                                    new TaskItem(Path.Combine("TestFiles", "middle1.read.tlog")),
+                                    new TaskItem(Path.Combine("TestFiles", "middle2.read.tlog")),
+                                    new TaskItem(Path.Combine("TestFiles", "middle3.read.tlog"))
+                                };
+
+            File.WriteAllLines(tlogs[0].ItemSpec, new[] { "^" + root, root, Path.GetFullPath(Path.Combine("TestFiles", "one1.h")) });
+            File.WriteAllLines(tlogs[1].ItemSpec, new[] { "^" + root, "", root });
+            File.WriteAllLines(tlogs[2].ItemSpec, new[] { "^" + root, root, Path.GetFullPath(Path.Combine("TestFiles", "one2.h")) });
+
+            MockTask task = DependencyTestHelper.MockTask;
+            CanonicalTrackedInputFiles d = new CanonicalTrackedInputFiles
+                (
+                    task,
+                    tlogs,
+                    DependencyTestHelper.ItemArray(new TaskItem(Path.Combine("TestFiles", "one.cpp"))),
+                    null,
+                    DependencyTestHelper.ItemArray(new TaskItem(Path.Combine("TestFiles", "one.obj"))),
+                    false, /* no minimal rebuild optimization */
+                    false /* shred composite rooting markers */
+                );
+
+            ITaskItem[] outofdate = d.ComputeSourcesNeedingCompilation();
+
+            Assert.Equal(1, ((MockEngine)task.BuildEngine).Warnings); // "Should have a warning."
+            Assert.Single(outofdate);
+            Assert.Equal(Path.Combine("TestFiles", "one.cpp"), outofdate[0].ItemSpec);
+
+            task = DependencyTestHelper.MockTask;
+            FlatTrackingData data = new FlatTrackingData
+                (
+                    task,
+                    tlogs,
+                    false /* don't skip missing files */
+                );
+
+            Assert.Equal(1, ((MockEngine)task.BuildEngine).Warnings); // "Should have a warning."
+            Assert.Empty(data.DependencyTable); // "DependencyTable should be empty."
+        }
+
+        [Fact]
+        public void FlatTrackingDataNewestTLogIncludesUnreadableTlog()
+        {
+            Console.WriteLine("Test: FlatTrackingDataNewestTLogIncludesUnreadableTlog");
+
+            DependencyTestHelper.WriteAll(Path.Combine("TestFiles", "one.cpp"), "");
+
+            ITaskItem[] tlogs = {
+                                    new TaskItem(Path.Combine("TestFiles", "newest1.write.tlog")),
+                                    new TaskItem(Path.Combine("TestFiles", "newest2.write.tlog"))
+                                };
+
+            File.WriteAllLines(tlogs[0].ItemSpec, new[] { "^FOO", Path.GetFullPath(Path.Combine("TestFiles", "one.cpp")) });
+
+            // A binary tlog whose path count the file can't hold, which fails to be read
+            using (var writer = new BinaryWriter(File.Create(tlogs[1].ItemSpec)))
+            {
+                writer.Write(new[] { (byte)'M', (byte)'S', (byte)'B', (byte)'T', (byte)'L', (byte)'O', (byte)'G', (byte)2 });
+                writer.Write(-1);
+                writer.Write(0);
+            }
+
+            DateTime unreadableTlogTimeUtc = DateTime.UtcNow.AddMinutes(-1);
+            File.SetLastWriteTimeUtc(tlogs[0].ItemSpec, unreadableTlogTimeUtc.AddMinutes(-1));
+            File.SetLastWriteTimeUtc(tlogs[1].ItemSpec, unreadableTlogTimeUtc);
+
+            MockTask task = DependencyTestHelper.MockTask;
+            FlatTrackingData data = new FlatTrackingData
+                (
+                    task,
+                    tlogs,
+                    false /* don't skip missing files */
+                );
+
+            Assert.Equal(1, ((MockEngine)task.BuildEngine).Warnings); // "Should have a warning."
+            Assert.Equal(tlogs[1].ItemSpec, data.NewestTLogFileName);
+            Assert.Equal(unreadableTlogTimeUtc, data.NewestTLogTimeUtc);
+        }
+
         [Fact]
         public void InvalidFlatTrackingTLogName()
         {
@@ -3654,6 +4490,76 @@ namespace Microsoft.Build.UnitTests.TrackedDependencies
             Assert.True(CanonicalTrackedFilesHelper.RootContainsAllSubRootComponents("a|b|c|d|e|f|g", "b|a"));
             Assert.True(CanonicalTrackedFilesHelper.RootContainsAllSubRootComponents("a|b|c|d|e|f|g", "g|f"));
             Assert.True(CanonicalTrackedFilesHelper.RootContainsAllSubRootComponents("a|b|c|d|e|f|g", "b|e"));
+            Assert.False(CanonicalTrackedFilesHelper.RootContainsAllSubRootComponents("a|b|c|d|e|f|g", "h"));
+            Assert.False(CanonicalTrackedFilesHelper.RootContainsAllSubRootComponents("a|b|c|d|e|f|g", "a|h"));
+            Assert.False(CanonicalTrackedFilesHelper.RootContainsAllSubRootComponents("a|b|c|d|e|f|g", "a|b|c|d|e|f|g|h"));
+        }
+
+        [Fact]
+        public void PathPrefixSetMatchesPrefixesIgnoringCase()
+        {
+            Console.WriteLine("Test: PathPrefixSetMatchesPrefixesIgnoringCase");
+
+            var prefixes = new PathPrefixSet(new[] { @"C:\FOO\", @"C:\FOO\BAR\", @"D:\Temp\" });
+
+            Assert.True(prefixes.MatchesStartOf(@"C:\Foo\one.h"));
+            Assert.True(prefixes.MatchesStartOf(@"c:\foo\bar\two.h"));
+            Assert.True(prefixes.MatchesStartOf(@"d:\TEMP\three.h"));
+            Assert.False(prefixes.MatchesStartOf(@"C:\FooFile.txt"));
+            Assert.False(prefixes.MatchesStartOf(@"C:\FOO"));
+            Assert.False(prefixes.MatchesStartOf(@"E:\Temp\three.h"));
+            Assert.False(new PathPrefixSet(Array.Empty<string>()).MatchesStartOf(@"C:\Foo\one.h"));
+        }
+
+        [Fact]
+        public void FormatRootingMarkerSortsAndUpperCasesPaths()
+        {
+            Console.WriteLine("Test: FormatRootingMarkerSortsAndUpperCasesPaths");
+
+            string one = Path.GetFullPath(Path.Combine("TestFiles", "one.cpp"));
+            string two = Path.GetFullPath(Path.Combine("TestFiles", "Two.cpp"));
+            string three = Path.GetFullPath(Path.Combine("TestFiles", "three.cpp"));
+
+            ITaskItem[] sources = { new TaskItem(two), new TaskItem(Path.Combine("TestFiles", "one.cpp")), new TaskItem(three) };
+
+            Assert.Equal(
+                string.Join("|", one.ToUpperInvariant(), three.ToUpperInvariant(), two.ToUpperInvariant()),
+                FileTracker.FormatRootingMarker(sources));
+            Assert.Equal(one.ToUpperInvariant(), FileTracker.FormatRootingMarker(sources[1]));
+            Assert.Equal(
+                string.Join("|", one.ToUpperInvariant(), two.ToUpperInvariant()),
+                FileTracker.FormatRootingMarker(sources[1], sources[0]));
+        }
+
+        [Fact]
+        public void FormatRootingMarkerExpandsShortNames()
+        {
+            Console.WriteLine("Test: FormatRootingMarkerExpandsShortNames");
+
+            if (!NativeMethodsShared.IsWindows)
+            {
+                return;
+            }
+
+            using (TestEnvironment env = TestEnvironment.Create())
+            {
+                TransientTestFolder folder = env.CreateFolder();
+                string longPath = Path.Combine(folder.Path, "LongSourceFileName.cpp");
+                DependencyTestHelper.WriteAll(longPath, "");
+
+                string shortPath = NativeMethodsShared.GetShortFilePath(longPath);
+
+                // 8.3 names can be disabled on the volume
+                if (shortPath.IndexOf('~') < 0)
+                {
+                    return;
+                }
+
+                // Tracker writes long names to tlogs, so the rooting marker has to use them too
+                Assert.Equal(
+                    NativeMethodsShared.GetLongFilePath(longPath).ToUpperInvariant(),
+                    FileTracker.FormatRootingMarker(new TaskItem(shortPath)));
+            }
         }
     }
 
@@ -685,6 +685,10 @@ namespace Microsoft.Build.Utilities
 
             _eventsDisposed = false;
 
+            _standardErrorReader = null;
+            _standardOutputReader = null;
+            bool readStandardErrorAndOutputInChunks = !Traits.Instance.EscapeHatches.UseProcessDataReceivedEventsInToolTask;
+
             try
             {
                 responseFile = GetTemporaryResponseFile(responseFileCommands, out string responseFileSwitch);
@@ -698,15 +702,27 @@ namespace Microsoft.Build.Utilities
                 // sign up for the exit notification
                 proc.Exited += ReceiveExitNotification;
 
-                // turn on async stderr notifications
-                proc.ErrorDataReceived += ReceiveStandardErrorData;
-                // turn on async stdout notifications
-                proc.OutputDataReceived += ReceiveStandardOutputData;
+                if (!readStandardErrorAndOutputInChunks)
+                {
+                    // turn on async stderr notifications
+                    proc.ErrorDataReceived += ReceiveStandardErrorData;
+                    // turn on async stdout notifications
+                    proc.OutputDataReceived += ReceiveStandardOutputData;
+                }
 
                 // if we've got this far, we expect to get an exit code from the process. If we don't
                 // get one from the process, we want to use an exit code value of -1.
                 ExitCode = -1;
 
+#if FEATURE_FILE_TRACKER
+                // Tracker writes the tlogs of the tool it runs, which may be ones saved in the background. They are named
+                // in its arguments rather than known here, so every pending write is waited for.
+                if (FileTracker.IsTrackerPath(pathToTool))
+                {
+                    WrittenTlogCache.WaitForPendingWrites();
+                }
+#endif
+
                 // Start the process
                 proc.Start();
 
@@ -720,10 +736,19 @@ namespace Microsoft.Build.Utilities
                 // Call user-provided hook for code that should execute immediately after the process starts
                 this.ProcessStarted();
 
-                // sign up for stderr callbacks
-                proc.BeginErrorReadLine();
-                // sign up for stdout callbacks
-                proc.BeginOutputReadLine();
+                if (readStandardErrorAndOutputInChunks)
+                {
+                    // read stderr and stdout ourselves, without an event per line
+                    _standardErrorReader = ReadStandardErrorOrOutputAsync(proc.StandardError, _standardErrorData, _standardErrorDataAvailable);
+                    _standardOutputReader = ReadStandardErrorOrOutputAsync(proc.StandardOutput, _standardOutputData, _standardOutputDataAvailable);
+                }
+                else
+                {
+                    // sign up for stderr callbacks
+                    proc.BeginErrorReadLine();
+                    // sign up for stdout callbacks
+                    proc.BeginOutputReadLine();
+                }
 
                 // start the time-out timer
                 _toolTimer = new Timer(ReceiveTimeoutNotification, null, Timeout, System.Threading.Timeout.Infinite /* no periodic timeouts */);
@@ -894,6 +919,11 @@ namespace Microsoft.Build.Utilities
                             // is the Process class sending the exit notification prematurely?
                             WaitForProcessExit(proc);
 
+                            // Process.WaitForExit() only waits for the streams it reads itself, so
+                            // also wait for the end of the streams we read
+                            _standardErrorReader?.Wait();
+                            _standardOutputReader?.Wait();
+
                             // flush the stderr and stdout queues to clear out the data placed
                             // in them while we were waiting for the process to exit
                             LogMessagesFromStandardError();
@@ -973,7 +1003,7 @@ namespace Microsoft.Build.Utilities
                     return;
                 }
 
-                if (isBeingCancelled)
+                if (isBeingCancelled && _standardOutputReader == null)
                 {
                     try
                     {
@@ -1204,6 +1234,111 @@ namespace Microsoft.Build.Utilities
             }
         }
 
+        /// <summary>
+        /// Queues up the output from either the stderr or stdout stream of the
+        /// process executing the tool, in the same lines as the Process object
+        /// would send them to <see cref="ReceiveStandardErrorOrOutputData"/>().
+        /// The stream is read in chunks, and the lines of each chunk are queued
+        /// together, so that tools writing many lines, like cl.exe with
+        /// /showIncludes, don't cost an event, a lock and a signal per line.
+        /// </summary>
+        /// <param name="reader"></param>
+        /// <param name="dataQueue"></param>
+        /// <param name="dataAvailableSignal"></param>
+        private async System.Threading.Tasks.Task ReadStandardErrorOrOutputAsync(StreamReader reader, Queue dataQueue, ManualResetEvent dataAvailableSignal)
+        {
+            var buffer = new char[4096];
+            var lines = new List<string>();
+
+            // the start of a line that continues in the next chunk
+            var partialLine = new StringBuilder();
+            bool previousWasCarriageReturn = false;
+
+            try
+            {
+                int count;
+                while ((count = await reader.ReadAsync(buffer, 0, buffer.Length).ConfigureAwait(false)) > 0)
+                {
+                    int lineStart = 0;
+                    for (int i = 0; i < count; i++)
+                    {
+                        char c = buffer[i];
+
+                        // like StreamReader.ReadLine(), lines end with "\r", "\n" or "\r\n"
+                        if (c == '\n' && previousWasCarriageReturn)
+                        {
+                            previousWasCarriageReturn = false;
+                            lineStart = i + 1;
+                            continue;
+                        }
+
+                        previousWasCarriageReturn = c == '\r';
+                        if (c == '\r' || c == '\n')
+                        {
+                            if (partialLine.Length == 0)
+                            {
+                                lines.Add(new string(buffer, lineStart, i - lineStart));
+                            }
+                            else
+                            {
+                                partialLine.Append(buffer, lineStart, i - lineStart);
+                                lines.Add(partialLine.ToString());
+                                partialLine.Clear();
+                            }
+
+                            lineStart = i + 1;
+                        }
+                    }
+
+                    partialLine.Append(buffer, lineStart, count - lineStart);
+
+                    if (lines.Count > 0)
+                    {
+                        EnqueueStandardErrorOrOutputData(lines, dataQueue, dataAvailableSignal);
+                        lines.Clear();
+                    }
+                }
+
+                // NOTE: like the Process object, send the last line even if it doesn't end with a line break
+                if (partialLine.Length > 0)
+                {
+                    lines.Add(partialLine.ToString());
+                    EnqueueStandardErrorOrOutputData(lines, dataQueue, dataAvailableSignal);
+                }
+            }
+            catch (Exception e) when (e is ObjectDisposedException || ExceptionHandling.IsIoRelatedException(e))
+            {
+                // The process was disposed of, after the tool was terminated
+            }
+        }
+
+        /// <summary>
+        /// Queues up lines of output and signals the availability of the data,
+        /// like <see cref="ReceiveStandardErrorOrOutputData"/>() does for one line.
+        /// </summary>
+        /// <param name="lines"></param>
+        /// <param name="dataQueue"></param>
+        /// <param name="dataAvailableSignal"></param>
+        private void EnqueueStandardErrorOrOutputData(List<string> lines, Queue dataQueue, ManualResetEvent dataAvailableSignal)
+        {
+            lock (dataQueue.SyncRoot)
+            {
+                foreach (string line in lines)
+                {
+                    dataQueue.Enqueue(line);
+                }
+
+                // NOTE: see ReceiveStandardErrorOrOutputData() for why the signalling is inside the lock
+                lock (_eventCloseLock)
+                {
+                    if (!_eventsDisposed)
+                    {
+                        dataAvailableSignal.Set();
+                    }
+                }
+            }
+        }
+
         /// <summary>
         /// Assign the importances that will be used for stdout/stderr logging of messages from this tool task.
         /// This takes into account (1 is highest precedence):
@@ -1661,6 +1796,16 @@ namespace Microsoft.Build.Utilities
         /// </summary>
         private ManualResetEvent _standardOutputDataAvailable;
 
+        /// <summary>
+        /// Reads the stderr output from the tool, unless the Process object does.
+        /// </summary>
+        private System.Threading.Tasks.Task _standardErrorReader;
+
+        /// <summary>
+        /// Reads the stdout output from the tool, unless the Process object does.
+        /// </summary>
+        private System.Threading.Tasks.Task _standardOutputReader;
+
         /// <summary>
         /// Used for signalling when the tool exits.
         /// </summary>
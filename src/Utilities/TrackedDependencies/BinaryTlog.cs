@@ -0,0 +1,525 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.IO.MemoryMappedFiles;
+using System.Text;
+
+using Microsoft.Build.Framework;
+using Microsoft.Build.Shared;
+
+#if FEATURE_FILE_TRACKER
+
+namespace Microsoft.Build.Utilities
+{
+    /// <summary>
+    /// Reads and writes tracking logs in either the classic line-based text format or a compact
+    /// binary format.
+    /// </summary>
+    /// <remarks>
+    /// The binary format stores every distinct line of the tlog once in an interned path table,
+    /// followed by one section per rooting marker that lists the table offsets of the entries
+    /// beneath it:
+    ///
+    ///     signature        8 bytes, "MSBTLOG" followed by the format version
+    ///     path count       int32
+    ///     path table       (int32 char count, UTF-16 chars) per path
+    ///     section count    int32
+    ///     sections         (int32 root offset or -1, int32 entry count, int32 entry offsets) per section
+    ///
+    /// A section whose entries are identical to those of an earlier section, as is common for sources
+    /// that include the same set of headers, stores -(n + 1) as its entry count instead, where n is the
+    /// index of the earlier section, and no entry offsets of its own.
+    ///
+    /// Rooting markers are stored with their leading '^' so that a reader hands back exactly the
+    /// lines the text format would have produced. The file is memory-mapped on read and each path
+    /// is decoded at most once, so an include file shared by many sources becomes a single string.
+    /// </remarks>
+    internal static class BinaryTlog
+    {
+        private const byte FormatVersion = 2;
+
+        private static readonly byte[] s_signature = { (byte)'M', (byte)'S', (byte)'B', (byte)'T', (byte)'L', (byte)'O', (byte)'G', FormatVersion };
+
+        /// <summary>
+        /// Opens the tlog for line-based reading, regardless of the format it was written in.
+        /// </summary>
+        /// <param name="tlogPath">The path to the tlog</param>
+        internal static TextReader OpenRead(string tlogPath) => OpenRead(tlogPath, null);
+
+        /// <summary>
+        /// Opens the tlog for line-based reading, regardless of the format it was written in, adding its
+        /// size and the number of lines read from it to the given statistics once the reader is disposed.
+        /// </summary>
+        /// <param name="tlogPath">The path to the tlog</param>
+        /// <param name="statistics">The statistics to add to, or null if none are being collected</param>
+        internal static TextReader OpenRead(string tlogPath, TlogReadStatistics statistics)
+        {
+            TextReader savedTlog = WrittenTlogCache.TryOpenRead(tlogPath);
+            if (savedTlog != null)
+            {
+                return statistics != null ? new CountingTlogReader(savedTlog, 0, statistics) : savedTlog;
+            }
+
+            var stream = new FileStream(tlogPath, FileMode.Open, FileAccess.Read, FileShare.Read);
+
+            try
+            {
+                long length = statistics != null ? stream.Length : 0;
+                TextReader reader;
+
+                if (HasSignature(stream))
+                {
+                    reader = new BinaryTlogReader(stream);
+                }
+                else
+                {
+                    stream.Position = 0;
+                    reader = new StreamReader(stream);
+                }
+
+                return statistics != null ? new CountingTlogReader(reader, length, statistics) : reader;
+            }
+            catch
+            {
+                stream.Dispose();
+                throw;
+            }
+        }
+
+        /// <summary>
+        /// Opens the tlog for line-based writing. Binary tlogs are written only when opted in to via
+        /// the MSBUILDWRITEBINARYTLOGS environment variable; otherwise the classic text format is used.
+        /// </summary>
+        /// <param name="tlogPath">The path to the tlog</param>
+        internal static TextWriter OpenWrite(string tlogPath)
+            => Traits.Instance.WriteBinaryTlogs
+                ? new BinaryTlogWriter(tlogPath)
+                : FileUtilities.OpenWrite(tlogPath, false, Encoding.Unicode);
+
+        /// <summary>
+        /// Opens the first of a set of tlogs for writing their compacted contents, emptying the others. When opted in to
+        /// via the MSBUILDWRITETLOGSINBACKGROUND environment variable, the tlogs are instead written in the background
+        /// once the writer is disposed, and readers in this process are handed the lines in memory.
+        /// </summary>
+        /// <param name="tlogFiles">The tlogs being compacted</param>
+        internal static TextWriter OpenCompactedWrite(ITaskItem[] tlogFiles)
+        {
+            if (Traits.Instance.WriteTlogsInBackground)
+            {
+                return WrittenTlogCache.OpenCompactedWrite(tlogFiles);
+            }
+
+            CanonicalTrackedFilesHelper.EmptyAllButFirstTlog(tlogFiles);
+            return OpenWrite(tlogFiles[0].ItemSpec);
+        }
+
+        /// <summary>
+        /// Determine whether the given file was written in the binary tlog format.
+        /// </summary>
+        /// <param name="tlogPath">The path to the tlog</param>
+        internal static bool IsBinaryTlog(string tlogPath)
+        {
+            using (var stream = new FileStream(tlogPath, FileMode.Open, FileAccess.Read, FileShare.Read))
+            {
+                return HasSignature(stream);
+            }
+        }
+
+        private static bool HasSignature(Stream stream)
+        {
+            if (stream.Length < s_signature.Length + sizeof(int))
+            {
+                return false;
+            }
+
+            for (int i = 0; i < s_signature.Length - 1; i++)
+            {
+                if (stream.ReadByte() != s_signature[i])
+                {
+                    return false;
+                }
+            }
+
+            // Version 1 tlogs differ only in never sharing the entries of a section
+            int version = stream.ReadByte();
+            return version >= 1 && version <= FormatVersion;
+        }
+
+        /// <summary>
+        /// Counts the lines read from a tlog, for the statistics reported when tracing is enabled.
+        /// </summary>
+        private sealed class CountingTlogReader : TextReader
+        {
+            private readonly TextReader _reader;
+            private readonly long _length;
+            private readonly TlogReadStatistics _statistics;
+            private int _lines;
+
+            internal CountingTlogReader(TextReader reader, long length, TlogReadStatistics statistics)
+            {
+                _reader = reader;
+                _length = length;
+                _statistics = statistics;
+            }
+
+            public override string ReadLine()
+            {
+                string line = _reader.ReadLine();
+                if (line != null)
+                {
+                    _lines++;
+                }
+
+                return line;
+            }
+
+            public override int Peek() => throw new NotSupportedException();
+
+            public override int Read() => throw new NotSupportedException();
+
+            protected override void Dispose(bool disposing)
+            {
+                if (disposing)
+                {
+                    _reader.Dispose();
+                    _statistics.Add(_length, _lines);
+                }
+
+                base.Dispose(disposing);
+            }
+        }
+
+        /// <summary>
+        /// Hands back the lines of a memory-mapped binary tlog in the order they were written.
+        /// </summary>
+        private sealed class BinaryTlogReader : TextReader
+        {
+            private readonly MemoryMappedFile _mappedFile;
+            private readonly MemoryMappedViewAccessor _view;
+
+            // The length of the file, as the capacity of the view is rounded up to a whole page
+            private readonly long _length;
+
+            // Offsets of each path within the view, and the paths decoded so far
+            private readonly long[] _pathOffsets;
+            private readonly string[] _paths;
+
+            // The position of the next section header or entry offset to read
+            private long _position;
+            private int _sectionsRemaining;
+            private int _entriesRemaining;
+
+            // The position and entry count of the entries of each section read so far, and where to
+            // carry on reading once the entries of an earlier section have been handed back again
+            private readonly List<KeyValuePair<long, int>> _sectionEntries = new List<KeyValuePair<long, int>>();
+            private long _resumePosition = -1;
+
+            internal BinaryTlogReader(FileStream stream)
+            {
+                _mappedFile = MemoryMappedFile.CreateFromFile(stream, null, 0, MemoryMappedFileAccess.Read, HandleInheritability.None, false);
+                _view = _mappedFile.CreateViewAccessor(0, 0, MemoryMappedFileAccess.Read);
+                _length = stream.Length;
+
+                try
+                {
+                    // A truncated or otherwise corrupt tlog is reported like any other unreadable tlog,
+                    // rather than by trying to allocate for counts that the file can't hold
+                    _position = s_signature.Length;
+                    int pathCount = ReadInt32();
+                    if (pathCount < 0 || pathCount > (_length - _position) / sizeof(int))
+                    {
+                        throw new EndOfStreamException();
+                    }
+
+                    _pathOffsets = new long[pathCount];
+                    _paths = new string[pathCount];
+
+                    for (int i = 0; i < pathCount; i++)
+                    {
+                        _pathOffsets[i] = _position;
+                        int length = ReadInt32();
+                        if (length < 0 || length > (_length - _position) / sizeof(char))
+                        {
+                            throw new EndOfStreamException();
+                        }
+
+                        _position += (long)length * sizeof(char);
+                    }
+
+                    _sectionsRemaining = ReadInt32();
+                    if (_sectionsRemaining < 0 || _sectionsRemaining > (_length - _position) / (2 * sizeof(int)))
+                    {
+                        throw new EndOfStreamException();
+                    }
+                }
+                catch
+                {
+                    _view.Dispose();
+                    _mappedFile.Dispose();
+                    throw;
+                }
+            }
+
+            public override string ReadLine()
+            {
+                while (_entriesRemaining == 0)
+                {
+                    if (_resumePosition >= 0)
+                    {
+                        _position = _resumePosition;
+                        _resumePosition = -1;
+                    }
+
+                    if (_sectionsRemaining == 0)
+                    {
+                        return null;
+                    }
+
+                    _sectionsRemaining--;
+                    int rootOffset = ReadInt32();
+                    int entryCount = ReadInt32();
+
+                    if (entryCount >= 0)
+                    {
+                        _sectionEntries.Add(new KeyValuePair<long, int>(_position, entryCount));
+                        _entriesRemaining = entryCount;
+                    }
+                    else
+                    {
+                        int sharedSection = -(entryCount + 1);
+                        if (sharedSection >= _sectionEntries.Count)
+                        {
+                            throw new EndOfStreamException();
+                        }
+
+                        KeyValuePair<long, int> entries = _sectionEntries[sharedSection];
+                        _sectionEntries.Add(entries);
+                        _resumePosition = _position;
+                        _position = entries.Key;
+                        _entriesRemaining = entries.Value;
+                    }
+
+                    if (rootOffset >= 0)
+                    {
+                        return GetPath(rootOffset);
+                    }
+                }
+
+                _entriesRemaining--;
+                return GetPath(ReadInt32());
+            }
+
+            public override int Peek() => throw new NotSupportedException();
+
+            public override int Read() => throw new NotSupportedException();
+
+            protected override void Dispose(bool disposing)
+            {
+                if (disposing)
+                {
+                    _view.Dispose();
+                    _mappedFile.Dispose();
+                }
+
+                base.Dispose(disposing);
+            }
+
+            private int ReadInt32()
+            {
+                if (_position > _length - sizeof(int))
+                {
+                    throw new EndOfStreamException();
+                }
+
+                int value = _view.ReadInt32(_position);
+                _position += sizeof(int);
+                return value;
+            }
+
+            private string GetPath(int index)
+            {
+                if ((uint)index >= (uint)_paths.Length)
+                {
+                    throw new EndOfStreamException();
+                }
+
+                string path = _paths[index];
+                if (path == null)
+                {
+                    long offset = _pathOffsets[index];
+                    int length = _view.ReadInt32(offset);
+                    var chars = new char[length];
+                    _view.ReadArray(offset + sizeof(int), chars, 0, length);
+                    path = new string(chars);
+                    _paths[index] = path;
+                }
+
+                return path;
+            }
+        }
+
+        /// <summary>
+        /// Collects the lines of a tlog and writes them out in the binary format when disposed.
+        /// </summary>
+        private sealed class BinaryTlogWriter : TextWriter
+        {
+            private readonly string _tlogPath;
+            private readonly Dictionary<string, int> _pathOffsets = new Dictionary<string, int>(StringComparer.Ordinal);
+            private readonly List<string> _paths = new List<string>();
+            private readonly List<KeyValuePair<int, List<int>>> _sections = new List<KeyValuePair<int, List<int>>>();
+            private readonly StringBuilder _currentLine = new StringBuilder();
+
+            internal BinaryTlogWriter(string tlogPath)
+            {
+                _tlogPath = tlogPath;
+            }
+
+            public override Encoding Encoding => Encoding.Unicode;
+
+            public override void Write(char value)
+            {
+                if (value == '\n')
+                {
+                    CommitLine(_currentLine.ToString());
+                    _currentLine.Clear();
+                }
+                else if (value != '\r')
+                {
+                    _currentLine.Append(value);
+                }
+            }
+
+            public override void WriteLine(string value)
+            {
+                if (_currentLine.Length == 0)
+                {
+                    CommitLine(value ?? string.Empty);
+                }
+                else
+                {
+                    _currentLine.Append(value);
+                    WriteLine();
+                }
+            }
+
+            protected override void Dispose(bool disposing)
+            {
+                if (disposing)
+                {
+                    if (_currentLine.Length > 0)
+                    {
+                        CommitLine(_currentLine.ToString());
+                        _currentLine.Clear();
+                    }
+
+                    using (var writer = new BinaryWriter(new FileStream(_tlogPath, FileMode.Create, FileAccess.Write, FileShare.Read, 4096, FileOptions.SequentialScan), Encoding.Unicode))
+                    {
+                        writer.Write(s_signature);
+                        writer.Write(_paths.Count);
+                        foreach (string path in _paths)
+                        {
+                            writer.Write(path.Length);
+                            writer.Write(path.ToCharArray());
+                        }
+
+                        // Sections with the same entries as an earlier one refer back to it
+                        var firstSectionWithEntries = new Dictionary<List<int>, int>(EntryListComparer.Instance);
+
+                        writer.Write(_sections.Count);
+                        for (int i = 0; i < _sections.Count; i++)
+                        {
+                            KeyValuePair<int, List<int>> section = _sections[i];
+                            writer.Write(section.Key);
+
+                            if (section.Value.Count > 0)
+                            {
+                                if (firstSectionWithEntries.TryGetValue(section.Value, out int sharedSection))
+                                {
+                                    writer.Write(-(sharedSection + 1));
+                                    continue;
+                                }
+
+                                firstSectionWithEntries.Add(section.Value, i);
+                            }
+
+                            writer.Write(section.Value.Count);
+                            foreach (int offset in section.Value)
+                            {
+                                writer.Write(offset);
+                            }
+                        }
+                    }
+                }
+
+                base.Dispose(disposing);
+            }
+
+            private void CommitLine(string line)
+            {
+                if (!_pathOffsets.TryGetValue(line, out int offset))
+                {
+                    offset = _paths.Count;
+                    _paths.Add(line);
+                    _pathOffsets.Add(line, offset);
+                }
+
+                if (line.Length > 0 && line[0] == '^')
+                {
+                    _sections.Add(new KeyValuePair<int, List<int>>(offset, new List<int>()));
+                }
+                else
+                {
+                    if (_sections.Count == 0)
+                    {
+                        // entries that precede any rooting marker, as in flat tlogs
+                        _sections.Add(new KeyValuePair<int, List<int>>(-1, new List<int>()));
+                    }
+
+                    _sections[_sections.Count - 1].Value.Add(offset);
+                }
+            }
+        }
+
+        /// <summary>
+        /// Compares the entries of two sections by the paths they refer to.
+        /// </summary>
+        private sealed class EntryListComparer : IEqualityComparer<List<int>>
+        {
+            internal static readonly EntryListComparer Instance = new EntryListComparer();
+
+            public bool Equals(List<int> x, List<int> y)
+            {
+                if (x.Count != y.Count)
+                {
+                    return false;
+                }
+
+                for (int i = 0; i < x.Count; i++)
+                {
+                    if (x[i] != y[i])
+                    {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            public int GetHashCode(List<int> entries)
+            {
+                int hash = entries.Count;
+                foreach (int offset in entries)
+                {
+                    hash = unchecked((hash * 31) + offset);
+                }
+
+                return hash;
+            }
+        }
+    }
+}
+
+#endif
@@ -3,6 +3,8 @@
 
 using System;
 using System.Collections.Generic;
+using System.IO;
+using System.Text;
 using Microsoft.Build.Framework;
 using Microsoft.Build.Shared;
 
@@ -15,7 +17,8 @@ namespace Microsoft.Build.Utilities
         internal const int MaxLogCount = 100;
 
         /// <summary>
-        /// Check that the given composite root contains all entries in the composite sub root
+        /// Check that the given composite root contains all entries in the composite sub root. When checking
+        /// many sub roots against the same root, build its <see cref="RootingMarkerComponents"/> once instead.
         /// </summary>
         /// <param name="compositeRoot">The root to look for all sub roots in</param>
         /// <param name="compositeSubRoot">The root that is comprised of subroots to look for</param>
@@ -29,17 +32,7 @@ namespace Microsoft.Build.Utilities
             }
 
             // look for each sub key in the main composite key
-            string[] rootComponents = compositeSubRoot.Split(MSBuildConstants.PipeChar);
-            foreach (string subRoot in rootComponents)
-            {
-                // we didn't find this subkey, so bail out
-                if (!compositeRoot.Contains(subRoot))
-                {
-                    return false;
-                }
-            }
-
-            return true;
+            return new RootingMarkerComponents(compositeRoot).ContainsAll(compositeSubRoot);
         }
 
         /// <summary>
@@ -68,6 +61,52 @@ namespace Microsoft.Build.Utilities
         internal static bool FilesExistAndRecordOldestWriteTime(ICollection<ITaskItem> files, TaskLoggingHelper log, out DateTime outputOldestTime, out string outputOldestFilename)
             => FilesExistAndRecordRequestedWriteTime(files, log, false /* return information about the oldest file */, out outputOldestTime, out outputOldestFilename);
 
+        /// <summary>
+        /// Get the keys of a dependency table in the order they are written to a compacted tlog, so that
+        /// the same dependencies are always written out the same way.
+        /// </summary>
+        /// <param name="table">The table to get the keys of</param>
+        /// <returns>The keys, sorted</returns>
+        internal static string[] GetSortedKeys<T>(Dictionary<string, T> table)
+        {
+            var keys = new string[table.Count];
+            table.Keys.CopyTo(keys, 0);
+            Array.Sort(keys, StringComparer.OrdinalIgnoreCase);
+            return keys;
+        }
+
+        /// <summary>
+        /// Get the dependencies of a root in the order they are written to a compacted tlog: the first
+        /// dependency, which is the root's primary file and is never pruned as missing, stays first and
+        /// the rest are sorted.
+        /// </summary>
+        /// <param name="dependencies">The dependencies of a root</param>
+        /// <returns>The dependencies, sorted after the first</returns>
+        internal static string[] GetSortedDependencies<T>(Dictionary<string, T> dependencies)
+        {
+            var keys = new string[dependencies.Count];
+            dependencies.Keys.CopyTo(keys, 0);
+            if (keys.Length > 2)
+            {
+                Array.Sort(keys, 1, keys.Length - 1, StringComparer.OrdinalIgnoreCase);
+            }
+
+            return keys;
+        }
+
+        /// <summary>
+        /// Empty all but the first of a set of tlogs, which is about to be replaced by the compacted
+        /// contents of all of them.
+        /// </summary>
+        /// <param name="tlogFiles">The tlogs being compacted</param>
+        internal static void EmptyAllButFirstTlog(ITaskItem[] tlogFiles)
+        {
+            for (int i = 1; i < tlogFiles.Length; i++)
+            {
+                File.WriteAllText(tlogFiles[i].ItemSpec, "", Encoding.Unicode);
+            }
+        }
+
         private static bool FilesExistAndRecordRequestedWriteTime(ICollection<ITaskItem> files, TaskLoggingHelper log, bool getNewest, out DateTime requestedTime, out string requestedFilename)
         {
             bool allExist = true;
@@ -2,12 +2,14 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 using System;
+using System.Collections;
 using System.Collections.Generic;
 using System.Collections.Concurrent;
 using System.Diagnostics.CodeAnalysis;
 using System.IO;
 using System.Threading.Tasks;
 
+using Microsoft.Build.Eventing;
 using Microsoft.Build.Framework;
 using Microsoft.Build.Shared;
 
@@ -49,6 +51,14 @@ namespace Microsoft.Build.Utilities
         private readonly HashSet<string> _excludedInputPaths = new HashSet<string>(StringComparer.Ordinal);
         // Cache of last write times
         private readonly ConcurrentDictionary<string, DateTime> _lastWriteTimeCache = new ConcurrentDictionary<string, DateTime>(StringComparer.Ordinal);
+        // Cache of last write times of installed files, shared by everything in the current build
+        private ConcurrentDictionary<string, DateTime> _sharedLastWriteTimeCache;
+        // The cache entry holding the dependency table, if any
+        private DependencyTableCacheEntry _dependencyTableEntry;
+        // The roots depending on each dependency, when the dependency table isn't cached
+        private DependentsIndex _dependentsIndex;
+        // The contents of the dependencies as of the last up to date check, when opted in to
+        private TrackedContentHashes _contentHashes;
         #endregion
 
         #region Properties
@@ -149,6 +159,10 @@ namespace Microsoft.Build.Utilities
                 };
             }
 
+            _sharedLastWriteTimeCache = SharedFileTimestampCache.GetForBuild(ownerTask?.BuildEngine);
+
+            // Tlogs saved in the background are looked for on disk
+            WrittenTlogCache.WaitForPendingWrites(tlogFiles);
             _tlogFiles = TrackedDependencies.ExpandWildcards(tlogFiles);
             _tlogAvailable = TrackedDependencies.ItemsExist(_tlogFiles);
             _sourceFiles = sourceFiles;
@@ -191,6 +205,13 @@ namespace Microsoft.Build.Utilities
         /// <returns>Array of files that need to be compiled</returns>
         public ITaskItem[] ComputeSourcesNeedingCompilation(bool searchForSubRootsInCompositeRootingMarkers)
         {
+            string tlogNames = null;
+            if (MSBuildEventSource.Log.IsEnabled())
+            {
+                tlogNames = TlogReadStatistics.FormatTlogNames(_tlogFiles);
+                MSBuildEventSource.Log.TrackedDependenciesUpToDateCheckStart(tlogNames);
+            }
+
             if (_outputFiles != null)
             {
                 _outputFileGroup = _outputFiles;
@@ -204,9 +225,16 @@ namespace Microsoft.Build.Utilities
                 _outputFileGroup = _outputs.OutputsForNonCompositeSource(_sourceFiles);
             }
 
-            return _maintainCompositeRootingMarkers
+            ITaskItem[] sourcesNeedingCompilation = _maintainCompositeRootingMarkers
                 ? ComputeSourcesNeedingCompilationFromCompositeRootingMarker(searchForSubRootsInCompositeRootingMarkers)
                 : ComputeSourcesNeedingCompilationFromPrimaryFiles();
+
+            if (tlogNames != null)
+            {
+                MSBuildEventSource.Log.TrackedDependenciesUpToDateCheckStop(tlogNames, _lastWriteTimeCache.Count, sourcesNeedingCompilation.Length);
+            }
+
+            return sourcesNeedingCompilation;
         }
 
         /// <summary>
@@ -222,18 +250,37 @@ namespace Microsoft.Build.Utilities
             {
                 var sourcesNeedingCompilationList = new ConcurrentQueue<ITaskItem>();
                 bool allOutputFilesExist = false;
+                HashSet<string> rootsWithChangedDependencies = null;
 
                 if (_tlogAvailable)
                 {
+                    if (Traits.Instance.UseContentHashesForTrackedInputs)
+                    {
+                        _contentHashes = TrackedContentHashes.Load(_tlogFiles);
+                    }
+
                     if (!_useMinimalRebuildOptimization)
                     {
                         allOutputFilesExist = FilesExistAndRecordNewestWriteTime(_outputFileGroup);
+
+                        // Every source is compared against the same output time, so each dependency only
+                        // needs to be checked once and only the sources depending on changed files revisited
+                        if (allOutputFilesExist)
+                        {
+                            rootsWithChangedDependencies = GetRootsWithChangedDependencies(_outputNewestTime);
+                        }
                     }
                 }
 
                 // If the TLOG file is not available, or not up to date then add source to sourcesNeedingCompilationList
-                Parallel.For(0, _sourceFiles.Length, index => CheckIfSourceNeedsCompilation(sourcesNeedingCompilationList, allOutputFilesExist, _sourceFiles[index]));
+                Parallel.For(0, _sourceFiles.Length, i => CheckIfSourceNeedsCompilation(sourcesNeedingCompilationList, allOutputFilesExist, rootsWithChangedDependencies, _sourceFiles[i]));
                 SourcesNeedingCompilation = sourcesNeedingCompilationList.ToArray();
+
+                if (_contentHashes != null)
+                {
+                    // Whatever is compiled next is compiled from the dependencies as they are now
+                    RecordContentHashes();
+                }
             }
 
             if (SourcesNeedingCompilation.Length == 0)
@@ -283,7 +330,7 @@ namespace Microsoft.Build.Utilities
         /// <summary>
         /// Check to see if the source specified needs compilation relative to its outputs
         /// </summary>
-        private void CheckIfSourceNeedsCompilation(ConcurrentQueue<ITaskItem> sourcesNeedingCompilationList, bool allOutputFilesExist, ITaskItem source)
+        private void CheckIfSourceNeedsCompilation(ConcurrentQueue<ITaskItem> sourcesNeedingCompilationList, bool allOutputFilesExist, HashSet<string> rootsWithChangedDependencies, ITaskItem source)
         {
             if (!_tlogAvailable || _outputFileGroup == null)
             {
@@ -295,7 +342,7 @@ namespace Microsoft.Build.Utilities
                 source.SetMetadata("_trackerCompileReason", "Tracking_SourceOutputsNotAvailable");
                 sourcesNeedingCompilationList.Enqueue(source);
             }
-            else if (!IsUpToDate(source))
+            else if (!IsUpToDate(source, rootsWithChangedDependencies))
             {
                 if (string.IsNullOrEmpty(source.GetMetadata("_trackerCompileReason")))
                 {
@@ -344,15 +391,20 @@ namespace Microsoft.Build.Utilities
             string upperSourcesRoot = FileTracker.FormatRootingMarker(_sourceFiles);
             var sourcesNeedingCompilationList = new List<ITaskItem>();
 
+            // Split the sources' rooting marker once, rather than once for every root it is compared with
+            RootingMarkerComponents sourcesRootComponents = searchForSubRootsInCompositeRootingMarkers
+                ? new RootingMarkerComponents(upperSourcesRoot)
+                : null;
+
             // Check each root in the table to see if it matches.
             foreach (string tableEntryRoot in DependencyTable.Keys)
             {
-                string upperTableEntryRoot = tableEntryRoot.ToUpperInvariant();
+                string upperTableEntryRoot = FileTracker.ToUpperInvariantIfNeeded(tableEntryRoot);
 
                 if (searchForSubRootsInCompositeRootingMarkers)
                 {
                     if (upperTableEntryRoot.Contains(upperSourcesRoot) ||
-                        CanonicalTrackedFilesHelper.RootContainsAllSubRootComponents(upperSourcesRoot, upperTableEntryRoot))
+                        sourcesRootComponents.ContainsAll(upperTableEntryRoot))
                     {
                         // Gather the unique outputs for this root
                         SourceDependenciesForOutputRoot(sourcesNeedingCompilation, upperTableEntryRoot, _outputFileGroup);
@@ -456,17 +508,138 @@ namespace Microsoft.Build.Utilities
             }
         }
 
+        /// <summary>
+        /// Find the roots with at least one dependency that is missing or newer than the given time,
+        /// checking each distinct dependency in the table once.
+        /// </summary>
+        /// <param name="outputNewestTime">The time of the newest output</param>
+        /// <returns>The roots that are out of date</returns>
+        private HashSet<string> GetRootsWithChangedDependencies(DateTime outputNewestTime)
+        {
+            DependentsIndex index = GetDependentsIndex();
+            string[] dependencies = index.Dependencies;
+            var changed = new bool[dependencies.Length];
+
+            Parallel.For(0, dependencies.Length, i =>
+            {
+                string file = dependencies[i];
+                if (!FileIsExcludedFromDependencyCheck(file))
+                {
+                    if (!_lastWriteTimeCache.TryGetValue(file, out DateTime dependeeTime))
+                    {
+                        dependeeTime = SharedFileTimestampCache.GetLastWriteFileUtcTime(file, _sharedLastWriteTimeCache);
+                        _lastWriteTimeCache[file] = dependeeTime;
+                    }
+
+                    // Missing dependencies are out of date too
+                    changed[i] = dependeeTime == DateTime.MinValue || HasChangedSince(file, dependeeTime, outputNewestTime);
+                }
+            });
+
+            var rootsWithChangedDependencies = new HashSet<string>(StringComparer.OrdinalIgnoreCase);
+            for (int i = 0; i < dependencies.Length; i++)
+            {
+                if (changed[i])
+                {
+                    rootsWithChangedDependencies.UnionWith(index.GetDependents(dependencies[i]));
+                }
+            }
+
+            return rootsWithChangedDependencies;
+        }
+
+        /// <summary>
+        /// Determine whether a file that exists has changed since the given time: it has been written
+        /// since, and, when content hashes are in use, its contents differ from those seen before then.
+        /// </summary>
+        private bool HasChangedSince(string file, DateTime lastWriteTimeUtc, DateTime timeUtc)
+            => lastWriteTimeUtc > timeUtc && _contentHashes?.IsUnchangedSince(file, lastWriteTimeUtc, timeUtc) != true;
+
+        /// <summary>
+        /// Record the contents of every dependency in the table, so that later up to date checks can
+        /// tell dependencies that have only been touched from dependencies that have changed.
+        /// </summary>
+        private void RecordContentHashes()
+        {
+            string[] dependencies = GetDependentsIndex().Dependencies;
+
+            Parallel.For(0, dependencies.Length, i =>
+            {
+                string file = dependencies[i];
+                if (!FileIsExcludedFromDependencyCheck(file))
+                {
+                    if (!_lastWriteTimeCache.TryGetValue(file, out DateTime dependeeTime))
+                    {
+                        dependeeTime = SharedFileTimestampCache.GetLastWriteFileUtcTime(file, _sharedLastWriteTimeCache);
+                        _lastWriteTimeCache[file] = dependeeTime;
+                    }
+
+                    _contentHashes.Record(file, dependeeTime);
+                }
+            });
+
+            _contentHashes.Save();
+        }
+
+        /// <summary>
+        /// Get the index of the roots depending on each dependency in the dependency table, building it
+        /// the first time it is needed for the table.
+        /// </summary>
+        private DependentsIndex GetDependentsIndex()
+        {
+            // Share the index with everyone else using the cached table
+            bool tableIsCached = _dependencyTableEntry != null && ReferenceEquals(_dependencyTableEntry.DependencyTable, DependencyTable);
+            DependentsIndex index = tableIsCached ? _dependencyTableEntry.DependentsIndex : _dependentsIndex;
+
+            if (index == null || !ReferenceEquals(index.DependencyTable, DependencyTable))
+            {
+                index = DependentsIndex.Build(DependencyTable);
+
+                if (tableIsCached)
+                {
+                    _dependencyTableEntry.DependentsIndex = index;
+                }
+                else
+                {
+                    _dependentsIndex = index;
+                }
+            }
+
+            return index;
+        }
+
+        /// <summary>
+        /// Drop the index of the dependency table after the table has been edited, here and in the cache entry
+        /// sharing the table.
+        /// </summary>
+        private void InvalidateDependentsIndex()
+        {
+            _dependentsIndex = null;
+
+            if (_dependencyTableEntry != null && ReferenceEquals(_dependencyTableEntry.DependencyTable, DependencyTable))
+            {
+                _dependencyTableEntry.DependentsIndex = null;
+            }
+        }
+
         /// <summary>
         /// Check if the source file needs to be compiled
         /// </summary>
         /// <param name="sourceFile">The primary dependency</param>
+        /// <param name="rootsWithChangedDependencies">The roots known to have changed dependencies, or null if they haven't been found</param>
         /// <returns>bool</returns>
-        private bool IsUpToDate(ITaskItem sourceFile)
+        private bool IsUpToDate(ITaskItem sourceFile, HashSet<string> rootsWithChangedDependencies)
         {
             string sourceFullPath = FileUtilities.NormalizePath(sourceFile.ItemSpec);
             bool dependenciesAvailable = DependencyTable.TryGetValue(sourceFullPath, out Dictionary<string, string> dependencies);
             DateTime thisSourceOutputNewestTime = _outputNewestTime;
 
+            // None of the dependencies of this source have changed; otherwise go through them to find out which
+            if (dependenciesAvailable && rootsWithChangedDependencies?.Contains(sourceFullPath) == false)
+            {
+                return true;
+            }
+
             if (_useMinimalRebuildOptimization && _outputs != null && dependenciesAvailable)
             {
                 thisSourceOutputNewestTime = DateTime.MinValue;
@@ -482,7 +655,7 @@ namespace Microsoft.Build.Utilities
                         // If the file exists
                         if (outputFileTime > DateTime.MinValue)
                         {
-                            if (outputFileTime < sourceTime)
+                            if (outputFileTime < sourceTime && HasChangedSince(sourceFullPath, sourceTime, outputFileTime))
                             {
                                 sourceFile.SetMetadata("_trackerCompileReason", "Tracking_SourceWillBeCompiledDependencyWasModifiedAt");
                                 sourceFile.SetMetadata("_trackerModifiedPath", sourceFullPath);
@@ -522,14 +695,14 @@ namespace Microsoft.Build.Utilities
                         // to determine up-to-dateness
                         if (!_lastWriteTimeCache.TryGetValue(file, out DateTime dependeeTime))
                         {
-                            dependeeTime = NativeMethodsShared.GetLastWriteFileUtcTime(file);
+                            dependeeTime = SharedFileTimestampCache.GetLastWriteFileUtcTime(file, _sharedLastWriteTimeCache);
                             _lastWriteTimeCache[file] = dependeeTime;
                         }
 
                         // If the file exists
                         if (dependeeTime > DateTime.MinValue)
                         {
-                            if (dependeeTime > thisSourceOutputNewestTime)
+                            if (dependeeTime > thisSourceOutputNewestTime && HasChangedSince(file, dependeeTime, thisSourceOutputNewestTime))
                             {
                                 sourceFile.SetMetadata("_trackerCompileReason", "Tracking_SourceWillBeCompiledDependencyWasModifiedAt");
                                 sourceFile.SetMetadata("_trackerModifiedPath", file);
@@ -601,24 +774,19 @@ namespace Microsoft.Build.Utilities
                     }
                 }
 
-                lock (DependencyTableCache.DependencyTable)
-                {
-                    // The tracking logs are not available, they may have been deleted at some point.
-                    // Be safe and remove any references from the cache.
-                    DependencyTableCache.DependencyTable.Remove(tLogRootingMarker);
-                }
+                // The tracking logs are not available, they may have been deleted at some point.
+                // Be safe and remove any references from the cache.
+                DependencyTableCache.DependencyTable.TryRemove(tLogRootingMarker, out _);
                 return;
             }
 
-            DependencyTableCacheEntry cachedEntry;
-            lock (DependencyTableCache.DependencyTable)
-            {
-                // Look in the dependency table cache to see if its available and up to date
-                cachedEntry = DependencyTableCache.GetCachedEntry(tLogRootingMarker);
-            }
+            // Look in the dependency table cache to see if its available and up to date, and read
+            // the tracking logs if it isn't
+            DependencyTableCacheEntry cachedEntry = DependencyTableCache.GetOrLoadEntry(tLogRootingMarker, DependencyTableKind.Inputs, _tlogFiles, () => ReadDependencyTable(currentProjectDirectory), out bool loaded);
+            _dependencyTableEntry = cachedEntry;
 
             // We have an up to date cached entry
-            if (cachedEntry != null)
+            if (!loaded)
             {
                 DependencyTable = (Dictionary<string, Dictionary<string, string>>)cachedEntry.DependencyTable;
                 // Log information about what we're using
@@ -627,215 +795,252 @@ namespace Microsoft.Build.Utilities
                 {
                     FileTracker.LogMessage(_log, MessageImportance.Low, "\t{0}", tlogItem.ItemSpec);
                 }
-                return;
             }
+        }
 
+        /// <summary>
+        /// Construct a dependency table for the primary sources from the tlog files
+        /// </summary>
+        /// <param name="currentProjectDirectory">The project directory, beneath which tracked paths are never excluded</param>
+        /// <returns>The table, or null if the tlogs were invalid</returns>
+        private IDictionary ReadDependencyTable(string currentProjectDirectory)
+        {
             // Now we need to construct a dependency table for the primary sources from the TLOG files
             // If there are any errors in the tlogs, we want to warn, stop parsing tlogs, and empty
             // out the dependency table, essentially forcing a rebuild.
             bool encounteredInvalidTLogContents = false;
-            bool exceptionCaught = false;
-            string invalidTLogName = null;
             FileTracker.LogMessageFromResources(_log, MessageImportance.Low, "Tracking_ReadTrackingLogs");
-            foreach (ITaskItem tlogFileName in _tlogFiles)
+
+            // Tools such as CL with /MP write a tlog per process, so each tlog is read into a table
+            // of its own and the tables are merged in tlog order
+            TlogReadStatistics statistics = TlogReadStatistics.Start(_tlogFiles);
+            TlogContents<Dictionary<string, Dictionary<string, string>>>[] tlogContents = TrackedDependencies.ReadTlogs(_tlogFiles, tlogPath => ReadDependencyTlog(tlogPath, currentProjectDirectory, statistics));
+            statistics?.Stop();
+
+            for (int i = 0; i < _tlogFiles.Length; i++)
             {
-                try
+                FileTracker.LogMessage(_log, MessageImportance.Low, "\t{0}", _tlogFiles[i].ItemSpec);
+
+                Exception e = tlogContents[i].GetIoException();
+                if (e != null)
+                {
+                    FileTracker.LogWarningWithCodeFromResources(_log, "Tracking_RebuildingDueToInvalidTLog", e.Message);
+                    break;
+                }
+
+                if (tlogContents[i].Table == null)
                 {
-                    FileTracker.LogMessage(_log, MessageImportance.Low, "\t{0}", tlogFileName.ItemSpec);
+                    encounteredInvalidTLogContents = true;
+                    FileTracker.LogWarningWithCodeFromResources(_log, "Tracking_RebuildingDueToInvalidTLogContents", _tlogFiles[i].ItemSpec);
+                    break;
+                }
 
-                    using (StreamReader tlog = File.OpenText(tlogFileName.ItemSpec))
+                MergeDependencyTable(tlogContents[i].Table);
+            }
+
+            // There were problems with the tracking logs -- we've already warned or errored; now we want to make
+            // sure that we essentially force a rebuild of this particular root.
+            if (encounteredInvalidTLogContents)
+            {
+                DependencyTable = new Dictionary<string, Dictionary<string, string>>(StringComparer.OrdinalIgnoreCase);
+                return null;
+            }
+
+            return DependencyTable;
+        }
+
+        /// <summary>
+        /// Read the dependencies of the primary sources recorded in a single tlog
+        /// </summary>
+        /// <param name="tlogPath">The tlog to read</param>
+        /// <param name="currentProjectDirectory">The project directory, beneath which tracked paths are never excluded</param>
+        /// <param name="statistics">The statistics to add to, or null if none are being collected</param>
+        /// <returns>The dependencies in the tlog, or null if its contents are invalid</returns>
+        private Dictionary<string, Dictionary<string, string>> ReadDependencyTlog(string tlogPath, string currentProjectDirectory, TlogReadStatistics statistics)
+        {
+            var table = new Dictionary<string, Dictionary<string, string>>(StringComparer.OrdinalIgnoreCase);
+
+            using (TextReader tlog = BinaryTlog.OpenRead(tlogPath, statistics))
+            {
+                string tlogEntry = tlog.ReadLine();
+
+                while (tlogEntry != null)
+                {
+                    if (tlogEntry.Length == 0)
                     {
-                        string tlogEntry = tlog.ReadLine();
+                        return null;
+                    }
 
-                        while (tlogEntry != null)
+                    if (tlogEntry[0] != '#') // command marker
+                    {
+                        bool rootingRecord = false;
+                        // If this is a rooting record, remove the rooting marker
+                        if (tlogEntry[0] == '^')
                         {
+                            tlogEntry = tlogEntry.Substring(1);
+
                             if (tlogEntry.Length == 0)
                             {
-                                encounteredInvalidTLogContents = true;
-                                invalidTLogName = tlogFileName.ItemSpec;
-                                break;
+                                return null;
                             }
 
-                            if (tlogEntry[0] != '#') // command marker
+                            rootingRecord = true;
+                        }
+
+                        // found one of our primary sources
+                        if (rootingRecord)
+                        {
+                            // dependency table for the source file
+                            Dictionary<string, string> dependencies;
+                            Dictionary<string, string> primaryFiles;
+
+                            if (!_maintainCompositeRootingMarkers)
                             {
-                                bool rootingRecord = false;
-                                // If this is a rooting record, remove the rooting marker
-                                if (tlogEntry[0] == '^')
-                                {
-                                    tlogEntry = tlogEntry.Substring(1);
+                                primaryFiles = new Dictionary<string, string>(StringComparer.OrdinalIgnoreCase);
 
-                                    if (tlogEntry.Length == 0)
+                                if (tlogEntry.Contains("|"))
+                                {
+                                    foreach (ITaskItem file in _sourceFiles)
                                     {
-                                        encounteredInvalidTLogContents = true;
-                                        invalidTLogName = tlogFileName.ItemSpec;
-                                        break;
+                                        if (!primaryFiles.ContainsKey(FileUtilities.NormalizePath(file.ItemSpec)))
+                                        {
+                                            primaryFiles.Add(FileUtilities.NormalizePath(file.ItemSpec), null);
+                                        }
                                     }
-
-                                    rootingRecord = true;
                                 }
+                                else
+                                {
+                                    primaryFiles.Add(tlogEntry, null);
+                                }
+                            }
+                            else
+                            {
+                                primaryFiles = null;
+                            }
 
-                                // found one of our primary sources
-                                if (rootingRecord)
+                            // We haven't seen this source before in the tracking log
+                            // so create a new dependency table and add the source file(s)
+                            if (!table.TryGetValue(tlogEntry, out dependencies))
+                            {
+                                dependencies = new Dictionary<string, string>(StringComparer.OrdinalIgnoreCase);
+
+                                if (!_maintainCompositeRootingMarkers)
                                 {
-                                    // dependency table for the source file
-                                    Dictionary<string, string> dependencies;
-                                    Dictionary<string, string> primaryFiles;
+                                    dependencies.Add(tlogEntry, null);
+                                }
 
-                                    if (!_maintainCompositeRootingMarkers)
-                                    {
-                                        primaryFiles = new Dictionary<string, string>(StringComparer.OrdinalIgnoreCase);
+                                table.Add(tlogEntry, dependencies);
+                            }
 
-                                        if (tlogEntry.Contains("|"))
+                            tlogEntry = tlog.ReadLine();
+
+                            if (_maintainCompositeRootingMarkers)
+                            {
+                                // Process each file encountered until we reach:
+                                // the end of the or,
+                                // A command marker or,
+                                // we hit a rooting marker
+                                while (tlogEntry != null)
+                                {
+                                    if (tlogEntry.Length == 0)
+                                    {
+                                        return null;
+                                    }
+                                    else if (tlogEntry[0] != '#' && tlogEntry[0] != '^')
+                                    {
+                                        if (!dependencies.ContainsKey(tlogEntry))
                                         {
-                                            foreach (ITaskItem file in _sourceFiles)
+                                            if (FileTracker.FileIsUnderPath(tlogEntry, currentProjectDirectory) || !FileTracker.FileIsExcludedFromDependencies(tlogEntry))
                                             {
-                                                if (!primaryFiles.ContainsKey(FileUtilities.NormalizePath(file.ItemSpec)))
-                                                {
-                                                    primaryFiles.Add(FileUtilities.NormalizePath(file.ItemSpec), null);
-                                                }
+                                                dependencies.Add(tlogEntry, null);
                                             }
                                         }
-                                        else
-                                        {
-                                            primaryFiles.Add(tlogEntry, null);
-                                        }
                                     }
                                     else
                                     {
-                                        primaryFiles = null;
+                                        break;
                                     }
 
-                                    // We haven't seen this source before in the tracking log
-                                    // so create a new dependency table and add the source file(s)
-                                    if (!DependencyTable.TryGetValue(tlogEntry, out dependencies))
+                                    tlogEntry = tlog.ReadLine();
+                                }
+                            }
+                            else
+                            {
+                                while (tlogEntry != null)
+                                {
+                                    if (tlogEntry.Length == 0)
                                     {
-                                        dependencies = new Dictionary<string, string>(StringComparer.OrdinalIgnoreCase);
-
-                                        if (!_maintainCompositeRootingMarkers)
-                                        {
-                                            dependencies.Add(tlogEntry, null);
-                                        }
-
-                                        DependencyTable.Add(tlogEntry, dependencies);
+                                        return null;
                                     }
-
-                                    tlogEntry = tlog.ReadLine();
-
-                                    if (_maintainCompositeRootingMarkers)
+                                    else if (tlogEntry[0] != '#' && tlogEntry[0] != '^')
                                     {
-                                        // Process each file encountered until we reach:
-                                        // the end of the or,
-                                        // A command marker or,
-                                        // we hit a rooting marker
-                                        while (tlogEntry != null)
+                                        if (primaryFiles.ContainsKey(tlogEntry))
                                         {
-                                            if (tlogEntry.Length == 0)
+                                            // if this is a primary file, we need to add it to the dependency table, and we need
+                                            // to reset "dependencies" so that the following dependencies get written into this
+                                            // primary file's table instead of the previous one.
+                                            if (!table.TryGetValue(tlogEntry, out dependencies))
                                             {
-                                                encounteredInvalidTLogContents = true;
-                                                invalidTLogName = tlogFileName.ItemSpec;
-                                                break;
-                                            }
-                                            else if (tlogEntry[0] != '#' && tlogEntry[0] != '^')
-                                            {
-                                                if (!dependencies.ContainsKey(tlogEntry))
+                                                dependencies = new Dictionary<string, string>(StringComparer.OrdinalIgnoreCase)
                                                 {
-                                                    if (FileTracker.FileIsUnderPath(tlogEntry, currentProjectDirectory) || !FileTracker.FileIsExcludedFromDependencies(tlogEntry))
-                                                    {
-                                                        dependencies.Add(tlogEntry, null);
-                                                    }
-                                                }
+                                                    {tlogEntry, null}
+                                                };
+
+                                                table.Add(tlogEntry, dependencies);
                                             }
-                                            else
+                                        }
+                                        else if (!dependencies.ContainsKey(tlogEntry))
+                                        {
+                                            // however, if it's not a primary file, just add it to the current dependency table
+                                            if (FileTracker.FileIsUnderPath(tlogEntry, currentProjectDirectory) || !FileTracker.FileIsExcludedFromDependencies(tlogEntry))
                                             {
-                                                break;
+                                                dependencies.Add(tlogEntry, null);
                                             }
-
-                                            tlogEntry = tlog.ReadLine();
                                         }
                                     }
                                     else
                                     {
-                                        while (tlogEntry != null)
-                                        {
-                                            if (tlogEntry.Length == 0)
-                                            {
-                                                encounteredInvalidTLogContents = true;
-                                                invalidTLogName = tlogFileName.ItemSpec;
-                                                break;
-                                            }
-                                            else if (tlogEntry[0] != '#' && tlogEntry[0] != '^')
-                                            {
-                                                if (primaryFiles.ContainsKey(tlogEntry))
-                                                {
-                                                    // if this is a primary file, we need to add it to the dependency table, and we need
-                                                    // to reset "dependencies" so that the following dependencies get written into this
-                                                    // primary file's table instead of the previous one.
-                                                    if (!DependencyTable.TryGetValue(tlogEntry, out dependencies))
-                                                    {
-                                                        dependencies = new Dictionary<string, string>(StringComparer.OrdinalIgnoreCase)
-                                                        {
-                                                            {tlogEntry, null}
-                                                        };
-
-                                                        DependencyTable.Add(tlogEntry, dependencies);
-                                                    }
-                                                }
-                                                else if (!dependencies.ContainsKey(tlogEntry))
-                                                {
-                                                    // however, if it's not a primary file, just add it to the current dependency table
-                                                    if (FileTracker.FileIsUnderPath(tlogEntry, currentProjectDirectory) || !FileTracker.FileIsExcludedFromDependencies(tlogEntry))
-                                                    {
-                                                        dependencies.Add(tlogEntry, null);
-                                                    }
-                                                }
-                                            }
-                                            else
-                                            {
-                                                break;
-                                            }
-
-                                            tlogEntry = tlog.ReadLine();
-                                        }
+                                        break;
                                     }
-                                }
-                                else // don't know what this entry is, so skip it
-                                {
+
                                     tlogEntry = tlog.ReadLine();
                                 }
                             }
-                            else // skip over the initial '#' line
-                            {
-                                tlogEntry = tlog.ReadLine();
-                            }
+                        }
+                        else // don't know what this entry is, so skip it
+                        {
+                            tlogEntry = tlog.ReadLine();
                         }
                     }
-                }
-                catch (Exception e) when (ExceptionHandling.IsIoRelatedException(e))
-                {
-                    FileTracker.LogWarningWithCodeFromResources(_log, "Tracking_RebuildingDueToInvalidTLog", e.Message);
-                    break;
-                }
-
-                if (encounteredInvalidTLogContents)
-                {
-                    FileTracker.LogWarningWithCodeFromResources(_log, "Tracking_RebuildingDueToInvalidTLogContents", invalidTLogName);
-                    break;
+                    else // skip over the initial '#' line
+                    {
+                        tlogEntry = tlog.ReadLine();
+                    }
                 }
             }
 
-            lock (DependencyTableCache.DependencyTable)
+            return table;
+        }
+
+        /// <summary>
+        /// Merge the dependencies read from one tlog into the dependency table
+        /// </summary>
+        private void MergeDependencyTable(Dictionary<string, Dictionary<string, string>> table)
+        {
+            foreach (KeyValuePair<string, Dictionary<string, string>> entry in table)
             {
-                // There were problems with the tracking logs -- we've already warned or errored; now we want to make
-                // sure that we essentially force a rebuild of this particular root.
-                if (encounteredInvalidTLogContents || exceptionCaught)
+                if (!DependencyTable.TryGetValue(entry.Key, out Dictionary<string, string> dependencies))
                 {
-                    DependencyTableCache.DependencyTable.Remove(tLogRootingMarker);
-                    DependencyTable = new Dictionary<string, Dictionary<string, string>>(StringComparer.OrdinalIgnoreCase);
+                    DependencyTable.Add(entry.Key, entry.Value);
+                    continue;
                 }
-                else
+
+                foreach (string dependency in entry.Value.Keys)
                 {
-                    // Record the newly built dependency table in the cache
-                    DependencyTableCache.DependencyTable[tLogRootingMarker] = new DependencyTableCacheEntry(_tlogFiles, DependencyTable);
+                    if (!dependencies.ContainsKey(dependency))
+                    {
+                        dependencies.Add(dependency, null);
+                    }
                 }
             }
         }
@@ -863,33 +1068,26 @@ namespace Microsoft.Build.Utilities
             {
                 string tLogRootingMarker = DependencyTableCache.FormatNormalizedTlogRootingMarker(_tlogFiles);
 
-                lock (DependencyTableCache.DependencyTable)
-                {
-                    // The tracking logs in the cache will be invalidated by this compaction
-                    // remove the cached entries
-                    DependencyTableCache.DependencyTable.Remove(tLogRootingMarker);
-                }
+                // The tracking logs in the cache will be invalidated by this compaction
+                // remove the cached entries
+                DependencyTableCache.DependencyTable.TryRemove(tLogRootingMarker, out _);
 
                 string firstTlog = _tlogFiles[0].ItemSpec;
+                MSBuildEventSource.Log.SaveTrackingLogStart(firstTlog);
 
-                // empty all tlogs
-                foreach (ITaskItem tlogFile in _tlogFiles)
-                {
-                    File.WriteAllText(tlogFile.ItemSpec, "", System.Text.Encoding.Unicode);
-                }
-
-                // Write out the remaining dependency information as a new tlog
-                using (StreamWriter inputs = FileUtilities.OpenWrite(firstTlog, false, System.Text.Encoding.Unicode))
+                // Write out the remaining dependency information as a new tlog, in sorted order so that
+                // sources with the same dependencies are written identically
+                using (TextWriter inputs = BinaryTlog.OpenCompactedWrite(_tlogFiles))
                 {
                     if (!_maintainCompositeRootingMarkers)
                     {
-                        foreach (string primaryFile in DependencyTable.Keys)
+                        foreach (string primaryFile in CanonicalTrackedFilesHelper.GetSortedKeys(DependencyTable))
                         {
                             if (!primaryFile.Contains("|")) // composite roots are not needed
                             {
                                 Dictionary<string, string> dependencies = DependencyTable[primaryFile];
                                 inputs.WriteLine("^" + primaryFile);
-                                foreach (string file in dependencies.Keys)
+                                foreach (string file in CanonicalTrackedFilesHelper.GetSortedDependencies(dependencies))
                                 {
                                     // We only want to write the tlog entry if it isn't the primary file
                                     // and we aren't being asked to filter it out
@@ -905,11 +1103,11 @@ namespace Microsoft.Build.Utilities
                     {
                         // Just output the rooting markers and their dependencies -- we don't want to
                         // compact out the composite ones.
-                        foreach (string rootingMarker in DependencyTable.Keys)
+                        foreach (string rootingMarker in CanonicalTrackedFilesHelper.GetSortedKeys(DependencyTable))
                         {
                             Dictionary<string, string> dependencies = DependencyTable[rootingMarker];
                             inputs.WriteLine("^" + rootingMarker);
-                            foreach (string file in dependencies.Keys)
+                            foreach (string file in CanonicalTrackedFilesHelper.GetSortedDependencies(dependencies))
                             {
                                 // Give the task a chance to filter dependencies out of the written TLog
                                 if (includeInTLog == null || includeInTLog(file))
@@ -921,6 +1119,8 @@ namespace Microsoft.Build.Utilities
                         }
                     }
                 }
+
+                MSBuildEventSource.Log.SaveTrackingLogStop(firstTlog, DependencyTable.Count);
             }
         }
 
@@ -947,6 +1147,8 @@ namespace Microsoft.Build.Utilities
             {
                 DependencyTable.Remove(FileUtilities.NormalizePath(sourceItem.ItemSpec));
             }
+
+            InvalidateDependentsIndex();
         }
 
         /// <summary>
@@ -954,7 +1156,11 @@ namespace Microsoft.Build.Utilities
         /// passed in. 
         /// </summary>
         /// <param name="rootingMarker">The root to remove</param>
-        public void RemoveEntryForSourceRoot(string rootingMarker) => DependencyTable.Remove(rootingMarker);
+        public void RemoveEntryForSourceRoot(string rootingMarker)
+        {
+            DependencyTable.Remove(rootingMarker);
+            InvalidateDependentsIndex();
+        }
 
         /// <summary>
         /// Remove the output graph entries for the given sources and corresponding outputs
@@ -989,6 +1195,7 @@ namespace Microsoft.Build.Utilities
             if (DependencyTable.TryGetValue(rootingMarker, out Dictionary<string, string> dependencies))
             {
                 dependencies.Remove(FileUtilities.NormalizePath(dependencyToRemove.ItemSpec));
+                InvalidateDependentsIndex();
             }
             else
             {
@@ -1087,6 +1294,7 @@ namespace Microsoft.Build.Utilities
                 }
 
                 DependencyTable[rootingMarker] = dependenciesWithoutMissingFiles;
+                InvalidateDependentsIndex();
             }
         }
         #endregion
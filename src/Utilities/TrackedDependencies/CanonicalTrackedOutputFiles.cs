@@ -2,10 +2,12 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 using System;
+using System.Collections;
 using System.Collections.Generic;
 using System.Diagnostics.CodeAnalysis;
 using System.IO;
 
+using Microsoft.Build.Eventing;
 using Microsoft.Build.Framework;
 using Microsoft.Build.Shared;
 
@@ -77,6 +79,8 @@ namespace Microsoft.Build.Utilities
                 };
             }
 
+            // Tlogs saved in the background are looked for on disk
+            WrittenTlogCache.WaitForPendingWrites(tlogFiles);
             _tlogFiles = TrackedDependencies.ExpandWildcards(tlogFiles);
             _tlogAvailable = TrackedDependencies.ItemsExist(_tlogFiles);
             DependencyTable = new Dictionary<string, Dictionary<string, DateTime>>(StringComparer.OrdinalIgnoreCase);
@@ -112,25 +116,19 @@ namespace Microsoft.Build.Utilities
             if (!_tlogAvailable)
             {
                 FileTracker.LogMessageFromResources(_log, MessageImportance.Low, "Tracking_TrackingLogNotAvailable");
-                lock (DependencyTableCache.DependencyTable)
-                {
-                    // The tracking logs are not available, they may have been deleted at some point.
-                    // Be safe and remove any references from the cache.
-                    DependencyTableCache.DependencyTable.Remove(tLogRootingMarker);
-                }
+
+                // The tracking logs are not available, they may have been deleted at some point.
+                // Be safe and remove any references from the cache.
+                DependencyTableCache.DependencyTable.TryRemove(tLogRootingMarker, out _);
                 return;
             }
 
-            DependencyTableCacheEntry cachedEntry = null;
-
-            lock (DependencyTableCache.DependencyTable)
-            {
-                // Look in the dependency table cache to see if its available and up to date
-                cachedEntry = DependencyTableCache.GetCachedEntry(tLogRootingMarker);
-            }
+            // Look in the dependency table cache to see if its available and up to date, and read
+            // the tracking logs if it isn't
+            DependencyTableCacheEntry cachedEntry = DependencyTableCache.GetOrLoadEntry(tLogRootingMarker, DependencyTableKind.Outputs, _tlogFiles, () => ReadOutputTable(currentProjectDirectory), out bool loaded);
 
             // We have an up to date cached entry
-            if (cachedEntry != null)
+            if (!loaded)
             {
                 DependencyTable = (Dictionary<string, Dictionary<string, DateTime>>)cachedEntry.DependencyTable;
                 // Log information about what we're using
@@ -139,9 +137,16 @@ namespace Microsoft.Build.Utilities
                 {
                     FileTracker.LogMessage(_log, MessageImportance.Low, "\t{0}", tlogItem.ItemSpec);
                 }
-                return;
             }
+        }
 
+        /// <summary>
+        /// Construct the output table from the tlog files
+        /// </summary>
+        /// <param name="currentProjectDirectory">The project directory, beneath which tracked paths are never excluded</param>
+        /// <returns>The table, or null if the tlogs were invalid</returns>
+        private IDictionary ReadOutputTable(string currentProjectDirectory)
+        {
             FileTracker.LogMessageFromResources(_log, MessageImportance.Low, "Tracking_WriteTrackingLogs");
 
             // Now we need to construct the rest of the table from the TLOG files
@@ -149,13 +154,14 @@ namespace Microsoft.Build.Utilities
             // out the dependency table, essentially forcing a rebuild.
             bool encounteredInvalidTLogContents = false;
             string invalidTLogName = null;
+            TlogReadStatistics statistics = TlogReadStatistics.Start(_tlogFiles);
             foreach (ITaskItem tlogFileName in _tlogFiles)
             {
                 FileTracker.LogMessage(_log, MessageImportance.Low, "\t{0}", tlogFileName.ItemSpec);
 
                 try
                 {
-                    using (StreamReader tlog = File.OpenText(tlogFileName.ItemSpec))
+                    using (TextReader tlog = BinaryTlog.OpenRead(tlogFileName.ItemSpec, statistics))
                     {
                         string tlogEntry = tlog.ReadLine();
 
@@ -237,21 +243,17 @@ namespace Microsoft.Build.Utilities
                 }
             }
 
-            lock (DependencyTableCache.DependencyTable)
+            statistics?.Stop();
+
+            // There were problems with the tracking logs -- we've already warned or errored; now we want to make
+            // sure that we essentially force a rebuild of this particular root.
+            if (encounteredInvalidTLogContents)
             {
-                // There were problems with the tracking logs -- we've already warned or errored; now we want to make
-                // sure that we essentially force a rebuild of this particular root.
-                if (encounteredInvalidTLogContents)
-                {
-                    DependencyTableCache.DependencyTable.Remove(tLogRootingMarker);
-                    DependencyTable = new Dictionary<string, Dictionary<string, DateTime>>(StringComparer.OrdinalIgnoreCase);
-                }
-                else
-                {
-                    // Record the newly built valid dependency table in the cache
-                    DependencyTableCache.DependencyTable[tLogRootingMarker] = new DependencyTableCacheEntry(_tlogFiles, DependencyTable);
-                }
+                DependencyTable = new Dictionary<string, Dictionary<string, DateTime>>(StringComparer.OrdinalIgnoreCase);
+                return null;
             }
+
+            return DependencyTable;
         }
 
         /// <summary>
@@ -416,14 +418,19 @@ namespace Microsoft.Build.Utilities
             string upperSourcesRoot = FileTracker.FormatRootingMarker(sources);
             var outputsArray = new List<ITaskItem>();
 
+            // Split the sources' rooting marker once, rather than once for every root it is compared with
+            RootingMarkerComponents sourcesRootComponents = searchForSubRootsInCompositeRootingMarkers
+                ? new RootingMarkerComponents(upperSourcesRoot)
+                : null;
+
             // Check each root in the output table to see if meets case 1 or two described above
             foreach (string tableEntryRoot in DependencyTable.Keys)
             {
-                string upperTableEntryRoot = tableEntryRoot.ToUpperInvariant();
+                string upperTableEntryRoot = FileTracker.ToUpperInvariantIfNeeded(tableEntryRoot);
                 if (searchForSubRootsInCompositeRootingMarkers &&
                    (upperSourcesRoot.Contains(upperTableEntryRoot) ||
                     upperTableEntryRoot.Contains(upperSourcesRoot) ||
-                    CanonicalTrackedFilesHelper.RootContainsAllSubRootComponents(upperSourcesRoot, upperTableEntryRoot)))
+                    sourcesRootComponents.ContainsAll(upperTableEntryRoot)))
                 {
                     // Gather the unique outputs for this root
                     OutputsForSourceRoot(outputs, upperTableEntryRoot);
@@ -573,25 +580,18 @@ namespace Microsoft.Build.Utilities
             {
                 string tLogRootingMarker = DependencyTableCache.FormatNormalizedTlogRootingMarker(_tlogFiles);
 
-                lock (DependencyTableCache.DependencyTable)
-                {
-                    // The tracking logs in the cache will be invalidated by this compaction
-                    // remove the cached entries to be sure
-                    DependencyTableCache.DependencyTable.Remove(tLogRootingMarker);
-                }
+                // The tracking logs in the cache will be invalidated by this compaction
+                // remove the cached entries to be sure
+                DependencyTableCache.DependencyTable.TryRemove(tLogRootingMarker, out _);
 
                 string firstTlog = _tlogFiles[0].ItemSpec;
+                MSBuildEventSource.Log.SaveTrackingLogStart(firstTlog);
 
-                // empty all tlogs
-                foreach (ITaskItem tlogFile in _tlogFiles)
-                {
-                    File.WriteAllText(tlogFile.ItemSpec, "", System.Text.Encoding.Unicode);
-                }
-
-                // Write out the dependency information as a new tlog
-                using (StreamWriter outputs = FileUtilities.OpenWrite(firstTlog, false, System.Text.Encoding.Unicode))
+                // Write out the dependency information as a new tlog, with the roots in sorted order. The outputs of
+                // each root keep their order: the first is never pruned as missing, and callers see them in this order.
+                using (TextWriter outputs = BinaryTlog.OpenCompactedWrite(_tlogFiles))
                 {
-                    foreach (string rootingMarker in DependencyTable.Keys)
+                    foreach (string rootingMarker in CanonicalTrackedFilesHelper.GetSortedKeys(DependencyTable))
                     {
                         Dictionary<string, DateTime> dependencies = DependencyTable[rootingMarker];
                         outputs.WriteLine("^" + rootingMarker);
@@ -606,6 +606,8 @@ namespace Microsoft.Build.Utilities
                         }
                     }
                 }
+
+                MSBuildEventSource.Log.SaveTrackingLogStop(firstTlog, DependencyTable.Count);
             }
         }
 
@@ -3,11 +3,16 @@
 
 using System;
 using System.Collections;
+using System.Collections.Concurrent;
 using System.Collections.Generic;
+using System.IO;
 using System.Linq;
 using System.Text;
+using System.Threading;
+using Microsoft.Build.Eventing;
 using Microsoft.Build.Framework;
 using Microsoft.Build.Shared;
+using Microsoft.Build.Shared.FileSystem;
 
 #if FEATURE_FILE_TRACKER
 
@@ -18,15 +23,41 @@ namespace Microsoft.Build.Utilities
     /// The cache is keyed on the root marker created from the full paths of the tlog files concerned.
     /// As an entry is added to the cache so is the datetime it was added.
     /// </summary>
+    /// <remarks>
+    /// The cache is safe to use from many tasks at once without any external locking. Entries are
+    /// validated against their tlogs outside of any lock, concurrent loads of the same set of tlogs
+    /// are coalesced so that the tlogs are only parsed once, and the least recently used entries are
+    /// evicted once the cache grows beyond MSBUILDDEPENDENCYTABLECACHECAPACITY entries.
+    /// </remarks>
     internal static class DependencyTableCache
     {
         private static readonly char[] s_numerals = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9' };
         private static readonly TaskItemItemSpecIgnoreCaseComparer s_taskItemComparer = new TaskItemItemSpecIgnoreCaseComparer();
 
+        /// <summary>
+        /// "MSBDEPS" followed by the version of the persisted table format
+        /// </summary>
+        private static readonly byte[] s_persistedSignature = { (byte)'M', (byte)'S', (byte)'B', (byte)'D', (byte)'E', (byte)'P', (byte)'S', 1 };
+
+        /// <summary>
+        /// The loads of dependency tables currently in progress, keyed like the cache itself
+        /// </summary>
+        private static readonly ConcurrentDictionary<string, Lazy<DependencyTableCacheEntry>> s_pendingLoads = new ConcurrentDictionary<string, Lazy<DependencyTableCacheEntry>>(StringComparer.OrdinalIgnoreCase);
+
+        /// <summary>
+        /// Serializes eviction, so that concurrent inserts into a full cache don't all scan it
+        /// </summary>
+        private static readonly object s_evictionLock = new object();
+
+        /// <summary>
+        /// Monotonic clock used to order entries by when they were last used
+        /// </summary>
+        private static long s_lastUsedClock;
+
         /// <summary>
         /// The dictionary that maps the root of the tlog filenames to the dependencytable built from their content
         /// </summary>
-        internal static Dictionary<string, DependencyTableCacheEntry> DependencyTable { get; } = new Dictionary<string, DependencyTableCacheEntry>(StringComparer.OrdinalIgnoreCase);
+        internal static ConcurrentDictionary<string, DependencyTableCacheEntry> DependencyTable { get; } = new ConcurrentDictionary<string, DependencyTableCacheEntry>(StringComparer.OrdinalIgnoreCase);
 
         #region Methods
         /// <summary>
@@ -35,10 +66,17 @@ namespace Microsoft.Build.Utilities
         /// <param name="dependencyTable">The cache entry to check</param>
         /// <returns>true if up to date</returns>
         private static bool DependencyTableIsUpToDate(DependencyTableCacheEntry dependencyTable)
-        {
-            DateTime tableTime = dependencyTable.TableTime;
+            => DependencyTableIsUpToDate(dependencyTable.TlogFiles, dependencyTable.TableTime);
 
-            foreach (ITaskItem tlogFile in dependencyTable.TlogFiles)
+        /// <summary>
+        /// Determine if a table built at the given time is up to date with respect to the given tlogs
+        /// </summary>
+        /// <param name="tlogFiles">The tlogs the table was built from</param>
+        /// <param name="tableTime">The last write time of the newest tlog when the table was built</param>
+        /// <returns>true if up to date</returns>
+        private static bool DependencyTableIsUpToDate(ITaskItem[] tlogFiles, DateTime tableTime)
+        {
+            foreach (ITaskItem tlogFile in tlogFiles)
             {
                 string tlogFilename = FileUtilities.NormalizePath(tlogFile.ItemSpec);
 
@@ -64,18 +102,365 @@ namespace Microsoft.Build.Utilities
             {
                 if (DependencyTableIsUpToDate(cacheEntry))
                 {
+                    cacheEntry.LastUsed = Interlocked.Increment(ref s_lastUsedClock);
                     return cacheEntry;
                 }
                 else
                 {
-                    // Remove the cached entry from memory
-                    DependencyTable.Remove(tLogRootingMarker);
+                    // Remove the cached entry from memory, unless another task has already replaced it
+                    RemoveCachedEntry(tLogRootingMarker, cacheEntry);
                 }
             }
             // Either there was no cache entry, or it was out of date and was removed
             return null;
         }
 
+        /// <summary>
+        /// Get the cached entry for the given tlog set. If there is no up to date entry in memory and
+        /// persistence is enabled, the table persisted next to the tlogs by an earlier process is used instead.
+        /// </summary>
+        /// <param name="tLogRootingMarker">The rooting marker for the set of tlogs</param>
+        /// <param name="kind">The shape of the dependency table the caller expects</param>
+        /// <param name="tlogFiles">The tlogs the table is built from</param>
+        /// <returns>The cached table entry</returns>
+        internal static DependencyTableCacheEntry GetCachedEntry(string tLogRootingMarker, DependencyTableKind kind, ITaskItem[] tlogFiles)
+        {
+            DependencyTableCacheEntry cacheEntry = GetCachedEntry(tLogRootingMarker);
+
+            if (cacheEntry == null && Traits.Instance.PersistDependencyTableCache)
+            {
+                cacheEntry = ReadPersistedEntry(tLogRootingMarker, kind, tlogFiles);
+
+                if (cacheEntry != null)
+                {
+                    AddCachedEntry(tLogRootingMarker, cacheEntry);
+                }
+            }
+
+            return cacheEntry;
+        }
+
+        /// <summary>
+        /// Get the cached entry for the given tlog set, or load it if there isn't an up to date one. If another
+        /// task is already loading the same set of tlogs, wait for it instead of parsing them again.
+        /// </summary>
+        /// <param name="tLogRootingMarker">The rooting marker for the set of tlogs</param>
+        /// <param name="kind">The shape of the dependency table the caller expects</param>
+        /// <param name="tlogFiles">The tlogs the table is built from</param>
+        /// <param name="loadDependencyTable">Builds the dependency table from the tlogs, returning null if they were invalid</param>
+        /// <param name="loaded">true if the table was built by this call's <paramref name="loadDependencyTable"/></param>
+        /// <returns>The cached table entry, or null if the tlogs were invalid</returns>
+        internal static DependencyTableCacheEntry GetOrLoadEntry(string tLogRootingMarker, DependencyTableKind kind, ITaskItem[] tlogFiles, Func<IDictionary> loadDependencyTable, out bool loaded)
+        {
+            DependencyTableCacheEntry cacheEntry = GetCachedEntry(tLogRootingMarker, kind, tlogFiles);
+            if (cacheEntry != null)
+            {
+                MSBuildEventSource.Log.DependencyTableCacheHit(tLogRootingMarker);
+                loaded = false;
+                return cacheEntry;
+            }
+
+            MSBuildEventSource.Log.DependencyTableCacheMiss(tLogRootingMarker);
+
+            var load = new Lazy<DependencyTableCacheEntry>(() => LoadEntry(tLogRootingMarker, kind, tlogFiles, loadDependencyTable), LazyThreadSafetyMode.ExecutionAndPublication);
+            Lazy<DependencyTableCacheEntry> pendingLoad = s_pendingLoads.GetOrAdd(tLogRootingMarker, load);
+
+            if (pendingLoad == load)
+            {
+                try
+                {
+                    loaded = true;
+                    return load.Value;
+                }
+                finally
+                {
+                    ((ICollection<KeyValuePair<string, Lazy<DependencyTableCacheEntry>>>)s_pendingLoads).Remove(new KeyValuePair<string, Lazy<DependencyTableCacheEntry>>(tLogRootingMarker, load));
+                }
+            }
+
+            cacheEntry = pendingLoad.Value;
+            if (cacheEntry != null)
+            {
+                loaded = false;
+                return cacheEntry;
+            }
+
+            // The other task found the tlogs to be invalid. Load them again so that this task logs
+            // why, and ends up with an empty table in the same way.
+            loaded = true;
+            return LoadEntry(tLogRootingMarker, kind, tlogFiles, loadDependencyTable);
+        }
+
+        /// <summary>
+        /// Build the dependency table for the given tlog set and record the result in the cache
+        /// </summary>
+        private static DependencyTableCacheEntry LoadEntry(string tLogRootingMarker, DependencyTableKind kind, ITaskItem[] tlogFiles, Func<IDictionary> loadDependencyTable)
+        {
+            IDictionary dependencyTable = loadDependencyTable();
+
+            if (dependencyTable == null)
+            {
+                // There were problems with the tracking logs, so make sure that nothing cached
+                // stops this particular root from being rebuilt.
+                DependencyTable.TryRemove(tLogRootingMarker, out _);
+                return null;
+            }
+
+            var cacheEntry = new DependencyTableCacheEntry(tlogFiles, dependencyTable);
+            SetCachedEntry(tLogRootingMarker, kind, cacheEntry);
+            return cacheEntry;
+        }
+
+        /// <summary>
+        /// Remove the given entry from the cache, if it is still the entry cached for its tlog set
+        /// </summary>
+        private static void RemoveCachedEntry(string tLogRootingMarker, DependencyTableCacheEntry cacheEntry)
+            => ((ICollection<KeyValuePair<string, DependencyTableCacheEntry>>)DependencyTable).Remove(new KeyValuePair<string, DependencyTableCacheEntry>(tLogRootingMarker, cacheEntry));
+
+        /// <summary>
+        /// Add an entry to the cache, evicting the least recently used entries if it is over capacity
+        /// </summary>
+        private static void AddCachedEntry(string tLogRootingMarker, DependencyTableCacheEntry cacheEntry)
+        {
+            cacheEntry.LastUsed = Interlocked.Increment(ref s_lastUsedClock);
+            DependencyTable[tLogRootingMarker] = cacheEntry;
+
+            int capacity = Traits.Instance.DependencyTableCacheCapacity;
+            if (capacity > 0 && DependencyTable.Count > capacity)
+            {
+                EvictLeastRecentlyUsedEntries(capacity);
+            }
+        }
+
+        /// <summary>
+        /// Evict the least recently used entries. The cache is trimmed to 90% of its capacity, so that
+        /// a full cache isn't scanned again on every insert.
+        /// </summary>
+        /// <param name="capacity">The maximum number of entries to keep</param>
+        private static void EvictLeastRecentlyUsedEntries(int capacity)
+        {
+            lock (s_evictionLock)
+            {
+                KeyValuePair<string, DependencyTableCacheEntry>[] entries = DependencyTable.ToArray();
+                int excess = entries.Length - (capacity - (capacity / 10));
+                if (excess <= 0)
+                {
+                    return;
+                }
+
+                Array.Sort(entries, (x, y) => x.Value.LastUsed.CompareTo(y.Value.LastUsed));
+                for (int i = 0; i < excess; i++)
+                {
+                    RemoveCachedEntry(entries[i].Key, entries[i].Value);
+                }
+            }
+        }
+
+        /// <summary>
+        /// Record a newly built dependency table in the cache, and persist it next to the tlogs if enabled
+        /// </summary>
+        /// <param name="tLogRootingMarker">The rooting marker for the set of tlogs</param>
+        /// <param name="kind">The shape of the dependency table</param>
+        /// <param name="cacheEntry">The entry to cache</param>
+        internal static void SetCachedEntry(string tLogRootingMarker, DependencyTableKind kind, DependencyTableCacheEntry cacheEntry)
+        {
+            AddCachedEntry(tLogRootingMarker, cacheEntry);
+
+            if (Traits.Instance.PersistDependencyTableCache)
+            {
+                WritePersistedEntry(tLogRootingMarker, kind, cacheEntry);
+            }
+        }
+
+        /// <summary>
+        /// Get the path of the persisted table for the given tlog set. It lives beside the first tlog, so
+        /// that it is cleaned along with the intermediate directory.
+        /// </summary>
+        /// <param name="tLogRootingMarker">The rooting marker for the set of tlogs</param>
+        /// <param name="kind">The shape of the dependency table</param>
+        /// <param name="tlogFiles">The full paths of the tlogs the table is built from</param>
+        /// <returns>The path of the persisted table</returns>
+        private static string GetPersistedEntryPath(string tLogRootingMarker, DependencyTableKind kind, ITaskItem[] tlogFiles)
+        {
+            // FNV-1a, since the name has to be the same in every process. Collisions are caught
+            // by comparing the rooting marker stored in the file.
+            uint hash = 2166136261;
+            foreach (char c in tLogRootingMarker)
+            {
+                hash = (hash ^ char.ToUpperInvariant(c)) * 16777619;
+            }
+
+            string fileName = string.Concat(hash.ToString("x8"), ".", kind.ToString().ToLowerInvariant(), ".depscache");
+            return Path.Combine(Path.GetDirectoryName(tlogFiles[0].ItemSpec), fileName);
+        }
+
+        /// <summary>
+        /// Read the persisted table for the given tlog set, if there is one and it is up to date
+        /// </summary>
+        /// <param name="tLogRootingMarker">The rooting marker for the set of tlogs</param>
+        /// <param name="kind">The shape of the dependency table the caller expects</param>
+        /// <param name="tlogFiles">The tlogs the table is built from</param>
+        /// <returns>The entry, or null if it either doesn't exist or can't be used</returns>
+        private static DependencyTableCacheEntry ReadPersistedEntry(string tLogRootingMarker, DependencyTableKind kind, ITaskItem[] tlogFiles)
+        {
+            if (tlogFiles.Length == 0)
+            {
+                return null;
+            }
+
+            try
+            {
+                var fullPathTlogFiles = new ITaskItem[tlogFiles.Length];
+                for (int i = 0; i < tlogFiles.Length; i++)
+                {
+                    fullPathTlogFiles[i] = new TaskItem(FileUtilities.NormalizePath(tlogFiles[i].ItemSpec));
+                }
+
+                string path = GetPersistedEntryPath(tLogRootingMarker, kind, fullPathTlogFiles);
+                if (!FileSystems.Default.FileExists(path))
+                {
+                    return null;
+                }
+
+                using (var reader = new BinaryReader(new FileStream(path, FileMode.Open, FileAccess.Read, FileShare.Read, 4096, FileOptions.SequentialScan)))
+                {
+                    byte[] signature = reader.ReadBytes(s_persistedSignature.Length);
+                    if (!signature.SequenceEqual(s_persistedSignature) ||
+                        reader.ReadByte() != (byte)kind ||
+                        !string.Equals(reader.ReadString(), tLogRootingMarker, StringComparison.OrdinalIgnoreCase) ||
+                        !string.Equals(reader.ReadString(), GetCurrentProjectDirectory(), StringComparison.OrdinalIgnoreCase))
+                    {
+                        return null;
+                    }
+
+                    var tableTime = new DateTime(reader.ReadInt64(), DateTimeKind.Utc);
+                    if (!DependencyTableIsUpToDate(fullPathTlogFiles, tableTime))
+                    {
+                        return null;
+                    }
+
+                    IDictionary dependencyTable;
+                    switch (kind)
+                    {
+                        case DependencyTableKind.Inputs:
+                            dependencyTable = ReadTable(reader, r => ReadTable(r, r2 => r2.ReadBoolean() ? r2.ReadString() : null));
+                            break;
+                        case DependencyTableKind.Outputs:
+                            dependencyTable = ReadTable(reader, r => ReadTable(r, r2 => DateTime.FromBinary(r2.ReadInt64())));
+                            break;
+                        default:
+                            dependencyTable = ReadTable(reader, r => DateTime.FromBinary(r.ReadInt64()));
+                            break;
+                    }
+
+                    return new DependencyTableCacheEntry(fullPathTlogFiles, tableTime, dependencyTable);
+                }
+            }
+            catch (Exception e) when (ExceptionHandling.IsIoRelatedException(e))
+            {
+                // A missing, locked or corrupt persisted table just means the tlogs get parsed again
+                return null;
+            }
+        }
+
+        /// <summary>
+        /// Persist the given entry next to its tlogs. Failures are ignored; the next process will
+        /// simply parse the tlogs again.
+        /// </summary>
+        /// <param name="tLogRootingMarker">The rooting marker for the set of tlogs</param>
+        /// <param name="kind">The shape of the dependency table</param>
+        /// <param name="cacheEntry">The entry to persist</param>
+        private static void WritePersistedEntry(string tLogRootingMarker, DependencyTableKind kind, DependencyTableCacheEntry cacheEntry)
+        {
+            if (cacheEntry.TlogFiles.Length == 0)
+            {
+                return;
+            }
+
+            string path = null;
+            try
+            {
+                path = GetPersistedEntryPath(tLogRootingMarker, kind, cacheEntry.TlogFiles);
+
+                using (var writer = new BinaryWriter(new FileStream(path, FileMode.Create, FileAccess.Write, FileShare.None)))
+                {
+                    writer.Write(s_persistedSignature);
+                    writer.Write((byte)kind);
+                    writer.Write(tLogRootingMarker);
+                    writer.Write(GetCurrentProjectDirectory());
+                    writer.Write(cacheEntry.TableTime.Ticks);
+
+                    switch (kind)
+                    {
+                        case DependencyTableKind.Inputs:
+                            WriteTable(writer, (Dictionary<string, Dictionary<string, string>>)cacheEntry.DependencyTable, (w, dependencies) => WriteTable(w, dependencies, (w2, value) =>
+                            {
+                                w2.Write(value != null);
+                                if (value != null)
+                                {
+                                    w2.Write(value);
+                                }
+                            }));
+                            break;
+                        case DependencyTableKind.Outputs:
+                            WriteTable(writer, (Dictionary<string, Dictionary<string, DateTime>>)cacheEntry.DependencyTable, (w, outputs) => WriteTable(w, outputs, (w2, value) => w2.Write(value.ToBinary())));
+                            break;
+                        default:
+                            WriteTable(writer, (Dictionary<string, DateTime>)cacheEntry.DependencyTable, (w, value) => w.Write(value.ToBinary()));
+                            break;
+                    }
+                }
+            }
+            catch (Exception e) when (ExceptionHandling.IsIoRelatedException(e))
+            {
+                // Don't leave a partially written table behind
+                if (path != null)
+                {
+                    try
+                    {
+                        File.Delete(path);
+                    }
+                    catch (Exception ex) when (ExceptionHandling.IsIoRelatedException(ex))
+                    {
+                    }
+                }
+            }
+        }
+
+        private static Dictionary<string, T> ReadTable<T>(BinaryReader reader, Func<BinaryReader, T> readValue)
+        {
+            int count = reader.ReadInt32();
+            if (count < 0)
+            {
+                throw new EndOfStreamException();
+            }
+
+            var table = new Dictionary<string, T>(count, StringComparer.OrdinalIgnoreCase);
+            for (int i = 0; i < count; i++)
+            {
+                string key = reader.ReadString();
+                table[key] = readValue(reader);
+            }
+
+            return table;
+        }
+
+        private static void WriteTable<T>(BinaryWriter writer, Dictionary<string, T> table, Action<BinaryWriter, T> writeValue)
+        {
+            writer.Write(table.Count);
+            foreach (KeyValuePair<string, T> entry in table)
+            {
+                writer.Write(entry.Key);
+                writeValue(writer, entry.Value);
+            }
+        }
+
+        /// <summary>
+        /// Tracked paths beneath the project directory are never excluded from a table, so a persisted
+        /// table is only valid for the project directory it was built in.
+        /// </summary>
+        private static string GetCurrentProjectDirectory() => FileUtilities.EnsureTrailingSlash(Directory.GetCurrentDirectory());
+
         /// <summary>
         /// Given a set of TLog names, formats a rooting marker from them, that additionally replaces 
         /// all PIDs and TIDs with "[ID]" so the cache doesn't get overloaded with entries 
@@ -238,6 +623,13 @@ namespace Microsoft.Build.Utilities
 
         public IDictionary DependencyTable { get; }
 
+        // when the entry was last used, relative to the other entries in the cache
+        internal long LastUsed { get; set; }
+
+        // the roots depending on each dependency in an input table, built the first time it is needed
+        // and dropped whenever the table is edited through CanonicalTrackedInputFiles
+        internal DependentsIndex DependentsIndex { get; set; }
+
         /// <summary>
         /// Construct a new entry
         /// </summary>
@@ -264,6 +656,40 @@ namespace Microsoft.Build.Utilities
 
             DependencyTable = dependencyTable;
         }
+
+        /// <summary>
+        /// Construct an entry for a table that was built at a known time
+        /// </summary>
+        /// <param name="tlogFiles">The full paths of the tlog files used to build this dependency table</param>
+        /// <param name="tableTime">The last write time of the newest tlog when the table was built</param>
+        /// <param name="dependencyTable">The dependency table to be cached</param>
+        internal DependencyTableCacheEntry(ITaskItem[] tlogFiles, DateTime tableTime, IDictionary dependencyTable)
+        {
+            TlogFiles = tlogFiles;
+            TableTime = tableTime;
+            DependencyTable = dependencyTable;
+        }
+    }
+
+    /// <summary>
+    /// The shape of a cached dependency table, as built by each of the tracked dependency readers
+    /// </summary>
+    internal enum DependencyTableKind : byte
+    {
+        /// <summary>
+        /// The table built by CanonicalTrackedInputFiles
+        /// </summary>
+        Inputs = 1,
+
+        /// <summary>
+        /// The table built by CanonicalTrackedOutputFiles
+        /// </summary>
+        Outputs = 2,
+
+        /// <summary>
+        /// The table built by FlatTrackingData
+        /// </summary>
+        Files = 3
     }
 }
 
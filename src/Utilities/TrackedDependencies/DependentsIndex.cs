@@ -0,0 +1,76 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections.Generic;
+
+#if FEATURE_FILE_TRACKER
+
+namespace Microsoft.Build.Utilities
+{
+    /// <summary>
+    /// Maps each dependency in an input dependency table back to the roots that depend on it, so that
+    /// a header shared by many sources is checked once rather than once for every source that includes it.
+    /// </summary>
+    /// <remarks>
+    /// The index is built once per table and shared by everyone using the table from the dependency table
+    /// cache. The methods of <see cref="CanonicalTrackedInputFiles"/> that edit the table drop the index, but
+    /// edits made directly to the public dependency table are not seen by an index that has already been built.
+    /// </remarks>
+    internal sealed class DependentsIndex
+    {
+        // The roots that each dependency appears beneath
+        private readonly Dictionary<string, List<string>> _dependents;
+
+        private DependentsIndex(Dictionary<string, Dictionary<string, string>> dependencyTable, Dictionary<string, List<string>> dependents)
+        {
+            DependencyTable = dependencyTable;
+            _dependents = dependents;
+            Dependencies = new string[dependents.Count];
+            dependents.Keys.CopyTo(Dependencies, 0);
+        }
+
+        /// <summary>
+        /// The table the index was built from.
+        /// </summary>
+        internal Dictionary<string, Dictionary<string, string>> DependencyTable { get; }
+
+        /// <summary>
+        /// Every distinct dependency in the table.
+        /// </summary>
+        internal string[] Dependencies { get; }
+
+        /// <summary>
+        /// Build the index for the given dependency table.
+        /// </summary>
+        /// <param name="dependencyTable">The table of roots and their dependencies</param>
+        internal static DependentsIndex Build(Dictionary<string, Dictionary<string, string>> dependencyTable)
+        {
+            var dependents = new Dictionary<string, List<string>>(StringComparer.OrdinalIgnoreCase);
+
+            foreach (KeyValuePair<string, Dictionary<string, string>> root in dependencyTable)
+            {
+                foreach (string dependency in root.Value.Keys)
+                {
+                    if (!dependents.TryGetValue(dependency, out List<string> roots))
+                    {
+                        roots = new List<string>();
+                        dependents.Add(dependency, roots);
+                    }
+
+                    roots.Add(root.Key);
+                }
+            }
+
+            return new DependentsIndex(dependencyTable, dependents);
+        }
+
+        /// <summary>
+        /// Get the roots that depend on the given dependency.
+        /// </summary>
+        /// <param name="dependency">One of the dependencies in the index</param>
+        internal List<string> GetDependents(string dependency) => _dependents[dependency];
+    }
+}
+
+#endif
@@ -7,7 +7,6 @@ using System.Collections.Generic;
 using System.Diagnostics;
 using System.Diagnostics.CodeAnalysis;
 using System.IO;
-using System.Linq;
 using System.Text;
 using Microsoft.Build.Framework;
 using Microsoft.Build.Shared;
@@ -85,6 +84,9 @@ namespace Microsoft.Build.Utilities
         // Thus this list is created to store all possible common application data paths to cover more cases as possible.
         private static readonly List<string> s_commonApplicationDataPaths;
 
+        // All of the above, compiled so that each tlog entry is checked against them in a single pass
+        private static readonly PathPrefixSet s_excludedDependencyPaths;
+
         // The name of the standalone tracker tool.
         private static readonly string s_TrackerFilename = "Tracker.exe";
 
@@ -126,6 +128,17 @@ namespace Microsoft.Build.Utilities
             {
                 s_commonApplicationDataPaths.Add(alternativeCommonApplicationDataPath2);
             }
+
+            var excludedDependencyPaths = new List<string>
+            {
+                s_applicationDataPath,
+                s_localApplicationDataPath,
+                s_localLowApplicationDataPath,
+                s_tempShortPath,
+                s_tempLongPath
+            };
+            excludedDependencyPaths.AddRange(s_commonApplicationDataPaths);
+            s_excludedDependencyPaths = new PathPrefixSet(excludedDependencyPaths);
         }
 
         #endregion
@@ -184,7 +197,12 @@ namespace Microsoft.Build.Utilities
         /// <param name="taskName">The name of the task calling this function, used to determine the 
         /// names of the tracking log files</param>
         [SuppressMessage("Microsoft.Naming", "CA1702:CompoundWordsShouldBeCasedCorrectly", MessageId = "TLogs", Justification = "Has now shipped as public API; plus it's unclear whether 'Tlog' or 'TLog' is the preferred casing")]
-        public static void WriteAllTLogs(string intermediateDirectory, string taskName) => InprocTrackingNativeMethods.WriteAllTLogs(intermediateDirectory, taskName);
+        public static void WriteAllTLogs(string intermediateDirectory, string taskName)
+        {
+            // The tlogs written may be ones saved in the background
+            WrittenTlogCache.WaitForPendingWritesInDirectory(intermediateDirectory);
+            InprocTrackingNativeMethods.WriteAllTLogs(intermediateDirectory, taskName);
+        }
 
         /// <summary>
         /// Write tracking logs corresponding to the current tracking context.  
@@ -193,7 +211,12 @@ namespace Microsoft.Build.Utilities
         /// <param name="taskName">The name of the task calling this function, used to determine the 
         /// names of the tracking log files</param>
         [SuppressMessage("Microsoft.Naming", "CA1702:CompoundWordsShouldBeCasedCorrectly", MessageId = "TLogs", Justification = "Has now shipped as public API; plus it's unclear whether 'Tlog' or 'TLog' is the preferred casing")]
-        public static void WriteContextTLogs(string intermediateDirectory, string taskName) => InprocTrackingNativeMethods.WriteContextTLogs(intermediateDirectory, taskName);
+        public static void WriteContextTLogs(string intermediateDirectory, string taskName)
+        {
+            // The tlogs written may be ones saved in the background
+            WrittenTlogCache.WaitForPendingWritesInDirectory(intermediateDirectory);
+            InprocTrackingNativeMethods.WriteContextTLogs(intermediateDirectory, taskName);
+        }
 
         #endregion // Native method wrappers
 
@@ -226,12 +249,7 @@ namespace Microsoft.Build.Utilities
             // 5. Files under the common ("All Users") Application Data location -- C:\Documents and Settings\All Users\Application Data 
             //    on XP and either C:\Users\All Users\Application Data or C:\ProgramData on Vista+
 
-            return FileIsUnderPath(fileName, s_applicationDataPath) ||
-                   FileIsUnderPath(fileName, s_localApplicationDataPath) ||
-                   FileIsUnderPath(fileName, s_localLowApplicationDataPath) ||
-                   FileIsUnderPath(fileName, s_tempShortPath) ||
-                   FileIsUnderPath(fileName, s_tempLongPath) ||
-                   s_commonApplicationDataPaths.Any(p => FileIsUnderPath(fileName, p));
+            return s_excludedDependencyPaths.MatchesStartOf(fileName);
         }
 
         /// <summary>
@@ -263,7 +281,13 @@ namespace Microsoft.Build.Utilities
         /// Construct a rooting marker string from the ITaskItem array of primary sources.
         /// </summary>
         /// <param name="source">An <see cref="ITaskItem"/> containing information about the primary source.</param>
-        public static string FormatRootingMarker(ITaskItem source) => FormatRootingMarker(new[] { source }, null);
+        public static string FormatRootingMarker(ITaskItem source)
+        {
+            ErrorUtilities.VerifyThrowArgumentNull(source, nameof(source));
+
+            // A single source needs no sorting or joining
+            return ToUpperInvariantIfNeeded(NormalizeRootingMarkerPath(source.ItemSpec));
+        }
 
         /// <summary>
         /// Construct a rooting marker string from the ITaskItem array of primary sources.
@@ -294,21 +318,152 @@ namespace Microsoft.Build.Utilities
             // So we don't have to deal with null checks.
             outputs ??= Array.Empty<ITaskItem>();
 
-            var rootSources = new List<string>(sources.Length + outputs.Length);
+            var rootSources = new string[sources.Length + outputs.Length];
+            int length = rootSources.Length - 1;
 
-            foreach (ITaskItem source in sources)
+            for (int i = 0; i < sources.Length; i++)
             {
-                rootSources.Add(FileUtilities.NormalizePath(source.ItemSpec).ToUpperInvariant());
+                rootSources[i] = NormalizeRootingMarkerPath(sources[i].ItemSpec);
+                length += rootSources[i].Length;
             }
 
-            foreach (ITaskItem output in outputs)
+            for (int i = 0; i < outputs.Length; i++)
             {
-                rootSources.Add(FileUtilities.NormalizePath(output.ItemSpec).ToUpperInvariant());
+                rootSources[sources.Length + i] = NormalizeRootingMarkerPath(outputs[i].ItemSpec);
+                length += rootSources[sources.Length + i].Length;
+            }
+
+            if (rootSources.Length == 1)
+            {
+                return ToUpperInvariantIfNeeded(rootSources[0]);
+            }
+
+            // Sorting ignoring case orders the paths as their upper case forms would be ordered, so they
+            // can be upper cased as they are joined rather than each being copied first
+            Array.Sort(rootSources, StringComparer.OrdinalIgnoreCase);
+
+            StringBuilder rootingMarker = StringBuilderCache.Acquire(Math.Max(length, 0));
+
+            for (int i = 0; i < rootSources.Length; i++)
+            {
+                if (i > 0)
+                {
+                    rootingMarker.Append('|');
+                }
+
+                foreach (char c in rootSources[i])
+                {
+                    rootingMarker.Append(char.ToUpperInvariant(c));
+                }
             }
 
-            rootSources.Sort(StringComparer.OrdinalIgnoreCase);
+            return StringBuilderCache.GetStringAndRelease(rootingMarker);
+        }
 
-            return string.Join("|", rootSources);
+        /// <summary>
+        /// Returns the upper case form of the string, or the string itself if it is already upper case
+        /// as rooting markers read from tlogs usually are.
+        /// </summary>
+        internal static string ToUpperInvariantIfNeeded(string value)
+        {
+            foreach (char c in value)
+            {
+                if (char.ToUpperInvariant(c) != c)
+                {
+                    return value.ToUpperInvariant();
+                }
+            }
+
+            return value;
+        }
+
+        /// <summary>
+        /// Normalize a path that is part of a rooting marker. Item specs are usually full paths already,
+        /// and those that are canonical are used as they are rather than being looked up again.
+        /// </summary>
+        private static string NormalizeRootingMarkerPath(string path)
+            => IsCanonicalFullPath(path) ? path : FileUtilities.NormalizePath(path);
+
+        /// <summary>
+        /// Determine whether a path is a drive qualified Windows path that normalizing would leave
+        /// unchanged: backslash separated, with no empty, "." or ".." segments, no segment that ends
+        /// in a character Windows would trim and no reserved device names. Paths containing '~' may
+        /// be 8.3 short names, which normalizing expands to the long names Tracker writes to tlogs.
+        /// </summary>
+        private static bool IsCanonicalFullPath(string path)
+        {
+            if (!NativeMethodsShared.IsWindows ||
+                path.Length < 3 ||
+                path.Length >= NativeMethodsShared.MaxPath ||
+                !((path[0] >= 'A' && path[0] <= 'Z') || (path[0] >= 'a' && path[0] <= 'z')) ||
+                path[1] != ':' ||
+                path[2] != '\\')
+            {
+                return false;
+            }
+
+            int segmentStart = 3;
+            for (int i = 3; i <= path.Length; i++)
+            {
+                if (i == path.Length || path[i] == '\\')
+                {
+                    int segmentLength = i - segmentStart;
+
+                    // Only a trailing separator, which normalizing keeps, leaves an empty segment
+                    if (segmentLength == 0)
+                    {
+                        if (i != path.Length)
+                        {
+                            return false;
+                        }
+                    }
+                    else if (path[i - 1] == '.' || path[i - 1] == ' ' || IsReservedDeviceName(path, segmentStart, segmentLength))
+                    {
+                        return false;
+                    }
+
+                    segmentStart = i + 1;
+                }
+                else if (path[i] < ' ' || path[i] == '/' || path[i] == ':' || path[i] == '"' || path[i] == '<' ||
+                         path[i] == '>' || path[i] == '|' || path[i] == '*' || path[i] == '?' || path[i] == '~')
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        /// <summary>
+        /// Determine whether a path segment names a device such as CON, NUL, COM1 or LPT1, with or
+        /// without an extension, which normalizing turns into a device path.
+        /// </summary>
+        private static bool IsReservedDeviceName(string path, int start, int length)
+        {
+            int nameLength = path.IndexOf('.', start, length);
+            nameLength = nameLength < 0 ? length : nameLength - start;
+
+            while (nameLength > 0 && path[start + nameLength - 1] == ' ')
+            {
+                nameLength--;
+            }
+
+            if (nameLength == 3)
+            {
+                return string.Compare(path, start, "CON", 0, 3, StringComparison.OrdinalIgnoreCase) == 0 ||
+                       string.Compare(path, start, "PRN", 0, 3, StringComparison.OrdinalIgnoreCase) == 0 ||
+                       string.Compare(path, start, "AUX", 0, 3, StringComparison.OrdinalIgnoreCase) == 0 ||
+                       string.Compare(path, start, "NUL", 0, 3, StringComparison.OrdinalIgnoreCase) == 0;
+            }
+
+            if (nameLength == 4)
+            {
+                return (string.Compare(path, start, "COM", 0, 3, StringComparison.OrdinalIgnoreCase) == 0 ||
+                        string.Compare(path, start, "LPT", 0, 3, StringComparison.OrdinalIgnoreCase) == 0) &&
+                       path[start + 3] >= '0' && path[start + 3] <= '9';
+            }
+
+            return false;
         }
 
         /// <summary>
@@ -450,6 +605,12 @@ namespace Microsoft.Build.Utilities
         /// <param name="rootPath">The root path for Tracker.exe.  Overrides the toolType if specified.</param>
         public static string GetTrackerPath(ExecutableType toolType, string rootPath) => GetPath(s_TrackerFilename, toolType, rootPath);
 
+        /// <summary>
+        /// Returns true if the path is to Tracker.exe.
+        /// </summary>
+        /// <param name="path">The path to the tool</param>
+        internal static bool IsTrackerPath(string path) => s_TrackerFilename.Equals(Path.GetFileName(path), StringComparison.OrdinalIgnoreCase);
+
         /// <summary>
         /// Given the ExecutableType of the tool being wrapped and information that we 
         /// know about our current bitness, figures out and returns the path to the correct
@@ -644,6 +805,9 @@ namespace Microsoft.Build.Utilities
             dllName ??= GetFileTrackerPath(toolType);
 
             string fullArguments = TrackerArguments(command, arguments, dllName, intermediateDirectory, rootFiles, cancelEventName);
+
+            // The tracked tool reads and writes tlogs that may have been saved in the background
+            WrittenTlogCache.WaitForPendingWritesInDirectory(intermediateDirectory);
             return Process.Start(GetTrackerPath(toolType), fullArguments);
         }
 
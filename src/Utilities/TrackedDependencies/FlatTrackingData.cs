@@ -2,12 +2,15 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 using System;
+using System.Collections;
+using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.Diagnostics.CodeAnalysis;
 using System.IO;
 using System.Resources;
-using System.Text;
+using System.Threading.Tasks;
 
+using Microsoft.Build.Eventing;
 using Microsoft.Build.Framework;
 using Microsoft.Build.Shared;
 using Microsoft.Build.Shared.FileSystem;
@@ -54,8 +57,14 @@ namespace Microsoft.Build.Utilities
         // Cache of last write times
         private readonly IDictionary<string, DateTime> _lastWriteTimeUtcCache = new Dictionary<string, DateTime>(StringComparer.OrdinalIgnoreCase);
 
+        // Cache of last write times of installed files, shared by everything in the current build
+        private ConcurrentDictionary<string, DateTime> _sharedLastWriteTimeUtcCache;
+
+        // The contents of the entries as of the last up to date check, loaded when first needed
+        private TrackedContentHashes _contentHashes;
+
         // The set of paths that contain files that are to be ignored during up to date check - these directories or their subdirectories
-        private readonly List<string> _excludedInputPaths = new List<string>();
+        private PathPrefixSet _excludedInputPaths;
         #endregion
 
         #region Properties
@@ -266,6 +275,10 @@ namespace Microsoft.Build.Utilities
                 };
             }
 
+            _sharedLastWriteTimeUtcCache = SharedFileTimestampCache.GetForBuild(ownerTask?.BuildEngine);
+
+            // Tlogs saved in the background are looked for on disk
+            WrittenTlogCache.WaitForPendingWrites(tlogFilesLocal);
             ITaskItem[] expandedTlogFiles = TrackedDependencies.ExpandWildcards(tlogFilesLocal);
 
             if (tlogFilesToIgnore != null)
@@ -318,11 +331,14 @@ namespace Microsoft.Build.Utilities
             {
                 // Assign our exclude paths to our lookup - and make sure that all recorded paths end in a slash so that
                 // our "starts with" comparison doesn't pick up incomplete matches, such as C:\Foo matching C:\FooFile.txt
+                var fullExcludePaths = new List<string>(excludedInputPaths.Length);
                 foreach (string excludePath in excludedInputPaths)
                 {
                     string fullexcludePath = FileUtilities.EnsureTrailingSlash(FileUtilities.NormalizePath(excludePath)).ToUpperInvariant();
-                    _excludedInputPaths.Add(fullexcludePath);
+                    fullExcludePaths.Add(fullexcludePath);
                 }
+
+                _excludedInputPaths = PathPrefixSet.GetShared(fullExcludePaths);
             }
 
             TlogsAvailable = TrackedDependencies.ItemsExist(TlogFiles);
@@ -355,25 +371,18 @@ namespace Microsoft.Build.Utilities
             }
             if (!TlogsAvailable)
             {
-                lock (DependencyTableCache.DependencyTable)
-                {
-                    // The tracking logs are not available, they may have been deleted at some point.
-                    // Be safe and remove any references from the cache.
-                    DependencyTableCache.DependencyTable.Remove(tLogRootingMarker);
-                }
+                // The tracking logs are not available, they may have been deleted at some point.
+                // Be safe and remove any references from the cache.
+                DependencyTableCache.DependencyTable.TryRemove(tLogRootingMarker, out _);
                 return;
             }
 
-            DependencyTableCacheEntry cachedEntry;
-
-            lock (DependencyTableCache.DependencyTable)
-            {
-                // Look in the dependency table cache to see if its available and up to date
-                cachedEntry = DependencyTableCache.GetCachedEntry(tLogRootingMarker);
-            }
+            // Look in the dependency table cache to see if its available and up to date, and read
+            // the tracking logs if it isn't
+            DependencyTableCacheEntry cachedEntry = DependencyTableCache.GetOrLoadEntry(tLogRootingMarker, DependencyTableKind.Files, TlogFiles, ReadFileTable, out bool loaded);
 
             // We have an up to date cached entry
-            if (cachedEntry != null)
+            if (!loaded)
             {
                 DependencyTable = (Dictionary<string, DateTime>)cachedEntry.DependencyTable;
 
@@ -388,104 +397,127 @@ namespace Microsoft.Build.Utilities
                 {
                     FileTracker.LogMessage(_log, MessageImportance.Low, "\t{0}", tlogItem.ItemSpec);
                 }
-                return;
             }
+        }
 
+        /// <summary>
+        /// Construct the file table from the tlog files
+        /// </summary>
+        /// <returns>The table, or null if the tlogs were invalid</returns>
+        private IDictionary ReadFileTable()
+        {
             FileTracker.LogMessageFromResources(_log, MessageImportance.Low, "Tracking_TrackingLogs");
             // Now we need to construct the rest of the table from the TLOG files
             // If there are any errors in the tlogs, we want to warn, stop parsing tlogs, and empty 
             // out the dependency table, essentially forcing a rebuild.  
             bool encounteredInvalidTLogContents = false;
-            string invalidTLogName = null;
-            foreach (ITaskItem tlogFileName in TlogFiles)
-            {
-                try
-                {
-                    FileTracker.LogMessage(_log, MessageImportance.Low, "\t{0}", tlogFileName.ItemSpec);
 
-                    DateTime tlogLastWriteTimeUtc = NativeMethodsShared.GetLastWriteFileUtcTime(tlogFileName.ItemSpec);
-                    if (tlogLastWriteTimeUtc > _newestTLogTimeUtc)
-                    {
-                        _newestTLogTimeUtc = tlogLastWriteTimeUtc;
-                        NewestTLogFileName = tlogFileName.ItemSpec;
-                    }
+            // Each tlog is read on its own, concurrently when there are several, and the entries are
+            // then recorded in tlog order
+            TlogReadStatistics statistics = TlogReadStatistics.Start(TlogFiles);
+            TlogContents<List<string>>[] tlogContents = TrackedDependencies.ReadTlogs(TlogFiles, tlogPath => ReadFileTlog(tlogPath, statistics));
+            statistics?.Stop();
 
-                    using (StreamReader tlog = File.OpenText(tlogFileName.ItemSpec))
-                    {
-                        string tlogEntry = tlog.ReadLine();
+            for (int i = 0; i < TlogFiles.Length; i++)
+            {
+                ITaskItem tlogFileName = TlogFiles[i];
+                FileTracker.LogMessage(_log, MessageImportance.Low, "\t{0}", tlogFileName.ItemSpec);
 
-                        while (tlogEntry != null)
-                        {
-                            if (tlogEntry.Length == 0) // empty lines are a sign that something has gone wrong
-                            {
-                                encounteredInvalidTLogContents = true;
-                                invalidTLogName = tlogFileName.ItemSpec;
-                                break;
-                            }
-                            // Preprocessing for the line entry
-                            else if (tlogEntry[0] == '#') // a comment marker should be skipped
-                            {
-                                tlogEntry = tlog.ReadLine();
-                                continue;
-                            }
-                            else if (tlogEntry[0] == '^' && TreatRootMarkersAsEntries && tlogEntry.IndexOf('|') < 0) // This is a rooting non composite record, and we should keep it
-                            {
-                                tlogEntry = tlogEntry.Substring(1);
-
-                                if (tlogEntry.Length == 0)
-                                {
-                                    encounteredInvalidTLogContents = true;
-                                    invalidTLogName = tlogFileName.ItemSpec;
-                                    break;
-                                }
-                            }
-                            else if (tlogEntry[0] == '^') // root marker is not being treated as an entry, skip it
-                            {
-                                tlogEntry = tlog.ReadLine();
-                                continue;
-                            }
-
-                            // If we haven't seen this file before, then record it
-                            if (!DependencyTable.ContainsKey(tlogEntry))
-                            {
-                                // It may be that this is one of the locations that we should ignore
-                                if (!FileTracker.FileIsExcludedFromDependencies(tlogEntry))
-                                {
-                                    RecordEntryDetails(tlogEntry, true);
-                                }
-                            }
-                            tlogEntry = tlog.ReadLine();
-                        }
-                    }
+                // The tlog counts towards the newest tlog even if it couldn't be read
+                DateTime tlogLastWriteTimeUtc = NativeMethodsShared.GetLastWriteFileUtcTime(tlogFileName.ItemSpec);
+                if (tlogLastWriteTimeUtc > _newestTLogTimeUtc)
+                {
+                    _newestTLogTimeUtc = tlogLastWriteTimeUtc;
+                    NewestTLogFileName = tlogFileName.ItemSpec;
                 }
-                catch (Exception e) when (ExceptionHandling.IsIoRelatedException(e))
+
+                Exception e = tlogContents[i].GetIoException();
+                if (e != null)
                 {
                     FileTracker.LogWarningWithCodeFromResources(_log, "Tracking_RebuildingDueToInvalidTLog", e.Message);
                     break;
                 }
 
-                if (encounteredInvalidTLogContents)
+                if (tlogContents[i].Table == null)
                 {
-                    FileTracker.LogWarningWithCodeFromResources(_log, "Tracking_RebuildingDueToInvalidTLogContents", invalidTLogName);
+                    encounteredInvalidTLogContents = true;
+                    FileTracker.LogWarningWithCodeFromResources(_log, "Tracking_RebuildingDueToInvalidTLogContents", tlogFileName.ItemSpec);
                     break;
                 }
-            }
 
-            lock (DependencyTableCache.DependencyTable)
-            {
-                // There were problems with the tracking logs -- we've already warned or errored; now we want to make 
-                // sure that we essentially force a rebuild of this particular root. 
-                if (encounteredInvalidTLogContents)
+                foreach (string tlogEntry in tlogContents[i].Table)
                 {
-                    DependencyTableCache.DependencyTable.Remove(tLogRootingMarker);
-                    DependencyTable = new Dictionary<string, DateTime>(StringComparer.OrdinalIgnoreCase);
+                    // If we haven't seen this file before, then record it
+                    if (!DependencyTable.ContainsKey(tlogEntry))
+                    {
+                        RecordEntryDetails(tlogEntry, true);
+                    }
                 }
-                else
+            }
+
+            // There were problems with the tracking logs -- we've already warned or errored; now we want to make 
+            // sure that we essentially force a rebuild of this particular root. 
+            if (encounteredInvalidTLogContents)
+            {
+                DependencyTable = new Dictionary<string, DateTime>(StringComparer.OrdinalIgnoreCase);
+                return null;
+            }
+
+            return DependencyTable;
+        }
+
+        /// <summary>
+        /// Read the entries recorded in a single tlog, leaving out those in locations that we should ignore
+        /// </summary>
+        /// <param name="tlogPath">The tlog to read</param>
+        /// <param name="statistics">The statistics to add to, or null if none are being collected</param>
+        /// <returns>The entries in the order they were first seen, or null if the contents of the tlog are invalid</returns>
+        private List<string> ReadFileTlog(string tlogPath, TlogReadStatistics statistics)
+        {
+            var entries = new List<string>();
+            var seenEntries = new HashSet<string>(StringComparer.OrdinalIgnoreCase);
+
+            using (TextReader tlog = BinaryTlog.OpenRead(tlogPath, statistics))
+            {
+                string tlogEntry = tlog.ReadLine();
+
+                while (tlogEntry != null)
                 {
-                    // Record the newly built dependency table in the cache
-                    DependencyTableCache.DependencyTable[tLogRootingMarker] = new DependencyTableCacheEntry(TlogFiles, DependencyTable);
+                    if (tlogEntry.Length == 0) // empty lines are a sign that something has gone wrong
+                    {
+                        return null;
+                    }
+                    // Preprocessing for the line entry
+                    else if (tlogEntry[0] == '#') // a comment marker should be skipped
+                    {
+                        tlogEntry = tlog.ReadLine();
+                        continue;
+                    }
+                    else if (tlogEntry[0] == '^' && TreatRootMarkersAsEntries && tlogEntry.IndexOf('|') < 0) // This is a rooting non composite record, and we should keep it
+                    {
+                        tlogEntry = tlogEntry.Substring(1);
+
+                        if (tlogEntry.Length == 0)
+                        {
+                            return null;
+                        }
+                    }
+                    else if (tlogEntry[0] == '^') // root marker is not being treated as an entry, skip it
+                    {
+                        tlogEntry = tlog.ReadLine();
+                        continue;
+                    }
+
+                    // It may be that this is one of the locations that we should ignore
+                    if (seenEntries.Add(tlogEntry) && !FileTracker.FileIsExcludedFromDependencies(tlogEntry))
+                    {
+                        entries.Add(tlogEntry);
+                    }
+                    tlogEntry = tlog.ReadLine();
                 }
             }
+
+            return entries;
         }
 
         /// <summary>
@@ -534,15 +566,7 @@ namespace Microsoft.Build.Utilities
         /// </remarks>
         public bool FileIsExcludedFromDependencyCheck(string fileName)
         {
-            foreach (string path in _excludedInputPaths)
-            {
-                if (fileName.StartsWith(path, StringComparison.OrdinalIgnoreCase))
-                {
-                    return true;
-                }
-            }
-
-            return false;
+            return _excludedInputPaths?.MatchesStartOf(fileName) == true;
         }
 
         /// <summary>
@@ -608,25 +632,17 @@ namespace Microsoft.Build.Utilities
             {
                 string tLogRootingMarker = DependencyTableCache.FormatNormalizedTlogRootingMarker(TlogFiles);
 
-                lock (DependencyTableCache.DependencyTable)
-                {
-                    // The tracking logs in the cache will be invalidated by this write
-                    // remove the cached entries to be sure
-                    DependencyTableCache.DependencyTable.Remove(tLogRootingMarker);
-                }
+                // The tracking logs in the cache will be invalidated by this write
+                // remove the cached entries to be sure
+                DependencyTableCache.DependencyTable.TryRemove(tLogRootingMarker, out _);
 
                 string firstTlog = TlogFiles[0].ItemSpec;
+                MSBuildEventSource.Log.SaveTrackingLogStart(firstTlog);
 
-                // empty all tlogs
-                foreach (ITaskItem tlogFile in TlogFiles)
-                {
-                    File.WriteAllText(tlogFile.ItemSpec, "", Encoding.Unicode);
-                }
-
-                // Write out the dependency information as a new tlog
-                using (StreamWriter newTlog = FileUtilities.OpenWrite(firstTlog, false, Encoding.Unicode))
+                // Write out the dependency information as a new tlog, in sorted order
+                using (TextWriter newTlog = BinaryTlog.OpenCompactedWrite(TlogFiles))
                 {
-                    foreach (string fileEntry in DependencyTable.Keys)
+                    foreach (string fileEntry in CanonicalTrackedFilesHelper.GetSortedKeys(DependencyTable))
                     {
                         // Give the task a chance to filter dependencies out of the written TLog
                         if (includeInTLog == null || includeInTLog(fileEntry))
@@ -636,6 +652,8 @@ namespace Microsoft.Build.Utilities
                         }
                     }
                 }
+
+                MSBuildEventSource.Log.SaveTrackingLogStop(firstTlog, DependencyTable.Count);
             }
             else if (_tlogMarker != string.Empty)
             {
@@ -651,6 +669,57 @@ namespace Microsoft.Build.Utilities
             }
         }
 
+        /// <summary>
+        /// Find an entry newer than the given time whose contents have changed since they were last
+        /// recorded before that time.
+        /// </summary>
+        /// <param name="timeUtc">The time the entries are compared against</param>
+        /// <param name="changedFile">The first changed entry, if any</param>
+        /// <param name="changedFileTimeUtc">The last write time of the changed entry</param>
+        /// <returns>True if an entry has changed</returns>
+        private bool FindFileWithChangedContents(DateTime timeUtc, out string changedFile, out DateTime changedFileTimeUtc)
+        {
+            _contentHashes ??= TrackedContentHashes.Load(TlogFiles);
+
+            var newerFiles = new List<KeyValuePair<string, DateTime>>();
+            foreach (KeyValuePair<string, DateTime> entry in DependencyTable)
+            {
+                if (entry.Value > timeUtc)
+                {
+                    newerFiles.Add(entry);
+                }
+            }
+
+            // Hash the newer files in parallel, settling on the first changed one in table order
+            var changed = new bool[newerFiles.Count];
+            Parallel.For(0, newerFiles.Count, i => changed[i] = !_contentHashes.IsUnchangedSince(newerFiles[i].Key, newerFiles[i].Value, timeUtc));
+
+            int firstChanged = Array.IndexOf(changed, true);
+            changedFile = firstChanged >= 0 ? newerFiles[firstChanged].Key : null;
+            changedFileTimeUtc = firstChanged >= 0 ? newerFiles[firstChanged].Value : DateTime.MinValue;
+            return firstChanged >= 0;
+        }
+
+        /// <summary>
+        /// Record the contents of every entry, so that later up to date checks can tell entries that
+        /// have only been touched from entries that have changed.
+        /// </summary>
+        private void RecordContentHashes()
+        {
+            _contentHashes ??= TrackedContentHashes.Load(TlogFiles);
+
+            // The write times are looked up first, since their cache isn't safe to use concurrently
+            var entries = new List<KeyValuePair<string, DateTime>>(DependencyTable.Count);
+            foreach (string file in DependencyTable.Keys)
+            {
+                entries.Add(new KeyValuePair<string, DateTime>(file, GetLastWriteTimeUtc(file)));
+            }
+
+            Parallel.For(0, entries.Count, i => _contentHashes.Record(entries[i].Key, entries[i].Value));
+
+            _contentHashes.Save();
+        }
+
         /// <summary>
         /// Returns cached value for last write time of file. Update the cache if it is the first 
         /// time someone asking for that file
@@ -659,7 +728,7 @@ namespace Microsoft.Build.Utilities
         {
             if (!_lastWriteTimeUtcCache.TryGetValue(file, out DateTime fileModifiedTimeUtc))
             {
-                fileModifiedTimeUtc = NativeMethodsShared.GetLastWriteFileUtcTime(file);
+                fileModifiedTimeUtc = SharedFileTimestampCache.GetLastWriteFileUtcTime(file, _sharedLastWriteTimeUtcCache);
                 _lastWriteTimeUtcCache[file] = fileModifiedTimeUtc;
             }
 
@@ -723,6 +792,13 @@ namespace Microsoft.Build.Utilities
             // Keep a record of the task resources that was in use before
             ResourceManager taskResources = Log.TaskResources;
 
+            string tlogNames = null;
+            if (MSBuildEventSource.Log.IsEnabled())
+            {
+                tlogNames = TlogReadStatistics.FormatTlogNames(inputs.TlogFiles);
+                MSBuildEventSource.Log.TrackedDependenciesUpToDateCheckStart(tlogNames);
+            }
+
             Log.TaskResources = AssemblyResources.PrimaryResources;
 
             inputs.UpdateFileEntryDetails();
@@ -795,6 +871,13 @@ namespace Microsoft.Build.Utilities
                 // One of the inputs is newer than the outputs
                 Log.LogMessageFromResources(MessageImportance.Low, "Tracking_DependencyWasModifiedAt", inputs.NewestFileName, inputs.NewestFileTimeUtc, outputs.NewestFileName, outputs.NewestFileTimeUtc);
             }
+            else if (upToDateCheckType == UpToDateCheckType.InputNewerThanOutputAndContentsChanged &&
+                    inputs.NewestFileTimeUtc > outputs.NewestFileTimeUtc &&
+                    inputs.FindFileWithChangedContents(outputs.NewestFileTimeUtc, out string changedFile, out DateTime changedFileTimeUtc))
+            {
+                // One of the inputs is newer than the outputs, and not just because it was touched
+                Log.LogMessageFromResources(MessageImportance.Low, "Tracking_DependencyWasModifiedAt", changedFile, changedFileTimeUtc, outputs.NewestFileName, outputs.NewestFileTimeUtc);
+            }
             else if (upToDateCheckType == UpToDateCheckType.InputNewerThanTracking &&
                     inputs.NewestFileTimeUtc > inputs.NewestTLogTimeUtc)
             {
@@ -814,9 +897,20 @@ namespace Microsoft.Build.Utilities
                 Log.LogMessageFromResources(MessageImportance.Normal, "Tracking_UpToDate");
             }
 
+            if (upToDateCheckType == UpToDateCheckType.InputNewerThanOutputAndContentsChanged && inputs.TlogsAvailable)
+            {
+                // Whatever is built next is built from the inputs as they are now
+                inputs.RecordContentHashes();
+            }
+
             // Set the task resources back now that we're done with it
             Log.TaskResources = taskResources;
 
+            if (tlogNames != null)
+            {
+                MSBuildEventSource.Log.TrackedDependenciesUpToDateCheckStop(tlogNames, inputs._lastWriteTimeUtcCache.Count + outputs._lastWriteTimeUtcCache.Count, isUpToDate ? 0 : 1);
+            }
+
             return isUpToDate;
         }
 
@@ -902,7 +996,13 @@ namespace Microsoft.Build.Utilities
         /// <summary>
         /// The input is newer than the tracking file.
         /// </summary>
-        InputNewerThanTracking
+        InputNewerThanTracking,
+        /// <summary>
+        /// The input is newer than the output, and its contents have changed since they were last seen
+        /// before the output was written. The contents of the inputs are hashed, so this is slower than
+        /// InputNewerThanOutput the first time but avoids rebuilding when inputs are only touched.
+        /// </summary>
+        InputNewerThanOutputAndContentsChanged
     }
 }
 
@@ -0,0 +1,147 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+
+#if FEATURE_FILE_TRACKER
+
+namespace Microsoft.Build.Utilities
+{
+    /// <summary>
+    /// A set of path prefixes compiled into a case insensitive trie, so that finding whether a path starts
+    /// with any of them costs at most one step per character of the longest prefix, however many there are.
+    /// </summary>
+    /// <remarks>
+    /// Characters are compared as <see cref="StringComparison.OrdinalIgnoreCase"/> compares them, by their
+    /// invariant upper case forms. Prefixes that are directories should end in a slash, so that C:\Foo\ does
+    /// not match C:\FooFile.txt. The set is immutable once built, so it is safe to share between threads.
+    /// </remarks>
+    internal sealed class PathPrefixSet
+    {
+        // Sets built for the excluded paths of tracking data, shared between the many instances that are
+        // created with the same exclusions over the course of a build
+        private static readonly ConcurrentDictionary<string, PathPrefixSet> s_sharedSets = new ConcurrentDictionary<string, PathPrefixSet>(StringComparer.Ordinal);
+
+        private const int MaxSharedSets = 32;
+
+        private readonly Node _root = new Node();
+
+        /// <summary>
+        /// Build the set of the given prefixes.
+        /// </summary>
+        /// <param name="prefixes">The prefixes to match</param>
+        internal PathPrefixSet(IEnumerable<string> prefixes)
+        {
+            foreach (string prefix in prefixes)
+            {
+                Node node = _root;
+                foreach (char c in prefix)
+                {
+                    node = node.GetOrAddChild(char.ToUpperInvariant(c));
+                }
+
+                node.IsPrefixEnd = true;
+            }
+        }
+
+        /// <summary>
+        /// Get a set of the given prefixes, reusing one built earlier for the same prefixes if there is one.
+        /// </summary>
+        /// <param name="prefixes">The prefixes to match</param>
+        internal static PathPrefixSet GetShared(IReadOnlyList<string> prefixes)
+        {
+            string key = string.Join("|", prefixes);
+
+            if (!s_sharedSets.TryGetValue(key, out PathPrefixSet set))
+            {
+                // The exclusions in use in a build are few; a build that somehow uses many more just
+                // stops sharing the older ones
+                if (s_sharedSets.Count >= MaxSharedSets)
+                {
+                    s_sharedSets.Clear();
+                }
+
+                set = s_sharedSets.GetOrAdd(key, new PathPrefixSet(prefixes));
+            }
+
+            return set;
+        }
+
+        /// <summary>
+        /// Determine whether the path starts with any of the prefixes in the set.
+        /// </summary>
+        /// <param name="path">The path to test</param>
+        internal bool MatchesStartOf(string path)
+        {
+            Node node = _root;
+            if (node.IsPrefixEnd)
+            {
+                return true;
+            }
+
+            foreach (char c in path)
+            {
+                node = node.GetChild(char.ToUpperInvariant(c));
+                if (node == null)
+                {
+                    return false;
+                }
+
+                if (node.IsPrefixEnd)
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        private sealed class Node
+        {
+            // Most nodes of a set of paths have a single child, so the children are kept in small arrays
+            // that are searched in order rather than in a dictionary
+            private char[] _keys = Array.Empty<char>();
+            private Node[] _children = Array.Empty<Node>();
+
+            internal bool IsPrefixEnd { get; set; }
+
+            internal Node GetChild(char key)
+            {
+                for (int i = 0; i < _keys.Length; i++)
+                {
+                    if (_keys[i] == key)
+                    {
+                        return _children[i];
+                    }
+                }
+
+                return null;
+            }
+
+            internal Node GetOrAddChild(char key)
+            {
+                Node child = GetChild(key);
+                if (child == null)
+                {
+                    child = new Node();
+
+                    var keys = new char[_keys.Length + 1];
+                    var children = new Node[_children.Length + 1];
+                    _keys.CopyTo(keys, 0);
+                    _children.CopyTo(children, 0);
+                    keys[_keys.Length] = key;
+                    children[_children.Length] = child;
+
+                    _keys = keys;
+                    _children = children;
+                }
+
+                return child;
+            }
+        }
+    }
+}
+
+#endif
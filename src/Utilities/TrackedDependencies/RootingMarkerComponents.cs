@@ -0,0 +1,108 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections.Generic;
+
+#if FEATURE_FILE_TRACKER
+
+namespace Microsoft.Build.Utilities
+{
+    /// <summary>
+    /// The set of paths that make up a composite rooting marker, built once so that each root in a
+    /// dependency table can be checked against it in time proportional to the length of that root,
+    /// rather than by splitting the root and scanning the whole marker for every part of it.
+    /// </summary>
+    /// <remarks>
+    /// Components are compared ordinally; rooting markers are upper cased when they are formatted.
+    /// The components are kept as ranges of the marker, and looked up by ranges of the root being
+    /// checked, so that checking a root allocates nothing.
+    /// </remarks>
+    internal sealed class RootingMarkerComponents
+    {
+        private readonly HashSet<Component> _components = new HashSet<Component>();
+
+        /// <summary>
+        /// Build the set of components of the given rooting marker.
+        /// </summary>
+        /// <param name="rootingMarker">The rooting marker, its paths separated by '|'</param>
+        internal RootingMarkerComponents(string rootingMarker)
+        {
+            int start = 0;
+            while (start <= rootingMarker.Length)
+            {
+                int end = GetComponentEnd(rootingMarker, start);
+                _components.Add(new Component(rootingMarker, start, end - start));
+                start = end + 1;
+            }
+        }
+
+        /// <summary>
+        /// Determine whether every component of the given rooting marker is also a component of this one.
+        /// </summary>
+        /// <param name="compositeSubRoot">The rooting marker to look for the components of</param>
+        internal bool ContainsAll(string compositeSubRoot)
+        {
+            int start = 0;
+            while (start <= compositeSubRoot.Length)
+            {
+                int end = GetComponentEnd(compositeSubRoot, start);
+
+                // An empty component is contained in anything
+                if (end > start && !_components.Contains(new Component(compositeSubRoot, start, end - start)))
+                {
+                    return false;
+                }
+
+                start = end + 1;
+            }
+
+            return true;
+        }
+
+        private static int GetComponentEnd(string rootingMarker, int start)
+        {
+            int end = rootingMarker.IndexOf('|', start);
+            return end < 0 ? rootingMarker.Length : end;
+        }
+
+        /// <summary>
+        /// A range of a rooting marker holding one of its paths.
+        /// </summary>
+        private readonly struct Component : IEquatable<Component>
+        {
+            private readonly string _rootingMarker;
+            private readonly int _start;
+            private readonly int _length;
+
+            internal Component(string rootingMarker, int start, int length)
+            {
+                _rootingMarker = rootingMarker;
+                _start = start;
+                _length = length;
+            }
+
+            public bool Equals(Component other)
+                => _length == other._length &&
+                   string.CompareOrdinal(_rootingMarker, _start, other._rootingMarker, other._start, _length) == 0;
+
+            public override bool Equals(object obj) => obj is Component other && Equals(other);
+
+            public override int GetHashCode()
+            {
+                unchecked
+                {
+                    int hash = (int)2166136261;
+                    for (int i = _start; i < _start + _length; i++)
+                    {
+                        hash = (hash ^ _rootingMarker[i]) * 16777619;
+                    }
+
+                    return hash;
+                }
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,81 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System.Threading;
+
+using Microsoft.Build.Eventing;
+using Microsoft.Build.Framework;
+
+#if FEATURE_FILE_TRACKER
+
+namespace Microsoft.Build.Utilities
+{
+    /// <summary>
+    /// The amount read from a set of tlogs as they are read into a dependency table, reported through
+    /// <see cref="MSBuildEventSource"/>. The counts are only collected while tracing is enabled.
+    /// </summary>
+    internal sealed class TlogReadStatistics
+    {
+        private readonly string _tlogNames;
+
+        private long _bytesRead;
+        private int _linesRead;
+
+        private TlogReadStatistics(string tlogNames)
+        {
+            _tlogNames = tlogNames;
+        }
+
+        /// <summary>
+        /// Report that the given tlogs are being read, and start counting what is read from them.
+        /// </summary>
+        /// <param name="tlogFiles">The tlogs being read</param>
+        /// <returns>The statistics to collect, or null if tracing is not enabled</returns>
+        internal static TlogReadStatistics Start(ITaskItem[] tlogFiles)
+        {
+            if (!MSBuildEventSource.Log.IsEnabled())
+            {
+                return null;
+            }
+
+            var statistics = new TlogReadStatistics(FormatTlogNames(tlogFiles));
+            MSBuildEventSource.Log.ReadTrackingLogsStart(statistics._tlogNames);
+            return statistics;
+        }
+
+        /// <summary>
+        /// Describe a set of tlogs for an event.
+        /// </summary>
+        internal static string FormatTlogNames(ITaskItem[] tlogFiles)
+        {
+            if (tlogFiles == null)
+            {
+                return string.Empty;
+            }
+
+            var names = new string[tlogFiles.Length];
+            for (int i = 0; i < tlogFiles.Length; i++)
+            {
+                names[i] = tlogFiles[i].ItemSpec;
+            }
+
+            return string.Join(";", names);
+        }
+
+        /// <summary>
+        /// Add what was read from one of the tlogs. Tlogs may be read concurrently.
+        /// </summary>
+        internal void Add(long bytesRead, int linesRead)
+        {
+            Interlocked.Add(ref _bytesRead, bytesRead);
+            Interlocked.Add(ref _linesRead, linesRead);
+        }
+
+        /// <summary>
+        /// Report that the tlogs have been read, and how much was read from them.
+        /// </summary>
+        internal void Stop() => MSBuildEventSource.Log.ReadTrackingLogsStop(_tlogNames, Interlocked.Read(ref _bytesRead), Volatile.Read(ref _linesRead));
+    }
+}
+
+#endif
@@ -0,0 +1,239 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+
+using Microsoft.Build.Framework;
+using Microsoft.Build.Shared;
+using Microsoft.Build.Shared.FileSystem;
+
+#if FEATURE_FILE_TRACKER
+
+namespace Microsoft.Build.Utilities
+{
+    /// <summary>
+    /// The content hashes of tracked inputs as of the last up to date check, so that an input whose
+    /// timestamp has moved on without its contents changing, as happens when switching branches, doesn't
+    /// force its outputs to be rebuilt.
+    /// </summary>
+    /// <remarks>
+    /// The hashes are kept in a file next to the first tlog rather than in the tlogs themselves, which
+    /// other tools read and write as plain lists of paths. Each record holds the hash and length of the
+    /// file, the write time the file had when those contents were first seen, and the most recent write
+    /// time at which the contents were verified to be the same, so that a file is only read again when
+    /// its timestamp changes.
+    ///
+    /// An input is unchanged with respect to an output only if its current contents were first seen no
+    /// later than the output was written; otherwise the output may have been built from older contents.
+    /// </remarks>
+    internal sealed class TrackedContentHashes
+    {
+        private static readonly byte[] s_signature = { (byte)'M', (byte)'S', (byte)'B', (byte)'H', (byte)'A', (byte)'S', (byte)'H', 1 };
+
+        private readonly string _path;
+
+        // The records read from disk, and those recorded or verified since
+        private readonly Dictionary<string, ContentRecord> _previousRecords;
+        private readonly ConcurrentDictionary<string, ContentRecord> _records = new ConcurrentDictionary<string, ContentRecord>(StringComparer.OrdinalIgnoreCase);
+
+        private TrackedContentHashes(string path, Dictionary<string, ContentRecord> previousRecords)
+        {
+            _path = path;
+            _previousRecords = previousRecords;
+        }
+
+        /// <summary>
+        /// Load the content hashes kept for the given tlogs. Missing or unreadable hashes are treated as
+        /// though no inputs had been seen before.
+        /// </summary>
+        /// <param name="tlogFiles">The tlogs the inputs were read from</param>
+        internal static TrackedContentHashes Load(ITaskItem[] tlogFiles)
+        {
+            string path = FileUtilities.NormalizePath(tlogFiles[0].ItemSpec) + ".hashes";
+            var records = new Dictionary<string, ContentRecord>(StringComparer.OrdinalIgnoreCase);
+
+            try
+            {
+                if (FileSystems.Default.FileExists(path))
+                {
+                    using (var reader = new BinaryReader(new FileStream(path, FileMode.Open, FileAccess.Read, FileShare.Read, 4096, FileOptions.SequentialScan)))
+                    {
+                        if (reader.ReadBytes(s_signature.Length).SequenceEqual(s_signature))
+                        {
+                            int count = reader.ReadInt32();
+                            for (int i = 0; i < count; i++)
+                            {
+                                string file = reader.ReadString();
+                                records[file] = new ContentRecord(
+                                    new DateTime(reader.ReadInt64(), DateTimeKind.Utc),
+                                    new DateTime(reader.ReadInt64(), DateTimeKind.Utc),
+                                    reader.ReadInt64(),
+                                    reader.ReadUInt64());
+                            }
+                        }
+                    }
+                }
+            }
+            catch (Exception e) when (ExceptionHandling.IsIoRelatedException(e))
+            {
+                records.Clear();
+            }
+
+            return new TrackedContentHashes(path, records);
+        }
+
+        /// <summary>
+        /// Determine whether the contents of a file newer than an output are the same as they were
+        /// before the output was written.
+        /// </summary>
+        /// <param name="file">The full path of the file</param>
+        /// <param name="lastWriteTimeUtc">The current write time of the file</param>
+        /// <param name="outputTimeUtc">The write time of the output</param>
+        internal bool IsUnchangedSince(string file, DateTime lastWriteTimeUtc, DateTime outputTimeUtc)
+        {
+            ContentRecord record = GetRecord(file);
+            if (record == null || record.ContentTimeUtc > outputTimeUtc)
+            {
+                return false;
+            }
+
+            if (record.VerifiedTimeUtc == lastWriteTimeUtc)
+            {
+                return true;
+            }
+
+            if (!TryHashFile(file, record.Length, out long length, out ulong hash) || length != record.Length || hash != record.Hash)
+            {
+                return false;
+            }
+
+            _records[file] = new ContentRecord(record.ContentTimeUtc, lastWriteTimeUtc, length, hash);
+            return true;
+        }
+
+        /// <summary>
+        /// Record the current contents of a file, reading it only if its write time has changed since
+        /// its contents were last seen.
+        /// </summary>
+        /// <param name="file">The full path of the file</param>
+        /// <param name="lastWriteTimeUtc">The current write time of the file, or DateTime.MinValue if it is missing</param>
+        internal void Record(string file, DateTime lastWriteTimeUtc)
+        {
+            if (lastWriteTimeUtc == DateTime.MinValue)
+            {
+                return;
+            }
+
+            ContentRecord record = GetRecord(file);
+            if (record?.VerifiedTimeUtc == lastWriteTimeUtc)
+            {
+                _records[file] = record;
+            }
+            else if (TryHashFile(file, -1, out long length, out ulong hash))
+            {
+                _records[file] = record != null && record.Length == length && record.Hash == hash
+                    ? new ContentRecord(record.ContentTimeUtc, lastWriteTimeUtc, length, hash)
+                    : new ContentRecord(lastWriteTimeUtc, lastWriteTimeUtc, length, hash);
+            }
+        }
+
+        /// <summary>
+        /// Write out the records of the files recorded or verified since the hashes were loaded, replacing
+        /// the previous ones. Failures are ignored; the inputs are simply treated as unseen next time.
+        /// </summary>
+        internal void Save()
+        {
+            try
+            {
+                using (var writer = new BinaryWriter(new FileStream(_path, FileMode.Create, FileAccess.Write, FileShare.None)))
+                {
+                    writer.Write(s_signature);
+                    writer.Write(_records.Count);
+                    foreach (KeyValuePair<string, ContentRecord> entry in _records)
+                    {
+                        writer.Write(entry.Key);
+                        writer.Write(entry.Value.ContentTimeUtc.Ticks);
+                        writer.Write(entry.Value.VerifiedTimeUtc.Ticks);
+                        writer.Write(entry.Value.Length);
+                        writer.Write(entry.Value.Hash);
+                    }
+                }
+            }
+            catch (Exception e) when (ExceptionHandling.IsIoRelatedException(e))
+            {
+                // Don't leave partially written hashes behind
+                try
+                {
+                    File.Delete(_path);
+                }
+                catch (Exception ex) when (ExceptionHandling.IsIoRelatedException(ex))
+                {
+                }
+            }
+        }
+
+        private ContentRecord GetRecord(string file)
+        {
+            if (!_records.TryGetValue(file, out ContentRecord record))
+            {
+                _previousRecords.TryGetValue(file, out record);
+            }
+
+            return record;
+        }
+
+        /// <summary>
+        /// Hash the contents of the file, unless its length shows it has changed already.
+        /// </summary>
+        private static bool TryHashFile(string file, long expectedLength, out long length, out ulong hash)
+        {
+            hash = 0;
+            try
+            {
+                using (var stream = new FileStream(file, FileMode.Open, FileAccess.Read, FileShare.Read, 1, FileOptions.SequentialScan))
+                {
+                    length = stream.Length;
+                    if (expectedLength >= 0 && length != expectedLength)
+                    {
+                        return true;
+                    }
+
+                    hash = XxHash64.Hash(stream);
+                    return true;
+                }
+            }
+            catch (Exception e) when (ExceptionHandling.IsIoRelatedException(e))
+            {
+                length = -1;
+                return false;
+            }
+        }
+
+        private sealed class ContentRecord
+        {
+            internal ContentRecord(DateTime contentTimeUtc, DateTime verifiedTimeUtc, long length, ulong hash)
+            {
+                ContentTimeUtc = contentTimeUtc;
+                VerifiedTimeUtc = verifiedTimeUtc;
+                Length = length;
+                Hash = hash;
+            }
+
+            // The write time of the file when these contents were first seen
+            internal DateTime ContentTimeUtc { get; }
+
+            // The most recent write time at which the file was found to have these contents
+            internal DateTime VerifiedTimeUtc { get; }
+
+            internal long Length { get; }
+
+            internal ulong Hash { get; }
+        }
+    }
+}
+
+#endif
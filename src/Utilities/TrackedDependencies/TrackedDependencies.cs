@@ -1,8 +1,11 @@
 ﻿// Copyright (c) Microsoft. All rights reserved.
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
+using System;
 using System.Collections.Generic;
 using System.IO;
+using System.Runtime.ExceptionServices;
+using System.Threading.Tasks;
 
 using Microsoft.Build.Framework;
 using Microsoft.Build.Shared;
@@ -88,6 +91,80 @@ namespace Microsoft.Build.Utilities
             }
             return allExist;
         }
+
+        /// <summary>
+        /// Read each of the tlogs on its own, concurrently when there is more than one, so that the
+        /// partial results can then be merged in tlog order.
+        /// </summary>
+        /// <param name="tlogFiles">The tlogs to read</param>
+        /// <param name="readTlog">Reads a single tlog, returning null if its contents are invalid</param>
+        /// <returns>The contents of each tlog, in the same order as the tlogs</returns>
+        internal static TlogContents<T>[] ReadTlogs<T>(ITaskItem[] tlogFiles, Func<string, T> readTlog) where T : class
+        {
+            var contents = new TlogContents<T>[tlogFiles.Length];
+
+            void ReadTlog(int index)
+            {
+                try
+                {
+                    contents[index] = new TlogContents<T>(readTlog(tlogFiles[index].ItemSpec), null);
+                }
+                catch (Exception e)
+                {
+                    // Surfaced when the tlog is merged, so that failures are reported in tlog order
+                    contents[index] = new TlogContents<T>(null, ExceptionDispatchInfo.Capture(e));
+                }
+            }
+
+            if (tlogFiles.Length > 1)
+            {
+                Parallel.For(0, tlogFiles.Length, ReadTlog);
+            }
+            else if (tlogFiles.Length == 1)
+            {
+                ReadTlog(0);
+            }
+
+            return contents;
+        }
         #endregion
     }
+
+    /// <summary>
+    /// The contents of a single tlog, read independently of the others.
+    /// </summary>
+    internal readonly struct TlogContents<T> where T : class
+    {
+        private readonly ExceptionDispatchInfo _exception;
+
+        internal TlogContents(T table, ExceptionDispatchInfo exception)
+        {
+            Table = table;
+            _exception = exception;
+        }
+
+        /// <summary>
+        /// The table read from the tlog, or null if it was invalid or could not be read.
+        /// </summary>
+        internal T Table { get; }
+
+        /// <summary>
+        /// The I/O related exception that stopped the tlog being read, if any. Any other exception
+        /// is rethrown on the calling thread.
+        /// </summary>
+        internal Exception GetIoException()
+        {
+            if (_exception == null)
+            {
+                return null;
+            }
+
+            if (!ExceptionHandling.IsIoRelatedException(_exception.SourceException))
+            {
+                _exception.Throw();
+            }
+
+            return _exception.SourceException;
+        }
+    }
 }
@@ -0,0 +1,400 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.IO;
+using System.Text;
+using System.Threading;
+using System.Threading.Tasks;
+
+using Microsoft.Build.Eventing;
+using Microsoft.Build.Framework;
+using Microsoft.Build.Shared;
+using Microsoft.Build.Shared.FileSystem;
+
+#if FEATURE_FILE_TRACKER
+
+namespace Microsoft.Build.Utilities
+{
+    /// <summary>
+    /// The compacted tlogs saved by this process, written to disk in the background and kept in memory until they are
+    /// next read, so that a task reading a tlog saved earlier in the build gets its lines without reading it back.
+    /// </summary>
+    /// <remarks>
+    /// The tlogs are written one set at a time, in the order they were saved. The compacted tlog is written to a temporary
+    /// file that then replaces the first tlog, and only after that are the tlogs it replaces emptied, so that a process that
+    /// exits in the middle of a write leaves the dependencies in either the old tlogs or the new one, never in neither.
+    /// Anything else that reads or writes tlogs waits for the pending writes to them first: the tracking classes, when they
+    /// are constructed, and <see cref="FileTracker"/>, for the tlogs in its intermediate directory. <see cref="ToolTask"/>
+    /// cannot tell which tlogs a tracked tool uses, so it waits for every pending write before it starts Tracker.
+    /// A write that fails is traced, and leaves the tlogs it was to replace as they were.
+    /// </remarks>
+    internal static class WrittenTlogCache
+    {
+        /// <summary>
+        /// The most tlogs kept in memory once saved, for the case where nothing in the process reads them again.
+        /// </summary>
+        private const int Capacity = 64;
+
+        private static readonly ConcurrentDictionary<string, WrittenTlog> s_tlogs = new ConcurrentDictionary<string, WrittenTlog>(StringComparer.OrdinalIgnoreCase);
+
+        private static readonly object s_writeLock = new object();
+
+        private static System.Threading.Tasks.Task s_lastWrite = System.Threading.Tasks.Task.CompletedTask;
+
+        /// <summary>
+        /// The writes which haven't finished, in the order they were saved.
+        /// </summary>
+        private static readonly List<PendingWrite> s_pendingWrites = new List<PendingWrite>();
+
+        private static long s_lastSaveOrder;
+
+        private static bool s_waitsForWritesOnExit;
+
+        /// <summary>
+        /// Opens a writer for the compacted contents of a set of tlogs, which replaces them once the writer is disposed.
+        /// </summary>
+        /// <param name="tlogFiles">The tlogs being compacted, the first of which is replaced by the compacted tlog</param>
+        internal static TextWriter OpenCompactedWrite(ITaskItem[] tlogFiles) => new CompactedTlogWriter(tlogFiles);
+
+        /// <summary>
+        /// Opens a reader for the lines of a tlog saved by this process, if they are still in memory and the tlog hasn't
+        /// been written since. The lines are handed out once, as the reader of a tlog keeps what it read.
+        /// </summary>
+        /// <param name="tlogPath">The path to the tlog</param>
+        /// <returns>The reader, or null if the tlog has to be read from disk</returns>
+        internal static TextReader TryOpenRead(string tlogPath)
+        {
+            if (s_tlogs.IsEmpty || !s_tlogs.TryRemove(FileUtilities.NormalizePath(tlogPath), out WrittenTlog tlog))
+            {
+                return null;
+            }
+
+            tlog.Written.Wait();
+
+            // A tlog that failed to write, or that a tracked tool wrote to since, is read from disk
+            if (tlog.LastWriteTimeUtc == DateTime.MinValue || tlog.LastWriteTimeUtc != NativeMethodsShared.GetLastWriteFileUtcTime(tlogPath))
+            {
+                return null;
+            }
+
+            return new LineListReader(tlog.Lines);
+        }
+
+        /// <summary>
+        /// Waits for every tlog saved so far to be written to disk.
+        /// </summary>
+        internal static void WaitForPendingWrites()
+        {
+            System.Threading.Tasks.Task lastWrite;
+            lock (s_writeLock)
+            {
+                lastWrite = s_lastWrite;
+            }
+
+            lastWrite.Wait();
+        }
+
+        /// <summary>
+        /// Waits for the tlogs saved so far among the given ones to be written to disk. A wildcard waits for the tlogs saved
+        /// in its directory, or for every tlog if its directory has wildcards too.
+        /// </summary>
+        /// <param name="tlogFiles">The tlogs about to be read or written, which may contain wildcards</param>
+        internal static void WaitForPendingWrites(ITaskItem[] tlogFiles)
+        {
+            if (tlogFiles == null)
+            {
+                return;
+            }
+
+            var tlogPaths = new HashSet<string>(StringComparer.OrdinalIgnoreCase);
+            var tlogDirectories = new HashSet<string>(StringComparer.OrdinalIgnoreCase);
+            foreach (ITaskItem tlogFile in tlogFiles)
+            {
+                if (!FileMatcher.HasWildcards(tlogFile.ItemSpec))
+                {
+                    tlogPaths.Add(FileUtilities.NormalizePath(tlogFile.ItemSpec));
+                    continue;
+                }
+
+                string directory = Path.GetDirectoryName(tlogFile.ItemSpec);
+                if (FileMatcher.HasWildcards(directory))
+                {
+                    WaitForPendingWrites();
+                    return;
+                }
+
+                tlogDirectories.Add(GetFullDirectoryPath(directory));
+            }
+
+            WaitForPendingWrites(tlogPath => tlogPaths.Contains(tlogPath) || tlogDirectories.Contains(Path.GetDirectoryName(tlogPath)));
+        }
+
+        /// <summary>
+        /// Waits for the tlogs saved so far in a directory to be written to disk.
+        /// </summary>
+        /// <param name="directory">The directory, or null for every tlog</param>
+        internal static void WaitForPendingWritesInDirectory(string directory)
+        {
+            if (string.IsNullOrEmpty(directory))
+            {
+                WaitForPendingWrites();
+                return;
+            }
+
+            string fullDirectory = GetFullDirectoryPath(directory);
+            WaitForPendingWrites(tlogPath => string.Equals(Path.GetDirectoryName(tlogPath), fullDirectory, StringComparison.OrdinalIgnoreCase));
+        }
+
+        /// <summary>
+        /// Waits for the pending writes of any tlog that matches.
+        /// </summary>
+        private static void WaitForPendingWrites(Func<string, bool> isAwaitedTlog)
+        {
+            System.Threading.Tasks.Task lastAwaitedWrite = null;
+            lock (s_writeLock)
+            {
+                foreach (PendingWrite pendingWrite in s_pendingWrites)
+                {
+                    foreach (KeyValuePair<string, WrittenTlog> tlog in pendingWrite.Tlogs)
+                    {
+                        if (isAwaitedTlog(tlog.Key))
+                        {
+                            // Each write follows those saved before it, so waiting for the last one waits for them all
+                            lastAwaitedWrite = tlog.Value.Written;
+                            break;
+                        }
+                    }
+                }
+            }
+
+            lastAwaitedWrite?.Wait();
+        }
+
+        private static string GetFullDirectoryPath(string directory)
+            => FileUtilities.EnsureNoTrailingSlash(Path.GetFullPath(string.IsNullOrEmpty(directory) ? "." : directory));
+
+        private static void Save(ITaskItem[] tlogFiles, List<string> lines)
+        {
+            var tlogs = new KeyValuePair<string, WrittenTlog>[tlogFiles.Length];
+            System.Threading.Tasks.Task written;
+
+            lock (s_writeLock)
+            {
+                for (int i = 0; i < tlogFiles.Length; i++)
+                {
+                    tlogs[i] = new KeyValuePair<string, WrittenTlog>(
+                        FileUtilities.NormalizePath(tlogFiles[i].ItemSpec),
+                        new WrittenTlog(i == 0 ? lines : new List<string>(), ++s_lastSaveOrder));
+                }
+
+                if (!s_waitsForWritesOnExit)
+                {
+                    AppDomain.CurrentDomain.ProcessExit += (sender, e) => WaitForPendingWrites();
+                    s_waitsForWritesOnExit = true;
+                }
+
+                var pendingWrite = new PendingWrite(tlogs);
+                written = s_lastWrite.ContinueWith(_ => Write(pendingWrite), CancellationToken.None, TaskContinuationOptions.None, TaskScheduler.Default);
+                s_lastWrite = written;
+                s_pendingWrites.Add(pendingWrite);
+
+                foreach (KeyValuePair<string, WrittenTlog> tlog in tlogs)
+                {
+                    tlog.Value.Written = written;
+                    s_tlogs[tlog.Key] = tlog.Value;
+                }
+            }
+
+            if (s_tlogs.Count > Capacity)
+            {
+                Trim();
+            }
+        }
+
+        private static void Write(PendingWrite pendingWrite)
+        {
+            KeyValuePair<string, WrittenTlog>[] tlogs = pendingWrite.Tlogs;
+            string firstTlog = tlogs[0].Key;
+            string temporaryTlog = firstTlog + "." + Guid.NewGuid().ToString("N") + ".tmp";
+
+            try
+            {
+                using (TextWriter writer = BinaryTlog.OpenWrite(temporaryTlog))
+                {
+                    foreach (string line in tlogs[0].Value.Lines)
+                    {
+                        writer.WriteLine(line);
+                    }
+                }
+
+                if (FileSystems.Default.FileExists(firstTlog))
+                {
+                    File.Replace(temporaryTlog, firstTlog, null);
+                }
+                else
+                {
+                    File.Move(temporaryTlog, firstTlog);
+                }
+
+                tlogs[0].Value.LastWriteTimeUtc = NativeMethodsShared.GetLastWriteFileUtcTime(firstTlog);
+
+                // The other tlogs are emptied only once the compacted tlog holds their dependencies
+                for (int i = 1; i < tlogs.Length; i++)
+                {
+                    File.WriteAllText(tlogs[i].Key, "", Encoding.Unicode);
+                    tlogs[i].Value.LastWriteTimeUtc = NativeMethodsShared.GetLastWriteFileUtcTime(tlogs[i].Key);
+                }
+            }
+            catch (Exception e) when (ExceptionHandling.IsIoRelatedException(e))
+            {
+                // The task that saved the tlogs may have finished, so there is no one left to log to. Readers get whatever
+                // is on disk instead, which still holds every dependency, if not compacted.
+                MSBuildEventSource.Log.SaveTrackingLogFailed(firstTlog, e.Message);
+                FileUtilities.DeleteNoThrow(temporaryTlog);
+
+                foreach (KeyValuePair<string, WrittenTlog> tlog in tlogs)
+                {
+                    ((ICollection<KeyValuePair<string, WrittenTlog>>)s_tlogs).Remove(tlog);
+                }
+            }
+            finally
+            {
+                lock (s_writeLock)
+                {
+                    s_pendingWrites.Remove(pendingWrite);
+                }
+            }
+        }
+
+        /// <summary>
+        /// Forgets the tlogs saved longest ago, down to the capacity. They are still written, and read from disk.
+        /// </summary>
+        private static void Trim()
+        {
+            KeyValuePair<string, WrittenTlog>[] tlogs = s_tlogs.ToArray();
+            Array.Sort(tlogs, (x, y) => x.Value.SaveOrder.CompareTo(y.Value.SaveOrder));
+
+            for (int i = 0; i < tlogs.Length - Capacity; i++)
+            {
+                ((ICollection<KeyValuePair<string, WrittenTlog>>)s_tlogs).Remove(tlogs[i]);
+            }
+        }
+
+        /// <summary>
+        /// A set of tlogs being written together, the first replaced by the compacted tlog and the others emptied.
+        /// </summary>
+        private sealed class PendingWrite
+        {
+            internal PendingWrite(KeyValuePair<string, WrittenTlog>[] tlogs)
+            {
+                Tlogs = tlogs;
+            }
+
+            internal KeyValuePair<string, WrittenTlog>[] Tlogs { get; }
+        }
+
+        private sealed class WrittenTlog
+        {
+            internal WrittenTlog(List<string> lines, long saveOrder)
+            {
+                Lines = lines;
+                SaveOrder = saveOrder;
+            }
+
+            internal List<string> Lines { get; }
+
+            internal long SaveOrder { get; }
+
+            /// <summary>
+            /// The write of the tlog, which sets <see cref="LastWriteTimeUtc"/> once it succeeds.
+            /// </summary>
+            internal System.Threading.Tasks.Task Written { get; set; }
+
+            internal DateTime LastWriteTimeUtc { get; set; } = DateTime.MinValue;
+        }
+
+        /// <summary>
+        /// Collects the lines of a compacted tlog and saves them when disposed.
+        /// </summary>
+        private sealed class CompactedTlogWriter : TextWriter
+        {
+            private readonly ITaskItem[] _tlogFiles;
+            private readonly List<string> _lines = new List<string>();
+            private readonly StringBuilder _currentLine = new StringBuilder();
+
+            internal CompactedTlogWriter(ITaskItem[] tlogFiles)
+            {
+                _tlogFiles = tlogFiles;
+            }
+
+            public override Encoding Encoding => Encoding.Unicode;
+
+            public override void Write(char value)
+            {
+                if (value == '\n')
+                {
+                    _lines.Add(_currentLine.ToString());
+                    _currentLine.Clear();
+                }
+                else if (value != '\r')
+                {
+                    _currentLine.Append(value);
+                }
+            }
+
+            public override void WriteLine(string value)
+            {
+                if (_currentLine.Length == 0)
+                {
+                    _lines.Add(value ?? string.Empty);
+                }
+                else
+                {
+                    _currentLine.Append(value);
+                    WriteLine();
+                }
+            }
+
+            protected override void Dispose(bool disposing)
+            {
+                if (disposing)
+                {
+                    if (_currentLine.Length > 0)
+                    {
+                        _lines.Add(_currentLine.ToString());
+                        _currentLine.Clear();
+                    }
+
+                    Save(_tlogFiles, _lines);
+                }
+
+                base.Dispose(disposing);
+            }
+        }
+
+        /// <summary>
+        /// Hands back the lines of a tlog held in memory.
+        /// </summary>
+        private sealed class LineListReader : TextReader
+        {
+            private readonly List<string> _lines;
+            private int _nextLine;
+
+            internal LineListReader(List<string> lines)
+            {
+                _lines = lines;
+            }
+
+            public override string ReadLine() => _nextLine < _lines.Count ? _lines[_nextLine++] : null;
+
+            public override int Peek() => throw new NotSupportedException();
+
+            public override int Read() => throw new NotSupportedException();
+        }
+    }
+}
+
+#endif